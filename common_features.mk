@@ -34,9 +34,16 @@ ifeq ($(strip $(AUDIO_ENABLE)), yes)
     OPT_DEFS += -DAUDIO_ENABLE
     MUSIC_ENABLE := 1
     SRC += $(QUANTUM_DIR)/process_keycode/process_audio.c
-    SRC += $(QUANTUM_DIR)/audio/audio.c
+    ifeq ($(PLATFORM),CHIBIOS)
+        SRC += $(QUANTUM_DIR)/audio/audio_arm.c
+        SRC += $(QUANTUM_DIR)/audio/mixer.c
+    else
+        SRC += $(QUANTUM_DIR)/audio/audio.c
+    endif
     SRC += $(QUANTUM_DIR)/audio/voices.c
     SRC += $(QUANTUM_DIR)/audio/luts.c
+    SRC += $(QUANTUM_DIR)/audio/synth.c
+    SRC += $(QUANTUM_DIR)/audio/song.c
 endif
 
 ifeq ($(strip $(MIDI_ENABLE)), yes)
@@ -69,6 +76,16 @@ ifeq ($(strip $(FAUXCLICKY_ENABLE)), yes)
     SRC += $(QUANTUM_DIR)/fauxclicky.c
 endif
 
+ifeq ($(strip $(DEBOUNCE_TYPE)), vertical)
+    OPT_DEFS += -DDEBOUNCE_VERTICAL
+    SRC += $(QUANTUM_DIR)/debounce.c
+endif
+
+ifeq ($(strip $(MATRIX_IDLE_WAKE)), yes)
+    OPT_DEFS += -DMATRIX_IDLE_WAKE_ENABLE
+    SRC += $(QUANTUM_DIR)/matrix_idle.c
+endif
+
 ifeq ($(strip $(POINTING_DEVICE_ENABLE)), yes)
 	SRC += $(QUANTUM_DIR)/pointing_device.c
 endif
@@ -104,6 +121,13 @@ ifeq ($(strip $(RGBLIGHT_ENABLE)), yes)
         OPT_DEFS += -DRGBLIGHT_CUSTOM_DRIVER
     else
 	    SRC += ws2812.c
+        ifeq ($(PLATFORM),CHIBIOS)
+            SRC += ws2812_encode.c
+        endif
+    endif
+    ifeq ($(strip $(RGBLIGHT_LAYERS)), yes)
+        OPT_DEFS += -DRGBLIGHT_LAYERS
+        SRC += $(QUANTUM_DIR)/rgblight_layers.c
     endif
 endif
 
@@ -147,9 +171,9 @@ ifeq ($(strip $(LCD_ENABLE)), yes)
 endif
 
 ifeq ($(strip $(BACKLIGHT_ENABLE)), yes)
-    ifeq ($(strip $(VISUALIZER_ENABLE)), yes)
-        CIE1931_CURVE = yes
-    endif
+    SRC += $(QUANTUM_DIR)/backlight_pwm.c
+    CIE1931_CURVE = yes
+    LED_BREATHING_TABLE = yes
 endif
 
 ifeq ($(strip $(CIE1931_CURVE)), yes)
@@ -171,6 +195,15 @@ ifeq ($(strip $(TERMINAL_ENABLE)), yes)
     OPT_DEFS += -DTERMINAL_ENABLE
 endif
 
+ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
+    OPT_DEFS += -DSPLIT_KEYBOARD
+    SRC += $(QUANTUM_DIR)/split_common/split_util.c \
+           $(QUANTUM_DIR)/split_common/transport.c \
+           $(QUANTUM_DIR)/split_common/i2c.c \
+           $(QUANTUM_DIR)/split_common/serial.c
+    COMMON_VPATH += $(QUANTUM_PATH)/split_common
+endif
+
 ifeq ($(strip $(USB_HID_ENABLE)), yes)
     include $(TMK_DIR)/protocol/usb_hid.mk
 endif
@@ -182,5 +215,9 @@ QUANTUM_SRC:= \
     $(QUANTUM_DIR)/process_keycode/process_leader.c
 
 ifndef CUSTOM_MATRIX
-    QUANTUM_SRC += $(QUANTUM_DIR)/matrix.c
+    ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
+        QUANTUM_SRC += $(QUANTUM_DIR)/split_common/matrix.c
+    else
+        QUANTUM_SRC += $(QUANTUM_DIR)/matrix.c
+    endif
 endif
@@ -0,0 +1,114 @@
+/*
+ * WS2812 over SPI and DMA, for ChibiOS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ch.h"
+#include "hal.h"
+#include "ws2812.h"
+#include "ws2812_encode.h"
+
+#ifndef WS2812_SPI
+  #define WS2812_SPI SPID1
+#endif
+#ifndef WS2812_MOSI_PORT
+  #define WS2812_MOSI_PORT GPIOB
+#endif
+#ifndef WS2812_MOSI_PIN
+  #define WS2812_MOSI_PIN 5
+#endif
+#ifndef WS2812_MOSI_PAL_MODE
+  #define WS2812_MOSI_PAL_MODE 5
+#endif
+#ifndef WS2812_SPI_CR1
+  // Clock / 32
+  #define WS2812_SPI_CR1 SPI_CR1_BR_2
+#endif
+
+#define BUFFER_SIZE WS2812_ENCODED_SIZE(RGBLED_NUM)
+
+// One being sent, the other filled or waiting
+static uint8_t buffers[2][BUFFER_SIZE];
+static uint16_t sizes[2];
+static uint8_t sending;
+static volatile bool active = false;
+static volatile bool queued = false;
+static bool started = false;
+
+// From the SPI interrupt, straight on to the frame waiting, if there's one
+static void transfer_done(SPIDriver *spip) {
+  osalSysLockFromISR();
+  if (queued) {
+    sending ^= 1;
+    queued = false;
+    spiStartSendI(spip, sizes[sending], buffers[sending]);
+  } else {
+    active = false;
+  }
+  osalSysUnlockFromISR();
+}
+
+static const SPIConfig spi_config = {
+  transfer_done,
+  NULL,
+  0,
+  WS2812_SPI_CR1,
+#ifdef SPI_CR2_DS
+  // 8-bit frames on the SPIv2 peripherals
+  SPI_CR2_DS_2 | SPI_CR2_DS_1 | SPI_CR2_DS_0,
+#endif
+};
+
+static void start(void) {
+  palSetPadMode(WS2812_MOSI_PORT, WS2812_MOSI_PIN, PAL_MODE_ALTERNATE(WS2812_MOSI_PAL_MODE));
+  spiStart(&WS2812_SPI, &spi_config);
+  started = true;
+}
+
+bool ws2812_busy(void) {
+  return queued;
+}
+
+void ws2812_setleds(LED_TYPE *ledarray, uint16_t number_of_leds) {
+  if (!started) {
+    start();
+  }
+  if (number_of_leds > RGBLED_NUM) {
+    number_of_leds = RGBLED_NUM;
+  }
+
+  // The buffer not being sent is free, whether a frame waits in it or not
+  osalSysLock();
+  queued = false;
+  uint8_t next = active ? sending ^ 1 : sending;
+  osalSysUnlock();
+
+  sizes[next] = ws2812_encode(ledarray, number_of_leds, buffers[next]);
+
+  osalSysLock();
+  if (active) {
+    queued = true;
+  } else {
+    sending = next;
+    active = true;
+    spiStartSendI(&WS2812_SPI, sizes[next], buffers[next]);
+  }
+  osalSysUnlock();
+}
+
+void ws2812_setleds_rgbw(LED_TYPE *ledarray, uint16_t number_of_leds) {
+  // LED_TYPE already has the white channel with RGBW
+  ws2812_setleds(ledarray, number_of_leds);
+}
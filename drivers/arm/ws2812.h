@@ -0,0 +1,47 @@
+/*
+ * WS2812 over SPI and DMA, for ChibiOS
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIGHT_WS2812_H_
+#define LIGHT_WS2812_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rgblight_types.h"
+
+/*
+ * The LEDs are driven from the MOSI pin of an SPI peripheral, which sends
+ * the frame by DMA. ws2812_setleds() encodes the frame and returns right
+ * away, while the previous frame may still be going out. There's room for
+ * one frame waiting behind the one being sent, a newer one replaces it.
+ *
+ * The board has to enable HAL_USE_SPI and the SPI driver in halconf.h and
+ * mcuconf.h. WS2812_SPI is the driver, SPID1 by default, and MOSI is
+ * WS2812_MOSI_PIN on WS2812_MOSI_PORT, PB5 by default, in alternate
+ * function WS2812_MOSI_PAL_MODE. WS2812_SPI_CR1 has to divide the SPI clock
+ * down to WS2812_SPI_BIT_RATE, 72 MHz / 32 on the STM32F303.
+ */
+
+// The frames go out without waiting, see ws2812_busy()
+#define WS2812_ASYNC
+
+void ws2812_setleds     (LED_TYPE *ledarray, uint16_t number_of_leds);
+void ws2812_setleds_rgbw(LED_TYPE *ledarray, uint16_t number_of_leds);
+
+// Whether a frame is still waiting behind the one being sent
+bool ws2812_busy(void);
+
+#endif /* LIGHT_WS2812_H_ */
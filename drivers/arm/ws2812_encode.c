@@ -0,0 +1,46 @@
+/*
+ * WS2812 bit stream for an SPI peripheral
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "ws2812_encode.h"
+
+// 100 eight times, the middle bit of each is the data
+#define ALL_ZEROS 0x924924UL
+
+uint32_t ws2812_encode_byte(uint8_t byte) {
+  uint32_t bits = ALL_ZEROS;
+  for (uint8_t i = 0; i < 8; i++) {
+    if (byte & (0x80 >> i)) {
+      bits |= 1UL << (22 - i * 3);
+    }
+  }
+  return bits;
+}
+
+uint16_t ws2812_encode(const LED_TYPE *leds, uint16_t count, uint8_t *buffer) {
+  // LED_TYPE is already in the order the LEDs take it
+  const uint8_t *data = (const uint8_t *)leds;
+  uint8_t *out = buffer;
+  for (uint16_t i = 0; i < count * sizeof(LED_TYPE); i++) {
+    uint32_t bits = ws2812_encode_byte(data[i]);
+    *out++ = bits >> 16;
+    *out++ = bits >> 8;
+    *out++ = bits;
+  }
+  memset(out, 0, WS2812_RESET_BYTES);
+  return WS2812_ENCODED_SIZE(count);
+}
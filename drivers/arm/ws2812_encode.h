@@ -0,0 +1,56 @@
+/*
+ * WS2812 bit stream for an SPI peripheral
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WS2812_ENCODE_H_
+#define WS2812_ENCODE_H_
+
+#include <stdint.h>
+#include "rgblight_types.h"
+
+/*
+ * Each bit for the LEDs takes three bits on MOSI: 100 for a 0 and 110 for a
+ * 1. At 2.25 MHz an SPI bit lasts 444 ns, which makes a 0 high for 444 ns
+ * and a 1 high for 889 ns out of 1.33 µs, all within the WS2812 timings.
+ * The frame ends with the line held low long enough for the LEDs to latch.
+ */
+
+// The SPI clock, in Hz
+#ifndef WS2812_SPI_BIT_RATE
+  #define WS2812_SPI_BIT_RATE 2250000UL
+#endif
+
+// How long the line is held low at the end of a frame, in µs
+#ifndef WS2812_RESET_US
+  #define WS2812_RESET_US 300
+#endif
+
+#define WS2812_SPI_BITS_PER_BIT 3
+#define WS2812_BYTES_PER_LED (sizeof(LED_TYPE) * WS2812_SPI_BITS_PER_BIT)
+#define WS2812_RESET_BYTES \
+  ((WS2812_RESET_US * (WS2812_SPI_BIT_RATE / 1000) / 1000 + 7) / 8)
+#define WS2812_ENCODED_SIZE(leds) ((leds) * WS2812_BYTES_PER_LED + WS2812_RESET_BYTES)
+
+// The SPI bits for one byte, in the low 24 bits
+uint32_t ws2812_encode_byte(uint8_t byte);
+
+/* Fills buffer with the bit stream for the LEDs, the reset included.
+ * buffer has to hold WS2812_ENCODED_SIZE(count) bytes, and that's also
+ * what is returned.
+ */
+uint16_t ws2812_encode(const LED_TYPE *leds, uint16_t count, uint8_t *buffer);
+
+#endif /* WS2812_ENCODE_H_ */
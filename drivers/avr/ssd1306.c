@@ -4,6 +4,7 @@
 #include "i2c.h"
 #include <string.h>
 #include "print.h"
+#include "progmem.h"
 #include "glcdfont.c"
 #ifdef ADAFRUIT_BLE_ENABLE
 #include "adafruit_ble.h"
@@ -28,10 +29,19 @@
 static uint8_t displaying;
 #endif
 static uint16_t last_flush;
+static bool display_on;
 
-// Write command sequence.
+struct CharacterMatrix display;
+
+// What the display shows, rendering sends the characters that differ
+static uint8_t shown[MatrixRows][MatrixCols];
+#ifdef SSD1306_INCREMENTAL_RENDER
+static uint8_t next_row;
+#endif
+
+// Write command sequence, all in one transfer.
 // Returns true on success.
-static inline bool _send_cmd1(uint8_t cmd) {
+static bool _send_cmds(const uint8_t *cmds, uint8_t count) {
   bool res = false;
 
   if (i2c_start_write(SSD1306_ADDRESS)) {
@@ -39,15 +49,17 @@ static inline bool _send_cmd1(uint8_t cmd) {
     goto done;
   }
 
-  if (i2c_master_write(0x0 /* command byte follows */)) {
+  if (i2c_master_write(0x0 /* commands follow */)) {
     print("failed to write control byte\n");
 
     goto done;
   }
 
-  if (i2c_master_write(cmd)) {
-    xprintf("failed to write command %d\n", cmd);
-    goto done;
+  for (uint8_t i = 0; i < count; ++i) {
+    if (i2c_master_write(cmds[i])) {
+      xprintf("failed to write command %d\n", cmds[i]);
+      goto done;
+    }
   }
   res = true;
 done:
@@ -55,25 +67,22 @@ done:
   return res;
 }
 
+static inline bool _send_cmd1(uint8_t cmd) {
+  return _send_cmds(&cmd, 1);
+}
+
 // Write 2-byte command sequence.
 // Returns true on success
 static inline bool _send_cmd2(uint8_t cmd, uint8_t opr) {
-  if (!_send_cmd1(cmd)) {
-    return false;
-  }
-  return _send_cmd1(opr);
+  const uint8_t cmds[] = {cmd, opr};
+  return _send_cmds(cmds, sizeof(cmds));
 }
 
 // Write 3-byte command sequence.
 // Returns true on success
 static inline bool _send_cmd3(uint8_t cmd, uint8_t opr1, uint8_t opr2) {
-  if (!_send_cmd1(cmd)) {
-    return false;
-  }
-  if (!_send_cmd1(opr1)) {
-    return false;
-  }
-  return _send_cmd1(opr2);
+  const uint8_t cmds[] = {cmd, opr1, opr2};
+  return _send_cmds(cmds, sizeof(cmds));
 }
 
 #define send_cmd1(c) if (!_send_cmd1(c)) {goto done;}
@@ -82,6 +91,8 @@ static inline bool _send_cmd3(uint8_t cmd, uint8_t opr1, uint8_t opr2) {
 
 static void clear_display(void) {
   matrix_clear(&display);
+  // Unknown until the clear goes through
+  memset(shown, 0, sizeof(shown));
 
   // Clear all of the display bits (there can be random noise
   // in the RAM on startup)
@@ -101,6 +112,8 @@ static void clear_display(void) {
     }
   }
 
+  // Blank like the space character
+  memset(shown, ' ', sizeof(shown));
   display.dirty = false;
 
 done:
@@ -153,6 +166,7 @@ bool iota_gfx_init(void) {
   send_cmd1(NormalDisplay);
   send_cmd1(DeActivateScroll);
   send_cmd1(DisplayOn);
+  display_on = true;
 
   send_cmd2(SetContrast, 0); // Dim
 
@@ -174,6 +188,7 @@ bool iota_gfx_off(void) {
   bool success = false;
 
   send_cmd1(DisplayOff);
+  display_on = false;
   success = true;
 
 done:
@@ -183,7 +198,11 @@ done:
 bool iota_gfx_on(void) {
   bool success = false;
 
+  if (display_on) {
+    return true;
+  }
   send_cmd1(DisplayOn);
+  display_on = true;
   success = true;
 
 done:
@@ -261,16 +280,34 @@ void iota_gfx_clear_screen(void) {
   matrix_clear(&display);
 }
 
-void matrix_render(struct CharacterMatrix *matrix) {
-  last_flush = timer_read();
-  iota_gfx_on();
-#if DEBUG_TO_SCREEN
-  ++displaying;
-#endif
+// Finds the characters on the row that differ from what the display shows.
+// Returns false if there are none.
+static bool row_changes(struct CharacterMatrix *matrix, uint8_t row,
+                        uint8_t *first, uint8_t *last) {
+  uint8_t col = 0;
+  while (matrix->display[row][col] == shown[row][col]) {
+    if (++col == MatrixCols) {
+      return false;
+    }
+  }
+  *first = col;
+  col = MatrixCols - 1;
+  while (matrix->display[row][col] == shown[row][col]) {
+    --col;
+  }
+  *last = col;
+  return true;
+}
+
+// Sends the characters from first to last on the row, which is one page
+// of the display.
+// Returns true on success.
+static bool render_row(struct CharacterMatrix *matrix, uint8_t row,
+                       uint8_t first, uint8_t last) {
+  bool res = false;
 
-  // Move to the home position
-  send_cmd3(PageAddr, 0, MatrixRows - 1);
-  send_cmd3(ColumnAddr, 0, (MatrixCols * FontWidth) - 1);
+  send_cmd3(PageAddr, row, row);
+  send_cmd3(ColumnAddr, first * FontWidth, (last + 1) * FontWidth - 1);
 
   if (i2c_start_write(SSD1306_ADDRESS)) {
     goto done;
@@ -280,29 +317,67 @@ void matrix_render(struct CharacterMatrix *matrix) {
     goto done;
   }
 
-  for (uint8_t row = 0; row < MatrixRows; ++row) {
-    for (uint8_t col = 0; col < MatrixCols; ++col) {
-      const uint8_t *glyph = font + (matrix->display[row][col] * (FontWidth - 1));
+  for (uint8_t col = first; col <= last; ++col) {
+    const uint8_t *glyph = font + (matrix->display[row][col] * (FontWidth - 1));
 
-      for (uint8_t glyphCol = 0; glyphCol < FontWidth - 1; ++glyphCol) {
-        uint8_t colBits = pgm_read_byte(glyph + glyphCol);
-        i2c_master_write(colBits);
-      }
+    for (uint8_t glyphCol = 0; glyphCol < FontWidth - 1; ++glyphCol) {
+      uint8_t colBits = pgm_read_byte(glyph + glyphCol);
+      i2c_master_write(colBits);
+    }
 
-      // 1 column of space between chars (it's not included in the glyph)
-      i2c_master_write(0);
+    // 1 column of space between chars (it's not included in the glyph)
+    i2c_master_write(0);
+    shown[row][col] = matrix->display[row][col];
+  }
+  res = true;
+
+done:
+  i2c_master_stop();
+  return res;
+}
+
+void matrix_render(struct CharacterMatrix *matrix) {
+  last_flush = timer_read();
+  iota_gfx_on();
+#if DEBUG_TO_SCREEN
+  ++displaying;
+#endif
+
+  for (uint8_t row = 0; row < MatrixRows; ++row) {
+    uint8_t first, last;
+    if (row_changes(matrix, row, &first, &last) &&
+        !render_row(matrix, row, first, last)) {
+      goto done;
     }
   }
 
   matrix->dirty = false;
 
 done:
-  i2c_master_stop();
 #if DEBUG_TO_SCREEN
   --displaying;
 #endif
+  return;
 }
 
+#ifdef SSD1306_INCREMENTAL_RENDER
+// Sends the next row with changes, the matrix is clean once none are left
+static void matrix_render_row(struct CharacterMatrix *matrix) {
+  for (uint8_t i = 0; i < MatrixRows; ++i) {
+    uint8_t row = next_row;
+    uint8_t first, last;
+    next_row = (next_row + 1) % MatrixRows;
+    if (row_changes(matrix, row, &first, &last)) {
+      last_flush = timer_read();
+      iota_gfx_on();
+      render_row(matrix, row, first, last);
+      return;
+    }
+  }
+  matrix->dirty = false;
+}
+#endif
+
 void iota_gfx_flush(void) {
   matrix_render(&display);
 }
@@ -315,7 +390,11 @@ void iota_gfx_task(void) {
   iota_gfx_task_user();
 
   if (display.dirty) {
+#ifdef SSD1306_INCREMENTAL_RENDER
+    matrix_render_row(&display);
+#else
     iota_gfx_flush();
+#endif
   }
 
   if (timer_elapsed(last_flush) > ScreenOffInterval) {
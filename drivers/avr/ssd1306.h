@@ -2,9 +2,8 @@
 #define SSD1306_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
-#include "pincontrol.h"
-#include "config.h"
 
 enum ssd1306_cmds {
   DisplayOff = 0xAE,
@@ -67,7 +66,12 @@ struct CharacterMatrix {
   bool dirty;
 };
 
-struct CharacterMatrix display;
+extern struct CharacterMatrix display;
+
+// Rendering only sends the characters that differ from what the display
+// shows. With SSD1306_INCREMENTAL_RENDER, iota_gfx_task() sends at most one
+// row of them each time it's called, which spreads an update of the whole
+// display over a few matrix scans.
 
 bool iota_gfx_init(void);
 void iota_gfx_task(void);
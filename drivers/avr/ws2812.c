@@ -22,10 +22,34 @@
 */
 
 #include "ws2812.h"
+#include <stdbool.h>
 #include <avr/interrupt.h>
 #include <avr/io.h>
 #include <util/delay.h>
 #include "debug.h"
+#include "timer.h"
+
+/*
+ * The LEDs latch the data once the line has been low for 50µs (80µs for the
+ * SK6812RGBW). Instead of waiting that out after every frame, the next frame
+ * waits, and only when it comes right after the last one. The timer has a
+ * resolution of 1 ms, so only a frame 2 ms later is known to be late enough.
+ */
+static uint16_t last_frame_timer;
+static bool latch_pending = false;
+
+static inline void ws2812_latch_wait(void)
+{
+  if (latch_pending && timer_elapsed(last_frame_timer) < 2) {
+    _delay_us(80);
+  }
+}
+
+static inline void ws2812_latch_start(void)
+{
+  last_frame_timer = timer_read();
+  latch_pending = true;
+}
 
 #ifdef RGBW_BB_TWI
 
@@ -154,8 +178,9 @@ void inline ws2812_setleds_pin(LED_TYPE *ledarray, uint16_t leds, uint8_t pinmas
   // new universal format (DDR)
   _SFR_IO8((RGB_DI_PIN >> 4) + 1) |= pinmask;
 
+  ws2812_latch_wait();
   ws2812_sendarray_mask((uint8_t*)ledarray,leds+leds+leds,pinmask);
-  _delay_us(50);
+  ws2812_latch_start();
 }
 
 // Setleds for SK6812RGBW
@@ -188,12 +213,9 @@ void inline ws2812_setleds_rgbw(LED_TYPE *ledarray, uint16_t leds)
   // new universal format (DDR)
   _SFR_IO8((RGB_DI_PIN >> 4) + 1) |= _BV(RGB_DI_PIN & 0xF);
 
+  ws2812_latch_wait();
   ws2812_sendarray_mask((uint8_t*)ledarray,leds<<2,_BV(RGB_DI_PIN & 0xF));
-
-
-  #ifndef RGBW_BB_TWI
-    _delay_us(80);
-  #endif
+  ws2812_latch_start();
 }
 
 void ws2812_sendarray(uint8_t *data,uint16_t datlen)
@@ -23,8 +23,11 @@
 #ifndef LIGHT_WS2812_H_
 #define LIGHT_WS2812_H_
 
+#include <stdint.h>
+#ifdef __AVR__
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#endif
 //#include "ws2812_config.h"
 //#include "i2cmaster.h"
 
@@ -41,7 +44,8 @@
  * The functions will perform the following actions:
  *         - Set the data-out pin as output
  *         - Send out the LED data
- *         - Wait 50�s to reset the LEDs
+ *         - Return without waiting for the LEDs to latch, the next call
+ *           waits for that if it comes too soon
  */
 
 void ws2812_setleds     (LED_TYPE *ledarray, uint16_t number_of_leds);
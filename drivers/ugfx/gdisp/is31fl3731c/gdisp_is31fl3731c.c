@@ -109,6 +109,14 @@ typedef struct{
     uint8_t write_buffer[IS31_FRAME_SIZE];
     uint8_t frame_buffer[GDISP_SCREEN_HEIGHT * GDISP_SCREEN_WIDTH];
     uint8_t page;
+    // The PWM value for each color at the current backlight
+    uint8_t pwm[256];
+    // The PWM registers changed since the last flush, and the ones sent by
+    // it. first > last when there are none.
+    uint8_t dirty_first;
+    uint8_t dirty_last;
+    uint8_t sent_first;
+    uint8_t sent_last;
 }__attribute__((__packed__)) PrivData;
 
 // Some common routines and macros
@@ -139,6 +147,36 @@ static GFXINLINE void write_ram(GDisplay *g, uint8_t page, uint16_t offset, uint
     write_data(g, (uint8_t*)PRIV(g), length + 1);
 }
 
+// Sends the PWM registers from first to last, the byte in front of them
+// holds the register address while they are sent
+static GFXINLINE void write_pwm(GDisplay *g, uint8_t page, uint8_t first, uint8_t last) {
+    uint8_t* tx = PRIV(g)->write_buffer + first - 1;
+    uint8_t saved = *tx;
+    *tx = IS31_PWM_REG + first;
+    write_page(g, page);
+    write_data(g, tx, last - first + 2);
+    *tx = saved;
+}
+
+static void update_pwm_table(GDisplay *g) {
+    for (unsigned i = 0; i < 256; i++) {
+        PRIV(g)->pwm[i] = CIE1931_CURVE[i * g->g.Backlight / 100];
+    }
+}
+
+static void update_led(GDisplay *g, coord_t x, coord_t y) {
+    uint8_t address = get_led_address(g, x, y);
+    uint8_t value = PRIV(g)->pwm[PRIV(g)->frame_buffer[y * GDISP_SCREEN_WIDTH + x]];
+    if (PRIV(g)->write_buffer[address] == value)
+        return;
+    PRIV(g)->write_buffer[address] = value;
+    if (address < PRIV(g)->dirty_first)
+        PRIV(g)->dirty_first = address;
+    if (address > PRIV(g)->dirty_last)
+        PRIV(g)->dirty_last = address;
+    g->flags |= GDISP_FLG_NEEDFLUSH;
+}
+
 LLDSPEC bool_t gdisp_lld_init(GDisplay *g) {
     // The private area is the display surface.
     g->priv = gfxAlloc(sizeof(PrivData));
@@ -175,6 +213,13 @@ LLDSPEC bool_t gdisp_lld_init(GDisplay *g) {
     // Finish Init
     post_init_board(g);
 
+    // The PWM registers are all zero now, on both pages
+    __builtin_memset(PRIV(g)->write_buffer, 0, IS31_FRAME_SIZE);
+    PRIV(g)->dirty_first = 0xFF;
+    PRIV(g)->dirty_last = 0;
+    PRIV(g)->sent_first = 0xFF;
+    PRIV(g)->sent_last = 0;
+
     /* Initialise the GDISP structure */
     g->g.Width = GDISP_SCREEN_WIDTH;
     g->g.Height = GDISP_SCREEN_HEIGHT;
@@ -182,6 +227,7 @@ LLDSPEC bool_t gdisp_lld_init(GDisplay *g) {
     g->g.Powermode = powerOff;
     g->g.Backlight = GDISP_INITIAL_BACKLIGHT;
     g->g.Contrast = GDISP_INITIAL_CONTRAST;
+    update_pwm_table(g);
     return TRUE;
 }
 
@@ -193,20 +239,25 @@ LLDSPEC bool_t gdisp_lld_init(GDisplay *g) {
 
         PRIV(g)->page++;
         PRIV(g)->page %= 2;
-        // TODO: some smarter algorithm for this
-        // We should run only one physical page at a time
-        // This way we don't need to send so much data, and
-        // we could use slightly less memory
-        uint8_t* src = PRIV(g)->frame_buffer;
-        for (int y=0;y<GDISP_SCREEN_HEIGHT;y++) {
-            for (int x=0;x<GDISP_SCREEN_WIDTH;x++) {
-                uint8_t val = (uint16_t)*src * g->g.Backlight / 100;
-                PRIV(g)->write_buffer[get_led_address(g, x, y)]=CIE1931_CURVE[val];
-                ++src;
-            }
+        // The page written to was last written two flushes ago, so it
+        // misses the changes sent by the last flush as well
+        uint8_t first = PRIV(g)->dirty_first;
+        uint8_t last = PRIV(g)->dirty_last;
+        if (PRIV(g)->sent_first <= PRIV(g)->sent_last) {
+            if (PRIV(g)->sent_first < first)
+                first = PRIV(g)->sent_first;
+            if (PRIV(g)->sent_last > last)
+                last = PRIV(g)->sent_last;
+        }
+        PRIV(g)->sent_first = PRIV(g)->dirty_first;
+        PRIV(g)->sent_last = PRIV(g)->dirty_last;
+        PRIV(g)->dirty_first = 0xFF;
+        PRIV(g)->dirty_last = 0;
+
+        if (first <= last) {
+            write_pwm(g, PRIV(g)->page, first, last);
+            gfxSleepMilliseconds(1);
         }
-        write_ram(g, PRIV(g)->page, IS31_PWM_REG, IS31_PWM_SIZE);
-        gfxSleepMilliseconds(1);
         write_register(g, IS31_FUNCTIONREG, IS31_REG_PICTDISP, PRIV(g)->page);
 
         g->flags &= ~GDISP_FLG_NEEDFLUSH;
@@ -229,7 +280,7 @@ LLDSPEC bool_t gdisp_lld_init(GDisplay *g) {
             break;
         }
         PRIV(g)->frame_buffer[y * GDISP_SCREEN_WIDTH + x] = gdispColor2Native(g->p.color);
-        g->flags |= GDISP_FLG_NEEDFLUSH;
+        update_led(g, x, y);
     }
 #endif
 
@@ -299,7 +350,12 @@ LLDSPEC bool_t gdisp_lld_init(GDisplay *g) {
                 return;
             unsigned val = (unsigned)g->p.ptr;
             g->g.Backlight = val > 100 ? 100 : val;
-            g->flags |= GDISP_FLG_NEEDFLUSH;
+            update_pwm_table(g);
+            for (coord_t y = 0; y < GDISP_SCREEN_HEIGHT; y++) {
+                for (coord_t x = 0; x < GDISP_SCREEN_WIDTH; x++) {
+                    update_led(g, x, y);
+                }
+            }
             return;
         }
     }
@@ -35,6 +35,9 @@
 #define GDISP_FLG_NEEDFLUSH         (GDISP_FLG_DRIVER<<0)
 
 #include "st7565.h"
+#include "lcd_image.h"
+#include "progmem.h"
+#include <string.h>
 
 /*===========================================================================*/
 /* Driver config defaults for backward compatibility.                        */
@@ -56,11 +59,19 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#define PAGES                       (GDISP_SCREEN_HEIGHT / 8)
+
 typedef struct{
     bool_t buffer2;
     uint8_t data_pos;
     uint8_t data[16];
     uint8_t ram[GDISP_SCREEN_HEIGHT * GDISP_SCREEN_WIDTH / 8];
+    // The columns changed on each page since the last flush, and the ones
+    // sent by it. first > last when there are none.
+    uint8_t dirty_first[PAGES];
+    uint8_t dirty_last[PAGES];
+    uint8_t sent_first[PAGES];
+    uint8_t sent_last[PAGES];
 }PrivData;
 
 // Some common routines and macros
@@ -86,6 +97,22 @@ static GFXINLINE void flush_cmd(GDisplay* g) {
 #define xyaddr(x, y)        ((x) + ((y)>>3)*GDISP_SCREEN_WIDTH)
 #define xybit(y)            (1<<((y)&7))
 
+static GFXINLINE void mark_dirty(GDisplay* g, coord_t x, coord_t page) {
+    if (x < PRIV(g)->dirty_first[page])
+        PRIV(g)->dirty_first[page] = x;
+    if (x > PRIV(g)->dirty_last[page])
+        PRIV(g)->dirty_last[page] = x;
+}
+
+static GFXINLINE void set_all_dirty(GDisplay* g) {
+    for (unsigned p = 0; p < PAGES; p++) {
+        PRIV(g)->dirty_first[p] = 0;
+        PRIV(g)->dirty_last[p] = GDISP_SCREEN_WIDTH - 1;
+        PRIV(g)->sent_first[p] = 0;
+        PRIV(g)->sent_last[p] = GDISP_SCREEN_WIDTH - 1;
+    }
+}
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -102,6 +129,9 @@ LLDSPEC bool_t gdisp_lld_init(GDisplay *g) {
     g->priv = gfxAlloc(sizeof(PrivData));
     PRIV(g)->buffer2 = false;
     PRIV(g)->data_pos = 0;
+    // Neither buffer on the display has been written yet
+    memset(RAM(g), 0, sizeof(PRIV(g)->ram));
+    set_all_dirty(g);
 
     // Initialise the board interface
     init_board(g);
@@ -159,14 +189,31 @@ LLDSPEC void gdisp_lld_flush(GDisplay *g) {
     acquire_bus(g);
     enter_cmd_mode(g);
     unsigned dstOffset = (PRIV(g)->buffer2 ? 4 : 0);
-    for (p = 0; p < 4; p++) {
+    for (p = 0; p < PAGES; p++) {
+        // The buffer written to was last written two flushes ago, so it
+        // misses the changes sent by the last flush as well
+        unsigned first = PRIV(g)->dirty_first[p];
+        unsigned last = PRIV(g)->dirty_last[p];
+        if (PRIV(g)->sent_first[p] <= PRIV(g)->sent_last[p]) {
+            if (PRIV(g)->sent_first[p] < first)
+                first = PRIV(g)->sent_first[p];
+            if (PRIV(g)->sent_last[p] > last)
+                last = PRIV(g)->sent_last[p];
+        }
+        PRIV(g)->sent_first[p] = PRIV(g)->dirty_first[p];
+        PRIV(g)->sent_last[p] = PRIV(g)->dirty_last[p];
+        PRIV(g)->dirty_first[p] = 0xFF;
+        PRIV(g)->dirty_last[p] = 0;
+        if (first > last)
+            continue;
+
         write_cmd(g, ST7565_PAGE | (p + dstOffset));
-        write_cmd(g, ST7565_COLUMN_MSB | 0);
-        write_cmd(g, ST7565_COLUMN_LSB | 0);
+        write_cmd(g, ST7565_COLUMN_MSB | (first >> 4));
+        write_cmd(g, ST7565_COLUMN_LSB | (first & 0xF));
         write_cmd(g, ST7565_RMW);
         flush_cmd(g);
         enter_data_mode(g);
-        write_data(g, RAM(g) + (p*GDISP_SCREEN_WIDTH), GDISP_SCREEN_WIDTH);
+        write_data(g, RAM(g) + (p*GDISP_SCREEN_WIDTH) + first, last - first + 1);
         enter_cmd_mode(g);
     }
     unsigned line = (PRIV(g)->buffer2 ? 32 : 0);
@@ -202,11 +249,15 @@ LLDSPEC void gdisp_lld_draw_pixel(GDisplay *g) {
         y = g->p.x;
         break;
     }
+    uint8_t old = RAM(g)[xyaddr(x, y)];
     if (gdispColor2Native(g->p.color) != Black)
         RAM(g)[xyaddr(x, y)] |= xybit(y);
     else
         RAM(g)[xyaddr(x, y)] &= ~xybit(y);
-    g->flags |= GDISP_FLG_NEEDFLUSH;
+    if (RAM(g)[xyaddr(x, y)] != old) {
+        mark_dirty(g, x, y >> 3);
+        g->flags |= GDISP_FLG_NEEDFLUSH;
+    }
 }
 #endif
 
@@ -251,17 +302,21 @@ LLDSPEC void gdisp_lld_blit_area(GDisplay *g) {
             uint8_t bit = 7-(srcbit % 8);
             uint8_t bitset = (src >> bit) & 1;
             uint8_t* dst = &(RAM(g)[xyaddr(dstx, dsty)]);
+            uint8_t old = *dst;
             if (bitset) {
                 *dst |= xybit(dsty);
             }
             else {
                 *dst &= ~xybit(dsty);
             }
+            if (*dst != old) {
+                mark_dirty(g, dstx, dsty >> 3);
+                g->flags |= GDISP_FLG_NEEDFLUSH;
+            }
             dstx++;
             srcbit++;
         }
     }
-    g->flags |= GDISP_FLG_NEEDFLUSH;
 }
 
 #if GDISP_NEED_CONTROL && GDISP_HARDWARE_CONTROL
@@ -322,6 +377,23 @@ LLDSPEC void gdisp_lld_control(GDisplay *g) {
                 flush_cmd(g);
                 release_bus(g);
                 return;
+
+            case GDISP_CONTROL_LCD_IMAGE: {
+                // The image is in the page layout already, so it's decoded
+                // straight into the RAM
+                const uint8_t* image = (const uint8_t*)g->p.ptr;
+                coord_t width = pgm_read_byte(&image[0]);
+                coord_t height = pgm_read_byte(&image[1]);
+                if (width > GDISP_SCREEN_WIDTH || height > GDISP_SCREEN_HEIGHT)
+                    return;
+                lcd_image_decode(image, RAM(g), GDISP_SCREEN_WIDTH);
+                for (coord_t p = 0; p < (height + 7) / 8; p++) {
+                    mark_dirty(g, 0, p);
+                    mark_dirty(g, width - 1, p);
+                }
+                g->flags |= GDISP_FLG_NEEDFLUSH;
+                return;
+            }
     }
 }
 #endif // GDISP_NEED_CONTROL
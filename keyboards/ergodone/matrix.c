@@ -9,6 +9,7 @@
 #include "matrix.h"
 #include "ergodone.h"
 #include "expander.h"
+#include "debounce.h"
 #ifdef DEBUG_MATRIX_SCAN_RATE
 #include  "timer.h"
 #endif
@@ -24,18 +25,9 @@
  * And so, there is no sense to have DEBOUNCE higher than 2.
  */
 
-#ifndef DEBOUNCE
-#   define DEBOUNCE	5
-#endif
-
 /* matrix state(1:on, 0:off) */
 static matrix_row_t matrix[MATRIX_ROWS];
 
-// Debouncing: store for each key the number of scans until it's eligible to
-// change.  When scanning the matrix, ignore any changes in keys that have
-// already changed in the last DEBOUNCE scans.
-static uint8_t debounce_matrix[MATRIX_ROWS * MATRIX_COLS];
-
 static matrix_row_t read_cols(uint8_t row);
 static void init_cols(void);
 static void unselect_rows(void);
@@ -87,10 +79,8 @@ void matrix_init(void)
   // initialize matrix state: all keys off
   for (uint8_t i=0; i < MATRIX_ROWS; i++) {
     matrix[i] = 0;
-    for (uint8_t j=0; j < MATRIX_COLS; ++j) {
-      debounce_matrix[i * MATRIX_COLS + j] = 0;
-    }
   }
+  debounce_init();
 
 #ifdef DEBUG_MATRIX_SCAN_RATE
   matrix_timer = timer_read32();
@@ -116,30 +106,6 @@ void matrix_power_up(void) {
 #endif
 }
 
-// Returns a matrix_row_t whose bits are set if the corresponding key should be
-// eligible to change in this scan.
-matrix_row_t debounce_mask(uint8_t row) {
-  matrix_row_t result = 0;
-  for (uint8_t j=0; j < MATRIX_COLS; ++j) {
-    if (debounce_matrix[row * MATRIX_COLS + j]) {
-      --debounce_matrix[row * MATRIX_COLS + j];
-    } else {
-      result |= (1 << j);
-    }
-  }
-  return result;
-}
-
-// Report changed keys in the given row.  Resets the debounce countdowns
-// corresponding to each set bit in 'change' to DEBOUNCE.
-void debounce_report(matrix_row_t change, uint8_t row) {
-  for (uint8_t i = 0; i < MATRIX_COLS; ++i) {
-    if (change & (1 << i)) {
-      debounce_matrix[row * MATRIX_COLS + i] = DEBOUNCE;
-    }
-  }
-}
-
 uint8_t matrix_scan(void)
 {
   expander_scan();
@@ -162,10 +128,7 @@ uint8_t matrix_scan(void)
   for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
     select_row(i);
     wait_us(30);  // without this wait read unstable value.
-    matrix_row_t mask = debounce_mask(i);
-    matrix_row_t cols = (read_cols(i) & mask) | (matrix[i] & ~mask);
-    debounce_report(cols ^ matrix[i], i);
-    matrix[i] = cols;
+    matrix[i] = debounce_row(i, matrix[i], read_cols(i));
 
     unselect_rows();
   }
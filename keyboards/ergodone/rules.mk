@@ -71,6 +71,7 @@ OPT_DEFS += -DBOOTLOADER_SIZE=4096
 #   comment out to disable the options.
 #
 CUSTOM_MATRIX           = yes # Custom matrix file for the ErgoDone
+DEBOUNCE_TYPE           = vertical # Per key debouncing, the matrix.c relies on it
 UNICODE_ENABLE          = yes # Unicode
 BOOTMAGIC_ENABLE        = yes	# Virtual DIP switch configuration(+1000)
 MOUSEKEY_ENABLE         = yes	# Mouse keys(+4700)
@@ -35,6 +35,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "matrix.h"
 #include QMK_KEYBOARD_H
 #include "i2cmaster.h"
+#include "debounce.h"
 #ifdef DEBUG_MATRIX_SCAN_RATE
 #include  "timer.h"
 #endif
@@ -50,22 +51,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
  * And so, there is no sense to have DEBOUNCE higher than 2.
  */
 
-#ifndef DEBOUNCE
-#   define DEBOUNCE	5
-#endif
+/* The left hand rows are read from the mcp23018, the right hand ones from the teensy */
+#define MCP23018_ROWS (MATRIX_ROWS / 2)
 
 /* matrix state(1:on, 0:off) */
 static matrix_row_t matrix[MATRIX_ROWS];
 
-// Debouncing: store for each key the number of scans until it's eligible to
-// change.  When scanning the matrix, ignore any changes in keys that have
-// already changed in the last DEBOUNCE scans.
-static uint8_t debounce_matrix[MATRIX_ROWS * MATRIX_COLS];
-
 static matrix_row_t read_cols(uint8_t row);
 static void init_cols(void);
 static void unselect_rows(void);
+static void unselect_teensy_rows(void);
 static void select_row(uint8_t row);
+static void mcp23018_select_row(uint8_t row);
+static matrix_row_t mcp23018_read_cols(void);
+static void mcp23018_unselect_rows(void);
 
 static uint8_t mcp23018_reset_loop;
 
@@ -116,10 +115,8 @@ void matrix_init(void)
     // initialize matrix state: all keys off
     for (uint8_t i=0; i < MATRIX_ROWS; i++) {
         matrix[i] = 0;
-        for (uint8_t j=0; j < MATRIX_COLS; ++j) {
-            debounce_matrix[i * MATRIX_COLS + j] = 0;
-        }
     }
+    debounce_init();
 
 #ifdef DEBUG_MATRIX_SCAN_RATE
     matrix_timer = timer_read32();
@@ -147,28 +144,8 @@ void matrix_power_up(void) {
 #endif
 }
 
-// Returns a matrix_row_t whose bits are set if the corresponding key should be
-// eligible to change in this scan.
-matrix_row_t debounce_mask(uint8_t row) {
-  matrix_row_t result = 0;
-  for (uint8_t j=0; j < MATRIX_COLS; ++j) {
-    if (debounce_matrix[row * MATRIX_COLS + j]) {
-      --debounce_matrix[row * MATRIX_COLS + j];
-    } else {
-      result |= (1 << j);
-    }
-  }
-  return result;
-}
-
-// Report changed keys in the given row.  Resets the debounce countdowns
-// corresponding to each set bit in 'change' to DEBOUNCE.
-void debounce_report(matrix_row_t change, uint8_t row) {
-  for (uint8_t i = 0; i < MATRIX_COLS; ++i) {
-    if (change & (1 << i)) {
-      debounce_matrix[row * MATRIX_COLS + i] = DEBOUNCE;
-    }
-  }
+static void update_row(uint8_t row, matrix_row_t cols) {
+  matrix[row] = debounce_row(row, matrix[row], cols);
 }
 
 uint8_t matrix_scan(void)
@@ -202,16 +179,20 @@ uint8_t matrix_scan(void)
     }
 #endif
 
-    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
-        select_row(i);
+    // The rows of both halves are scanned in pairs. While the mcp23018 row
+    // settles the matching teensy row is read, and the i2c bus is held in
+    // between, so the whole left hand is scanned in a single i2c transaction.
+    for (uint8_t i = 0; i < MCP23018_ROWS; i++) {
+        mcp23018_select_row(i);
+
+        select_row(i + MCP23018_ROWS);
         wait_us(30);  // without this wait read unstable value.
-        matrix_row_t mask = debounce_mask(i);
-        matrix_row_t cols = (read_cols(i) & mask) | (matrix[i] & ~mask);
-        debounce_report(cols ^ matrix[i], i);
-        matrix[i] = cols;
+        update_row(i + MCP23018_ROWS, read_cols(i + MCP23018_ROWS));
+        unselect_teensy_rows();
 
-        unselect_rows();
+        update_row(i, mcp23018_read_cols());
     }
+    mcp23018_unselect_rows();
 
     matrix_scan_quantum();
 
@@ -277,29 +258,31 @@ static void  init_cols(void)
 
 static matrix_row_t read_cols(uint8_t row)
 {
-    if (row < 7) {
-        if (mcp23018_status) { // if there was an error
-            return 0;
-        } else {
-            uint8_t data = 0;
-            mcp23018_status = i2c_start(I2C_ADDR_WRITE);    if (mcp23018_status) goto out;
-            mcp23018_status = i2c_write(GPIOB);             if (mcp23018_status) goto out;
-            mcp23018_status = i2c_start(I2C_ADDR_READ);     if (mcp23018_status) goto out;
-            data = i2c_readNak();
-            data = ~data;
-        out:
-            i2c_stop();
-            return data;
-        }
+    // read from teensy
+    return
+        (PINF&(1<<0) ? 0 : (1<<0)) |
+        (PINF&(1<<1) ? 0 : (1<<1)) |
+        (PINF&(1<<4) ? 0 : (1<<2)) |
+        (PINF&(1<<5) ? 0 : (1<<3)) |
+        (PINF&(1<<6) ? 0 : (1<<4)) |
+        (PINF&(1<<7) ? 0 : (1<<5)) ;
+}
+
+// Finishes the row started by mcp23018_select_row(). The mcp23018 auto
+// increments its address pointer from GPIOA to GPIOB after the row has been
+// written, so a repeated start is enough to read the columns.
+static matrix_row_t mcp23018_read_cols(void)
+{
+    if (mcp23018_status) { // if there was an error
+        return 0;
     } else {
-        // read from teensy
-        return
-            (PINF&(1<<0) ? 0 : (1<<0)) |
-            (PINF&(1<<1) ? 0 : (1<<1)) |
-            (PINF&(1<<4) ? 0 : (1<<2)) |
-            (PINF&(1<<5) ? 0 : (1<<3)) |
-            (PINF&(1<<6) ? 0 : (1<<4)) |
-            (PINF&(1<<7) ? 0 : (1<<5)) ;
+        uint8_t data = 0;
+        mcp23018_status = i2c_rep_start(I2C_ADDR_READ); if (mcp23018_status) goto out;
+        data = i2c_readNak();
+        return ~data;
+    out:
+        i2c_stop();
+        return 0;
     }
 }
 
@@ -329,6 +312,28 @@ static void unselect_rows(void)
         i2c_stop();
     }
 
+    unselect_teensy_rows();
+}
+
+// Same as above, but continues the transaction kept open during the scan
+static void mcp23018_unselect_rows(void)
+{
+    if (mcp23018_status) { // if there was an error
+        // do nothing
+    } else {
+        // set all rows hi-Z : 1
+        mcp23018_status = i2c_rep_start(I2C_ADDR_WRITE);    if (mcp23018_status) goto out;
+        mcp23018_status = i2c_write(GPIOA);                 if (mcp23018_status) goto out;
+        mcp23018_status = i2c_write( 0xFF
+                              & ~(0<<7)
+                          );                                if (mcp23018_status) goto out;
+    out:
+        i2c_stop();
+    }
+}
+
+static void unselect_teensy_rows(void)
+{
     // unselect on teensy
     // Hi-Z(DDR:0, PORT:0) to unselect
     DDRB  &= ~(1<<0 | 1<<1 | 1<<2 | 1<<3);
@@ -339,56 +344,63 @@ static void unselect_rows(void)
     PORTC &= ~(1<<6);
 }
 
-static void select_row(uint8_t row)
+// Starts the transaction for the first row and continues it with a repeated
+// start for the others. The bus is kept until the columns have been read.
+static void mcp23018_select_row(uint8_t row)
 {
-    if (row < 7) {
-        // select on mcp23018
-        if (mcp23018_status) { // if there was an error
-            // do nothing
-        } else {
-            // set active row low  : 0
-            // set other rows hi-Z : 1
-            mcp23018_status = i2c_start(I2C_ADDR_WRITE);        if (mcp23018_status) goto out;
-            mcp23018_status = i2c_write(GPIOA);                 if (mcp23018_status) goto out;
-            mcp23018_status = i2c_write( 0xFF & ~(1<<row)
-                                  & ~(0<<7)
-                              );                                if (mcp23018_status) goto out;
-        out:
-            i2c_stop();
-        }
+    if (mcp23018_status) { // if there was an error
+        // do nothing
     } else {
-        // select on teensy
-        // Output low(DDR:1, PORT:0) to select
-        switch (row) {
-            case 7:
-                DDRB  |= (1<<0);
-                PORTB &= ~(1<<0);
-                break;
-            case 8:
-                DDRB  |= (1<<1);
-                PORTB &= ~(1<<1);
-                break;
-            case 9:
-                DDRB  |= (1<<2);
-                PORTB &= ~(1<<2);
-                break;
-            case 10:
-                DDRB  |= (1<<3);
-                PORTB &= ~(1<<3);
-                break;
-            case 11:
-                DDRD  |= (1<<2);
-                PORTD &= ~(1<<3);
-                break;
-            case 12:
-                DDRD  |= (1<<3);
-                PORTD &= ~(1<<3);
-                break;
-            case 13:
-                DDRC  |= (1<<6);
-                PORTC &= ~(1<<6);
-                break;
+        // set active row low  : 0
+        // set other rows hi-Z : 1
+        if (row == 0) {
+            mcp23018_status = i2c_start(I2C_ADDR_WRITE);
+        } else {
+            mcp23018_status = i2c_rep_start(I2C_ADDR_WRITE);
         }
+                                                            if (mcp23018_status) goto out;
+        mcp23018_status = i2c_write(GPIOA);                 if (mcp23018_status) goto out;
+        mcp23018_status = i2c_write( 0xFF & ~(1<<row)
+                              & ~(0<<7)
+                          );                                if (mcp23018_status) goto out;
+        return;
+    out:
+        i2c_stop();
     }
 }
 
+static void select_row(uint8_t row)
+{
+    // select on teensy
+    // Output low(DDR:1, PORT:0) to select
+    switch (row) {
+        case 7:
+            DDRB  |= (1<<0);
+            PORTB &= ~(1<<0);
+            break;
+        case 8:
+            DDRB  |= (1<<1);
+            PORTB &= ~(1<<1);
+            break;
+        case 9:
+            DDRB  |= (1<<2);
+            PORTB &= ~(1<<2);
+            break;
+        case 10:
+            DDRB  |= (1<<3);
+            PORTB &= ~(1<<3);
+            break;
+        case 11:
+            DDRD  |= (1<<2);
+            PORTD &= ~(1<<3);
+            break;
+        case 12:
+            DDRD  |= (1<<3);
+            PORTD &= ~(1<<3);
+            break;
+        case 13:
+            DDRC  |= (1<<6);
+            PORTC &= ~(1<<6);
+            break;
+    }
+}
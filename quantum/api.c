@@ -43,6 +43,47 @@ bool process_api_user(uint8_t length, uint8_t * data) {
     return true;
 }
 
+__attribute__ ((weak))
+bool process_api_transfer_write(uint8_t target, uint32_t offset, uint8_t length, uint8_t * data) {
+    return false;
+}
+
+__attribute__ ((weak))
+uint8_t process_api_transfer_read(uint8_t target, uint32_t offset, uint8_t length, uint8_t * data) {
+    return 0;
+}
+
+static uint8_t transfer_sequence = 0;
+
+static void process_api_transfer(uint16_t length, uint8_t * data) {
+    if (length < 8)
+        return;
+    uint8_t target = data[2];
+    uint8_t sequence = data[3];
+    uint32_t offset = bytes_to_dword(data, 4);
+
+    if (data[0] == MT_SET_DATA) {
+        uint8_t status = API_TRANSFER_OK;
+        if (sequence == 0)
+            transfer_sequence = 0;
+        if (sequence != transfer_sequence) {
+            status = API_TRANSFER_RESEND;
+        } else if (process_api_transfer_write(target, offset, length - 8, data + 8)) {
+            transfer_sequence++;
+        } else {
+            status = API_TRANSFER_REFUSED;
+        }
+        uint8_t ack[3] = { target, transfer_sequence, status };
+        MT_SET_DATA_ACK(DT_TRANSFER, ack, 3);
+    } else if (length >= 9) {
+        uint8_t reply[6 + API_TRANSFER_CHUNK_SIZE];
+        uint8_t requested = data[8] < API_TRANSFER_CHUNK_SIZE ? data[8] : API_TRANSFER_CHUNK_SIZE;
+        memcpy(reply, data + 2, 6);
+        uint8_t read = process_api_transfer_read(target, offset, requested, reply + 6);
+        MT_GET_DATA_ACK(DT_TRANSFER, reply, 6 + read);
+    }
+}
+
 void process_api(uint16_t length, uint8_t * data) {
     // SEND_STRING("\nRX: ");
     // for (uint8_t i = 0; i < length; i++) {
@@ -52,6 +93,11 @@ void process_api(uint16_t length, uint8_t * data) {
     if (!process_api_quantum(length, data))
         return;
 
+    if (length >= 2 && data[1] == DT_TRANSFER && (data[0] == MT_SET_DATA || data[0] == MT_GET_DATA)) {
+        process_api_transfer(length, data);
+        return;
+    }
+
     switch (data[0]) {
         case MT_SET_DATA:
             switch (data[1]) {
@@ -79,12 +125,12 @@ void process_api(uint16_t length, uint8_t * data) {
                     break;
                 }
                 case DT_DEBUG: {
-                    uint8_t debug_bytes[1] = { eeprom_read_byte(EECONFIG_DEBUG) };
+                    uint8_t debug_bytes[1] = { eeconfig_read_debug() };
                     MT_GET_DATA_ACK(DT_DEBUG, debug_bytes, 1);
                     break;
                 }
                 case DT_DEFAULT_LAYER: {
-                    uint8_t default_bytes[1] = { eeprom_read_byte(EECONFIG_DEFAULT_LAYER) };
+                    uint8_t default_bytes[1] = { eeconfig_read_default_layer() };
                     MT_GET_DATA_ACK(DT_DEFAULT_LAYER, default_bytes, 1);
                     break;
                 }
@@ -96,7 +142,7 @@ void process_api(uint16_t length, uint8_t * data) {
                 }
                 case DT_AUDIO: {
                     #ifdef AUDIO_ENABLE
-                        uint8_t audio_bytes[1] = { eeprom_read_byte(EECONFIG_AUDIO) };
+                        uint8_t audio_bytes[1] = { eeconfig_read_audio() };
                         MT_GET_DATA_ACK(DT_AUDIO, audio_bytes, 1);
                     #else
                         MT_GET_DATA_ACK(DT_AUDIO, NULL, 0);
@@ -105,7 +151,7 @@ void process_api(uint16_t length, uint8_t * data) {
                 }
                 case DT_BACKLIGHT: {
                     #ifdef BACKLIGHT_ENABLE
-                        uint8_t backlight_bytes[1] = { eeprom_read_byte(EECONFIG_BACKLIGHT) };
+                        uint8_t backlight_bytes[1] = { eeconfig_read_backlight() };
                         MT_GET_DATA_ACK(DT_BACKLIGHT, backlight_bytes, 1);
                     #else
                         MT_GET_DATA_ACK(DT_BACKLIGHT, NULL, 0);
@@ -46,7 +46,36 @@ enum DATA_TYPE {
     DT_KEYBOARD_ACTION,
     DT_USER_ACTION,
     DT_KEYMAP_SIZE,
-    DT_KEYMAP
+    DT_KEYMAP,
+    DT_TRANSFER
+};
+
+/*
+ * Transfers of more data than fits in one message, in numbered chunks.
+ *
+ * Writing, from the host:
+ *   MT_SET_DATA DT_TRANSFER target sequence offset[4] data...
+ * acknowledged with
+ *   MT_SET_DATA_ACK DT_TRANSFER target next_sequence status
+ *
+ * Reading, from the host:
+ *   MT_GET_DATA DT_TRANSFER target sequence offset[4] length
+ * answered with
+ *   MT_GET_DATA_ACK DT_TRANSFER target sequence offset[4] data...
+ * where no data means the end.
+ *
+ * The host keeps no more than API_TRANSFER_WINDOW chunks unacknowledged, so
+ * they fit in the MIDI input queue. Sequence 0 starts a transfer. A chunk
+ * out of sequence is answered with API_TRANSFER_RESEND and the sequence to
+ * go back to, the ones after it are thrown away until that one comes.
+ */
+#define API_TRANSFER_CHUNK_SIZE (API_SYSEX_MAX_SIZE - 8)
+#define API_TRANSFER_WINDOW 2
+
+enum TRANSFER_STATUS {
+    API_TRANSFER_OK = 0x00,
+    API_TRANSFER_RESEND,
+    API_TRANSFER_REFUSED
 };
 
 void dword_to_bytes(uint32_t dword, uint8_t * bytes);
@@ -72,4 +101,12 @@ bool process_api_keyboard(uint8_t length, uint8_t * data);
 __attribute__ ((weak))
 bool process_api_user(uint8_t length, uint8_t * data);
 
+// Takes a chunk written to target, returns false to refuse it
+__attribute__ ((weak))
+bool process_api_transfer_write(uint8_t target, uint32_t offset, uint8_t length, uint8_t * data);
+
+// Reads up to length bytes of target into data, returns how many
+__attribute__ ((weak))
+uint8_t process_api_transfer_read(uint8_t target, uint32_t offset, uint8_t length, uint8_t * data);
+
 #endif
@@ -17,56 +17,74 @@
 #include "sysex_tools.h"
 #include "print.h"
 
-void send_bytes_sysex(uint8_t message_type, uint8_t data_type, uint8_t * bytes, uint16_t length) {
-    // SEND_STRING("\nTX: ");
-    // for (uint8_t i = 0; i < length; i++) {
-    //     send_byte(bytes[i]);
-    //     SEND_STRING(" ");
-    // }
-    if (length > API_SYSEX_MAX_SIZE) {
-        xprintf("Sysex msg too big %d %d %d", message_type, data_type, length);
-        return;
-    }
+// The message goes out through the encoder as it's encoded, three bytes to
+// a MIDI event, so there's no buffer for the whole message
+static uint8_t send_chunk[3];
+static uint8_t send_chunk_length;
 
+static void send_sysex_byte(void * context, uint8_t byte) {
+    send_chunk[send_chunk_length++] = byte;
+    if (send_chunk_length == 3) {
+        midi_send_data(&midi_device, 3, send_chunk[0], send_chunk[1], send_chunk[2]);
+        send_chunk_length = 0;
+    }
+}
 
-    // The buffer size required is calculated as the following
-    // API_SYSEX_MAX_SIZE is the maximum length
-    // In addition to that we have a two byte message header consisting of the message_type and data_type
-    // This has to be encoded with an additional overhead of one byte for every starting 7 bytes
-    // We just add one extra byte in case it's not divisible by 7
-    // Then we have an unencoded header consisting of 4 bytes
-    // Plus a one byte terminator
-    const unsigned message_header = 2;
-    const unsigned unencoded_message = API_SYSEX_MAX_SIZE + message_header;
-    const unsigned encoding_overhead = unencoded_message / 7 + 1;
-    const unsigned encoded_size = unencoded_message + encoding_overhead;
-    const unsigned unencoded_header = 4;
-    const unsigned terminator = 1;
-    const unsigned buffer_size = encoded_size + unencoded_header + terminator;
-    uint8_t buffer[encoded_size + unencoded_header + terminator];
+void send_bytes_sysex(uint8_t message_type, uint8_t data_type, uint8_t * bytes, uint16_t length) {
     // The unencoded header
-    buffer[0] = 0xF0;
-    buffer[1] = 0x00;
-    buffer[2] = 0x00;
-    buffer[3] = 0x00;
+    send_chunk_length = 0;
+    send_sysex_byte(NULL, 0xF0);
+    send_sysex_byte(NULL, 0x00);
+    send_sysex_byte(NULL, 0x00);
+    send_sysex_byte(NULL, 0x00);
 
-    // We copy the message to the end of the array, this way we can do an inplace encoding, using the same
-    // buffer for both input and output
-    const unsigned message_size = length + message_header;
-    uint8_t* unencoded_start = buffer + buffer_size - message_size;
-    uint8_t* ptr = unencoded_start;
-    *(ptr++) = message_type;
-    *(ptr++) = data_type;
-    memcpy(ptr, bytes, length);
+    sysex_encoder_t encoder;
+    sysex_encoder_init(&encoder, send_sysex_byte, NULL);
+    uint8_t message_header[2] = { message_type, data_type };
+    sysex_encoder_write(&encoder, message_header, 2);
+    sysex_encoder_write(&encoder, bytes, length);
+    sysex_encoder_finish(&encoder);
 
-    unsigned encoded_length = sysex_encode(buffer + unencoded_header, unencoded_start, message_size);
-    unsigned final_size = unencoded_header + encoded_length + terminator;
-    buffer[final_size - 1] = 0xF7;
-    midi_send_array(&midi_device, final_size, buffer);
+    send_sysex_byte(NULL, 0xF7);
+    if (send_chunk_length) {
+        midi_send_data(&midi_device, send_chunk_length, send_chunk[0], send_chunk[1], send_chunk[2]);
+    }
+}
 
-    // SEND_STRING("\nTD: ");
-    // for (uint8_t i = 0; i < encoded_length + 5; i++) {
-    //     send_byte(buffer[i]);
-    //     SEND_STRING(" ");
-    // }
+// The message is decoded as it comes in, only the decoded message is kept
+// for process_api
+static uint8_t recv_buffer[API_SYSEX_MAX_SIZE];
+static uint8_t recv_length;
+static bool recv_overflow;
+static sysex_decoder_t recv_decoder;
+
+static void recv_sysex_byte(void * context, uint8_t byte) {
+    if (recv_length < API_SYSEX_MAX_SIZE) {
+        recv_buffer[recv_length++] = byte;
+    } else {
+        recv_overflow = true;
+    }
+}
+
+void recv_bytes_sysex(uint16_t start, uint8_t length, uint8_t * data) {
+    if (start == 0) {
+        recv_length = 0;
+        recv_overflow = false;
+        sysex_decoder_init(&recv_decoder, recv_sysex_byte, NULL);
+    }
+    for (uint8_t place = 0; place < length; place++) {
+        // Skip the unencoded header
+        if (start + place < 4) {
+            continue;
+        }
+        if (data[place] == 0xF7) {
+            if (recv_overflow) {
+                xprintf("Sysex msg too big\n");
+            } else {
+                process_api(recv_length, recv_buffer);
+            }
+            return;
+        }
+        sysex_decoder_write(&recv_decoder, &data[place], 1);
+    }
 }
@@ -19,7 +19,12 @@
 
 #include "api.h"
 
+// Sends a message of any length, encoding it on the way
 void send_bytes_sysex(uint8_t message_type, uint8_t data_type, uint8_t * bytes, uint16_t length);
+// Takes a received sysex message, in the pieces the MIDI device hands over,
+// and passes it to process_api once it's complete. Messages that decode to
+// more than API_SYSEX_MAX_SIZE bytes are dropped.
+void recv_bytes_sysex(uint16_t start, uint8_t length, uint8_t * data);
 
 #define SEND_BYTES(mt, dt, b, l) send_bytes_sysex(mt, dt, b, l)
 
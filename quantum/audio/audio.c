@@ -28,8 +28,7 @@
 #include "wait.h"
 
 #include "eeconfig.h"
-
-#define CPU_PRESCALER 8
+#include "song_stream.h"
 
 // -----------------------------------------------------------------------------
 // Timer Abstractions
@@ -78,42 +77,31 @@
 
 int voices = 0;
 int voice_place = 0;
-float frequency = 0;
-float frequency_alt = 0;
+pitch_t pitch = 0;
+pitch_t pitch_alt = 0;
 int volume = 0;
 long position = 0;
 
-float frequencies[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+pitch_t pitches[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+// Ticks each voice plays for before polyphony moves on to the next one
+uint16_t voice_ticks[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 int volumes[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 bool sliding = false;
 
-float place = 0;
+uint16_t place = 0;
 
 uint8_t * sample;
 uint16_t sample_length = 0;
 
 bool     playing_notes = false;
 bool     playing_note = false;
-float    note_frequency = 0;
-float    note_length = 0;
 uint8_t  note_tempo = TEMPO_DEFAULT;
-float    note_timbre = TIMBRE_DEFAULT;
-uint16_t note_position = 0;
-float (* notes_pointer)[][2];
-uint16_t notes_count;
-bool     notes_repeat;
-bool     note_resting = false;
-
-uint8_t current_note = 0;
-uint8_t rest_counter = 0;
+uint8_t  note_timbre = SYNTH_TIMBRE(TIMBRE_DEFAULT);
 
-#ifdef VIBRATO_ENABLE
-float vibrato_counter = 0;
-float vibrato_strength = .5;
-float vibrato_rate = 0.125;
-#endif
+uint8_t rest_counter = 0;
 
-float polyphony_rate = 0;
+// In 256ths
+uint16_t polyphony_rate = 0;
 
 static bool audio_initialized = false;
 
@@ -131,9 +119,9 @@ bool glissando = true;
 #ifndef AUDIO_OFF_SONG
     #define AUDIO_OFF_SONG SONG(AUDIO_OFF_SOUND)
 #endif
-float startup_song[][2] = STARTUP_SONG;
-float audio_on_song[][2] = AUDIO_ON_SONG;
-float audio_off_song[][2] = AUDIO_OFF_SONG;
+const song_event_t startup_song[] PROGMEM = STARTUP_SONG;
+const song_event_t audio_on_song[] PROGMEM = AUDIO_ON_SONG;
+const song_event_t audio_off_song[] PROGMEM = AUDIO_OFF_SONG;
 
 void audio_init()
 {
@@ -190,11 +178,24 @@ void audio_init()
     }
 
     if (audio_config.enable) {
-        PLAY_SONG(startup_song);
+        PLAY_STREAM(startup_song);
     }
 
 }
 
+// Worked out whenever the voices or the rate change, the interrupt only
+// counts up to it
+static void update_voice_ticks(void)
+{
+    for (uint8_t i = 0; i < 8; i++) {
+        if (pitches[i] == 0 || polyphony_rate == 0) {
+            voice_ticks[i] = 0;
+        } else {
+            voice_ticks[i] = ((uint32_t)SYNTH_TIMER_CLOCK * 32 / synth_period(pitches[i])) / polyphony_rate;
+        }
+    }
+}
+
 void stop_all_notes()
 {
     dprintf("audio stop all notes");
@@ -217,14 +218,16 @@ void stop_all_notes()
 
     playing_notes = false;
     playing_note = false;
-    frequency = 0;
-    frequency_alt = 0;
+    song_stop();
+    pitch = 0;
+    pitch_alt = 0;
     volume = 0;
 
     for (uint8_t i = 0; i < 8; i++)
     {
-        frequencies[i] = 0;
+        pitches[i] = 0;
         volumes[i] = 0;
+        voice_ticks[i] = 0;
     }
 }
 
@@ -236,19 +239,21 @@ void stop_note(float freq)
         if (!audio_initialized) {
             audio_init();
         }
+        pitch_t p = synth_pitch_from_freq(freq);
         for (int i = 7; i >= 0; i--) {
-            if (frequencies[i] == freq) {
-                frequencies[i] = 0;
+            if (pitches[i] == p) {
+                pitches[i] = 0;
                 volumes[i] = 0;
                 for (int j = i; (j < 7); j++) {
-                    frequencies[j] = frequencies[j+1];
-                    frequencies[j+1] = 0;
+                    pitches[j] = pitches[j+1];
+                    pitches[j+1] = 0;
                     volumes[j] = volumes[j+1];
                     volumes[j+1] = 0;
                 }
                 break;
             }
         }
+        update_voice_ticks();
         voices--;
         if (voices < 0)
             voices = 0;
@@ -264,66 +269,42 @@ void stop_note(float freq)
                 DISABLE_AUDIO_COUNTER_1_ISR;
                 DISABLE_AUDIO_COUNTER_1_OUTPUT;
             #endif
-            frequency = 0;
-            frequency_alt = 0;
+            pitch = 0;
+            pitch_alt = 0;
             volume = 0;
             playing_note = false;
         }
     }
 }
 
-#ifdef VIBRATO_ENABLE
-
-float mod(float a, int b)
-{
-    float r = fmod(a, b);
-    return r < 0 ? r + b : r;
-}
-
-float vibrato(float average_freq) {
-    #ifdef VIBRATO_STRENGTH_ENABLE
-        float vibrated_freq = average_freq * pow(vibrato_lut[(int)vibrato_counter], vibrato_strength);
-    #else
-        float vibrated_freq = average_freq * vibrato_lut[(int)vibrato_counter];
-    #endif
-    vibrato_counter = mod((vibrato_counter + vibrato_rate * (1.0 + 440.0/average_freq)), VIBRATO_LUT_LENGTH);
-    return vibrated_freq;
-}
-
-#endif
 
 #ifdef C6_AUDIO
 ISR(TIMER3_COMPA_vect)
 {
-    float freq;
+    pitch_t p;
+    uint16_t period;
 
     if (playing_note) {
         if (voices > 0) {
 
             #ifdef B5_AUDIO
-            float freq_alt = 0;
+            pitch_t p_alt = 0;
                 if (voices > 1) {
                     if (polyphony_rate == 0) {
                         if (glissando) {
-                            if (frequency_alt != 0 && frequency_alt < frequencies[voices - 2] && frequency_alt < frequencies[voices - 2] * pow(2, -440/frequencies[voices - 2]/12/2)) {
-                                frequency_alt = frequency_alt * pow(2, 440/frequency_alt/12/2);
-                            } else if (frequency_alt != 0 && frequency_alt > frequencies[voices - 2] && frequency_alt > frequencies[voices - 2] * pow(2, 440/frequencies[voices - 2]/12/2)) {
-                                frequency_alt = frequency_alt * pow(2, -440/frequency_alt/12/2);
-                            } else {
-                                frequency_alt = frequencies[voices - 2];
-                            }
+                            pitch_alt = synth_glide(pitch_alt, pitches[voices - 2]);
                         } else {
-                            frequency_alt = frequencies[voices - 2];
+                            pitch_alt = pitches[voices - 2];
                         }
 
                         #ifdef VIBRATO_ENABLE
                             if (vibrato_strength > 0) {
-                                freq_alt = vibrato(frequency_alt);
+                                p_alt = synth_vibrato(pitch_alt);
                             } else {
-                                freq_alt = frequency_alt;
+                                p_alt = pitch_alt;
                             }
                         #else
-                            freq_alt = frequency_alt;
+                            p_alt = pitch_alt;
                         #endif
                     }
 
@@ -331,56 +312,48 @@ ISR(TIMER3_COMPA_vect)
                         envelope_index++;
                     }
 
-                    freq_alt = voice_envelope(freq_alt);
+                    p_alt = voice_envelope(p_alt);
 
-                    if (freq_alt < 30.517578125) {
-                        freq_alt = 30.52;
-                    }
-
-                    TIMER_1_PERIOD = (uint16_t)(((float)F_CPU) / (freq_alt * CPU_PRESCALER));
-                    TIMER_1_DUTY_CYCLE = (uint16_t)((((float)F_CPU) / (freq_alt * CPU_PRESCALER)) * note_timbre);
+                    // synth_period() doesn't go below 30.52 Hz
+                    period = synth_period(p_alt);
+                    TIMER_1_PERIOD = period;
+                    TIMER_1_DUTY_CYCLE = synth_duty(period, note_timbre);
                 }
             #endif
 
             if (polyphony_rate > 0) {
                 if (voices > 1) {
                     voice_place %= voices;
-                    if (place++ > (frequencies[voice_place] / polyphony_rate / CPU_PRESCALER)) {
+                    if (place++ > voice_ticks[voice_place]) {
                         voice_place = (voice_place + 1) % voices;
-                        place = 0.0;
+                        place = 0;
                     }
                 }
 
                 #ifdef VIBRATO_ENABLE
                     if (vibrato_strength > 0) {
-                        freq = vibrato(frequencies[voice_place]);
+                        p = synth_vibrato(pitches[voice_place]);
                     } else {
-                        freq = frequencies[voice_place];
+                        p = pitches[voice_place];
                     }
                 #else
-                    freq = frequencies[voice_place];
+                    p = pitches[voice_place];
                 #endif
             } else {
                 if (glissando) {
-                    if (frequency != 0 && frequency < frequencies[voices - 1] && frequency < frequencies[voices - 1] * pow(2, -440/frequencies[voices - 1]/12/2)) {
-                        frequency = frequency * pow(2, 440/frequency/12/2);
-                    } else if (frequency != 0 && frequency > frequencies[voices - 1] && frequency > frequencies[voices - 1] * pow(2, 440/frequencies[voices - 1]/12/2)) {
-                        frequency = frequency * pow(2, -440/frequency/12/2);
-                    } else {
-                        frequency = frequencies[voices - 1];
-                    }
+                    pitch = synth_glide(pitch, pitches[voices - 1]);
                 } else {
-                    frequency = frequencies[voices - 1];
+                    pitch = pitches[voices - 1];
                 }
 
                 #ifdef VIBRATO_ENABLE
                     if (vibrato_strength > 0) {
-                        freq = vibrato(frequency);
+                        p = synth_vibrato(pitch);
                     } else {
-                        freq = frequency;
+                        p = pitch;
                     }
                 #else
-                    freq = frequency;
+                    p = pitch;
                 #endif
             }
 
@@ -388,82 +361,46 @@ ISR(TIMER3_COMPA_vect)
                 envelope_index++;
             }
 
-            freq = voice_envelope(freq);
-
-            if (freq < 30.517578125) {
-                freq = 30.52;
-            }
+            p = voice_envelope(p);
 
-            TIMER_3_PERIOD = (uint16_t)(((float)F_CPU) / (freq * CPU_PRESCALER));
-            TIMER_3_DUTY_CYCLE = (uint16_t)((((float)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre);
+            // synth_period() doesn't go below 30.52 Hz
+            period = synth_period(p);
+            TIMER_3_PERIOD = period;
+            TIMER_3_DUTY_CYCLE = synth_duty(period, note_timbre);
         }
     }
 
     if (playing_notes) {
-        if (note_frequency > 0) {
+        pitch_t note_pitch = song_pitch();
+        if (note_pitch > 0) {
             #ifdef VIBRATO_ENABLE
                 if (vibrato_strength > 0) {
-                    freq = vibrato(note_frequency);
+                    p = synth_vibrato(note_pitch);
                 } else {
-                    freq = note_frequency;
+                    p = note_pitch;
                 }
             #else
-                    freq = note_frequency;
+                    p = note_pitch;
             #endif
 
             if (envelope_index < 65535) {
                 envelope_index++;
             }
-            freq = voice_envelope(freq);
+            p = voice_envelope(p);
 
-            TIMER_3_PERIOD = (uint16_t)(((float)F_CPU) / (freq * CPU_PRESCALER));
-            TIMER_3_DUTY_CYCLE = (uint16_t)((((float)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre);
+            period = synth_period(p);
+            TIMER_3_PERIOD = period;
+            TIMER_3_DUTY_CYCLE = synth_duty(period, note_timbre);
         } else {
             TIMER_3_PERIOD = 0;
             TIMER_3_DUTY_CYCLE = 0;
         }
 
-        note_position++;
-        bool end_of_note = false;
-        if (TIMER_3_PERIOD > 0) {
-            if (!note_resting) 
-                end_of_note = (note_position >= (note_length / TIMER_3_PERIOD * 0xFFFF - 1));
-            else
-                end_of_note = (note_position >= (note_length));
-        } else {
-            end_of_note = (note_position >= (note_length));
-        }
-
-        if (end_of_note) {
-            current_note++;
-            if (current_note >= notes_count) {
-                if (notes_repeat) {
-                    current_note = 0;
-                } else {
-                    DISABLE_AUDIO_COUNTER_3_ISR;
-                    DISABLE_AUDIO_COUNTER_3_OUTPUT;
-                    playing_notes = false;
-                    return;
-                }
-            }
-            if (!note_resting) {
-                note_resting = true;
-                current_note--;
-                if ((*notes_pointer)[current_note][0] == (*notes_pointer)[current_note + 1][0]) {
-                    note_frequency = 0;
-                    note_length = 1;
-                } else {
-                    note_frequency = (*notes_pointer)[current_note][0];
-                    note_length = 1;
-                }
-            } else {
-                note_resting = false;
-                envelope_index = 0;
-                note_frequency = (*notes_pointer)[current_note][0];
-                note_length = ((*notes_pointer)[current_note][1] / 4) * (((float)note_tempo) / 100);
-            }
-
-            note_position = 0;
+        if (!song_tick(TIMER_3_PERIOD)) {
+            DISABLE_AUDIO_COUNTER_3_ISR;
+            DISABLE_AUDIO_COUNTER_3_OUTPUT;
+            playing_notes = false;
+            return;
         }
     }
 
@@ -478,49 +415,44 @@ ISR(TIMER3_COMPA_vect)
 ISR(TIMER1_COMPA_vect)
 {
     #if defined(B5_AUDIO) && !defined(C6_AUDIO)
-    float freq = 0;
+    pitch_t p = 0;
+    uint16_t period;
 
     if (playing_note) {
         if (voices > 0) {
             if (polyphony_rate > 0) {
                 if (voices > 1) {
                     voice_place %= voices;
-                    if (place++ > (frequencies[voice_place] / polyphony_rate / CPU_PRESCALER)) {
+                    if (place++ > voice_ticks[voice_place]) {
                         voice_place = (voice_place + 1) % voices;
-                        place = 0.0;
+                        place = 0;
                     }
                 }
 
                 #ifdef VIBRATO_ENABLE
                     if (vibrato_strength > 0) {
-                        freq = vibrato(frequencies[voice_place]);
+                        p = synth_vibrato(pitches[voice_place]);
                     } else {
-                        freq = frequencies[voice_place];
+                        p = pitches[voice_place];
                     }
                 #else
-                    freq = frequencies[voice_place];
+                    p = pitches[voice_place];
                 #endif
             } else {
                 if (glissando) {
-                    if (frequency != 0 && frequency < frequencies[voices - 1] && frequency < frequencies[voices - 1] * pow(2, -440/frequencies[voices - 1]/12/2)) {
-                        frequency = frequency * pow(2, 440/frequency/12/2);
-                    } else if (frequency != 0 && frequency > frequencies[voices - 1] && frequency > frequencies[voices - 1] * pow(2, 440/frequencies[voices - 1]/12/2)) {
-                        frequency = frequency * pow(2, -440/frequency/12/2);
-                    } else {
-                        frequency = frequencies[voices - 1];
-                    }
+                    pitch = synth_glide(pitch, pitches[voices - 1]);
                 } else {
-                    frequency = frequencies[voices - 1];
+                    pitch = pitches[voices - 1];
                 }
 
                 #ifdef VIBRATO_ENABLE
                     if (vibrato_strength > 0) {
-                        freq = vibrato(frequency);
+                        p = synth_vibrato(pitch);
                     } else {
-                        freq = frequency;
+                        p = pitch;
                     }
                 #else
-                    freq = frequency;
+                    p = pitch;
                 #endif
             }
 
@@ -528,82 +460,46 @@ ISR(TIMER1_COMPA_vect)
                 envelope_index++;
             }
 
-            freq = voice_envelope(freq);
-
-            if (freq < 30.517578125) {
-                freq = 30.52;
-            }
+            p = voice_envelope(p);
 
-            TIMER_1_PERIOD = (uint16_t)(((float)F_CPU) / (freq * CPU_PRESCALER));
-            TIMER_1_DUTY_CYCLE = (uint16_t)((((float)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre);
+            // synth_period() doesn't go below 30.52 Hz
+            period = synth_period(p);
+            TIMER_1_PERIOD = period;
+            TIMER_1_DUTY_CYCLE = synth_duty(period, note_timbre);
         }
     }
 
     if (playing_notes) {
-        if (note_frequency > 0) {
+        pitch_t note_pitch = song_pitch();
+        if (note_pitch > 0) {
             #ifdef VIBRATO_ENABLE
                 if (vibrato_strength > 0) {
-                    freq = vibrato(note_frequency);
+                    p = synth_vibrato(note_pitch);
                 } else {
-                    freq = note_frequency;
+                    p = note_pitch;
                 }
             #else
-                    freq = note_frequency;
+                    p = note_pitch;
             #endif
 
             if (envelope_index < 65535) {
                 envelope_index++;
             }
-            freq = voice_envelope(freq);
+            p = voice_envelope(p);
 
-            TIMER_1_PERIOD = (uint16_t)(((float)F_CPU) / (freq * CPU_PRESCALER));
-            TIMER_1_DUTY_CYCLE = (uint16_t)((((float)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre);
+            period = synth_period(p);
+            TIMER_1_PERIOD = period;
+            TIMER_1_DUTY_CYCLE = synth_duty(period, note_timbre);
         } else {
             TIMER_1_PERIOD = 0;
             TIMER_1_DUTY_CYCLE = 0;
         }
 
-        note_position++;
-        bool end_of_note = false;
-        if (TIMER_1_PERIOD > 0) {
-            if (!note_resting) 
-                end_of_note = (note_position >= (note_length / TIMER_1_PERIOD * 0xFFFF - 1));
-            else
-                end_of_note = (note_position >= (note_length));
-        } else {
-            end_of_note = (note_position >= (note_length));
-        }
-
-        if (end_of_note) {
-            current_note++;
-            if (current_note >= notes_count) {
-                if (notes_repeat) {
-                    current_note = 0;
-                } else {
-                    DISABLE_AUDIO_COUNTER_1_ISR;
-                    DISABLE_AUDIO_COUNTER_1_OUTPUT;
-                    playing_notes = false;
-                    return;
-                }
-            }
-            if (!note_resting) {
-                note_resting = true;
-                current_note--;
-                if ((*notes_pointer)[current_note][0] == (*notes_pointer)[current_note + 1][0]) {
-                    note_frequency = 0;
-                    note_length = 1;
-                } else {
-                    note_frequency = (*notes_pointer)[current_note][0];
-                    note_length = 1;
-                }
-            } else {
-                note_resting = false;
-                envelope_index = 0;
-                note_frequency = (*notes_pointer)[current_note][0];
-                note_length = ((*notes_pointer)[current_note][1] / 4) * (((float)note_tempo) / 100);
-            }
-
-            note_position = 0;
+        if (!song_tick(TIMER_1_PERIOD)) {
+            DISABLE_AUDIO_COUNTER_1_ISR;
+            DISABLE_AUDIO_COUNTER_1_OUTPUT;
+            playing_notes = false;
+            return;
         }
     }
 
@@ -640,10 +536,11 @@ void play_note(float freq, int vol) {
         envelope_index = 0;
 
         if (freq > 0) {
-            frequencies[voices] = freq;
+            pitches[voices] = synth_pitch_from_freq(freq);
             volumes[voices] = vol;
             voices++;
         }
+        update_voice_ticks();
 
         #ifdef C6_AUDIO
             ENABLE_AUDIO_COUNTER_3_ISR;
@@ -664,52 +561,64 @@ void play_note(float freq, int vol) {
 
 }
 
-void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat)
+// Stops the notes that are playing before a song starts.
+// Returns false if the audio is off.
+static bool prepare_notes(void)
 {
 
     if (!audio_initialized) {
         audio_init();
     }
 
-    if (audio_config.enable) {
-
-        #ifdef C6_AUDIO
-            DISABLE_AUDIO_COUNTER_3_ISR;
-        #endif
-        #ifdef B5_AUDIO
-            DISABLE_AUDIO_COUNTER_1_ISR;
-        #endif
-
-        // Cancel note if a note is playing
-        if (playing_note)
-            stop_all_notes();
-
-        playing_notes = true;
+    if (!audio_config.enable) {
+        return false;
+    }
 
-        notes_pointer = np;
-        notes_count = n_count;
-        notes_repeat = n_repeat;
+    #ifdef C6_AUDIO
+        DISABLE_AUDIO_COUNTER_3_ISR;
+    #endif
+    #ifdef B5_AUDIO
+        DISABLE_AUDIO_COUNTER_1_ISR;
+    #endif
 
-        place = 0;
-        current_note = 0;
+    // Cancel note if a note is playing
+    if (playing_note)
+        stop_all_notes();
 
-        note_frequency = (*notes_pointer)[current_note][0];
-        note_length = ((*notes_pointer)[current_note][1] / 4) * (((float)note_tempo) / 100);
-        note_position = 0;
+    return true;
+}
 
+static void start_notes(void)
+{
+    playing_notes = song_is_playing();
+    place = 0;
 
-        #ifdef C6_AUDIO
-            ENABLE_AUDIO_COUNTER_3_ISR;
-            ENABLE_AUDIO_COUNTER_3_OUTPUT;
-        #endif
-        #ifdef B5_AUDIO
-            #ifndef C6_AUDIO
-            ENABLE_AUDIO_COUNTER_1_ISR;
-            ENABLE_AUDIO_COUNTER_1_OUTPUT;
-            #endif
+    #ifdef C6_AUDIO
+        ENABLE_AUDIO_COUNTER_3_ISR;
+        ENABLE_AUDIO_COUNTER_3_OUTPUT;
+    #endif
+    #ifdef B5_AUDIO
+        #ifndef C6_AUDIO
+        ENABLE_AUDIO_COUNTER_1_ISR;
+        ENABLE_AUDIO_COUNTER_1_OUTPUT;
         #endif
+    #endif
+}
+
+void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat)
+{
+    if (prepare_notes()) {
+        song_play_floats(np, n_count, n_repeat);
+        start_notes();
     }
+}
 
+void play_stream(const song_event_t *events, uint16_t count, bool repeat)
+{
+    if (prepare_notes()) {
+        song_play(events, count, repeat);
+        start_notes();
+    }
 }
 
 bool is_playing_notes(void) {
@@ -731,11 +640,11 @@ void audio_on(void) {
     audio_config.enable = 1;
     eeconfig_update_audio(audio_config.raw);
     audio_on_user();
-    PLAY_SONG(audio_on_song);
+    PLAY_STREAM(audio_on_song);
 }
 
 void audio_off(void) {
-    PLAY_SONG(audio_off_song);
+    PLAY_STREAM(audio_off_song);
     wait_ms(100);
     stop_all_notes();
     audio_config.enable = 0;
@@ -747,7 +656,7 @@ void audio_off(void) {
 // Vibrato rate functions
 
 void set_vibrato_rate(float rate) {
-    vibrato_rate = rate;
+    vibrato_rate = rate * 256;
 }
 
 void increase_vibrato_rate(float change) {
@@ -761,7 +670,7 @@ void decrease_vibrato_rate(float change) {
 #ifdef VIBRATO_STRENGTH_ENABLE
 
 void set_vibrato_strength(float strength) {
-    vibrato_strength = strength;
+    vibrato_strength = strength * 256;
 }
 
 void increase_vibrato_strength(float change) {
@@ -779,29 +688,34 @@ void decrease_vibrato_strength(float change) {
 // Polyphony functions
 
 void set_polyphony_rate(float rate) {
-    polyphony_rate = rate;
+    polyphony_rate = rate * 256;
+    update_voice_ticks();
 }
 
 void enable_polyphony() {
-    polyphony_rate = 5;
+    polyphony_rate = 5 * 256;
+    update_voice_ticks();
 }
 
 void disable_polyphony() {
     polyphony_rate = 0;
+    update_voice_ticks();
 }
 
 void increase_polyphony_rate(float change) {
     polyphony_rate *= change;
+    update_voice_ticks();
 }
 
 void decrease_polyphony_rate(float change) {
     polyphony_rate /= change;
+    update_voice_ticks();
 }
 
 // Timbre function
 
 void set_timbre(float timbre) {
-    note_timbre = timbre;
+    note_timbre = SYNTH_TIMBRE(timbre);
 }
 
 // Tempo functions
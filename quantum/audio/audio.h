@@ -25,6 +25,7 @@
 #include "musical_notes.h"
 #include "song_list.h"
 #include "voices.h"
+#include "song.h"
 #include "quantum.h"
 #include <math.h>
 
@@ -90,6 +91,8 @@ void play_note(float freq, int vol);
 void stop_note(float freq);
 void stop_all_notes(void);
 void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat);
+// Plays a song compiled into a PROGMEM stream, see song_stream.h
+void play_stream(const song_event_t *events, uint16_t count, bool repeat);
 
 #define SCALE (int8_t []){ 0 + (12*0), 2 + (12*0), 4 + (12*0), 5 + (12*0), 7 + (12*0), 9 + (12*0), 11 + (12*0), \
                            0 + (12*1), 2 + (12*1), 4 + (12*1), 5 + (12*1), 7 + (12*1), 9 + (12*1), 11 + (12*1), \
@@ -105,6 +108,8 @@ void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat);
 	_Pragma ("message \"'PLAY_NOTE_ARRAY' macro is deprecated\"")
 #define PLAY_SONG(note_array) play_notes(&note_array, NOTE_ARRAY_SIZE((note_array)), false)
 #define PLAY_LOOP(note_array) play_notes(&note_array, NOTE_ARRAY_SIZE((note_array)), true)
+#define PLAY_STREAM(events) play_stream((events), NOTE_ARRAY_SIZE((events)), false)
+#define PLAY_STREAM_LOOP(events) play_stream((events), NOTE_ARRAY_SIZE((events)), true)
 
 bool is_playing_notes(void);
 
@@ -24,6 +24,11 @@
 #include "keymap.h"
 
 #include "eeconfig.h"
+#include "song_stream.h"
+
+#ifdef DAC_AUDIO
+#   include "mixer.h"
+#endif
 
 // -----------------------------------------------------------------------------
 
@@ -35,6 +40,9 @@ int volume = 0;
 long position = 0;
 
 float frequencies[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+// frequencies[] as pitches, converted when the notes change so the DAC
+// callback doesn't divide in double precision
+pitch_t pitches[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 int volumes[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 bool sliding = false;
 
@@ -46,25 +54,14 @@ uint16_t sample_length = 0;
 bool     playing_notes = false;
 bool     playing_note = false;
 float    note_frequency = 0;
-float    note_length = 0;
 uint8_t  note_tempo = TEMPO_DEFAULT;
-float    note_timbre = TIMBRE_DEFAULT;
+uint8_t  note_timbre = SYNTH_TIMBRE(TIMBRE_DEFAULT);
 uint16_t note_position = 0;
-float (* notes_pointer)[][2];
-uint16_t notes_count;
-bool     notes_repeat;
-bool     note_resting = false;
 
-uint8_t current_note = 0;
 uint8_t rest_counter = 0;
 
-#ifdef VIBRATO_ENABLE
-float vibrato_counter = 0;
-float vibrato_strength = .5;
-float vibrato_rate = 0.125;
-#endif
-
-float polyphony_rate = 0;
+// In 256ths
+uint16_t polyphony_rate = 0;
 
 static bool audio_initialized = false;
 
@@ -76,7 +73,95 @@ bool glissando = true;
 #ifndef STARTUP_SONG
     #define STARTUP_SONG SONG(STARTUP_SOUND)
 #endif
-float startup_song[][2] = STARTUP_SONG;
+const song_event_t startup_song[] PROGMEM = STARTUP_SONG;
+
+#ifdef DAC_AUDIO
+
+/*
+ * DAC output: GPT6 triggers a conversion every sample and the DMA streams
+ * dac_buffer to the DAC in a circle. Every time it's done with one half of
+ * the buffer, the voices are updated and that half is mixed again.
+ */
+
+#ifndef DAC_BUFFER_SIZE
+#   define DAC_BUFFER_SIZE 256
+#endif
+
+// GPT6 counts at 1 MHz, the sample rate has to divide it
+#define DAC_TIMER_FREQUENCY 1000000
+#if DAC_TIMER_FREQUENCY % MIXER_SAMPLE_RATE != 0
+#   error "MIXER_SAMPLE_RATE has to divide 1 MHz with DAC_AUDIO"
+#endif
+
+// The voices are updated this often
+#define DAC_STEPS_PER_SECOND (MIXER_SAMPLE_RATE / (DAC_BUFFER_SIZE / 2))
+
+// The song_note_length()s are about as many cycles of the 2 MHz timer of the AVRs
+#define DAC_NOTE_STEPS(length) ((length) / (2000000 / DAC_STEPS_PER_SECOND))
+
+// play_note() volumes go up to 0xF
+#define DAC_VOLUME(vol) ((vol) >= 0xF ? 255 : (vol) * 17)
+
+static dacsample_t dac_buffer[DAC_BUFFER_SIZE];
+static pitch_t dac_pitches[MIXER_VOICES];
+static bool dac_running = false;
+
+static void dac_step(void);
+
+static void dac_end(DACDriver *dacp, dacsample_t *buffer, size_t n) {
+    (void)dacp;
+    dac_step();
+    mixer_render(buffer, n);
+}
+
+static const DACConfig dac_config = {
+    .init     = MIXER_SAMPLE_CENTER,
+    .datamode = DAC_DHRM_12BIT_RIGHT
+};
+
+static const DACConversionGroup dac_group = {
+    .num_channels = 1U,
+    .end_cb       = dac_end,
+    .error_cb     = NULL,
+    .trigger      = DAC_TRG(0)     /* TIM6 TRGO */
+};
+
+GPTConfig gpt6cfg_dac = {
+  .frequency    = DAC_TIMER_FREQUENCY,
+  .callback     = NULL,
+  .cr2          = TIM_CR2_MMS_1,    /* MMS = 010 = TRGO on Update Event.    */
+  .dier         = 0U
+};
+
+static void dac_start(void) {
+    if (dac_running) {
+        return;
+    }
+    dac_running = true;
+    mixer_render(dac_buffer, DAC_BUFFER_SIZE);
+    dacStartConversion(&DACD1, &dac_group, dac_buffer, DAC_BUFFER_SIZE);
+    gptStartContinuous(&GPTD6, DAC_TIMER_FREQUENCY / MIXER_SAMPLE_RATE);
+}
+
+static void dac_stop(void) {
+    if (!dac_running) {
+        return;
+    }
+    gptStopTimer(&GPTD6);
+    dacStopConversion(&DACD1);
+    dac_running = false;
+}
+
+// From the DMA interrupt
+static void dac_stop_i(void) {
+    chSysLockFromISR();
+    gptStopTimerI(&GPTD6);
+    dacStopConversionI(&DACD1);
+    chSysUnlockFromISR();
+    dac_running = false;
+}
+
+#else
 
 static void gpt_cb6(GPTDriver *gptp);
 static void gpt_cb7(GPTDriver *gptp);
@@ -115,6 +200,8 @@ static void gpt_cb7(GPTDriver *gptp) {
     palTogglePad(GPIOA, 5);
 }
 
+#endif
+
 void audio_init()
 {
 
@@ -129,13 +216,20 @@ void audio_init()
     // audio_config.raw = eeconfig_read_audio();
     audio_config.enable = true;
 
+#ifdef DAC_AUDIO
+    palSetPadMode(GPIOA, 4, PAL_MODE_INPUT_ANALOG);
+    mixer_init();
+    dacStart(&DACD1, &dac_config);
+    gptStart(&GPTD6, &gpt6cfg_dac);
+#else
     palSetPadMode(GPIOA, 4, PAL_MODE_OUTPUT_PUSHPULL);
     palSetPadMode(GPIOA, 5, PAL_MODE_OUTPUT_PUSHPULL);
+#endif
 
     audio_initialized = true;
 
     if (audio_config.enable) {
-        PLAY_SONG(startup_song);
+        PLAY_STREAM(startup_song);
     }
 
 }
@@ -149,12 +243,18 @@ void stop_all_notes()
     }
     voices = 0;
 
+#ifdef DAC_AUDIO
+    mixer_stop();
+    dac_stop();
+#else
     gptStopTimer(&GPTD6);
     gptStopTimer(&GPTD7);
     gptStopTimer(&GPTD8);
+#endif
 
     playing_notes = false;
     playing_note = false;
+    song_stop();
     frequency = 0;
     frequency_alt = 0;
     volume = 0;
@@ -162,6 +262,7 @@ void stop_all_notes()
     for (uint8_t i = 0; i < 8; i++)
     {
         frequencies[i] = 0;
+        pitches[i] = 0;
         volumes[i] = 0;
     }
 }
@@ -177,10 +278,13 @@ void stop_note(float freq)
         for (int i = 7; i >= 0; i--) {
             if (frequencies[i] == freq) {
                 frequencies[i] = 0;
+                pitches[i] = 0;
                 volumes[i] = 0;
                 for (int j = i; (j < 7); j++) {
                     frequencies[j] = frequencies[j+1];
                     frequencies[j+1] = 0;
+                    pitches[j] = pitches[j+1];
+                    pitches[j+1] = 0;
                     volumes[j] = volumes[j+1];
                     volumes[j+1] = 0;
                 }
@@ -194,9 +298,14 @@ void stop_note(float freq)
             voice_place = 0;
         }
         if (voices == 0) {
+#ifdef DAC_AUDIO
+            mixer_stop();
+            dac_stop();
+#else
             gptStopTimer(&GPTD6);
             gptStopTimer(&GPTD7);
             gptStopTimer(&GPTD8);
+#endif
             frequency = 0;
             frequency_alt = 0;
             volume = 0;
@@ -205,22 +314,12 @@ void stop_note(float freq)
     }
 }
 
-#ifdef VIBRATO_ENABLE
+#ifndef DAC_AUDIO
 
-float mod(float a, int b)
-{
-    float r = fmod(a, b);
-    return r < 0 ? r + b : r;
-}
+#ifdef VIBRATO_ENABLE
 
-float vibrato(float average_freq) {
-    #ifdef VIBRATO_STRENGTH_ENABLE
-        float vibrated_freq = average_freq * pow(vibrato_lut[(int)vibrato_counter], vibrato_strength);
-    #else
-        float vibrated_freq = average_freq * vibrato_lut[(int)vibrato_counter];
-    #endif
-    vibrato_counter = mod((vibrato_counter + vibrato_rate * (1.0 + 440.0/average_freq)), VIBRATO_LUT_LENGTH);
-    return vibrated_freq;
+static float vibrato(float average_freq) {
+    return synth_freq_from_pitch(synth_vibrato(synth_pitch_from_freq(average_freq)));
 }
 
 #endif
@@ -239,6 +338,92 @@ static void restart_gpt7(void) {
     gptStartContinuous(&GPTD7, 2U);
 }
 
+#endif
+
+// Done once per note, not on every step
+static void load_note(void) {
+    note_position = 0;
+#ifndef DAC_AUDIO
+    note_frequency = song_pitch() > 0 ? synth_freq_from_pitch(song_pitch()) : 0;
+#endif
+}
+
+// Moves on to the rest after the current note, or to the next note.
+// Returns false once the song is over.
+static bool next_note(void) {
+    if (!song_next_note()) {
+        playing_notes = false;
+        return false;
+    }
+    load_note();
+    return true;
+}
+
+#ifdef DAC_AUDIO
+
+// Every note held gets a voice of its own, so there's no polyphony_rate
+static void dac_step(void) {
+    pitch_t p;
+
+    if (playing_note) {
+        if (envelope_index < 65535) {
+            envelope_index++;
+        }
+        for (uint8_t i = 0; i < MIXER_VOICES; i++) {
+            if (i >= voices) {
+                dac_pitches[i] = 0;
+                mixer_voice_stop(i);
+                continue;
+            }
+            if (glissando) {
+                dac_pitches[i] = synth_glide(dac_pitches[i], pitches[i]);
+            } else {
+                dac_pitches[i] = pitches[i];
+            }
+            p = dac_pitches[i];
+            #ifdef VIBRATO_ENABLE
+                if (vibrato_strength > 0) {
+                    p = synth_vibrato(p);
+                }
+            #endif
+            p = voice_envelope(p);
+            mixer_voice_play(i, p, note_timbre, DAC_VOLUME(volumes[i]));
+        }
+    }
+
+    if (playing_notes) {
+        p = song_pitch();
+        if (p > 0) {
+            #ifdef VIBRATO_ENABLE
+                if (vibrato_strength > 0) {
+                    p = synth_vibrato(p);
+                }
+            #endif
+            if (envelope_index < 65535) {
+                envelope_index++;
+            }
+            mixer_voice_play(0, voice_envelope(p), note_timbre, 255);
+        } else {
+            mixer_voice_stop(0);
+        }
+
+        note_position++;
+        if (note_position >= (song_is_resting() ? 1 : DAC_NOTE_STEPS(song_note_length())) && !next_note()) {
+            mixer_stop();
+            dac_stop_i();
+            return;
+        }
+    }
+
+    if (!audio_config.enable) {
+        playing_notes = false;
+        playing_note = false;
+        mixer_stop();
+    }
+}
+
+#else
+
 static void gpt_cb8(GPTDriver *gptp) {
     float freq;
 
@@ -275,7 +460,7 @@ static void gpt_cb8(GPTDriver *gptp) {
                         envelope_index++;
                     }
 
-                    freq_alt = voice_envelope(freq_alt);
+                    freq_alt = synth_freq_from_pitch(voice_envelope(synth_pitch_from_freq(freq_alt)));
 
                     if (freq_alt < 30.517578125) {
                         freq_alt = 30.52;
@@ -293,7 +478,7 @@ static void gpt_cb8(GPTDriver *gptp) {
             if (polyphony_rate > 0) {
                 if (voices > 1) {
                     voice_place %= voices;
-                    if (place++ > (frequencies[voice_place] / polyphony_rate)) {
+                    if (place++ > (frequencies[voice_place] / (polyphony_rate / 256.0))) {
                         voice_place = (voice_place + 1) % voices;
                         place = 0.0;
                     }
@@ -336,7 +521,7 @@ static void gpt_cb8(GPTDriver *gptp) {
                 envelope_index++;
             }
 
-            freq = voice_envelope(freq);
+            freq = synth_freq_from_pitch(voice_envelope(synth_pitch_from_freq(freq)));
 
             if (freq < 30.517578125) {
                 freq = 30.52;
@@ -368,7 +553,7 @@ static void gpt_cb8(GPTDriver *gptp) {
             if (envelope_index < 65535) {
                 envelope_index++;
             }
-            freq = voice_envelope(freq);
+            freq = synth_freq_from_pitch(voice_envelope(synth_pitch_from_freq(freq)));
 
 
             if (gpt6cfg1.frequency != (uint16_t)freq) {
@@ -384,47 +569,17 @@ static void gpt_cb8(GPTDriver *gptp) {
         }
 
         note_position++;
-        bool end_of_note = false;
-        if (gpt6cfg1.frequency > 0) {
-            if (!note_resting) 
-                end_of_note = (note_position >= (note_length*16 - 1));
-            else
-                end_of_note = (note_position >= (note_length*16));
-        } else {
-            end_of_note = (note_position >= (note_length*16));
+        // 16 steps to every 0x10000 of the length
+        uint32_t note_steps = (song_note_length() + 0xFFF) >> 12;
+        if (gpt6cfg1.frequency > 0 && !song_is_resting()) {
+            note_steps--;
         }
 
-        if (end_of_note) {
-            current_note++;
-            if (current_note >= notes_count) {
-                if (notes_repeat) {
-                    current_note = 0;
-                } else {
-                    gptStopTimer(&GPTD6);
-                    gptStopTimer(&GPTD7);
-                    // gptStopTimer(&GPTD8);
-                    playing_notes = false;
-                    return;
-                }
-            }
-            if (!note_resting) {
-                note_resting = true;
-                current_note--;
-                if ((*notes_pointer)[current_note][0] == (*notes_pointer)[current_note + 1][0]) {
-                    note_frequency = 0;
-                    note_length = 1;
-                } else {
-                    note_frequency = (*notes_pointer)[current_note][0];
-                    note_length = 1;
-                }
-            } else {
-                note_resting = false;
-                envelope_index = 0;
-                note_frequency = (*notes_pointer)[current_note][0];
-                note_length = ((*notes_pointer)[current_note][1] / 4) * (((float)note_tempo) / 100);
-            }
-
-            note_position = 0;
+        if (note_position >= note_steps && !next_note()) {
+            gptStopTimer(&GPTD6);
+            gptStopTimer(&GPTD7);
+            // gptStopTimer(&GPTD8);
+            return;
         }
     }
 
@@ -434,6 +589,8 @@ static void gpt_cb8(GPTDriver *gptp) {
     }
 }
 
+#endif
+
 void play_note(float freq, int vol) {
 
     dprintf("audio play note freq=%d vol=%d", (int)freq, vol);
@@ -454,49 +611,72 @@ void play_note(float freq, int vol) {
 
         if (freq > 0) {
             frequencies[voices] = freq;
+            pitches[voices] = synth_pitch_from_freq(freq);
             volumes[voices] = vol;
             voices++;
         }
 
+#ifdef DAC_AUDIO
+        dac_start();
+#else
         gptStart(&GPTD8, &gpt8cfg1);
         gptStartContinuous(&GPTD8, 2U);
+#endif
             
     }
 
 }
 
-void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat)
+// Stops the notes that are playing before a song starts.
+// Returns false if the audio is off.
+static bool prepare_notes(void)
 {
 
     if (!audio_initialized) {
         audio_init();
     }
 
-    if (audio_config.enable) {
-
-        // Cancel note if a note is playing
-        if (playing_note)
-            stop_all_notes();
-
-        playing_notes = true;
+    if (!audio_config.enable) {
+        return false;
+    }
 
-        notes_pointer = np;
-        notes_count = n_count;
-        notes_repeat = n_repeat;
+    // Cancel note if a note is playing
+    if (playing_note)
+        stop_all_notes();
 
-        place = 0;
-        current_note = 0;
+    return true;
+}
 
-        note_frequency = (*notes_pointer)[current_note][0];
-        note_length = ((*notes_pointer)[current_note][1] / 4) * (((float)note_tempo) / 100);
-        note_position = 0;
+static void start_notes(void)
+{
+    playing_notes = song_is_playing();
+    place = 0;
+    load_note();
+
+#ifdef DAC_AUDIO
+    dac_start();
+#else
+    gptStart(&GPTD8, &gpt8cfg1);
+    gptStartContinuous(&GPTD8, 2U);
+    restart_gpt6();
+    restart_gpt7();
+#endif
+}
 
-        gptStart(&GPTD8, &gpt8cfg1);
-        gptStartContinuous(&GPTD8, 2U);
-        restart_gpt6();
-        restart_gpt7();
+void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat)
+{
+    if (prepare_notes()) {
+        song_play_floats(np, n_count, n_repeat);
+        start_notes();
     }
+}
 
+void play_stream(const song_event_t *events, uint16_t count, bool repeat)
+{
+    if (prepare_notes()) {
+        song_play(events, count, repeat);
+        start_notes();
+    }
 }
 
 bool is_playing_notes(void) {
@@ -530,7 +710,7 @@ void audio_off(void) {
 // Vibrato rate functions
 
 void set_vibrato_rate(float rate) {
-    vibrato_rate = rate;
+    vibrato_rate = rate * 256;
 }
 
 void increase_vibrato_rate(float change) {
@@ -544,7 +724,7 @@ void decrease_vibrato_rate(float change) {
 #ifdef VIBRATO_STRENGTH_ENABLE
 
 void set_vibrato_strength(float strength) {
-    vibrato_strength = strength;
+    vibrato_strength = strength * 256;
 }
 
 void increase_vibrato_strength(float change) {
@@ -562,11 +742,11 @@ void decrease_vibrato_strength(float change) {
 // Polyphony functions
 
 void set_polyphony_rate(float rate) {
-    polyphony_rate = rate;
+    polyphony_rate = rate * 256;
 }
 
 void enable_polyphony() {
-    polyphony_rate = 5;
+    polyphony_rate = 5 * 256;
 }
 
 void disable_polyphony() {
@@ -584,7 +764,7 @@ void decrease_polyphony_rate(float change) {
 // Timbre function
 
 void set_timbre(float timbre) {
-    note_timbre = timbre;
+    note_timbre = SYNTH_TIMBRE(timbre);
 }
 
 // Tempo functions
@@ -86,7 +86,7 @@ bool     playing_note = false;
 float    note_frequency = 0;
 float    note_length = 0;
 uint8_t  note_tempo = TEMPO_DEFAULT;
-float    note_timbre = TIMBRE_DEFAULT;
+uint8_t  note_timbre = SYNTH_TIMBRE(TIMBRE_DEFAULT);
 uint16_t note_position = 0;
 float (* notes_pointer)[][2];
 uint16_t notes_count;
@@ -103,7 +103,8 @@ float vibrato_strength = .5;
 float vibrato_rate = 0.125;
 #endif
 
-float polyphony_rate = 0;
+// In 256ths
+uint16_t polyphony_rate = 0;
 
 static bool audio_initialized = false;
 
@@ -302,7 +303,7 @@ ISR(TIMER3_COMPA_vect)
                 if (polyphony_rate > 0) {
                     if (voices > 1) {
                         voice_place %= voices;
-                        if (place++ > (frequencies[voice_place] / polyphony_rate / CPU_PRESCALER)) {
+                        if (place++ > (frequencies[voice_place] / (polyphony_rate / 256.0) / CPU_PRESCALER)) {
                             voice_place = (voice_place + 1) % voices;
                             place = 0.0;
                         }
@@ -340,12 +341,12 @@ ISR(TIMER3_COMPA_vect)
                 if (envelope_index < 65535) {
                     envelope_index++;
                 }
-                freq = voice_envelope(freq);
+                freq = synth_freq_from_pitch(voice_envelope(synth_pitch_from_freq(freq)));
 
                 if (freq < 30.517578125)
                     freq = 30.52;
                 NOTE_PERIOD = (int)(((double)F_CPU) / (freq * CPU_PRESCALER)); // Set max to the period
-                NOTE_DUTY_CYCLE = (int)((((double)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre); // Set compare to half the period
+                NOTE_DUTY_CYCLE = (int)((((double)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre / 256); // Set compare to half the period
             }
         #endif
     }
@@ -386,10 +387,10 @@ ISR(TIMER3_COMPA_vect)
                 if (envelope_index < 65535) {
                     envelope_index++;
                 }
-                freq = voice_envelope(freq);
+                freq = synth_freq_from_pitch(voice_envelope(synth_pitch_from_freq(freq)));
 
                 NOTE_PERIOD = (int)(((double)F_CPU) / (freq * CPU_PRESCALER)); // Set max to the period
-                NOTE_DUTY_CYCLE = (int)((((double)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre); // Set compare to half the period
+                NOTE_DUTY_CYCLE = (int)((((double)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre / 256); // Set compare to half the period
             } else {
                 NOTE_PERIOD = 0;
                 NOTE_DUTY_CYCLE = 0;
@@ -599,11 +600,11 @@ void decrease_vibrato_strength(float change) {
 // Polyphony functions
 
 void set_polyphony_rate(float rate) {
-    polyphony_rate = rate;
+    polyphony_rate = rate * 256;
 }
 
 void enable_polyphony() {
-    polyphony_rate = 5;
+    polyphony_rate = 5 * 256;
 }
 
 void disable_polyphony() {
@@ -621,7 +622,7 @@ void decrease_polyphony_rate(float change) {
 // Timbre function
 
 void set_timbre(float timbre) {
-    note_timbre = timbre;
+    note_timbre = SYNTH_TIMBRE(timbre);
 }
 
 // Tempo functions
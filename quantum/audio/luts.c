@@ -40,6 +40,30 @@ const float vibrato_lut[VIBRATO_LUT_LENGTH] =
 	1.0000000000000,
 };
 
+const int8_t vibrato_pitch_lut[VIBRATO_LUT_LENGTH] =
+{
+	10,
+	19,
+	26,
+	30,
+	32,
+	30,
+	26,
+	19,
+	10,
+	0,
+	-10,
+	-19,
+	-26,
+	-30,
+	-32,
+	-30,
+	-26,
+	-19,
+	-10,
+	0,
+};
+
 const uint16_t frequency_lut[FREQUENCY_LUT_LENGTH] =
 {
 	0x8E0B,
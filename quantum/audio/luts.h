@@ -14,13 +14,11 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdint.h>
 #if defined(__AVR__)
     #include <avr/io.h>
     #include <avr/interrupt.h>
     #include <avr/pgmspace.h>
-#else
-    #include "ch.h"
-    #include "hal.h"
 #endif
 
 #ifndef LUTS_H
@@ -31,6 +29,8 @@
 #define FREQUENCY_LUT_LENGTH 349
 
 extern const float vibrato_lut[VIBRATO_LUT_LENGTH];
+// The same as vibrato_lut, in 256ths of a semitone
+extern const int8_t vibrato_pitch_lut[VIBRATO_LUT_LENGTH];
 extern const uint16_t frequency_lut[FREQUENCY_LUT_LENGTH];
 
 #endif /* LUTS_H */
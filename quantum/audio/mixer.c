@@ -0,0 +1,143 @@
+/*
+ * Software mixer for the DAC audio voices
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stddef.h>
+#include "mixer.h"
+
+#define OUTPUT_SHIFT (15 - (MIXER_SAMPLE_BITS - 1) + MIXER_HEADROOM)
+
+// The phase step of a timer period of 1, the step of a period is this
+// divided by it
+#define PHASE_STEP_UNIT ((((uint64_t)SYNTH_TIMER_CLOCK) << 32) / MIXER_SAMPLE_RATE)
+
+typedef struct {
+    uint32_t phase;
+    uint32_t step;
+    const int8_t *wave;
+    pitch_t pitch;
+    uint8_t timbre;
+    uint8_t volume;
+} mixer_voice_t;
+
+static mixer_voice_t mixer_voices[MIXER_VOICES];
+
+void mixer_init(void) {
+    for (uint8_t i = 0; i < MIXER_VOICES; i++) {
+        mixer_voices[i].phase = 0;
+        mixer_voices[i].step = 0;
+        mixer_voices[i].wave = NULL;
+        mixer_voices[i].pitch = 0;
+        mixer_voices[i].timbre = 0;
+        mixer_voices[i].volume = 0;
+    }
+}
+
+void mixer_voice_play(uint8_t voice, pitch_t pitch, uint8_t timbre, uint8_t volume) {
+    if (voice >= MIXER_VOICES) {
+        return;
+    }
+    mixer_voice_t *v = &mixer_voices[voice];
+    if (pitch == 0) {
+        v->volume = 0;
+        return;
+    }
+    // The division only happens when the pitch changes
+    if (pitch != v->pitch || v->step == 0) {
+        v->pitch = pitch;
+        v->step = PHASE_STEP_UNIT / synth_period(pitch);
+    }
+    v->timbre = timbre;
+    v->volume = volume;
+}
+
+void mixer_voice_set_wave(uint8_t voice, const int8_t *wave) {
+    if (voice < MIXER_VOICES) {
+        mixer_voices[voice].wave = wave;
+    }
+}
+
+void mixer_voice_stop(uint8_t voice) {
+    if (voice < MIXER_VOICES) {
+        mixer_voices[voice].volume = 0;
+    }
+}
+
+void mixer_stop(void) {
+    for (uint8_t i = 0; i < MIXER_VOICES; i++) {
+        mixer_voices[i].volume = 0;
+    }
+}
+
+bool mixer_is_playing(void) {
+    for (uint8_t i = 0; i < MIXER_VOICES; i++) {
+        if (mixer_voices[i].volume) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Samples mixed at a time, bounds the stack used in the DMA interrupt
+#define CHUNK_LENGTH 32
+
+static void render_chunk(mixer_sample_t *buffer, uint8_t length) {
+    int32_t mix[CHUNK_LENGTH] = { 0 };
+
+    // Silent voices are left out, the others are rendered one at a time
+    // so that their state stays in registers
+    for (uint8_t i = 0; i < MIXER_VOICES; i++) {
+        mixer_voice_t *v = &mixer_voices[i];
+        if (!v->volume) {
+            continue;
+        }
+        uint32_t phase = v->phase;
+        const uint32_t step = v->step;
+        const int16_t volume = v->volume;
+        if (v->wave) {
+            const int8_t *wave = v->wave;
+            for (uint8_t j = 0; j < length; j++) {
+                mix[j] += wave[phase >> 24] * volume;
+                phase += step;
+            }
+        } else {
+            const uint8_t duty = v->timbre;
+            for (uint8_t j = 0; j < length; j++) {
+                mix[j] += (phase >> 24) < duty ? 127 * volume : -127 * volume;
+                phase += step;
+            }
+        }
+        v->phase = phase;
+    }
+
+    for (uint8_t i = 0; i < length; i++) {
+        int32_t sample = MIXER_SAMPLE_CENTER + (mix[i] >> OUTPUT_SHIFT);
+        if (sample < 0) {
+            sample = 0;
+        } else if (sample > MIXER_SAMPLE_MAX) {
+            sample = MIXER_SAMPLE_MAX;
+        }
+        buffer[i] = sample;
+    }
+}
+
+void mixer_render(mixer_sample_t *buffer, uint16_t length) {
+    while (length > CHUNK_LENGTH) {
+        render_chunk(buffer, CHUNK_LENGTH);
+        buffer += CHUNK_LENGTH;
+        length -= CHUNK_LENGTH;
+    }
+    render_chunk(buffer, length);
+}
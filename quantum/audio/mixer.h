@@ -0,0 +1,74 @@
+/*
+ * Software mixer for the DAC audio voices
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "synth.h"
+
+/*
+ * A sample based mixer for the boards with a DAC. Every voice is a phase
+ * accumulator stepping through a 256 sample wavetable, the voices are
+ * summed into a buffer that the DMA streams to the DAC. The cost of a
+ * buffer only depends on the number of voices, not on the notes played.
+ *
+ * Nothing in here is platform specific, so it runs on the host too.
+ */
+
+#ifndef MIXER_VOICES
+#   define MIXER_VOICES 8
+#endif
+
+#ifndef MIXER_SAMPLE_RATE
+#   define MIXER_SAMPLE_RATE 25000
+#endif
+
+// The DAC resolution, the samples are unsigned and centred on half scale
+#ifndef MIXER_SAMPLE_BITS
+#   define MIXER_SAMPLE_BITS 12
+#endif
+
+// Number of voices that can play at full volume without clipping, as a
+// power of two
+#ifndef MIXER_HEADROOM
+#   define MIXER_HEADROOM 2
+#endif
+
+#define MIXER_SAMPLE_MAX    ((1 << MIXER_SAMPLE_BITS) - 1)
+#define MIXER_SAMPLE_CENTER (1 << (MIXER_SAMPLE_BITS - 1))
+
+#define MIXER_WAVE_LENGTH 256
+
+typedef uint16_t mixer_sample_t;
+
+void mixer_init(void);
+
+// Starts the voice or changes its pitch, timbre and volume. The phase is
+// kept, so that changing the pitch of a playing voice doesn't click.
+// Without a wavetable the voice is a pulse wave, the timbre being its duty
+// cycle in 256ths.
+void mixer_voice_play(uint8_t voice, pitch_t pitch, uint8_t timbre, uint8_t volume);
+// NULL goes back to the pulse wave
+void mixer_voice_set_wave(uint8_t voice, const int8_t *wave);
+void mixer_voice_stop(uint8_t voice);
+void mixer_stop(void);
+bool mixer_is_playing(void);
+
+void mixer_render(mixer_sample_t *buffer, uint16_t length);
+
+#endif
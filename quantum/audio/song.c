@@ -0,0 +1,162 @@
+/*
+ * Song playback from float arrays and PROGMEM event streams
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stddef.h>
+#include "song.h"
+#include "progmem.h"
+
+// Owned by the audio drivers
+extern uint8_t  note_tempo;
+extern uint16_t envelope_index;
+
+// The break after a note is one timer tick, in 16.16 like the note lengths
+#define REST_LENGTH 0x10000UL
+
+static const song_event_t *song_events;
+static float (*song_floats)[][2];
+static uint16_t song_count;
+static uint16_t song_index;
+static bool     song_repeat;
+static bool     song_playing = false;
+static bool     song_resting = false;
+
+static pitch_t  step_pitch;
+static uint32_t step_length;
+static uint16_t step_position;
+
+static pitch_t event_pitch(uint16_t index) {
+    if (song_floats) {
+        return synth_pitch_from_freq((*song_floats)[index][0]);
+    }
+    return (pitch_t)pgm_read_byte(&song_events[index].note) << 8;
+}
+
+static uint16_t event_duration(uint16_t index) {
+    if (song_floats) {
+        return SONG_DURATION((*song_floats)[index][1]);
+    }
+    // The events are packed, so the duration isn't always aligned
+    const uint8_t *duration = (const uint8_t *)&song_events[index].duration;
+    return pgm_read_byte(duration) | (pgm_read_byte(duration + 1) << 8);
+}
+
+// Done once per note, not on every tick
+static void load_event(void) {
+    step_pitch = event_pitch(song_index);
+    // duration / 1024 * 64 / 4 * tempo / 100 * 0x10000 == duration * tempo * 256 / 25
+    step_length = ((uint32_t)event_duration(song_index) * note_tempo << 8) / 25;
+    step_position = 0;
+}
+
+static void start(void) {
+    song_index = 0;
+    song_resting = false;
+    song_playing = song_count > 0;
+    envelope_index = 0;
+    if (song_playing) {
+        load_event();
+    } else {
+        step_pitch = 0;
+    }
+}
+
+void song_play(const song_event_t *events, uint16_t count, bool repeat) {
+    song_events = events;
+    song_floats = NULL;
+    song_count = count;
+    song_repeat = repeat;
+    start();
+}
+
+void song_play_floats(float (*notes)[][2], uint16_t count, bool repeat) {
+    song_events = NULL;
+    song_floats = notes;
+    song_count = count;
+    song_repeat = repeat;
+    start();
+}
+
+void song_stop(void) {
+    song_playing = false;
+    step_pitch = 0;
+}
+
+bool song_is_playing(void) {
+    return song_playing;
+}
+
+pitch_t song_pitch(void) {
+    return step_pitch;
+}
+
+bool song_is_resting(void) {
+    return song_resting;
+}
+
+uint32_t song_note_length(void) {
+    return step_length;
+}
+
+bool song_next_note(void) {
+    if (!song_playing) {
+        return false;
+    }
+
+    uint16_t next = song_index + 1;
+    if (next >= song_count) {
+        if (!song_repeat) {
+            song_stop();
+            return false;
+        }
+        next = 0;
+    }
+
+    if (!song_resting) {
+        // The tone carries on through the break, unless the next note is the
+        // same one and would blend into it
+        song_resting = true;
+        if (event_pitch(song_index) == event_pitch(next)) {
+            step_pitch = 0;
+        }
+        step_length = REST_LENGTH;
+        step_position = 0;
+    } else {
+        song_resting = false;
+        song_index = next;
+        envelope_index = 0;
+        load_event();
+    }
+    return true;
+}
+
+bool song_tick(uint16_t period) {
+    if (!song_playing) {
+        return false;
+    }
+
+    step_position++;
+    bool end_of_note;
+    if (period > 0 && !song_resting) {
+        end_of_note = ((uint32_t)(step_position + 1) * period >= step_length);
+    } else {
+        end_of_note = ((uint32_t)step_position << 16 >= step_length);
+    }
+
+    if (end_of_note) {
+        return song_next_note();
+    }
+    return true;
+}
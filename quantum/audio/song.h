@@ -0,0 +1,109 @@
+/*
+ * Song playback from float arrays and PROGMEM event streams
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SONG_H
+#define SONG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "synth.h"
+
+/*
+ * The song sequencer behind play_notes() and play_stream().
+ *
+ * Songs can be compiled into streams of song_event_t, three bytes per note,
+ * that live in PROGMEM. The notes are resolved to semitones by the compiler,
+ * so the audio ISR only has to fetch the next event and look up its period,
+ * there's no float math left when a note starts.
+ *
+ * The old float[][2] arrays still play, the notes are converted as they are
+ * loaded.
+ */
+
+typedef struct {
+    // Semitones above C0, 0 is a rest
+    uint8_t  note;
+    // In 1024ths of a whole note, the MUSICAL_NOTE() durations times 16
+    uint16_t duration;
+} __attribute__((packed)) song_event_t;
+
+/*
+ * The semitone of a NOTE_ frequency, as a constant expression. It counts the
+ * semitone boundaries below the frequency, so the compiler folds it away.
+ * Rests are 0, and so is C0 that can't be told apart from one.
+ */
+#define SONG_NOTE(f) ( \
+    ((f) >= 16.83) + ((f) >= 17.83) + ((f) >= 18.89) + ((f) >= 20.02) + \
+    ((f) >= 21.21) + ((f) >= 22.47) + ((f) >= 23.80) + ((f) >= 25.22) + \
+    ((f) >= 26.72) + ((f) >= 28.31) + ((f) >= 29.99) + ((f) >= 31.77) + \
+    ((f) >= 33.66) + ((f) >= 35.66) + ((f) >= 37.78) + ((f) >= 40.03) + \
+    ((f) >= 42.41) + ((f) >= 44.93) + ((f) >= 47.60) + ((f) >= 50.44) + \
+    ((f) >= 53.43) + ((f) >= 56.61) + ((f) >= 59.98) + ((f) >= 63.54) + \
+    ((f) >= 67.32) + ((f) >= 71.33) + ((f) >= 75.57) + ((f) >= 80.06) + \
+    ((f) >= 84.82) + ((f) >= 89.87) + ((f) >= 95.21) + ((f) >= 100.87) + \
+    ((f) >= 106.87) + ((f) >= 113.22) + ((f) >= 119.96) + ((f) >= 127.09) + \
+    ((f) >= 134.65) + ((f) >= 142.65) + ((f) >= 151.13) + ((f) >= 160.12) + \
+    ((f) >= 169.64) + ((f) >= 179.73) + ((f) >= 190.42) + ((f) >= 201.74) + \
+    ((f) >= 213.74) + ((f) >= 226.45) + ((f) >= 239.91) + ((f) >= 254.18) + \
+    ((f) >= 269.29) + ((f) >= 285.30) + ((f) >= 302.27) + ((f) >= 320.24) + \
+    ((f) >= 339.29) + ((f) >= 359.46) + ((f) >= 380.84) + ((f) >= 403.48) + \
+    ((f) >= 427.47) + ((f) >= 452.89) + ((f) >= 479.82) + ((f) >= 508.36) + \
+    ((f) >= 538.58) + ((f) >= 570.61) + ((f) >= 604.54) + ((f) >= 640.49) + \
+    ((f) >= 678.57) + ((f) >= 718.92) + ((f) >= 761.67) + ((f) >= 806.96) + \
+    ((f) >= 854.95) + ((f) >= 905.79) + ((f) >= 959.65) + ((f) >= 1016.71) + \
+    ((f) >= 1077.17) + ((f) >= 1141.22) + ((f) >= 1209.08) + ((f) >= 1280.97) + \
+    ((f) >= 1357.15) + ((f) >= 1437.85) + ((f) >= 1523.34) + ((f) >= 1613.93) + \
+    ((f) >= 1709.90) + ((f) >= 1811.57) + ((f) >= 1919.29) + ((f) >= 2033.42) + \
+    ((f) >= 2154.33) + ((f) >= 2282.44) + ((f) >= 2418.16) + ((f) >= 2561.95) + \
+    ((f) >= 2714.29) + ((f) >= 2875.69) + ((f) >= 3046.69) + ((f) >= 3227.85) + \
+    ((f) >= 3419.79) + ((f) >= 3623.14) + ((f) >= 3838.59) + ((f) >= 4066.84) + \
+    ((f) >= 4308.67) + ((f) >= 4564.88) + ((f) >= 4836.32) + ((f) >= 5123.90) + \
+    ((f) >= 5428.58) + ((f) >= 5751.38) + ((f) >= 6093.38) + ((f) >= 6455.71) + \
+    ((f) >= 6839.58) + ((f) >= 7246.29) + ((f) >= 7677.17) + ((f) >= 8133.68) + \
+    ((f) >= 8617.34) + ((f) >= 9129.75) + ((f) >= 9672.63) + ((f) >= 10247.80) + \
+    ((f) >= 10857.16) + ((f) >= 11502.76) + ((f) >= 12186.75) + ((f) >= 12911.42) + \
+    ((f) >= 13679.17) + ((f) >= 14492.58) + ((f) >= 15354.35))
+
+#define SONG_DURATION(duration) ((uint16_t)((duration) * 16))
+
+#define SONG_EVENT(freq, duration) { SONG_NOTE(freq), SONG_DURATION(duration) }
+
+// Starts a song, the events are in PROGMEM
+void song_play(const song_event_t *events, uint16_t count, bool repeat);
+// Starts a float[][2] song, for the songs that aren't streams
+void song_play_floats(float (*notes)[][2], uint16_t count, bool repeat);
+void song_stop(void);
+bool song_is_playing(void);
+
+// The pitch to play right now, 0 when silent
+pitch_t song_pitch(void);
+// True during the short break after every note
+bool song_is_resting(void);
+// The length of the current step, in 0x10000ths of a sixteenth note at the
+// default tempo. On AVR that's about as many ticks of the tone timer.
+uint32_t song_note_length(void);
+
+// Moves on to the break after the current note, or to the next note.
+// Returns false once the song is over.
+bool song_next_note(void);
+
+/*
+ * Called by the AVR audio ISR once every period of the tone timer, with the
+ * period it has just been set to. Returns false once the song is over.
+ */
+bool song_tick(uint16_t period);
+
+#endif
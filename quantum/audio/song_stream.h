@@ -0,0 +1,37 @@
+/*
+ * SONG() compiled into PROGMEM event streams
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Include this after audio.h to compile the SONG()s of a file into streams:
+ *
+ *   const song_event_t my_song[] PROGMEM = SONG(MY_SOUND);
+ *   PLAY_STREAM(my_song);
+ *
+ * From here on MUSICAL_NOTE() makes song_event_t initializers instead of
+ * {frequency, duration} pairs, so float[][2] songs can't be defined in the
+ * same file anymore.
+ */
+#ifndef SONG_STREAM_H
+#define SONG_STREAM_H
+
+#include "musical_notes.h"
+#include "song.h"
+
+#undef MUSICAL_NOTE
+#define MUSICAL_NOTE(note, duration) SONG_EVENT(NOTE##note, duration)
+
+#endif
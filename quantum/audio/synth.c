@@ -0,0 +1,157 @@
+/*
+ * Fixed point pitches, periods and envelopes for the audio drivers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "synth.h"
+#include "progmem.h"
+#include "luts.h"
+
+#define C0_FREQ 16.351597831287414
+
+// Expands to one entry per semitone of an octave
+#define SEMITONES(f) \
+    f(1.0000000000000000), f(1.0594630943592953), f(1.1224620483093730), \
+    f(1.1892071150027210), f(1.2599210498948732), f(1.3348398541700344), \
+    f(1.4142135623730951), f(1.4983070768766815), f(1.5874010519681994), \
+    f(1.6817928305074290), f(1.7817974362806785), f(1.8877486253633868)
+
+#define PERIOD(ratio)       ((uint32_t)(SYNTH_TIMER_CLOCK / (C0_FREQ * (ratio)) + 0.5))
+#define INVERSE_FREQ(ratio) ((uint16_t)(440.0 / (C0_FREQ * (ratio)) * 2048 + 0.5))
+
+// The timer periods of the lowest octave, every octave up halves them
+static const uint32_t period_table[12] PROGMEM = { SEMITONES(PERIOD) };
+// 440 / f of the lowest octave, with 11 fractional bits
+static const uint16_t inverse_freq_table[12] PROGMEM = { SEMITONES(INVERSE_FREQ) };
+
+static inline uint32_t semitone_period(uint8_t semitone) {
+    uint8_t octave = semitone / 12;
+    return pgm_read_dword(&period_table[semitone - octave * 12]) >> octave;
+}
+
+uint16_t synth_period(pitch_t pitch) {
+    uint8_t semitone = pitch >> 8;
+    uint32_t period = semitone_period(semitone);
+    uint8_t fraction = pitch & 0xFF;
+    if (fraction) {
+        // Linear between the semitones, the error is below 0.05%
+        uint32_t next = semitone_period(semitone + 1);
+        period -= ((period - next) * fraction) >> 8;
+    }
+    if (period > SYNTH_PERIOD_MAX) {
+        return SYNTH_PERIOD_MAX;
+    }
+    return period;
+}
+
+// The same with 8 fractional bits, so that high notes aren't rounded
+static inline uint32_t semitone_period_q8(uint8_t semitone) {
+    uint8_t octave = semitone / 12;
+    return (pgm_read_dword(&period_table[semitone - octave * 12]) << 8) >> octave;
+}
+
+static pitch_t pitch_from_period(uint32_t period) {
+    if (period >= semitone_period_q8(0)) {
+        return 1;
+    }
+    // Nothing above C10 (16.7 kHz) can be played anyway
+    if (period <= semitone_period_q8(12 * 10)) {
+        return (pitch_t)(12 * 10) << 8;
+    }
+    uint8_t semitone = 0;
+    while (period <= semitone_period_q8(semitone + 12)) {
+        semitone += 12;
+    }
+    while (period <= semitone_period_q8(semitone + 1)) {
+        semitone++;
+    }
+    uint32_t current = semitone_period_q8(semitone);
+    uint32_t next = semitone_period_q8(semitone + 1);
+    return ((pitch_t)semitone << 8) | (((current - period) << 8) / (current - next));
+}
+
+pitch_t synth_pitch_from_freq(float freq) {
+    if (freq <= 0) {
+        return 0;
+    }
+    return pitch_from_period((uint32_t)(SYNTH_TIMER_CLOCK * 256.0 / freq));
+}
+
+pitch_t synth_pitch_from_hz(uint16_t hz) {
+    if (hz == 0) {
+        return 0;
+    }
+    return pitch_from_period(((uint32_t)SYNTH_TIMER_CLOCK << 8) / hz);
+}
+
+float synth_freq_from_pitch(pitch_t pitch) {
+    return (float)SYNTH_TIMER_CLOCK / synth_period(pitch);
+}
+
+static inline uint16_t semitone_440_over_freq(uint8_t semitone) {
+    uint8_t octave = semitone / 12;
+    return pgm_read_word(&inverse_freq_table[semitone - octave * 12]) >> octave;
+}
+
+uint16_t synth_440_over_freq(pitch_t pitch) {
+    uint8_t semitone = pitch >> 8;
+    uint16_t value = semitone_440_over_freq(semitone);
+    uint8_t fraction = pitch & 0xFF;
+    if (fraction) {
+        uint16_t next = semitone_440_over_freq(semitone + 1);
+        value -= ((uint32_t)(value - next) * fraction) >> 8;
+    }
+    return value;
+}
+
+// The old ratio of 2^(440/f/24) is a step of 220/f semitones
+static inline uint16_t glide_step(pitch_t pitch) {
+    return (synth_440_over_freq(pitch) + 8) >> 4;
+}
+
+pitch_t synth_glide(pitch_t current, pitch_t target) {
+    if (current == 0) {
+        return target;
+    }
+    uint16_t target_step = glide_step(target);
+    if (current < target && (uint32_t)current + target_step < target) {
+        return current + glide_step(current);
+    }
+    if (current > target && current > (uint32_t)target + target_step) {
+        return current - glide_step(current);
+    }
+    return target;
+}
+
+#ifdef VIBRATO_ENABLE
+
+uint16_t vibrato_counter = 0;
+uint16_t vibrato_strength = 128;
+uint16_t vibrato_rate = 32;
+
+pitch_t synth_vibrato(pitch_t pitch) {
+    int16_t offset = vibrato_pitch_lut[vibrato_counter >> 8];
+#ifdef VIBRATO_STRENGTH_ENABLE
+    offset = ((int32_t)offset * vibrato_strength) >> 8;
+#endif
+    // The counter moves faster for the low notes
+    uint32_t step = ((uint32_t)vibrato_rate * (256 + (synth_440_over_freq(pitch) >> 3))) >> 8;
+    vibrato_counter += step;
+    while (vibrato_counter >= VIBRATO_LUT_LENGTH * 256) {
+        vibrato_counter -= VIBRATO_LUT_LENGTH * 256;
+    }
+    return pitch + offset;
+}
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * Fixed point pitches, periods and envelopes for the audio drivers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Fixed point helpers for the audio ISR, so that it doesn't have to do any
+ * float math.
+ *
+ * Notes are kept as pitches, in semitones above C0 (16.35 Hz) with 8
+ * fractional bits. That turns the glissando and the vibrato into additions,
+ * and a pitch is turned into a timer period with a table lookup.
+ */
+
+typedef uint16_t pitch_t;
+
+#define PITCH_SEMITONE 256
+#define PITCH_OCTAVE   (12 * PITCH_SEMITONE)
+
+#ifndef CPU_PRESCALER
+#   define CPU_PRESCALER 8
+#endif
+
+/* The clock of the timer that generates the tone */
+#ifndef SYNTH_TIMER_CLOCK
+#   ifdef F_CPU
+#       define SYNTH_TIMER_CLOCK (F_CPU / CPU_PRESCALER)
+#   else
+#       define SYNTH_TIMER_CLOCK 2000000
+#   endif
+#endif
+
+#define SYNTH_PERIOD_OF(freq) ((uint32_t)(SYNTH_TIMER_CLOCK / (freq)))
+
+/* The longest period played, notes are never lower than 30.52 Hz */
+#define SYNTH_PERIOD_MAX (SYNTH_PERIOD_OF(30.52) > 0xFFFF ? 0xFFFF : SYNTH_PERIOD_OF(30.52))
+
+/* The timbre is the duty cycle, in 256ths of the period */
+#define SYNTH_TIMBRE(timbre) ((uint8_t)((timbre) * 256 > 255 ? 255 : (timbre) * 256))
+
+// Conversions from frequencies, 0 Hz (a rest) is pitch 0
+pitch_t synth_pitch_from_freq(float freq);
+pitch_t synth_pitch_from_hz(uint16_t hz);
+float synth_freq_from_pitch(pitch_t pitch);
+
+uint16_t synth_period(pitch_t pitch);
+
+static inline uint16_t synth_duty(uint16_t period, uint8_t timbre) {
+    return ((uint32_t)period * timbre) >> 8;
+}
+
+// 440 Hz divided by the frequency of the pitch, with 11 fractional bits
+uint16_t synth_440_over_freq(pitch_t pitch);
+
+// Moves the current pitch a step towards the target, the steps are the same
+// as the old 2^(440/f/24) ratio. A current pitch of 0 jumps to the target.
+pitch_t synth_glide(pitch_t current, pitch_t target);
+
+#ifdef VIBRATO_ENABLE
+// All three are in 256ths
+extern uint16_t vibrato_counter;
+extern uint16_t vibrato_strength;
+extern uint16_t vibrato_rate;
+
+// Applies the vibrato to the pitch and advances it
+pitch_t synth_vibrato(pitch_t pitch);
+#endif
+
+#endif
@@ -0,0 +1,194 @@
+/*
+ * Tests for the DAC audio mixer
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+extern "C" {
+#include "mixer.h"
+}
+
+static int8_t sine[MIXER_WAVE_LENGTH];
+
+class Mixer : public ::testing::Test {
+public:
+    Mixer() {
+        for (int i = 0; i < MIXER_WAVE_LENGTH; i++) {
+            sine[i] = round(127 * sin(2 * M_PI * i / MIXER_WAVE_LENGTH));
+        }
+        mixer_init();
+    }
+
+    std::vector<mixer_sample_t> render(size_t length) {
+        std::vector<mixer_sample_t> buffer(length);
+        mixer_render(buffer.data(), length);
+        return buffer;
+    }
+
+    // The number of times the signal goes up through the centre
+    static int crossings(const std::vector<mixer_sample_t>& buffer) {
+        int count = 0;
+        for (size_t i = 1; i < buffer.size(); i++) {
+            count += buffer[i - 1] < MIXER_SAMPLE_CENTER && buffer[i] >= MIXER_SAMPLE_CENTER;
+        }
+        return count;
+    }
+
+    // Goertzel, the magnitude of one frequency relative to full scale
+    static double magnitude(const std::vector<mixer_sample_t>& buffer, double freq) {
+        double coefficient = 2 * cos(2 * M_PI * freq / MIXER_SAMPLE_RATE);
+        double s1 = 0;
+        double s2 = 0;
+        for (auto sample : buffer) {
+            double s = (double)sample - MIXER_SAMPLE_CENTER + coefficient * s1 - s2;
+            s2 = s1;
+            s1 = s;
+        }
+        double power = s1 * s1 + s2 * s2 - coefficient * s1 * s2;
+        return 2 * sqrt(power) / buffer.size() / MIXER_SAMPLE_CENTER;
+    }
+};
+
+TEST_F(Mixer, SilenceIsCentered) {
+    EXPECT_FALSE(mixer_is_playing());
+    for (auto sample : render(1000)) {
+        EXPECT_EQ(sample, MIXER_SAMPLE_CENTER);
+    }
+}
+
+TEST_F(Mixer, PlaysTheFrequencyOfThePitch) {
+    const float notes[] = { 65.41, 261.63, 440, 1046.5, 3951.07 };
+    for (float freq : notes) {
+        mixer_init();
+        mixer_voice_play(0, synth_pitch_from_freq(freq), 128, 255);
+        EXPECT_TRUE(mixer_is_playing());
+        EXPECT_NEAR(crossings(render(MIXER_SAMPLE_RATE)), freq, freq / 500 + 1) << freq << " Hz";
+    }
+}
+
+TEST_F(Mixer, ChordsPlayEveryNote) {
+    // A major
+    const float chord[] = { 440, 554.37, 659.26 };
+    for (uint8_t i = 0; i < 3; i++) {
+        mixer_voice_set_wave(i, sine);
+        mixer_voice_play(i, synth_pitch_from_freq(chord[i]), 0, 255);
+    }
+    auto buffer = render(MIXER_SAMPLE_RATE / 2);
+    double expected = 127.0 * 255 / (1 << (15 - (MIXER_SAMPLE_BITS - 1) + MIXER_HEADROOM)) / MIXER_SAMPLE_CENTER;
+    for (float freq : chord) {
+        EXPECT_NEAR(magnitude(buffer, freq), expected, expected / 10) << freq << " Hz";
+    }
+    EXPECT_LT(magnitude(buffer, 493.88), expected / 20);
+    EXPECT_LT(magnitude(buffer, 880), expected / 20);
+}
+
+TEST_F(Mixer, VolumeScalesTheVoice) {
+    mixer_voice_play(0, synth_pitch_from_freq(440), 128, 255);
+    auto loud = render(1000);
+    mixer_voice_play(0, synth_pitch_from_freq(440), 128, 64);
+    auto quiet = render(1000);
+    int loud_peak = *std::max_element(loud.begin(), loud.end()) - MIXER_SAMPLE_CENTER;
+    int quiet_peak = *std::max_element(quiet.begin(), quiet.end()) - MIXER_SAMPLE_CENTER;
+    EXPECT_NEAR(loud_peak, MIXER_SAMPLE_CENTER >> MIXER_HEADROOM, 8);
+    EXPECT_NEAR(quiet_peak, loud_peak / 4, 2);
+}
+
+TEST_F(Mixer, ClipsInsteadOfWrapping) {
+    for (uint8_t i = 0; i < MIXER_VOICES; i++) {
+        mixer_voice_play(i, synth_pitch_from_freq(110), 128, 255);
+    }
+    auto buffer = render(1000);
+    EXPECT_EQ(*std::max_element(buffer.begin(), buffer.end()), MIXER_SAMPLE_MAX);
+    EXPECT_EQ(*std::min_element(buffer.begin(), buffer.end()), 0);
+}
+
+TEST_F(Mixer, TimbreIsTheDutyCycle) {
+    mixer_voice_play(0, synth_pitch_from_freq(440), 64, 255);
+    auto buffer = render(MIXER_SAMPLE_RATE);
+    int high = 0;
+    for (auto sample : buffer) {
+        high += sample > MIXER_SAMPLE_CENTER;
+    }
+    EXPECT_NEAR(high, MIXER_SAMPLE_RATE / 4, MIXER_SAMPLE_RATE / 100);
+}
+
+TEST_F(Mixer, ChangingThePitchKeepsThePhase) {
+    mixer_voice_set_wave(0, sine);
+    mixer_voice_play(0, synth_pitch_from_freq(220), 0, 255);
+    auto before = render(1013);
+    mixer_voice_play(0, synth_pitch_from_freq(233.08), 0, 255);
+    auto after = render(100);
+    // The largest step between two samples of a 233 Hz sine
+    int max_step = ceil(2 * M_PI * 233.08 / MIXER_SAMPLE_RATE * (MIXER_SAMPLE_CENTER >> MIXER_HEADROOM)) + 1;
+    EXPECT_LE(abs((int)after[0] - (int)before.back()), max_step);
+}
+
+TEST_F(Mixer, StoppedVoicesAreSilent) {
+    mixer_voice_play(0, synth_pitch_from_freq(440), 128, 255);
+    mixer_voice_play(1, synth_pitch_from_freq(660), 128, 255);
+    render(100);
+    mixer_voice_stop(0);
+    EXPECT_TRUE(mixer_is_playing());
+    EXPECT_NEAR(crossings(render(MIXER_SAMPLE_RATE)), 660, 2);
+    mixer_stop();
+    EXPECT_FALSE(mixer_is_playing());
+    for (auto sample : render(100)) {
+        EXPECT_EQ(sample, MIXER_SAMPLE_CENTER);
+    }
+}
+
+TEST_F(Mixer, RenderingInPiecesIsSeamless) {
+    mixer_voice_set_wave(1, sine);
+    mixer_voice_play(0, synth_pitch_from_freq(300), 100, 200);
+    mixer_voice_play(1, synth_pitch_from_freq(450), 0, 255);
+    auto whole = render(256);
+
+    mixer_init();
+    mixer_voice_set_wave(1, sine);
+    mixer_voice_play(0, synth_pitch_from_freq(300), 100, 200);
+    mixer_voice_play(1, synth_pitch_from_freq(450), 0, 255);
+    auto first = render(37);
+    auto second = render(219);
+    first.insert(first.end(), second.begin(), second.end());
+    EXPECT_EQ(first, whole);
+}
+
+// Not a pass or fail, prints how many voice samples per second the host mixes
+TEST_F(Mixer, Benchmark) {
+    const size_t length = 128;
+    const int buffers = 2000;
+    std::vector<mixer_sample_t> buffer(length);
+    for (uint8_t voices = 1; voices <= MIXER_VOICES; voices *= 2) {
+        mixer_init();
+        for (uint8_t i = 0; i < voices; i++) {
+            if (i % 2) {
+                mixer_voice_set_wave(i, sine);
+            }
+            mixer_voice_play(i, synth_pitch_from_freq(220 + 50 * i), 128, 255);
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < buffers; i++) {
+            mixer_render(buffer.data(), length);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        printf("%d voices: %.1f M voice samples/s\n", voices, voices * length * buffers / elapsed.count() / 1e6);
+    }
+}
@@ -0,0 +1,18 @@
+quantum_audio_synth_SRC :=\
+	$(QUANTUM_PATH)/audio/tests/synth_tests.cpp \
+	$(QUANTUM_PATH)/audio/synth.c \
+	$(QUANTUM_PATH)/audio/voices.c \
+	$(QUANTUM_PATH)/audio/luts.c
+quantum_audio_synth_DEFS := -DF_CPU=16000000 -DAUDIO_VOICES
+
+quantum_audio_mixer_SRC :=\
+	$(QUANTUM_PATH)/audio/tests/mixer_tests.cpp \
+	$(QUANTUM_PATH)/audio/mixer.c \
+	$(QUANTUM_PATH)/audio/synth.c
+
+quantum_audio_song_SRC :=\
+	$(QUANTUM_PATH)/audio/tests/song_tests.cpp \
+	$(QUANTUM_PATH)/audio/tests/song_streams.c \
+	$(QUANTUM_PATH)/audio/song.c \
+	$(QUANTUM_PATH)/audio/synth.c
+quantum_audio_song_DEFS := -DF_CPU=16000000
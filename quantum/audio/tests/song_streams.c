@@ -0,0 +1,58 @@
+/*
+ * Songs used by the song tests
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The same songs as float[][2] arrays and as streams. The streams have to be
+ * defined in a C file, after song_stream.h has changed MUSICAL_NOTE().
+ */
+
+#include "musical_notes.h"
+#include "song_list.h"
+#include "song_tests.h"
+
+#define TEST_SONGS(f) \
+    f(startup, STARTUP_SOUND) \
+    f(goodbye, GOODBYE_SOUND) \
+    f(planck, PLANCK_SOUND) \
+    f(qwerty, QWERTY_SOUND) \
+    f(music_on, MUSIC_ON_SOUND) \
+    f(music_off, MUSIC_OFF_SOUND) \
+    f(voice_change, VOICE_CHANGE_SOUND) \
+    f(guitar, GUITAR_SOUND) \
+    f(caps_lock_on, CAPS_LOCK_ON_SOUND) \
+    f(coin, COIN_SOUND) \
+    f(one_up, ONE_UP_SOUND) \
+    f(terminal, TERMINAL_SOUND) \
+    f(odd, TEST_ODD_SOUND)
+
+#define FLOAT_SONG(name, sound) float name##_notes[][2] = SONG(sound);
+TEST_SONGS(FLOAT_SONG)
+float test_all_notes[][2] = SONG(TEST_ALL_NOTES);
+
+#include "song_stream.h"
+
+#define STREAM_SONG(name, sound) const song_event_t name##_events[] = SONG(sound);
+TEST_SONGS(STREAM_SONG)
+const song_event_t test_all_note_events[] = SONG(TEST_ALL_NOTES);
+const uint16_t test_all_note_count = sizeof(test_all_note_events) / sizeof(test_all_note_events[0]);
+
+#define COUNT(x) (sizeof(x) / sizeof(x[0]))
+#define TEST_SONG(name, sound) \
+    { #name, &name##_notes, COUNT(name##_notes), name##_events, COUNT(name##_events), sizeof(name##_events) },
+
+const test_song_t test_songs[] = { TEST_SONGS(TEST_SONG) };
+const uint16_t test_song_count = COUNT(test_songs);
@@ -0,0 +1,234 @@
+/*
+ * Tests for the song playback
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cstdlib>
+#include <vector>
+
+extern "C" {
+#include "synth.h"
+#include "song.h"
+#include "song_tests.h"
+
+// Normally owned by audio.c
+uint8_t note_tempo = 100;
+uint16_t envelope_index = 0;
+}
+
+// A stretch of the same pitch, the breaks between different notes don't show
+struct Tone {
+    pitch_t pitch;
+    uint32_t ticks;
+};
+
+static void add_tick(std::vector<Tone> &runs, pitch_t pitch) {
+    if (runs.empty() || runs.back().pitch != pitch) {
+        runs.push_back({pitch, 0});
+    }
+    runs.back().ticks++;
+}
+
+// How the audio ISR drives the song, one call per period of the timer
+static std::vector<Tone> play(uint32_t max_ticks = 10000000) {
+    std::vector<Tone> runs;
+    for (uint32_t i = 0; i < max_ticks; i++) {
+        pitch_t p = song_pitch();
+        add_tick(runs, p);
+        if (!song_tick(p > 0 ? synth_period(p) : 0)) {
+            break;
+        }
+    }
+    return runs;
+}
+
+// The float sequencer that was in the ISR before
+static std::vector<Tone> play_reference(float (*notes)[][2], uint16_t count) {
+    std::vector<Tone> runs;
+    uint16_t current = 0;
+    bool resting = false;
+    uint16_t position = 0;
+    pitch_t pitch = synth_pitch_from_freq((*notes)[0][0]);
+    uint32_t length = (uint32_t)((*notes)[0][1] * note_tempo * (0xFFFF / 400.0));
+
+    while (true) {
+        uint16_t period = pitch > 0 ? synth_period(pitch) : 0;
+        add_tick(runs, pitch);
+
+        position++;
+        bool end_of_note;
+        if (period > 0 && !resting) {
+            end_of_note = ((uint32_t)(position + 1) * period >= length);
+        } else {
+            end_of_note = ((uint32_t)position * 0xFFFF >= length);
+        }
+        if (end_of_note) {
+            current++;
+            if (current >= count) {
+                break;
+            }
+            if (!resting) {
+                resting = true;
+                current--;
+                if ((*notes)[current][0] == (*notes)[current + 1][0]) {
+                    pitch = 0;
+                } else {
+                    pitch = synth_pitch_from_freq((*notes)[current][0]);
+                }
+                length = 0xFFFF;
+            } else {
+                resting = false;
+                pitch = synth_pitch_from_freq((*notes)[current][0]);
+                length = (uint32_t)((*notes)[current][1] * note_tempo * (0xFFFF / 400.0));
+            }
+            position = 0;
+        }
+    }
+    return runs;
+}
+
+static uint32_t clocks(const std::vector<Tone> &runs) {
+    uint32_t total = 0;
+    for (const Tone &run : runs) {
+        total += run.ticks * (run.pitch > 0 ? synth_period(run.pitch) : 0xFFFF);
+    }
+    return total;
+}
+
+class Song : public testing::Test {
+protected:
+    void SetUp() override {
+        note_tempo = 100;
+        song_stop();
+    }
+};
+
+TEST_F(Song, EventsAreThreeBytes) {
+    EXPECT_EQ(3u, sizeof(song_event_t));
+    for (uint16_t i = 0; i < test_song_count; i++) {
+        EXPECT_EQ(test_songs[i].note_count, test_songs[i].event_count) << test_songs[i].name;
+        EXPECT_EQ(3u * test_songs[i].event_count, test_songs[i].event_bytes) << test_songs[i].name;
+    }
+}
+
+TEST_F(Song, NotesAreResolvedAtCompileTime) {
+    ASSERT_EQ(12 * 7 + 1, test_all_note_count);
+    for (uint16_t i = 0; i < test_all_note_count; i++) {
+        pitch_t p = synth_pitch_from_freq(test_all_notes[i][0]);
+        EXPECT_EQ((p + PITCH_SEMITONE / 2) / PITCH_SEMITONE, test_all_note_events[i].note) << test_all_notes[i][0];
+        EXPECT_EQ(23 + i, test_all_note_events[i].note);
+        EXPECT_EQ(16, test_all_note_events[i].duration);
+    }
+}
+
+TEST_F(Song, RestsAreZero) {
+    const song_event_t rest = SONG_EVENT(0.0, 4);
+    EXPECT_EQ(0, rest.note);
+    EXPECT_EQ(64, rest.duration);
+
+    const song_event_t fraction = SONG_EVENT(440.0, 0.0625);
+    EXPECT_EQ(57, fraction.note);
+    EXPECT_EQ(1, fraction.duration);
+}
+
+TEST_F(Song, FloatSongsKeepTheirTiming) {
+    for (uint16_t i = 0; i < test_song_count; i++) {
+        const test_song_t &song = test_songs[i];
+        std::vector<Tone> expected = play_reference(song.notes, song.note_count);
+        song_play_floats(song.notes, song.note_count, false);
+        std::vector<Tone> runs = play();
+
+        ASSERT_EQ(expected.size(), runs.size()) << song.name;
+        for (size_t j = 0; j < runs.size(); j++) {
+            EXPECT_EQ(expected[j].pitch, runs[j].pitch) << song.name << " " << j;
+            EXPECT_EQ(expected[j].ticks, runs[j].ticks) << song.name << " " << j;
+        }
+        EXPECT_FALSE(song_is_playing());
+    }
+}
+
+TEST_F(Song, StreamsPlayLikeFloatSongs) {
+    for (uint8_t tempo : {100, 60, 200}) {
+        note_tempo = tempo;
+        for (uint16_t i = 0; i < test_song_count; i++) {
+            const test_song_t &song = test_songs[i];
+            song_play_floats(song.notes, song.note_count, false);
+            std::vector<Tone> expected = play();
+            song_play(song.events, song.event_count, false);
+            std::vector<Tone> runs = play();
+
+            ASSERT_EQ(expected.size(), runs.size()) << song.name;
+            for (size_t j = 0; j < runs.size(); j++) {
+                // The float songs aren't exactly on the semitones
+                EXPECT_LE(std::abs((int)expected[j].pitch - (int)runs[j].pitch), 2) << song.name << " " << j;
+                // So the periods are a bit off, but a note never ends more
+                // than a period early or late
+                int32_t period = runs[j].pitch > 0 ? synth_period(runs[j].pitch) : 0xFFFF;
+                int32_t error = (int32_t)clocks({expected[j]}) - (int32_t)clocks({runs[j]});
+                EXPECT_LE(std::abs(error), period + 0xFF) << song.name << " " << j;
+            }
+        }
+    }
+}
+
+TEST_F(Song, TempoStretchesTheNotes) {
+    const test_song_t &song = test_songs[0];
+    song_play(song.events, song.event_count, false);
+    uint32_t normal = clocks(play());
+    note_tempo = 200;
+    song_play(song.events, song.event_count, false);
+    uint32_t slow = clocks(play());
+    EXPECT_NEAR(2.0, (double)slow / normal, 0.01);
+}
+
+TEST_F(Song, RepeatedNotesGetASilentBreak) {
+    static const song_event_t events[] = { SONG_EVENT(440.0, 16), SONG_EVENT(440.0, 16), SONG_EVENT(880.0, 16) };
+    song_play(events, 3, false);
+    std::vector<Tone> runs = play();
+    ASSERT_EQ(4u, runs.size());
+    EXPECT_EQ(57 * PITCH_SEMITONE, runs[0].pitch);
+    EXPECT_EQ(0, runs[1].pitch);
+    EXPECT_EQ(1u, runs[1].ticks);
+    EXPECT_EQ(57 * PITCH_SEMITONE, runs[2].pitch);
+    // The break before a different note keeps the tone going
+    EXPECT_EQ(69 * PITCH_SEMITONE, runs[3].pitch);
+}
+
+TEST_F(Song, LoopsWrapAround) {
+    static const song_event_t events[] = { SONG_EVENT(440.0, 16), SONG_EVENT(880.0, 16), SONG_EVENT(440.0, 16) };
+    song_play(events, 3, true);
+    std::vector<Tone> runs = play(20000);
+    EXPECT_TRUE(song_is_playing());
+    ASSERT_GE(runs.size(), 6u);
+    // The last note is the same as the first, so it gets a silent break too
+    EXPECT_EQ(0, runs[3].pitch);
+    EXPECT_EQ(57 * PITCH_SEMITONE, runs[4].pitch);
+    EXPECT_EQ(69 * PITCH_SEMITONE, runs[5].pitch);
+}
+
+TEST_F(Song, StopsAndRestarts) {
+    const test_song_t &song = test_songs[0];
+    song_play(song.events, song.event_count, false);
+    EXPECT_TRUE(song_is_playing());
+    EXPECT_NE(0, song_pitch());
+    song_stop();
+    EXPECT_FALSE(song_is_playing());
+    EXPECT_EQ(0, song_pitch());
+    EXPECT_FALSE(song_tick(1000));
+
+    song_play(song.events, 0, false);
+    EXPECT_FALSE(song_is_playing());
+}
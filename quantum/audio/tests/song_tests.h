@@ -0,0 +1,55 @@
+/*
+ * Songs used by the song tests
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SONG_TESTS_H
+#define SONG_TESTS_H
+
+#include <stdint.h>
+#include "song.h"
+
+// Every note that musical_notes.h has
+#define TEST_OCTAVE(o) \
+    MUSICAL_NOTE(_C##o, 1), MUSICAL_NOTE(_CS##o, 1), MUSICAL_NOTE(_D##o, 1), \
+    MUSICAL_NOTE(_DS##o, 1), MUSICAL_NOTE(_E##o, 1), MUSICAL_NOTE(_F##o, 1), \
+    MUSICAL_NOTE(_FS##o, 1), MUSICAL_NOTE(_G##o, 1), MUSICAL_NOTE(_GS##o, 1), \
+    MUSICAL_NOTE(_A##o, 1), MUSICAL_NOTE(_AS##o, 1), MUSICAL_NOTE(_B##o, 1),
+#define TEST_ALL_NOTES \
+    MUSICAL_NOTE(_B1, 1), TEST_OCTAVE(2) TEST_OCTAVE(3) TEST_OCTAVE(4) \
+    TEST_OCTAVE(5) TEST_OCTAVE(6) TEST_OCTAVE(7) TEST_OCTAVE(8)
+
+// Rests, repeated notes, odd and fractional durations
+#define TEST_ODD_SOUND \
+    Q__NOTE(_A4), Q__NOTE(_A4), S__NOTE(_REST), MUSICAL_NOTE(_C5, 3), \
+    MUSICAL_NOTE(_C5, 0.5), MUSICAL_NOTE(_REST, 0.25), W__NOTE(_E2), \
+    MUSICAL_NOTE(_B8, 20), Q__NOTE(_B8),
+
+typedef struct {
+    const char *name;
+    float (*notes)[][2];
+    uint16_t note_count;
+    const song_event_t *events;
+    uint16_t event_count;
+    uint16_t event_bytes;
+} test_song_t;
+
+extern const test_song_t test_songs[];
+extern const uint16_t test_song_count;
+
+extern float test_all_notes[][2];
+extern const song_event_t test_all_note_events[];
+extern const uint16_t test_all_note_count;
+
+#endif
@@ -0,0 +1,378 @@
+/*
+ * Tests for the fixed point synth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+extern "C" {
+#include "synth.h"
+#include "voices.h"
+#include "luts.h"
+#include "musical_notes.h"
+
+// Normally owned by audio.c
+uint16_t envelope_index = 0;
+uint8_t note_timbre = 0;
+uint16_t polyphony_rate = 0;
+bool glissando = true;
+}
+
+static const float c0 = 16.351597831287414;
+
+struct Tick {
+    uint16_t period;
+    uint16_t duty;
+};
+
+// The float implementation that the fixed point one replaced
+class Reference {
+public:
+    Reference(voice_type voice) : voice(voice) {}
+
+    Tick tick(float target) {
+        if (glissando) {
+            if (frequency != 0 && frequency < target && frequency < target * pow(2, -440/target/12/2)) {
+                frequency = frequency * pow(2, 440/frequency/12/2);
+            } else if (frequency != 0 && frequency > target && frequency > target * pow(2, 440/target/12/2)) {
+                frequency = frequency * pow(2, -440/frequency/12/2);
+            } else {
+                frequency = target;
+            }
+        } else {
+            frequency = target;
+        }
+        if (envelope_index < 65535) {
+            envelope_index++;
+        }
+        float freq = envelope(frequency);
+        if (freq < 30.517578125) {
+            freq = 30.52;
+        }
+        Tick t;
+        t.period = (uint16_t)(((float)F_CPU) / (freq * 8));
+        t.duty = (uint16_t)((((float)F_CPU) / (freq * 8)) * timbre);
+        return t;
+    }
+
+    void note_on() {
+        envelope_index = 0;
+    }
+
+private:
+    float envelope(float frequency) {
+        uint16_t compensated_index = (uint16_t)((float)envelope_index * (880.0 / frequency));
+        switch (voice) {
+            case default_voice:
+                glissando = false;
+                timbre = TIMBRE_50;
+                break;
+            case something:
+                glissando = false;
+                switch (compensated_index) {
+                    case 0 ... 9:
+                        timbre = TIMBRE_12;
+                        break;
+                    case 10 ... 19:
+                        timbre = TIMBRE_25;
+                        break;
+                    case 20 ... 200:
+                        timbre = .125 + .125;
+                        break;
+                    default:
+                        timbre = .125;
+                        break;
+                }
+                break;
+            case butts_fader:
+                glissando = true;
+                switch (compensated_index) {
+                    case 0 ... 9:
+                        frequency = frequency / 4;
+                        timbre = TIMBRE_12;
+                        break;
+                    case 10 ... 19:
+                        frequency = frequency / 2;
+                        timbre = TIMBRE_12;
+                        break;
+                    case 20 ... 200:
+                        timbre = .125 - pow(((float)compensated_index - 20) / (200 - 20), 2)*.125;
+                        break;
+                    default:
+                        timbre = 0;
+                        break;
+                }
+                break;
+            case duty_osc:
+                glissando = true;
+                timbre = (float)abs((compensated_index*10 % 3000) - 1500) * ( .25 / 1500 ) + (1 - .25) / 2;
+                break;
+            case duty_octave_down:
+                glissando = true;
+                timbre = (envelope_index % 2) * .125 + .375 * 2;
+                if ((envelope_index % 4) == 0)
+                    timbre = 0.5;
+                if ((envelope_index % 8) == 0)
+                    timbre = 0;
+                break;
+            case delayed_vibrato:
+                glissando = true;
+                timbre = TIMBRE_50;
+                switch (compensated_index) {
+                    case 0 ... 150:
+                        break;
+                    default:
+                        frequency = frequency * vibrato_lut[(int)fmod((((float)compensated_index - 151)/1000*50), VIBRATO_LUT_LENGTH)];
+                        break;
+                }
+                break;
+            default:
+                break;
+        }
+        return frequency;
+    }
+
+    voice_type voice;
+    float frequency = 0;
+    float timbre = 0;
+    uint16_t envelope_index = 0;
+    bool glissando = true;
+};
+
+// The same steps as the audio ISR
+class Synth {
+public:
+    Synth(voice_type voice) {
+        set_voice(voice);
+        glissando = true;
+        envelope_index = 0;
+    }
+
+    Tick tick(float target) {
+        pitch_t target_pitch = synth_pitch_from_freq(target);
+        if (glissando) {
+            pitch = synth_glide(pitch, target_pitch);
+        } else {
+            pitch = target_pitch;
+        }
+        if (envelope_index < 65535) {
+            envelope_index++;
+        }
+        uint16_t period = synth_period(voice_envelope(pitch));
+        Tick t;
+        t.period = period;
+        t.duty = synth_duty(period, note_timbre);
+        return t;
+    }
+
+    void note_on() {
+        envelope_index = 0;
+    }
+
+private:
+    pitch_t pitch = 0;
+};
+
+template<typename T>
+static std::vector<Tick> play(T& synth, const std::vector<std::pair<float, int>>& notes) {
+    std::vector<Tick> ticks;
+    for (auto& note : notes) {
+        synth.note_on();
+        for (int i = 0; i < note.second; i++) {
+            ticks.push_back(synth.tick(note.first));
+        }
+    }
+    return ticks;
+}
+
+// Samples the PWM output at 44.1 kHz
+static std::vector<uint8_t> render(const std::vector<Tick>& ticks) {
+    const double clock = F_CPU / 8.0;
+    const double sample_length = clock / 44100;
+    std::vector<uint8_t> pcm;
+    double start = 0;
+    double sample = 0;
+    for (auto& t : ticks) {
+        double end = start + t.period;
+        for (; sample < end; sample += sample_length) {
+            pcm.push_back(sample - start < t.duty ? 255 : 0);
+        }
+        start = end;
+    }
+    return pcm;
+}
+
+static std::vector<int> edges_per_window(const std::vector<uint8_t>& pcm, size_t window) {
+    std::vector<int> edges;
+    for (size_t i = 0; i + window <= pcm.size(); i += window) {
+        int count = 0;
+        for (size_t j = i + 1; j < i + window; j++) {
+            count += pcm[j] > pcm[j - 1];
+        }
+        edges.push_back(count);
+    }
+    return edges;
+}
+
+static bool close_enough(const Tick& a, const Tick& b) {
+    int period_error = abs((int)a.period - (int)b.period);
+    int duty_error = abs((int)a.duty - (int)b.duty);
+    return period_error <= std::max(2, b.period / 200) && duty_error <= std::max(3, b.period / 100);
+}
+
+TEST(Synth, NotePeriodsMatchTheFloatMath) {
+    for (int semitone = 12; semitone < 108; semitone++) {
+        float freq = c0 * pow(2, semitone / 12.0);
+        uint16_t expected = F_CPU / (freq * 8);
+        pitch_t pitch = synth_pitch_from_freq(freq);
+        EXPECT_NEAR(pitch, semitone * PITCH_SEMITONE, 1) << "semitone " << semitone;
+        EXPECT_NEAR(synth_period(pitch), expected, std::max(1, expected / 1000)) << "semitone " << semitone;
+    }
+}
+
+TEST(Synth, InterpolatedPeriodsMatchTheFloatMath) {
+    for (float freq = 31; freq < 8000; freq *= 1.013) {
+        uint16_t expected = F_CPU / (freq * 8);
+        uint16_t period = synth_period(synth_pitch_from_freq(freq));
+        EXPECT_NEAR(period, expected, std::max(1, expected / 1000)) << freq << " Hz";
+    }
+}
+
+TEST(Synth, HzAndFloatConversionsAgree) {
+    for (uint16_t hz = 40; hz < 6000; hz += 7) {
+        EXPECT_NEAR(synth_pitch_from_hz(hz), synth_pitch_from_freq(hz), 1) << hz << " Hz";
+    }
+}
+
+TEST(Synth, RestsAndLowNotes) {
+    EXPECT_EQ(synth_pitch_from_freq(0), 0);
+    EXPECT_EQ(synth_pitch_from_hz(0), 0);
+    uint16_t lowest = F_CPU / (30.52 * 8);
+    EXPECT_EQ(synth_period(synth_pitch_from_freq(20)), lowest);
+    EXPECT_EQ(synth_period(1), lowest);
+}
+
+TEST(Synth, InverseFrequencyMatchesTheFloatMath) {
+    for (float freq = 31; freq < 8000; freq *= 1.013) {
+        float expected = 440 / freq * 2048;
+        EXPECT_NEAR(synth_440_over_freq(synth_pitch_from_freq(freq)), expected, std::max(2.0f, expected / 500)) << freq << " Hz";
+    }
+}
+
+TEST(Synth, GlideTakesTheSameSteps) {
+    const float notes[][2] = {
+        { NOTE_C4, NOTE_C6 },
+        { NOTE_C6, NOTE_C4 },
+        { NOTE_A2, NOTE_E5 },
+        { NOTE_G7, NOTE_G6 },
+    };
+    for (auto& n : notes) {
+        float frequency = n[0];
+        pitch_t pitch = synth_pitch_from_freq(n[0]);
+        pitch_t target = synth_pitch_from_freq(n[1]);
+        int float_steps = 0;
+        while (frequency != n[1]) {
+            if (frequency < n[1] && frequency < n[1] * pow(2, -440/n[1]/12/2)) {
+                frequency = frequency * pow(2, 440/frequency/12/2);
+            } else if (frequency > n[1] && frequency > n[1] * pow(2, 440/n[1]/12/2)) {
+                frequency = frequency * pow(2, -440/frequency/12/2);
+            } else {
+                frequency = n[1];
+            }
+            pitch = synth_glide(pitch, target);
+            float_steps++;
+            if (frequency != n[1]) {
+                EXPECT_NEAR(synth_freq_from_pitch(pitch), frequency, frequency / 100) << n[0] << " to " << n[1] << " step " << float_steps;
+            }
+        }
+        int steps = float_steps;
+        while (pitch != target) {
+            pitch = synth_glide(pitch, target);
+            steps++;
+        }
+        EXPECT_NEAR(steps, float_steps, 1) << n[0] << " to " << n[1];
+    }
+}
+
+class SynthVoice : public ::testing::TestWithParam<voice_type> {};
+
+TEST_P(SynthVoice, MatchesTheFloatEnvelope) {
+    const std::vector<std::pair<float, int>> song = {
+        { NOTE_A3, 1500 },
+        { NOTE_C5, 3000 },
+        { NOTE_E6, 3000 },
+        { NOTE_G4, 2000 },
+    };
+    Reference reference(GetParam());
+    Synth synth(GetParam());
+    auto expected = play(reference, song);
+    auto actual = play(synth, song);
+    ASSERT_EQ(actual.size(), expected.size());
+
+    // A tick can land on the other side of an envelope step
+    size_t mismatches = 0;
+    for (size_t i = 0; i < actual.size(); i++) {
+        if (!close_enough(actual[i], expected[i])) {
+            mismatches++;
+        }
+    }
+    EXPECT_LE(mismatches, actual.size() / 200);
+}
+
+TEST_P(SynthVoice, RendersTheSameAudio) {
+    const std::vector<std::pair<float, int>> song = {
+        { NOTE_C4, 400 },
+        { NOTE_G5, 1600 },
+        { NOTE_D5, 1200 },
+    };
+    Reference reference(GetParam());
+    Synth synth(GetParam());
+    auto expected = edges_per_window(render(play(reference, song)), 441);
+    auto actual = edges_per_window(render(play(synth, song)), 441);
+    ASSERT_NEAR(actual.size(), expected.size(), 1);
+    for (size_t i = 0; i < std::min(actual.size(), expected.size()); i++) {
+        EXPECT_NEAR(actual[i], expected[i], 2) << "window " << i;
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(Voices, SynthVoice, ::testing::Values(
+    default_voice,
+    something,
+    butts_fader,
+    duty_osc,
+    duty_octave_down,
+    delayed_vibrato
+));
+
+TEST(Synth, DrumsStayInTheirRange) {
+    set_voice(drums);
+    const float notes[][3] = {
+        { 100, 60, 100 },
+        { 200, 1000, 2000 },
+        { 400, 3000, 5000 },
+        { 800, 3000, 5000 },
+    };
+    for (auto& n : notes) {
+        for (int i = 0; i < 50; i++) {
+            envelope_index = i;
+            float freq = synth_freq_from_pitch(voice_envelope(synth_pitch_from_freq(n[0])));
+            EXPECT_GE(freq, n[1] * 0.99) << n[0] << " Hz";
+            EXPECT_LE(freq, n[2] * 1.01) << n[0] << " Hz";
+        }
+    }
+}
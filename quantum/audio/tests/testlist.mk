@@ -0,0 +1,4 @@
+TEST_LIST +=\
+	quantum_audio_synth\
+	quantum_audio_mixer\
+	quantum_audio_song
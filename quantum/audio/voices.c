@@ -14,13 +14,13 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "voices.h"
-#include "audio.h"
+#include "musical_notes.h"
 #include "stdlib.h"
 
 // these are imported from audio.c
 extern uint16_t envelope_index;
-extern float note_timbre;
-extern float polyphony_rate;
+extern uint8_t note_timbre;
+extern uint16_t polyphony_rate;
 extern bool glissando;
 
 voice_type voice = default_voice;
@@ -37,15 +37,17 @@ void voice_deiterate() {
     voice = (voice - 1 + number_of_voices) % number_of_voices;
 }
 
-float voice_envelope(float frequency) {
+pitch_t voice_envelope(pitch_t pitch) {
     // envelope_index ranges from 0 to 0xFFFF, which is preserved at 880.0 Hz
     __attribute__ ((unused))
-    uint16_t compensated_index = (uint16_t)((float)envelope_index * (880.0 / frequency));
+    uint32_t compensated = ((uint32_t)envelope_index * synth_440_over_freq(pitch)) >> 10;
+    __attribute__ ((unused))
+    uint16_t compensated_index = compensated > 0xFFFF ? 0xFFFF : compensated;
 
     switch (voice) {
         case default_voice:
             glissando = false;
-            note_timbre = TIMBRE_50;
+            note_timbre = SYNTH_TIMBRE(TIMBRE_50);
             polyphony_rate = 0;
 	        break;
 
@@ -56,19 +58,19 @@ float voice_envelope(float frequency) {
             polyphony_rate = 0;
             switch (compensated_index) {
                 case 0 ... 9:
-                    note_timbre = TIMBRE_12;
+                    note_timbre = SYNTH_TIMBRE(TIMBRE_12);
                     break;
 
                 case 10 ... 19:
-                    note_timbre = TIMBRE_25;
+                    note_timbre = SYNTH_TIMBRE(TIMBRE_25);
                     break;
 
                 case 20 ... 200:
-                    note_timbre = .125 + .125;
+                    note_timbre = SYNTH_TIMBRE(.125 + .125);
                     break;
 
                 default:
-                    note_timbre = .125;
+                    note_timbre = SYNTH_TIMBRE(.125);
                     break;
             }
             break;
@@ -89,67 +91,68 @@ float voice_envelope(float frequency) {
                 // }
                 // frequency = (rand() % (int)(frequency * 1.2 - frequency)) + (frequency * 0.8);
 
-            if (frequency < 80.0) {
+            // Lower frequencies have longer periods
+            if (synth_period(pitch) > SYNTH_PERIOD_OF(80.0)) {
 
-            } else if (frequency < 160.0) {
+            } else if (synth_period(pitch) > SYNTH_PERIOD_OF(160.0)) {
 
                 // Bass drum: 60 - 100 Hz
-                frequency = (rand() % (int)(40)) + 60;
+                pitch = synth_pitch_from_hz((rand() % (int)(40)) + 60);
                 switch (envelope_index) {
                     case 0 ... 10:
-                        note_timbre = 0.5;
+                        note_timbre = SYNTH_TIMBRE(0.5);
                         break;
                     case 11 ... 20:
-                        note_timbre = 0.5 * (21 - envelope_index) / 10;
+                        note_timbre = SYNTH_TIMBRE(0.5) * (21 - envelope_index) / 10;
                         break;
                     default:
                         note_timbre = 0;
                         break;
                 }
 
-            } else if (frequency < 320.0) {
+            } else if (synth_period(pitch) > SYNTH_PERIOD_OF(320.0)) {
 
 
                 // Snare drum: 1 - 2 KHz
-                frequency = (rand() % (int)(1000)) + 1000;
+                pitch = synth_pitch_from_hz((rand() % (int)(1000)) + 1000);
                 switch (envelope_index) {
                     case 0 ... 5:
-                        note_timbre = 0.5;
+                        note_timbre = SYNTH_TIMBRE(0.5);
                         break;
                     case 6 ... 20:
-                        note_timbre = 0.5 * (21 - envelope_index) / 15;
+                        note_timbre = SYNTH_TIMBRE(0.5) * (21 - envelope_index) / 15;
                         break;
                     default:
                         note_timbre = 0;
                         break;
                 }
 
-            } else if (frequency < 640.0) {
+            } else if (synth_period(pitch) > SYNTH_PERIOD_OF(640.0)) {
 
                 // Closed Hi-hat: 3 - 5 KHz
-                frequency = (rand() % (int)(2000)) + 3000;
+                pitch = synth_pitch_from_hz((rand() % (int)(2000)) + 3000);
                 switch (envelope_index) {
                     case 0 ... 15:
-                        note_timbre = 0.5;
+                        note_timbre = SYNTH_TIMBRE(0.5);
                         break;
                     case 16 ... 20:
-                        note_timbre = 0.5 * (21 - envelope_index) / 5;
+                        note_timbre = SYNTH_TIMBRE(0.5) * (21 - envelope_index) / 5;
                         break;
                     default:
                         note_timbre = 0;
                         break;
                 }
 
-            } else if (frequency < 1280.0) {
+            } else if (synth_period(pitch) > SYNTH_PERIOD_OF(1280.0)) {
 
                 // Open Hi-hat: 3 - 5 KHz
-                frequency = (rand() % (int)(2000)) + 3000;
+                pitch = synth_pitch_from_hz((rand() % (int)(2000)) + 3000);
                 switch (envelope_index) {
                     case 0 ... 35:
-                        note_timbre = 0.5;
+                        note_timbre = SYNTH_TIMBRE(0.5);
                         break;
                     case 36 ... 50:
-                        note_timbre = 0.5 * (51 - envelope_index) / 15;
+                        note_timbre = SYNTH_TIMBRE(0.5) * (51 - envelope_index) / 15;
                         break;
                     default:
                         note_timbre = 0;
@@ -163,18 +166,20 @@ float voice_envelope(float frequency) {
             polyphony_rate = 0;
             switch (compensated_index) {
                 case 0 ... 9:
-                    frequency = frequency / 4;
-                    note_timbre = TIMBRE_12;
+                    pitch = pitch > 2 * PITCH_OCTAVE ? pitch - 2 * PITCH_OCTAVE : 1;
+                    note_timbre = SYNTH_TIMBRE(TIMBRE_12);
 	                break;
 
                 case 10 ... 19:
-                    frequency = frequency / 2;
-                    note_timbre = TIMBRE_12;
+                    pitch = pitch > PITCH_OCTAVE ? pitch - PITCH_OCTAVE : 1;
+                    note_timbre = SYNTH_TIMBRE(TIMBRE_12);
 	                break;
 
-                case 20 ... 200:
-                    note_timbre = .125 - pow(((float)compensated_index - 20) / (200 - 20), 2)*.125;
+                case 20 ... 200: {
+                    uint32_t t = compensated_index - 20;
+                    note_timbre = SYNTH_TIMBRE(.125) - SYNTH_TIMBRE(.125) * t * t / ((200 - 20) * (200 - 20));
 	                break;
+                }
 
                 default:
                     note_timbre = 0;
@@ -216,7 +221,7 @@ float voice_envelope(float frequency) {
                     // sine wave is slow
                     // note_timbre = (sin((float)compensated_index/10000*OCS_SPEED) * OCS_AMP / 2) + .5;
                     // triangle wave is a bit faster
-                    note_timbre = (float)abs((compensated_index*OCS_SPEED % 3000) - 1500) * ( OCS_AMP / 1500 ) + (1 - OCS_AMP) / 2;
+                    note_timbre = (uint32_t)abs((int32_t)((uint32_t)compensated_index*OCS_SPEED % 3000) - 1500) * SYNTH_TIMBRE(OCS_AMP) / 1500 + SYNTH_TIMBRE((1 - OCS_AMP) / 2);
                 	break;
             }
 	        break;
@@ -224,23 +229,23 @@ float voice_envelope(float frequency) {
         case duty_octave_down:
             glissando = true;
             polyphony_rate = 0;
-            note_timbre = (envelope_index % 2) * .125 + .375 * 2;
+            note_timbre = (envelope_index % 2) * SYNTH_TIMBRE(.125) + SYNTH_TIMBRE(.375 * 2);
             if ((envelope_index % 4) == 0)
-                note_timbre = 0.5;
+                note_timbre = SYNTH_TIMBRE(0.5);
             if ((envelope_index % 8) == 0)
                 note_timbre = 0;
             break;
         case delayed_vibrato:
             glissando = true;
             polyphony_rate = 0;
-            note_timbre = TIMBRE_50;
+            note_timbre = SYNTH_TIMBRE(TIMBRE_50);
             #define VOICE_VIBRATO_DELAY 150
             #define VOICE_VIBRATO_SPEED 50
             switch (compensated_index) {
                 case 0 ... VOICE_VIBRATO_DELAY:
                     break;
                 default:
-                    frequency = frequency * vibrato_lut[(int)fmod((((float)compensated_index - (VOICE_VIBRATO_DELAY + 1))/1000*VOICE_VIBRATO_SPEED), VIBRATO_LUT_LENGTH)];
+                    pitch += vibrato_pitch_lut[((compensated_index - (VOICE_VIBRATO_DELAY + 1)) / (1000 / VOICE_VIBRATO_SPEED)) % VIBRATO_LUT_LENGTH];
                     break;
             }
             break;
@@ -292,5 +297,5 @@ float voice_envelope(float frequency) {
    			break;
     }
 
-    return frequency;
+    return pitch;
 }
@@ -0,0 +1,165 @@
+/*
+ * Backlight fading and breathing as a 16-bit PWM duty cycle
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "progmem.h"
+#include "timer.h"
+#include "led_tables.h"
+#include "backlight_pwm.h"
+
+// Lightness per ms while fading, in 8.8 fixed point, rounded up so a fade
+// never takes longer than BACKLIGHT_FADE_TIME
+#if BACKLIGHT_FADE_TIME > 0
+  #define FADE_STEP ((0xFFFFUL + BACKLIGHT_FADE_TIME - 1) / BACKLIGHT_FADE_TIME)
+#else
+  #define FADE_STEP 0xFFFFUL
+#endif
+
+// In 8.8 fixed point
+static uint16_t lightness = 0;
+static uint16_t target = 0;
+static uint32_t last_update = 0;
+
+static bool breathing = false;
+static uint8_t breath_halt;
+static uint8_t breath_speed = 4;
+static uint8_t breath_peak = 255;
+static uint32_t breath_start;
+static uint16_t breath_phase;
+
+// The table interpolated, so that slow fades don't step
+uint16_t backlight_pwm_gamma(uint16_t light) {
+  uint8_t index = light >> 8;
+  uint8_t low = pgm_read_byte(&CIE1931_CURVE[index]);
+  uint8_t high = index == 255 ? low : pgm_read_byte(&CIE1931_CURVE[index + 1]);
+  return low * 257 + (((uint32_t)(high - low) * 257 * (light & 0xFF)) >> 8);
+}
+
+static uint16_t phase_at(uint32_t now) {
+  uint32_t elapsed = (now - breath_start) & ((256UL << breath_speed) - 1);
+  if (breath_speed <= 8) {
+    return elapsed << (8 - breath_speed);
+  }
+  return elapsed >> (breath_speed - 8);
+}
+
+static void set_phase(uint16_t phase) {
+  uint32_t now = timer_read32();
+  breath_start = now - (((uint32_t)phase << breath_speed) >> 8);
+  breath_phase = phase;
+}
+
+static uint16_t breath_lightness(uint16_t phase) {
+  uint8_t index = phase >> 8;
+  uint8_t frac = phase & 0xFF;
+  uint8_t a = pgm_read_byte(&LED_BREATHING_TABLE[index]);
+  uint8_t b = pgm_read_byte(&LED_BREATHING_TABLE[(uint8_t)(index + 1)]);
+  uint16_t light = ((uint16_t)a << 8) + (int16_t)(b - a) * frac;
+  return ((uint32_t)light * (breath_peak + 1)) >> 8;
+}
+
+void backlight_pwm_fade_to(uint8_t light) {
+  if (!backlight_pwm_animating()) {
+    last_update = timer_read32();
+  }
+  target = (uint16_t)light << 8 | light;
+}
+
+void backlight_pwm_jump(uint8_t light) {
+  breathing = false;
+  target = (uint16_t)light << 8 | light;
+  lightness = target;
+  last_update = timer_read32();
+}
+
+void backlight_pwm_breathe(uint16_t phase, uint8_t halt) {
+  set_phase(phase);
+  breath_halt = halt;
+  breathing = true;
+}
+
+void backlight_pwm_breathe_halt(uint8_t halt) {
+  breath_halt = halt;
+}
+
+void backlight_pwm_breathe_stop(void) {
+  if (breathing) {
+    breathing = false;
+    lightness = breath_lightness(phase_at(timer_read32()));
+    last_update = timer_read32();
+  }
+}
+
+void backlight_pwm_breathe_peak(uint8_t light) {
+  breath_peak = light;
+}
+
+void backlight_pwm_breathe_speed(uint8_t speed) {
+  if (speed > 10) {
+    speed = 10;
+  }
+  uint16_t phase = breathing ? phase_at(timer_read32()) : 0;
+  breath_speed = speed;
+  if (breathing) {
+    set_phase(phase);
+  }
+}
+
+bool backlight_pwm_breathing(void) {
+  return breathing;
+}
+
+bool backlight_pwm_animating(void) {
+  return breathing || lightness != target;
+}
+
+static void fade(uint32_t now) {
+  uint32_t elapsed = now - last_update;
+  last_update = now;
+  if (elapsed > BACKLIGHT_FADE_TIME) {
+    lightness = target;
+    return;
+  }
+  uint32_t step = elapsed * FADE_STEP;
+  if (lightness < target) {
+    lightness = target - lightness > step ? lightness + step : target;
+  } else if (lightness > target) {
+    lightness = lightness - target > step ? lightness - step : target;
+  }
+}
+
+uint16_t backlight_pwm_duty(void) {
+  uint32_t now = timer_read32();
+  if (!breathing) {
+    fade(now);
+    return backlight_pwm_gamma(lightness);
+  }
+
+  uint16_t phase = phase_at(now);
+  if (breath_halt != BACKLIGHT_HALT_NONE) {
+    uint16_t stop = breath_halt == BACKLIGHT_HALT_PEAK ? BACKLIGHT_PHASE_PEAK : 0;
+    // Whether the breath went past the stop since the last time
+    uint16_t distance = stop - breath_phase;
+    if (distance != 0 && distance <= (uint16_t)(phase - breath_phase)) {
+      breathing = false;
+      lightness = breath_lightness(stop);
+      last_update = now;
+      return backlight_pwm_gamma(lightness);
+    }
+  }
+  breath_phase = phase;
+  return backlight_pwm_gamma(breath_lightness(phase));
+}
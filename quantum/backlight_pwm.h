@@ -0,0 +1,67 @@
+/*
+ * Backlight fading and breathing as a 16-bit PWM duty cycle
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BACKLIGHT_PWM_H
+#define BACKLIGHT_PWM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* The backlight as a 16-bit PWM duty cycle
+ *
+ * The brightness is kept as lightness, the way the eye sees it, and turned
+ * into a duty cycle through the CIE 1931 curve. Changes fade from one
+ * lightness to the other, and breathing follows LED_BREATHING_TABLE.
+ * Everything is worked out from the time when backlight_pwm_duty() is
+ * called, so the compare register only needs updating from the main loop
+ * and there's no interrupt to run.
+ */
+
+// How long a fade from off to full takes, in ms
+#ifndef BACKLIGHT_FADE_TIME
+  #define BACKLIGHT_FADE_TIME 200
+#endif
+
+// Where a breath can stop by itself
+enum backlight_breath_halt {
+  BACKLIGHT_HALT_NONE,
+  BACKLIGHT_HALT_PEAK,
+  BACKLIGHT_HALT_DARK,
+};
+
+// Breaths start dark at phase 0 and peak at 0x8000
+#define BACKLIGHT_PHASE_PEAK 0x8000
+
+void backlight_pwm_fade_to(uint8_t lightness);
+// Stops any breath and goes straight to the lightness, for when the main
+// loop won't be around to fade
+void backlight_pwm_jump(uint8_t lightness);
+void backlight_pwm_breathe(uint16_t phase, uint8_t halt);
+void backlight_pwm_breathe_halt(uint8_t halt);
+// Fades from wherever the breath was back to the lightness set
+void backlight_pwm_breathe_stop(void);
+void backlight_pwm_breathe_peak(uint8_t lightness);
+// A breath takes 256 << speed ms
+void backlight_pwm_breathe_speed(uint8_t speed);
+bool backlight_pwm_breathing(void);
+
+// Whether the duty cycle is still changing
+bool backlight_pwm_animating(void);
+uint16_t backlight_pwm_duty(void);
+uint16_t backlight_pwm_gamma(uint16_t lightness);
+
+#endif
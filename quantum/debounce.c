@@ -0,0 +1,68 @@
+/*
+ * Per key vertical counter debouncing
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "debounce.h"
+
+// For each key the number of scans until it's eligible to change again
+static matrix_row_t debounce_counters[MATRIX_ROWS][DEBOUNCE_PLANES];
+
+void debounce_init(void) {
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        for (uint8_t j = 0; j < DEBOUNCE_PLANES; j++) {
+            debounce_counters[i][j] = 0;
+        }
+    }
+}
+
+matrix_row_t debounce_row(uint8_t row, matrix_row_t debounced, matrix_row_t raw) {
+    matrix_row_t *counter = debounce_counters[row];
+
+    matrix_row_t active = 0;
+    for (uint8_t j = 0; j < DEBOUNCE_PLANES; j++) {
+        active |= counter[j];
+    }
+
+    // Decrement all the non-zero counters at once, a plane flips wherever the
+    // borrow from the planes below reaches it
+    matrix_row_t borrow = active;
+    for (uint8_t j = 0; j < DEBOUNCE_PLANES; j++) {
+        matrix_row_t plane = counter[j];
+        counter[j] = plane ^ borrow;
+        borrow &= ~plane;
+    }
+
+    // Only the keys without a running counter can change, and those that do
+    // get their counter loaded with DEBOUNCE
+    matrix_row_t change = (raw ^ debounced) & ~active;
+    for (uint8_t j = 0; j < DEBOUNCE_PLANES; j++) {
+        if (DEBOUNCE & (1 << j)) {
+            counter[j] |= change;
+        } else {
+            counter[j] &= ~change;
+        }
+    }
+    return debounced ^ change;
+}
+
+bool debounce_row_active(uint8_t row) {
+    for (uint8_t j = 0; j < DEBOUNCE_PLANES; j++) {
+        if (debounce_counters[row][j]) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,61 @@
+/*
+ * Per key vertical counter debouncing
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+
+/*
+ * Per key debouncing, enabled with DEBOUNCE_TYPE = vertical in rules.mk.
+ *
+ * A key that changes state is reported straight away, and then ignored for
+ * the next DEBOUNCE scans. Note that DEBOUNCE counts scans, not ms.
+ *
+ * The counters are stored as vertical counters, plane n holds bit n of the
+ * counter of every key in the row. That way a whole row is debounced with a
+ * few bitwise operations, whatever the number of cols.
+ */
+
+#ifndef DEBOUNCE
+#   define DEBOUNCE 5
+#endif
+
+#if (DEBOUNCE < 2)
+#   define DEBOUNCE_PLANES 1
+#elif (DEBOUNCE < 4)
+#   define DEBOUNCE_PLANES 2
+#elif (DEBOUNCE < 8)
+#   define DEBOUNCE_PLANES 3
+#elif (DEBOUNCE < 16)
+#   define DEBOUNCE_PLANES 4
+#elif (DEBOUNCE < 32)
+#   define DEBOUNCE_PLANES 5
+#else
+#   error "DEBOUNCE must be lower than 32"
+#endif
+
+void debounce_init(void);
+// Takes the current debounced state and the raw reading of a row, and
+// returns the new debounced state. Has to be called once per scan for every row.
+matrix_row_t debounce_row(uint8_t row, matrix_row_t debounced, matrix_row_t raw);
+// True while a key in the row is still locked by its counter
+bool debounce_row_active(uint8_t row);
+
+#endif
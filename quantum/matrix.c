@@ -18,6 +18,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdbool.h>
 #if defined(__AVR__)
 #include <avr/io.h>
+#include <avr/interrupt.h>
 #endif
 #include "wait.h"
 #include "print.h"
@@ -25,6 +26,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util.h"
 #include "matrix.h"
 #include "timer.h"
+#ifdef MATRIX_IDLE_WAKE_ENABLE
+#include "matrix_idle.h"
+#endif
+#ifdef DEBOUNCE_VERTICAL
+#include "debounce.h"
+#endif
 
 
 /* Set 0 if debouncing isn't needed */
@@ -33,11 +40,22 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #   define DEBOUNCING_DELAY 5
 #endif
 
+/* The per key debouncing replaces the debouncing timer */
+#ifdef DEBOUNCE_VERTICAL
+#   undef DEBOUNCING_DELAY
+#   define DEBOUNCING_DELAY 0
+#endif
+
 #if (DEBOUNCING_DELAY > 0)
     static uint16_t debouncing_time;
     static bool debouncing = false;
 #endif
 
+/* Time for the lines to settle after a row (or col) has been selected, in us */
+#ifndef MATRIX_IO_DELAY
+#   define MATRIX_IO_DELAY 30
+#endif
+
 #if (MATRIX_COLS <= 8)
 #    define print_matrix_header()  print("\nr/c 01234567\n")
 #    define print_matrix_row(row)  print_bin_reverse8(matrix_get_row(row))
@@ -70,19 +88,77 @@ static matrix_row_t matrix[MATRIX_ROWS];
 static matrix_row_t matrix_debouncing[MATRIX_ROWS];
 
 
+#ifdef MATRIX_IDLE_SCAN
+/* Set while no key is down, see matrix_scan() */
+static bool matrix_idle = true;
+#endif
+
+#ifdef MATRIX_IDLE_WAKE_ENABLE
+/* The pin change interrupt only covers port B, this holds the PCMSK0 bits of
+ * the pins that are read during a scan, or 0 if any of them is elsewhere */
+static uint8_t wake_pcint_mask;
+#endif
+
+/* The pins read during a scan, the cols or the rows, and their state as one
+ * bit per pin */
+#if (DIODE_DIRECTION == COL2ROW)
+#   define READ_PIN_COUNT MATRIX_COLS
+#   define read_pins col_pins
+    typedef matrix_row_t read_bits_t;
+#elif (DIODE_DIRECTION == ROW2COL)
+#   define READ_PIN_COUNT MATRIX_ROWS
+#   define read_pins row_pins
+#   if (MATRIX_ROWS <= 8)
+        typedef uint8_t read_bits_t;
+#   elif (MATRIX_ROWS <= 16)
+        typedef uint16_t read_bits_t;
+#   elif (MATRIX_ROWS <= 32)
+        typedef uint32_t read_bits_t;
+#   else
+#       error "MATRIX_ROWS: invalid value"
+#   endif
+#endif
+
+#if (DIODE_DIRECTION == ROW2COL) || (DIODE_DIRECTION == COL2ROW)
+/* The read pins grouped by port, so that they are read with a single access
+ * to each port. A run is a set of pins on the same port whose bits land in
+ * the result in the same order, they are gathered with one mask and one
+ * shift. */
+typedef struct {
+    uint8_t port;
+    uint8_t mask;
+    int8_t  shift;
+} pin_run_t;
+
+static uint8_t read_port_count;
+static uint8_t read_ports[READ_PIN_COUNT];
+static uint8_t read_run_count;
+static pin_run_t read_runs[READ_PIN_COUNT];
+
+    static void init_read_pins(void);
+    static read_bits_t read_pin_bits(void);
+#endif
+
 #if (DIODE_DIRECTION == COL2ROW)
-    static void init_cols(void);
     static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row);
     static void unselect_rows(void);
     static void select_row(uint8_t row);
     static void unselect_row(uint8_t row);
 #elif (DIODE_DIRECTION == ROW2COL)
-    static void init_rows(void);
     static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col);
     static void unselect_cols(void);
     static void unselect_col(uint8_t col);
     static void select_col(uint8_t col);
 #endif
+#ifdef MATRIX_IDLE_SCAN
+    static bool any_key_down(void);
+#endif
+#if defined(MATRIX_IDLE_SCAN) || defined(MATRIX_IDLE_WAKE_ENABLE)
+    static bool keys_down(void);
+#endif
+#ifdef MATRIX_IDLE_WAKE_ENABLE
+    static void init_wake(void);
+#endif
 
 __attribute__ ((weak))
 void matrix_init_quantum(void) {
@@ -157,10 +233,10 @@ void matrix_init(void) {
     // initialize row and col
 #if (DIODE_DIRECTION == COL2ROW)
     unselect_rows();
-    init_cols();
+    init_read_pins();
 #elif (DIODE_DIRECTION == ROW2COL)
     unselect_cols();
-    init_rows();
+    init_read_pins();
 #endif
 
     // initialize matrix state: all keys off
@@ -168,12 +244,37 @@ void matrix_init(void) {
         matrix[i] = 0;
         matrix_debouncing[i] = 0;
     }
+#ifdef DEBOUNCE_VERTICAL
+    debounce_init();
+#endif
+
+#ifdef MATRIX_IDLE_WAKE_ENABLE
+    init_wake();
+    matrix_idle_init(wake_pcint_mask != 0);
+#endif
 
     matrix_init_quantum();
 }
 
 uint8_t matrix_scan(void)
 {
+#ifdef MATRIX_IDLE_WAKE_ENABLE
+    // Asleep until a col interrupt comes in, nothing can have changed
+    if (!matrix_idle_should_scan()) {
+        matrix_scan_quantum();
+        return 1;
+    }
+#endif
+
+#ifdef MATRIX_IDLE_SCAN
+    // While nothing is pressed select every row (or col) at once, and only
+    // do the full scan when something shows up on the other side.
+    if (matrix_idle && !any_key_down()) {
+        matrix_scan_quantum();
+        return 1;
+    }
+    matrix_idle = false;
+#endif
 
 #if (DIODE_DIRECTION == COL2ROW)
 
@@ -187,6 +288,8 @@ uint8_t matrix_scan(void)
                 debouncing_time = timer_read();
             }
 
+#       elif defined(DEBOUNCE_VERTICAL)
+            read_cols_on_row(matrix_debouncing, current_row);
 #       else
             read_cols_on_row(matrix, current_row);
 #       endif
@@ -203,8 +306,10 @@ uint8_t matrix_scan(void)
                 debouncing = true;
                 debouncing_time = timer_read();
             }
+#       elif defined(DEBOUNCE_VERTICAL)
+            read_rows_on_col(matrix_debouncing, current_col);
 #       else
-             read_rows_on_col(matrix, current_col);
+            read_rows_on_col(matrix, current_col);
 #       endif
 
     }
@@ -220,6 +325,20 @@ uint8_t matrix_scan(void)
         }
 #   endif
 
+#ifdef DEBOUNCE_VERTICAL
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        matrix[i] = debounce_row(i, matrix[i], matrix_debouncing[i]);
+    }
+#endif
+
+#ifdef MATRIX_IDLE_SCAN
+    matrix_idle = !keys_down();
+#endif
+
+#ifdef MATRIX_IDLE_WAKE_ENABLE
+    matrix_idle_scanned(keys_down());
+#endif
+
     matrix_scan_quantum();
     return 1;
 }
@@ -272,39 +391,78 @@ uint8_t matrix_key_count(void)
 
 
 
-#if (DIODE_DIRECTION == COL2ROW)
+#if (DIODE_DIRECTION == ROW2COL) || (DIODE_DIRECTION == COL2ROW)
 
-static void init_cols(void)
+static void init_read_pins(void)
 {
-    for(uint8_t x = 0; x < MATRIX_COLS; x++) {
-        uint8_t pin = col_pins[x];
+    read_port_count = 0;
+    read_run_count = 0;
+
+    for(uint8_t x = 0; x < READ_PIN_COUNT; x++) {
+        uint8_t pin = read_pins[x];
         _SFR_IO8((pin >> 4) + 1) &= ~_BV(pin & 0xF); // IN
         _SFR_IO8((pin >> 4) + 2) |=  _BV(pin & 0xF); // HI
+
+        uint8_t port = 0;
+        while (port < read_port_count && read_ports[port] != (pin >> 4)) {
+            port++;
+        }
+        if (port == read_port_count) {
+            read_ports[read_port_count++] = pin >> 4;
+        }
+
+        // Extend the previous run if this pin follows on from it
+        int8_t shift = (int8_t)x - (int8_t)(pin & 0xF);
+        if (read_run_count > 0) {
+            pin_run_t *run = &read_runs[read_run_count - 1];
+            if (run->port == port && run->shift == shift) {
+                run->mask |= _BV(pin & 0xF);
+                continue;
+            }
+        }
+        read_runs[read_run_count].port = port;
+        read_runs[read_run_count].mask = _BV(pin & 0xF);
+        read_runs[read_run_count].shift = shift;
+        read_run_count++;
+    }
+}
+
+static read_bits_t read_pin_bits(void)
+{
+    // Sample every port first (active low)
+    uint8_t port_state[READ_PIN_COUNT];
+    for (uint8_t i = 0; i < read_port_count; i++) {
+        port_state[i] = ~_SFR_IO8(read_ports[i]);
+    }
+
+    read_bits_t bits = 0;
+    for (uint8_t i = 0; i < read_run_count; i++) {
+        const pin_run_t *run = &read_runs[i];
+        read_bits_t run_bits = port_state[run->port] & run->mask;
+        if (run->shift >= 0) {
+            bits |= run_bits << run->shift;
+        } else {
+            bits |= run_bits >> -run->shift;
+        }
     }
+    return bits;
 }
 
+#endif
+
+#if (DIODE_DIRECTION == COL2ROW)
+
 static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
 {
     // Store last value of row prior to reading
     matrix_row_t last_row_value = current_matrix[current_row];
 
-    // Clear data in matrix row
-    current_matrix[current_row] = 0;
-
     // Select row and wait for row selecton to stabilize
     select_row(current_row);
-    wait_us(30);
-
-    // For each col...
-    for(uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
+    wait_us(MATRIX_IO_DELAY);
 
-        // Select the col pin to read (active low)
-        uint8_t pin = col_pins[col_index];
-        uint8_t pin_state = (_SFR_IO8(pin >> 4) & _BV(pin & 0xF));
-
-        // Populate the matrix row with the state of the col pin
-        current_matrix[current_row] |=  pin_state ? 0 : (ROW_SHIFTER << col_index);
-    }
+    // Populate the matrix row with the state of the col pins
+    current_matrix[current_row] = read_pin_bits();
 
     // Unselect row
     unselect_row(current_row);
@@ -335,16 +493,22 @@ static void unselect_rows(void)
     }
 }
 
-#elif (DIODE_DIRECTION == ROW2COL)
-
-static void init_rows(void)
+#ifdef MATRIX_IDLE_SCAN
+static bool any_key_down(void)
 {
     for(uint8_t x = 0; x < MATRIX_ROWS; x++) {
-        uint8_t pin = row_pins[x];
-        _SFR_IO8((pin >> 4) + 1) &= ~_BV(pin & 0xF); // IN
-        _SFR_IO8((pin >> 4) + 2) |=  _BV(pin & 0xF); // HI
+        select_row(x);
     }
+    wait_us(MATRIX_IO_DELAY);
+
+    bool key_down = read_pin_bits() != 0;
+
+    unselect_rows();
+    return key_down;
 }
+#endif
+
+#elif (DIODE_DIRECTION == ROW2COL)
 
 static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col)
 {
@@ -352,7 +516,10 @@ static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col)
 
     // Select col and wait for col selecton to stabilize
     select_col(current_col);
-    wait_us(30);
+    wait_us(MATRIX_IO_DELAY);
+
+    // Every row pin at once, a bit for each row that is LO
+    read_bits_t rows = read_pin_bits();
 
     // For each row...
     for(uint8_t row_index = 0; row_index < MATRIX_ROWS; row_index++)
@@ -362,7 +529,7 @@ static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col)
         matrix_row_t last_row_value = current_matrix[row_index];
 
         // Check row pin state
-        if ((_SFR_IO8(row_pins[row_index] >> 4) & _BV(row_pins[row_index] & 0xF)) == 0)
+        if (rows & 1)
         {
             // Pin LO, set col bit
             current_matrix[row_index] |= (ROW_SHIFTER << current_col);
@@ -373,6 +540,8 @@ static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col)
             current_matrix[row_index] &= ~(ROW_SHIFTER << current_col);
         }
 
+        rows >>= 1;
+
         // Determine if the matrix changed state
         if ((last_row_value != current_matrix[row_index]) && !(matrix_changed))
         {
@@ -409,4 +578,104 @@ static void unselect_cols(void)
     }
 }
 
+#ifdef MATRIX_IDLE_SCAN
+static bool any_key_down(void)
+{
+    for(uint8_t x = 0; x < MATRIX_COLS; x++) {
+        select_col(x);
+    }
+    wait_us(MATRIX_IO_DELAY);
+
+    bool key_down = read_pin_bits() != 0;
+
+    unselect_cols();
+    return key_down;
+}
+#endif
+
+#endif
+
+#if defined(MATRIX_IDLE_SCAN) || defined(MATRIX_IDLE_WAKE_ENABLE)
+/* Also true while a debounce counter is still running, they only count down
+ * while the matrix is being scanned */
+static bool keys_down(void)
+{
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        if (matrix[i] || matrix_debouncing[i]) {
+            return true;
+        }
+#ifdef DEBOUNCE_VERTICAL
+        if (debounce_row_active(i)) {
+            return true;
+        }
+#endif
+    }
+    return false;
+}
+#endif
+
+#ifdef MATRIX_IDLE_WAKE_ENABLE
+
+static void init_wake(void)
+{
+    wake_pcint_mask = 0;
+#if defined(PCMSK0)
+    for (uint8_t x = 0; x < READ_PIN_COUNT; x++) {
+        if ((read_pins[x] >> 4) != (B0 >> 4)) {
+            wake_pcint_mask = 0;
+            return;
+        }
+        wake_pcint_mask |= _BV(read_pins[x] & 0xF);
+    }
+#endif
+}
+
+#if defined(PCMSK0)
+
+bool matrix_idle_arm(void)
+{
+#if (DIODE_DIRECTION == COL2ROW)
+    for (uint8_t x = 0; x < MATRIX_ROWS; x++) {
+        select_row(x);
+    }
+#else
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        select_col(x);
+    }
+#endif
+    wait_us(MATRIX_IO_DELAY);
+
+    PCMSK0 = wake_pcint_mask;
+    PCIFR = _BV(PCIF0);
+    PCICR |= _BV(PCIE0);
+
+    // A key that went down before the interrupt was enabled doesn't generate
+    // an edge, so check the pins once by hand
+    if ((PINB & wake_pcint_mask) != wake_pcint_mask) {
+        matrix_idle_disarm();
+        return false;
+    }
+    return true;
+}
+
+void matrix_idle_disarm(void)
+{
+    PCICR &= ~_BV(PCIE0);
+    PCMSK0 = 0;
+#if (DIODE_DIRECTION == COL2ROW)
+    unselect_rows();
+#else
+    unselect_cols();
+#endif
+}
+
+ISR(PCINT0_vect)
+{
+    // Only the first edge matters, the rest is picked up by the scan
+    PCICR &= ~_BV(PCIE0);
+    matrix_idle_wake();
+}
+
+#endif
+
 #endif
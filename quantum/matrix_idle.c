@@ -0,0 +1,79 @@
+/*
+ * Stops the matrix scans while no key is down, until a pin change wakes them
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "matrix_idle.h"
+#include "timer.h"
+
+static bool sleep_allowed;
+static bool asleep;
+static volatile bool wake_pending;
+static uint16_t last_activity;
+
+__attribute__ ((weak))
+bool matrix_idle_arm(void) {
+    return false;
+}
+
+__attribute__ ((weak))
+void matrix_idle_disarm(void) {
+}
+
+void matrix_idle_init(bool can_sleep) {
+    sleep_allowed = can_sleep;
+    asleep = false;
+    wake_pending = false;
+    last_activity = timer_read();
+}
+
+bool matrix_idle_should_scan(void) {
+    if (!asleep) {
+        return true;
+    }
+    if (!wake_pending) {
+        return false;
+    }
+    matrix_idle_disarm();
+    asleep = false;
+    last_activity = timer_read();
+    return true;
+}
+
+void matrix_idle_scanned(bool keys_down) {
+    if (keys_down) {
+        last_activity = timer_read();
+        return;
+    }
+    if (!sleep_allowed || timer_elapsed(last_activity) < MATRIX_IDLE_TIMEOUT) {
+        return;
+    }
+    // Cleared before arming, so that an interrupt from here on isn't lost
+    wake_pending = false;
+    if (matrix_idle_arm()) {
+        asleep = true;
+    } else {
+        // A key went down after the last scan, try again later
+        last_activity = timer_read();
+    }
+}
+
+void matrix_idle_wake(void) {
+    wake_pending = true;
+}
+
+bool matrix_idle_is_asleep(void) {
+    return asleep;
+}
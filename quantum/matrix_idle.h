@@ -0,0 +1,56 @@
+/*
+ * Stops the matrix scans while no key is down, until a pin change wakes them
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MATRIX_IDLE_H
+#define MATRIX_IDLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Lets the matrix stop scanning after it has been idle for a while.
+ *
+ * Once no key has been down for MATRIX_IDLE_TIMEOUT ms, the matrix driver is
+ * asked to select every row at once and to arm a pin change interrupt on the
+ * cols. From then on no scans are done until the interrupt calls
+ * matrix_idle_wake(), and the time goes to the lighting, audio and the
+ * visualizer instead. The first scan after waking up is done straight away.
+ */
+
+#ifndef MATRIX_IDLE_TIMEOUT
+#   define MATRIX_IDLE_TIMEOUT 500
+#endif
+
+// Call with can_sleep = false when the matrix can't wake itself up again,
+// for example when some of the col pins can't raise an interrupt
+void matrix_idle_init(bool can_sleep);
+// Call before scanning, returns false when the scan can be skipped
+bool matrix_idle_should_scan(void);
+// Call after a full scan
+void matrix_idle_scanned(bool keys_down);
+// Safe to call from an interrupt handler
+void matrix_idle_wake(void);
+bool matrix_idle_is_asleep(void);
+
+// Implemented by the matrix driver. matrix_idle_arm selects all rows and
+// enables the interrupt, it should return false if a key is already down, in
+// which case the interrupt has to be left disabled.
+bool matrix_idle_arm(void);
+// Disables the interrupt and unselects the rows again
+void matrix_idle_disarm(void);
+
+#endif
@@ -41,6 +41,7 @@ static uint16_t music_sequence_timer = 0;
 static uint16_t music_sequence_interval = 100;
 
 #ifdef AUDIO_ENABLE
+  #include "song_stream.h"
   #ifndef MUSIC_ON_SONG
     #define MUSIC_ON_SONG SONG(MUSIC_ON_SOUND)
   #endif
@@ -59,14 +60,14 @@ static uint16_t music_sequence_interval = 100;
   #ifndef MAJOR_SONG
     #define MAJOR_SONG SONG(MAJOR_SOUND)
   #endif
-  float music_mode_songs[NUMBER_OF_MODES][5][2] = {
+  const song_event_t music_mode_songs[NUMBER_OF_MODES][5] PROGMEM = {
     CHROMATIC_SONG,
     GUITAR_SONG,
     VIOLIN_SONG,
     MAJOR_SONG
   };
-  float music_on_song[][2] = MUSIC_ON_SONG;
-  float music_off_song[][2] = MUSIC_OFF_SONG;
+  const song_event_t music_on_song[] PROGMEM = MUSIC_ON_SONG;
+  const song_event_t music_off_song[] PROGMEM = MUSIC_OFF_SONG;
 #endif
 
 #ifndef MUSIC_MASK
@@ -211,7 +212,7 @@ void music_toggle(void) {
 void music_on(void) {
     music_activated = 1;
     #ifdef AUDIO_ENABLE
-      PLAY_SONG(music_on_song);
+      PLAY_STREAM(music_on_song);
     #endif
     music_on_user();
 }
@@ -220,7 +221,7 @@ void music_off(void) {
     music_all_notes_off();
     music_activated = 0;
     #ifdef AUDIO_ENABLE
-      PLAY_SONG(music_off_song);
+      PLAY_STREAM(music_off_song);
     #endif
 }
 
@@ -228,7 +229,7 @@ void music_mode_cycle(void) {
   music_all_notes_off();
   music_mode = (music_mode + 1) % NUMBER_OF_MODES;
   #ifdef AUDIO_ENABLE
-    PLAY_SONG(music_mode_songs[music_mode]);
+    PLAY_STREAM(music_mode_songs[music_mode]);
   #endif
 }
 
@@ -29,11 +29,12 @@ __attribute__ ((weak))
 const char terminal_prompt[8] = "> ";
 
 #ifdef AUDIO_ENABLE
+    #include "song_stream.h"
     #ifndef TERMINAL_SONG
         #define TERMINAL_SONG SONG(TERMINAL_SOUND)
     #endif
-    float terminal_song[][2] = TERMINAL_SONG;
-    #define TERMINAL_BELL() PLAY_SONG(terminal_song)
+    const song_event_t terminal_song[] PROGMEM = TERMINAL_SONG;
+    #define TERMINAL_BELL() PLAY_STREAM(terminal_song)
 #else 
     #define TERMINAL_BELL()  
 #endif
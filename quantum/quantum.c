@@ -31,6 +31,7 @@ extern backlight_config_t backlight_config;
 #endif
 
 #ifdef AUDIO_ENABLE
+  #include "song_stream.h"
   #ifndef GOODBYE_SONG
     #define GOODBYE_SONG SONG(GOODBYE_SOUND)
   #endif
@@ -40,11 +41,11 @@ extern backlight_config_t backlight_config;
   #ifndef AG_SWAP_SONG
     #define AG_SWAP_SONG SONG(AG_SWAP_SOUND)
   #endif
-  float goodbye_song[][2] = GOODBYE_SONG;
-  float ag_norm_song[][2] = AG_NORM_SONG;
-  float ag_swap_song[][2] = AG_SWAP_SONG;
+  const song_event_t goodbye_song[] PROGMEM = GOODBYE_SONG;
+  const song_event_t ag_norm_song[] PROGMEM = AG_NORM_SONG;
+  const song_event_t ag_swap_song[] PROGMEM = AG_SWAP_SONG;
   #ifdef DEFAULT_LAYER_SONGS
-    float default_layer_songs[][16][2] = DEFAULT_LAYER_SONGS;
+    const song_event_t default_layer_songs[][16] PROGMEM = DEFAULT_LAYER_SONGS;
   #endif
 #endif
 
@@ -135,7 +136,7 @@ void reset_keyboard(void) {
 #if defined(AUDIO_ENABLE) || (defined(MIDI_ENABLE) && defined(MIDI_ENABLE_BASIC))
   music_all_notes_off();
   uint16_t timer_start = timer_read();
-  PLAY_SONG(goodbye_song);
+  PLAY_STREAM(goodbye_song);
   shutdown_user();
   while(timer_elapsed(timer_start) < 250) 
     wait_ms(1);
@@ -143,6 +144,7 @@ void reset_keyboard(void) {
 #else
   wait_ms(250);
 #endif
+  eeconfig_flush();
 #ifdef CATERINA_BOOTLOADER
   *(uint16_t *)0x0800 = 0x7777; // these two are a-star-specific
 #endif
@@ -196,6 +198,11 @@ bool process_record_quantum(keyrecord_t *record) {
     //   return false;
     // }
 
+  #ifdef RGBLIGHT_LAYERS
+    // Every key lights up, whichever feature ends up handling it
+    rgblight_layers_key_event(key, record->event.pressed);
+  #endif
+
   if (!(
   #if defined(KEY_LOCK_ENABLE)
     // Must run first to be able to mask key_up events.
@@ -442,7 +449,7 @@ bool process_record_quantum(keyrecord_t *record) {
             keymap_config.swap_lalt_lgui = true;
             keymap_config.swap_ralt_rgui = true;
             #ifdef AUDIO_ENABLE
-              PLAY_SONG(ag_swap_song);
+              PLAY_STREAM(ag_swap_song);
             #endif
             break;
           case MAGIC_UNSWAP_CONTROL_CAPSLOCK:
@@ -473,7 +480,7 @@ bool process_record_quantum(keyrecord_t *record) {
             keymap_config.swap_lalt_lgui = false;
             keymap_config.swap_ralt_rgui = false;
             #ifdef AUDIO_ENABLE
-              PLAY_SONG(ag_norm_song);
+              PLAY_STREAM(ag_norm_song);
             #endif
             break;
           case MAGIC_TOGGLE_NKRO:
@@ -678,7 +685,7 @@ void send_char(char ascii_code) {
 
 void set_single_persistent_default_layer(uint8_t default_layer) {
   #if defined(AUDIO_ENABLE) && defined(DEFAULT_LAYER_SONGS)
-    PLAY_SONG(default_layer_songs[default_layer]);
+    PLAY_STREAM(default_layer_songs[default_layer]);
   #endif
   eeconfig_update_default_layer(1U<<default_layer);
   default_layer_set(1U<<default_layer);
@@ -820,45 +827,41 @@ void backlight_init_ports(void)
   #endif
 }
 
+#ifndef NO_BACKLIGHT_CLOCK
+// The lightness the levels fade to, evenly spaced as the eye sees them
+static uint8_t level_lightness(uint8_t level)
+{
+  if (level >= BACKLIGHT_LEVELS) {
+    return 255;
+  }
+  return (uint16_t)level * 255 / BACKLIGHT_LEVELS;
+}
+
+static void set_duty(uint16_t duty)
+{
+  if (duty == 0) {
+    // Turn off PWM control on backlight pin, revert to output low.
+    TCCR1A &= ~(_BV(COM1x1));
+    OCR1x = 0x0;
+  } else {
+    // Turn on PWM control of backlight pin
+    TCCR1A |= _BV(COM1x1);
+    OCR1x = duty;
+  }
+}
+#endif
+
 __attribute__ ((weak))
 void backlight_set(uint8_t level)
 {
-  // Prevent backlight blink on lowest level
-  // #if BACKLIGHT_ON_STATE == 0
-  //   // PORTx &= ~n
-  //   _SFR_IO8((backlight_pin >> 4) + 2) &= ~_BV(backlight_pin & 0xF);
-  // #else
-  //   // PORTx |= n
-  //   _SFR_IO8((backlight_pin >> 4) + 2) |= _BV(backlight_pin & 0xF);
-  // #endif
-
-  if ( level == 0 ) {
-    #ifndef NO_BACKLIGHT_CLOCK
-      // Turn off PWM control on backlight pin, revert to output low.
-      TCCR1A &= ~(_BV(COM1x1));
-      OCR1x = 0x0;
-    #else
-      // #if BACKLIGHT_ON_STATE == 0
-      //   // PORTx |= n
-      //   _SFR_IO8((backlight_pin >> 4) + 2) |= _BV(backlight_pin & 0xF);
-      // #else
-      //   // PORTx &= ~n
-      //   _SFR_IO8((backlight_pin >> 4) + 2) &= ~_BV(backlight_pin & 0xF);
-      // #endif
-    #endif
-  }
   #ifndef NO_BACKLIGHT_CLOCK
-    else if ( level == BACKLIGHT_LEVELS ) {
-      // Turn on PWM control of backlight pin
-      TCCR1A |= _BV(COM1x1);
-      // Set the brightness
-      OCR1x = 0xFFFF;
-    }
-    else {
-      // Turn on PWM control of backlight pin
-      TCCR1A |= _BV(COM1x1);
-      // Set the brightness
-      OCR1x = 0xFFFF >> ((BACKLIGHT_LEVELS - level) * ((BACKLIGHT_LEVELS + 1) / 2));
+    if (level == 0) {
+      // Off right away, the main loop doesn't run while suspended
+      backlight_pwm_jump(0);
+      set_duty(0);
+    } else {
+      // The compare register follows in backlight_task()
+      backlight_pwm_fade_to(level_lightness(level));
     }
   #endif
 
@@ -889,60 +892,34 @@ void backlight_task(void) {
     #endif
   }
   backlight_tick = (backlight_tick + 1) % 16;
+  #else
+  if (!backlight_pwm_animating()) {
+    return;
+  }
+  // OCR1x is double buffered and only changes at the end of a period
+  set_duty(backlight_pwm_duty());
   #endif
 }
 
 #ifdef BACKLIGHT_BREATHING
 
-#define BREATHING_NO_HALT  0
-#define BREATHING_HALT_OFF 1
-#define BREATHING_HALT_ON  2
-
-static uint8_t breath_intensity;
 static uint8_t breath_speed;
-static uint16_t breathing_index;
-static uint8_t breathing_halt;
 
 void breathing_enable(void)
 {
-    if (get_backlight_level() == 0)
-    {
-        breathing_index = 0;
-    }
-    else
-    {
-        // Set breathing_index to be at the midpoint (brightest point)
-        breathing_index = 0x20 << breath_speed;
-    }
-
-    breathing_halt = BREATHING_NO_HALT;
-
-    // Enable breathing interrupt
-    TIMSK1 |= _BV(OCIE1A);
+    // From dark, or from the brightest point
+    backlight_pwm_breathe(get_backlight_level() == 0 ? 0 : BACKLIGHT_PHASE_PEAK, BACKLIGHT_HALT_NONE);
 }
 
 void breathing_pulse(void)
 {
-    if (get_backlight_level() == 0)
-    {
-        breathing_index = 0;
-    }
-    else
-    {
-        // Set breathing_index to be at the midpoint + 1 (brightest point)
-        breathing_index = 0x21 << breath_speed;
-    }
-
-    breathing_halt = BREATHING_HALT_ON;
-
-    // Enable breathing interrupt
-    TIMSK1 |= _BV(OCIE1A);
+    // Once round, back to the brightest point
+    backlight_pwm_breathe(get_backlight_level() == 0 ? 0 : BACKLIGHT_PHASE_PEAK + 0x100, BACKLIGHT_HALT_PEAK);
 }
 
 void breathing_disable(void)
 {
-    // Disable breathing interrupt
-    TIMSK1 &= ~_BV(OCIE1A);
+    backlight_pwm_breathe_stop();
     backlight_set(get_backlight_level());
 }
 
@@ -950,86 +927,54 @@ void breathing_self_disable(void)
 {
     if (get_backlight_level() == 0)
     {
-        breathing_halt = BREATHING_HALT_OFF;
+        backlight_pwm_breathe_halt(BACKLIGHT_HALT_DARK);
     }
     else
     {
-        breathing_halt = BREATHING_HALT_ON;
+        backlight_pwm_breathe_halt(BACKLIGHT_HALT_PEAK);
     }
-
-    //backlight_set(get_backlight_level());
 }
 
 void breathing_toggle(void)
 {
     if (!is_breathing())
     {
-        if (get_backlight_level() == 0)
-        {
-            breathing_index = 0;
-        }
-        else
-        {
-            // Set breathing_index to be at the midpoint + 1 (brightest point)
-            breathing_index = 0x21 << breath_speed;
-        }
-
-        breathing_halt = BREATHING_NO_HALT;
+        backlight_pwm_breathe(get_backlight_level() == 0 ? 0 : BACKLIGHT_PHASE_PEAK + 0x100, BACKLIGHT_HALT_NONE);
     }
-
-    // Toggle breathing interrupt
-    TIMSK1 ^= _BV(OCIE1A);
-
-    // Restore backlight level
-    if (!is_breathing())
+    else
     {
-        backlight_set(get_backlight_level());
+        breathing_disable();
     }
 }
 
 bool is_breathing(void)
 {
-    return (TIMSK1 && _BV(OCIE1A));
+    return backlight_pwm_breathing();
 }
 
 void breathing_intensity_default(void)
 {
-    //breath_intensity = (uint8_t)((uint16_t)100 * (uint16_t)get_backlight_level() / (uint16_t)BACKLIGHT_LEVELS);
-    breath_intensity = ((BACKLIGHT_LEVELS - get_backlight_level()) * ((BACKLIGHT_LEVELS + 1) / 2));
+    // Up to the level set, or the lowest level when off
+    uint8_t level = get_backlight_level();
+    backlight_pwm_breathe_peak(level_lightness(level == 0 ? 1 : level));
 }
 
+// Each step halves the lightness the breath peaks at
 void breathing_intensity_set(uint8_t value)
 {
-    breath_intensity = value;
+    backlight_pwm_breathe_peak(value > 7 ? 0 : 0xFF >> value);
 }
 
 void breathing_speed_default(void)
 {
     breath_speed = 4;
+    backlight_pwm_breathe_speed(breath_speed);
 }
 
 void breathing_speed_set(uint8_t value)
 {
-    bool is_breathing_now = is_breathing();
-    uint8_t old_breath_speed = breath_speed;
-
-    if (is_breathing_now)
-    {
-        // Disable breathing interrupt
-        TIMSK1 &= ~_BV(OCIE1A);
-    }
-
     breath_speed = value;
-
-    if (is_breathing_now)
-    {
-        // Adjust index to account for new speed
-        breathing_index = (( (uint8_t)( (breathing_index) >> old_breath_speed ) ) & 0x3F) << breath_speed;
-
-        // Enable breathing interrupt
-        TIMSK1 |= _BV(OCIE1A);
-    }
-
+    backlight_pwm_breathe_speed(breath_speed);
 }
 
 void breathing_speed_inc(uint8_t value)
@@ -1060,41 +1005,8 @@ void breathing_defaults(void)
 {
     breathing_intensity_default();
     breathing_speed_default();
-    breathing_halt = BREATHING_NO_HALT;
 }
 
-/* Breathing Sleep LED brighness(PWM On period) table
- * (64[steps] * 4[duration]) / 64[PWM periods/s] = 4 second breath cycle
- *
- * http://www.wolframalpha.com/input/?i=%28sin%28+x%2F64*pi%29**8+*+255%2C+x%3D0+to+63
- * (0..63).each {|x| p ((sin(x/64.0*PI)**8)*255).to_i }
- */
-static const uint8_t breathing_table[64] PROGMEM = {
-  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,   2,   4,   6,  10,
- 15,  23,  32,  44,  58,  74,  93, 113, 135, 157, 179, 199, 218, 233, 245, 252,
-255, 252, 245, 233, 218, 199, 179, 157, 135, 113,  93,  74,  58,  44,  32,  23,
- 15,  10,   6,   4,   2,   1,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-};
-
-ISR(TIMER1_COMPA_vect)
-{
-    // OCR1x = (pgm_read_byte(&breathing_table[ ( (uint8_t)( (breathing_index++) >> breath_speed ) ) & 0x3F ] )) * breath_intensity;
-
-
-    uint8_t local_index = ( (uint8_t)( (breathing_index++) >> breath_speed ) ) & 0x3F;
-
-    if (((breathing_halt == BREATHING_HALT_ON) && (local_index == 0x20)) || ((breathing_halt == BREATHING_HALT_OFF) && (local_index == 0x3F)))
-    {
-        // Disable breathing interrupt
-        TIMSK1 &= ~_BV(OCIE1A);
-    }
-
-    OCR1x = (uint16_t)(((uint16_t)pgm_read_byte(&breathing_table[local_index]) * 257)) >> breath_intensity;
-
-}
-
-
-
 #endif // breathing
 
 #else // backlight
@@ -26,9 +26,13 @@
 #include "keymap.h"
 #ifdef BACKLIGHT_ENABLE
     #include "backlight.h"
+    #include "backlight_pwm.h"
 #endif
 #ifdef RGBLIGHT_ENABLE
   #include "rgblight.h"
+  #ifdef RGBLIGHT_LAYERS
+    #include "rgblight_layers.h"
+  #endif
 #endif
 #include "action_layer.h"
 #include "eeconfig.h"
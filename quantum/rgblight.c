@@ -14,14 +14,22 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <math.h>
-#include <avr/eeprom.h>
-#include <avr/interrupt.h>
-#include <util/delay.h>
+#include <string.h>
+#ifdef __AVR__
+  #include <avr/eeprom.h>
+  #include <avr/interrupt.h>
+#else
+  #include "eeprom.h"
+#endif
+#include "wait.h"
 #include "progmem.h"
 #include "timer.h"
 #include "rgblight.h"
 #include "debug.h"
 #include "led_tables.h"
+#ifdef RGBLIGHT_LAYERS
+  #include "rgblight_layers.h"
+#endif
 
 __attribute__ ((weak))
 const uint8_t RGBLED_BREATHING_INTERVALS[] PROGMEM = {30, 20, 10, 5};
@@ -51,10 +59,15 @@ void sethsv(uint16_t hue, uint8_t sat, uint8_t val, LED_TYPE *led1) {
     g = val;
     b = val;
   } else {
+    // hue / 60 and hue % 60 with multiplications, AVR has no divide
+    // instruction. Both are exact for every hue in 0-359
+    uint8_t sector = hue < 360 ? ((hue >> 2) * 137) >> 11 : 6;
+    uint8_t offset = hue - sector * 60;
+
     base = ((255 - sat) * val) >> 8;
-    color = (val - base) * (hue % 60) / 60;
+    color = ((uint32_t)(val - base) * offset * 34953) >> 21;
 
-    switch (hue / 60) {
+    switch (sector) {
       case 0:
         r = val;
         g = base + color;
@@ -94,6 +107,12 @@ void sethsv(uint16_t hue, uint8_t sat, uint8_t val, LED_TYPE *led1) {
   setrgb(r, g, b, led1);
 }
 
+// (hue + step) % 360 for a hue and step below 360
+static inline uint16_t hue_add(uint16_t hue, uint16_t step) {
+  hue += step;
+  return hue >= 360 ? hue - 360 : hue;
+}
+
 void setrgb(uint8_t r, uint8_t g, uint8_t b, LED_TYPE *led1) {
   (*led1).r = r;
   (*led1).g = g;
@@ -102,10 +121,12 @@ void setrgb(uint8_t r, uint8_t g, uint8_t b, LED_TYPE *led1) {
 
 
 uint32_t eeconfig_read_rgblight(void) {
-  return eeprom_read_dword(EECONFIG_RGBLIGHT);
+  uint32_t val;
+  eeconfig_read_block(&val, EECONFIG_RGBLIGHT, sizeof(val));
+  return val;
 }
 void eeconfig_update_rgblight(uint32_t val) {
-  eeprom_update_dword(EECONFIG_RGBLIGHT, val);
+  eeconfig_update_block(&val, EECONFIG_RGBLIGHT, sizeof(val));
 }
 void eeconfig_update_rgblight_default(void) {
   dprintf("eeconfig_update_rgblight_default\n");
@@ -152,6 +173,10 @@ void rgblight_init(void) {
   }
 }
 
+uint32_t rgblight_read_dword(void) {
+  return rgblight_config.raw;
+}
+
 void rgblight_update_dword(uint32_t dword) {
   rgblight_config.raw = dword;
   eeconfig_update_rgblight(rgblight_config.raw);
@@ -254,7 +279,7 @@ void rgblight_toggle(void) {
     #ifdef RGBLIGHT_ANIMATIONS
       rgblight_timer_disable();
     #endif
-    _delay_ms(50);
+    wait_ms(50);
     rgblight_set();
   }
 }
@@ -345,13 +370,14 @@ void rgblight_sethsv(uint16_t hue, uint8_t sat, uint8_t val) {
         hue = rgblight_config.hue;
       } else if (rgblight_config.mode >= 25 && rgblight_config.mode <= 34) {
         // static gradient
-        uint16_t _hue;
         int8_t direction = ((rgblight_config.mode - 25) % 2) ? -1 : 1;
         uint16_t range = pgm_read_word(&RGBLED_GRADIENT_RANGES[(rgblight_config.mode - 25) / 2]);
+        uint16_t step = range / RGBLED_NUM;
+        uint16_t _hue = hue % 360;
         for (uint8_t i = 0; i < RGBLED_NUM; i++) {
-          _hue = (range / RGBLED_NUM * i * direction + hue + 360) % 360;
           dprintf("rgblight rainbow set hsv: %u,%u,%d,%u\n", i, _hue, direction, range);
           sethsv(_hue, sat, val, (LED_TYPE *)&led[i]);
+          _hue = hue_add(_hue, direction > 0 ? step : 360 - step);
         }
         rgblight_set();
       }
@@ -375,25 +401,81 @@ void rgblight_setrgb(uint8_t r, uint8_t g, uint8_t b) {
 }
 
 #ifndef RGBLIGHT_CUSTOM_DRIVER
+
+// What the strip is showing. The LEDs keep their color until new data is
+// shifted through them, so a frame only has to reach the last LED that
+// changed, and a frame that changes nothing isn't sent at all.
+static LED_TYPE led_shown[RGBLED_NUM];
+static bool led_shown_valid = false;
+static bool frame_pending = false;
+static uint16_t last_frame_timer = 0;
+
+// The number of LEDs that have to be sent to show frame
+static uint8_t rgblight_dirty_leds(const LED_TYPE *frame) {
+  if (!led_shown_valid) {
+    return RGBLED_NUM;
+  }
+  for (uint8_t i = RGBLED_NUM; i > 0; i--) {
+    if (memcmp(&frame[i - 1], &led_shown[i - 1], sizeof(LED_TYPE)) != 0) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+static void rgblight_flush(void) {
+  if (!frame_pending) {
+    return;
+  }
+  #if RGBLIGHT_MAX_FPS > 0
+    // rgblight_task() sends the frame once it's time
+    if (led_shown_valid && timer_elapsed(last_frame_timer) < 1000 / RGBLIGHT_MAX_FPS) {
+      return;
+    }
+  #endif
+  #ifdef WS2812_ASYNC
+    // The driver has a frame waiting already
+    if (ws2812_busy()) {
+      #ifdef RGBLIGHT_ANIMATIONS
+        // rgblight_task() sends this one
+        return;
+      #else
+        while (ws2812_busy());
+      #endif
+    }
+  #endif
+  frame_pending = false;
+
+  LED_TYPE *frame = led;
+  #ifdef RGBLIGHT_LAYERS
+    if (rgblight_config.enable) {
+      frame = rgblight_layers_compose(led);
+    }
+  #endif
+  uint8_t count = rgblight_dirty_leds(frame);
+  if (count == 0) {
+    return;
+  }
+  #ifdef RGBW
+    ws2812_setleds_rgbw(frame, count);
+  #else
+    ws2812_setleds(frame, count);
+  #endif
+  memcpy(led_shown, frame, count * sizeof(LED_TYPE));
+  led_shown_valid = true;
+  last_frame_timer = timer_read();
+}
+
 void rgblight_set(void) {
-  if (rgblight_config.enable) {
-    #ifdef RGBW
-      ws2812_setleds_rgbw(led, RGBLED_NUM);
-    #else
-      ws2812_setleds(led, RGBLED_NUM);
-    #endif
-  } else {
+  if (!rgblight_config.enable) {
     for (uint8_t i = 0; i < RGBLED_NUM; i++) {
       led[i].r = 0;
       led[i].g = 0;
       led[i].b = 0;
     }
-    #ifdef RGBW
-      ws2812_setleds_rgbw(led, RGBLED_NUM);
-    #else
-      ws2812_setleds(led, RGBLED_NUM);
-    #endif
   }
+  frame_pending = true;
+  rgblight_flush();
 }
 #endif
 
@@ -438,6 +520,14 @@ void rgblight_show_solid_color(uint8_t r, uint8_t g, uint8_t b) {
 }
 
 void rgblight_task(void) {
+  #ifdef RGBLIGHT_LAYERS
+    if (rgblight_layers_animating()) {
+      frame_pending = true;
+    }
+  #endif
+  #if !defined(RGBLIGHT_CUSTOM_DRIVER) && (RGBLIGHT_MAX_FPS > 0 || defined(WS2812_ASYNC))
+    rgblight_flush();
+  #endif
   if (rgblight_timer_enabled) {
     // mode = 1, static light, do nothing here
     if (rgblight_config.mode >= 2 && rgblight_config.mode <= 5) {
@@ -463,20 +553,50 @@ void rgblight_task(void) {
 }
 
 // Effects
+
+// http://sean.voisen.org/blog/2011/10/breathing-led-with-arduino/
+// exp(sin(pos / 255 * PI)) for the rising half of the cycle, scaled so that
+// 1/e..e maps onto 0..65535. The falling half mirrors it.
+static const uint16_t BREATHING_CURVE[128] PROGMEM = {
+  17625, 17971, 18321, 18675, 19033, 19395, 19762, 20133,
+  20508, 20888, 21271, 21658, 22050, 22446, 22846, 23249,
+  23657, 24069, 24484, 24904, 25327, 25754, 26185, 26619,
+  27057, 27499, 27944, 28392, 28844, 29299, 29757, 30218,
+  30682, 31150, 31620, 32092, 32567, 33045, 33525, 34008,
+  34493, 34979, 35468, 35958, 36451, 36944, 37439, 37936,
+  38433, 38932, 39431, 39931, 40431, 40932, 41433, 41934,
+  42435, 42936, 43436, 43935, 44433, 44931, 45427, 45921,
+  46415, 46906, 47395, 47882, 48367, 48848, 49328, 49804,
+  50276, 50746, 51211, 51673, 52131, 52584, 53033, 53477,
+  53917, 54351, 54780, 55203, 55620, 56032, 56437, 56836,
+  57228, 57613, 57992, 58363, 58726, 59083, 59431, 59771,
+  60103, 60427, 60742, 61049, 61347, 61635, 61915, 62185,
+  62445, 62696, 62937, 63168, 63389, 63600, 63800, 63990,
+  64170, 64338, 64496, 64643, 64779, 64904, 65018, 65121,
+  65212, 65292, 65361, 65419, 65465, 65499, 65522, 65534,
+};
+
+// The curve moved down by RGBLIGHT_EFFECT_BREATHE_CENTER, in the same scale.
+// This folds into a constant, so the breathing config stays a plain #define
+#define BREATHING_OFFSET ((uint32_t)(RGBLIGHT_EFFECT_BREATHE_MAX * (RGBLIGHT_EFFECT_BREATHE_CENTER - 1) / (M_E * M_E - 1) * 65536 + 0.5))
+
+static uint8_t breathing_val(uint8_t pos) {
+  uint32_t curve = pgm_read_word(&BREATHING_CURVE[pos < 128 ? pos : 255 - pos]);
+  uint32_t val = curve * RGBLIGHT_EFFECT_BREATHE_MAX;
+  // The curve is scaled by 65535, not 65536
+  return (val + (val >> 16) - BREATHING_OFFSET) >> 16;
+}
+
 void rgblight_effect_breathing(uint8_t interval) {
   static uint8_t pos = 0;
   static uint16_t last_timer = 0;
-  float val;
 
   if (timer_elapsed(last_timer) < pgm_read_byte(&RGBLED_BREATHING_INTERVALS[interval])) {
     return;
   }
   last_timer = timer_read();
 
-
-  // http://sean.voisen.org/blog/2011/10/breathing-led-with-arduino/
-  val = (exp(sin((pos/255.0)*M_PI)) - RGBLIGHT_EFFECT_BREATHE_CENTER/M_E)*(RGBLIGHT_EFFECT_BREATHE_MAX/(M_E-1/M_E));
-  rgblight_sethsv_noeeprom(rgblight_config.hue, rgblight_config.sat, val);
+  rgblight_sethsv_noeeprom(rgblight_config.hue, rgblight_config.sat, breathing_val(pos));
   pos = (pos + 1) % 256;
 }
 void rgblight_effect_rainbow_mood(uint8_t interval) {
@@ -499,9 +619,10 @@ void rgblight_effect_rainbow_swirl(uint8_t interval) {
     return;
   }
   last_timer = timer_read();
+  hue = current_hue;
   for (i = 0; i < RGBLED_NUM; i++) {
-    hue = (360 / RGBLED_NUM * i + current_hue) % 360;
     sethsv(hue, rgblight_config.sat, rgblight_config.val, (LED_TYPE *)&led[i]);
+    hue = hue_add(hue, 360 / RGBLED_NUM);
   }
   rgblight_set();
 
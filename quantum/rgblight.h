@@ -54,6 +54,17 @@
 #define RGBLIGHT_EFFECT_CHRISTMAS_STEP 2
 #endif
 
+// Frames come at most this often, the effects of the fastest modes skip the
+// frames in between. The limit needs rgblight_task(), so it's only there
+// with RGBLIGHT_ANIMATIONS.
+#ifndef RGBLIGHT_MAX_FPS
+  #ifdef RGBLIGHT_ANIMATIONS
+    #define RGBLIGHT_MAX_FPS 60
+  #else
+    #define RGBLIGHT_MAX_FPS 0
+  #endif
+#endif
+
 #ifndef RGBLIGHT_HUE_STEP
 #define RGBLIGHT_HUE_STEP 10
 #endif
@@ -70,6 +81,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "eeconfig.h"
+#include "progmem.h"
 #ifndef RGBLIGHT_CUSTOM_DRIVER
 #include "ws2812.h"
 #endif
@@ -104,6 +116,7 @@ void rgblight_step_reverse(void);
 uint32_t rgblight_get_mode(void);
 void rgblight_mode(uint8_t mode);
 void rgblight_set(void);
+uint32_t rgblight_read_dword(void);
 void rgblight_update_dword(uint32_t dword);
 void rgblight_increase_hue(void);
 void rgblight_decrease_hue(void);
@@ -0,0 +1,201 @@
+/*
+ * Layers drawn over the rgblight colors before every frame is sent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+#include "progmem.h"
+#include "timer.h"
+#include "rgblight_layers.h"
+
+static rgblight_layer_t *layers[RGBLIGHT_LAYERS_MAX];
+static uint8_t layer_count = 0;
+static bool animating = false;
+
+// The frame being composed, and the layer drawing into it
+static LED_TYPE frame[RGBLED_NUM];
+static rgblight_layer_t *current_layer;
+
+void rgblight_layers_add(rgblight_layer_t *layer) {
+  if (layer_count < RGBLIGHT_LAYERS_MAX) {
+    layers[layer_count++] = layer;
+    animating = true;
+  }
+}
+
+void rgblight_layers_remove(rgblight_layer_t *layer) {
+  for (uint8_t i = 0; i < layer_count; i++) {
+    if (layers[i] == layer) {
+      layer_count--;
+      memmove(&layers[i], &layers[i + 1], (layer_count - i) * sizeof(layers[0]));
+      animating = true;
+      return;
+    }
+  }
+}
+
+void rgblight_layers_refresh(void) {
+  animating = true;
+}
+
+bool rgblight_layers_animating(void) {
+  return animating;
+}
+
+static uint8_t blend(uint8_t below, uint8_t color) {
+  switch (current_layer->blend) {
+    case RGBLIGHT_BLEND_ADD:
+      return below + color > 255 ? 255 : below + color;
+    case RGBLIGHT_BLEND_MAX:
+      return below > color ? below : color;
+    case RGBLIGHT_BLEND_MULTIPLY:
+      return (below * (color + 1)) >> 8;
+    default:
+      return color;
+  }
+}
+
+void rgblight_layer_set(uint8_t index, uint8_t r, uint8_t g, uint8_t b) {
+  if (index >= RGBLED_NUM) {
+    return;
+  }
+  if (current_layer->mask && !(pgm_read_byte(&current_layer->mask[index / 8]) & (1 << (index % 8)))) {
+    return;
+  }
+  frame[index].r = blend(frame[index].r, r);
+  frame[index].g = blend(frame[index].g, g);
+  frame[index].b = blend(frame[index].b, b);
+}
+
+void rgblight_layer_sethsv(uint8_t index, uint16_t hue, uint8_t sat, uint8_t val) {
+  LED_TYPE color;
+  sethsv(hue, sat, val, &color);
+  rgblight_layer_set(index, color.r, color.g, color.b);
+}
+
+LED_TYPE *rgblight_layers_compose(LED_TYPE *base) {
+  if (layer_count == 0) {
+    animating = false;
+    return base;
+  }
+  memcpy(frame, base, sizeof(frame));
+  animating = false;
+  for (uint8_t i = 0; i < layer_count; i++) {
+    if (layers[i]->enabled) {
+      current_layer = layers[i];
+      animating |= current_layer->render(current_layer);
+    }
+  }
+  return frame;
+}
+
+__attribute__ ((weak))
+uint8_t rgblight_led_for_key(keypos_t key) {
+  return (uint16_t)key.col * RGBLED_NUM / MATRIX_COLS;
+}
+
+void rgblight_layers_key_event(keypos_t key, bool pressed) {
+  uint8_t led = RGBLIGHT_NO_LED;
+  bool found = false;
+  for (uint8_t i = 0; i < layer_count; i++) {
+    if (layers[i]->enabled && layers[i]->key_event) {
+      if (!found) {
+        led = rgblight_led_for_key(key);
+        found = true;
+      }
+      layers[i]->key_event(layers[i], led, pressed);
+      animating = true;
+    }
+  }
+}
+
+// Reactive layer
+
+enum {
+  HIT_FREE = 0,
+  HIT_HELD,
+  HIT_FADING,
+};
+
+void rgblight_reactive_key_event(rgblight_layer_t *layer, uint8_t led, bool pressed) {
+  rgblight_reactive_t *reactive = (rgblight_reactive_t *)layer;
+  if (led == RGBLIGHT_NO_LED) {
+    return;
+  }
+
+  if (!pressed) {
+    for (uint8_t i = 0; i < RGBLIGHT_REACTIVE_HITS; i++) {
+      rgblight_hit_t *hit = &reactive->hits[i];
+      if (hit->state == HIT_HELD && hit->led == led) {
+        hit->state = HIT_FADING;
+        hit->timer = timer_read();
+      }
+    }
+    return;
+  }
+
+  // A free slot, or the one that has been fading the longest
+  rgblight_hit_t *slot = NULL;
+  uint16_t oldest = 0;
+  for (uint8_t i = 0; i < RGBLIGHT_REACTIVE_HITS; i++) {
+    rgblight_hit_t *hit = &reactive->hits[i];
+    if (hit->state == HIT_FREE) {
+      slot = hit;
+      break;
+    }
+    if (hit->state == HIT_FADING && timer_elapsed(hit->timer) >= oldest) {
+      oldest = timer_elapsed(hit->timer);
+      slot = hit;
+    }
+  }
+  if (!slot) {
+    return;
+  }
+  // A ripple sets off right away, a key without one waits for the release
+  slot->state = reactive->spread ? HIT_FADING : HIT_HELD;
+  slot->led = led;
+  slot->timer = timer_read();
+}
+
+bool rgblight_reactive_render(rgblight_layer_t *layer) {
+  rgblight_reactive_t *reactive = (rgblight_reactive_t *)layer;
+  bool fading = false;
+
+  for (uint8_t i = 0; i < RGBLIGHT_REACTIVE_HITS; i++) {
+    rgblight_hit_t *hit = &reactive->hits[i];
+    if (hit->state == HIT_FREE) {
+      continue;
+    }
+    if (hit->state == HIT_HELD) {
+      rgblight_layer_sethsv(hit->led, reactive->hue, reactive->sat, reactive->val);
+      continue;
+    }
+
+    uint16_t age = timer_elapsed(hit->timer);
+    if (age >= reactive->duration) {
+      hit->state = HIT_FREE;
+      continue;
+    }
+    fading = true;
+    uint8_t val = (uint32_t)reactive->val * (reactive->duration - age) / reactive->duration;
+    uint8_t distance = (uint32_t)age * (reactive->spread + 1) / reactive->duration;
+    if (hit->led >= distance) {
+      rgblight_layer_sethsv(hit->led - distance, reactive->hue, reactive->sat, val);
+    }
+    if (distance > 0 && hit->led + distance < RGBLED_NUM) {
+      rgblight_layer_sethsv(hit->led + distance, reactive->hue, reactive->sat, val);
+    }
+  }
+  return fading;
+}
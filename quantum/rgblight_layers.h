@@ -0,0 +1,125 @@
+/*
+ * Layers drawn over the rgblight colors before every frame is sent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef RGBLIGHT_LAYERS_H
+#define RGBLIGHT_LAYERS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "keyboard.h"
+#include "rgblight.h"
+
+#ifndef RGBLIGHT_ANIMATIONS
+  #error "RGBLIGHT_LAYERS needs RGBLIGHT_ANIMATIONS, the layers are drawn from rgblight_task()"
+#endif
+#ifdef RGBLIGHT_CUSTOM_DRIVER
+  #error "RGBLIGHT_LAYERS can't be used with RGBLIGHT_CUSTOM_DRIVER"
+#endif
+
+// The most layers that can be added at the same time
+#ifndef RGBLIGHT_LAYERS_MAX
+  #define RGBLIGHT_LAYERS_MAX 4
+#endif
+
+// The most keys a reactive layer animates at the same time, the oldest
+// animation makes way for a new one
+#ifndef RGBLIGHT_REACTIVE_HITS
+  #define RGBLIGHT_REACTIVE_HITS 6
+#endif
+
+#define RGBLIGHT_NO_LED 0xFF
+
+// How a layer is drawn over the layers below it
+enum rgblight_blend {
+  RGBLIGHT_BLEND_REPLACE,
+  RGBLIGHT_BLEND_ADD,      // saturates at 255
+  RGBLIGHT_BLEND_MAX,      // the brighter of the two
+  RGBLIGHT_BLEND_MULTIPLY, // 255 keeps what's below, 0 turns it off
+};
+
+typedef struct rgblight_layer_t rgblight_layer_t;
+
+/*
+ * A layer over the colors in led[]. The layers are drawn from the bottom up,
+ * in the order they were added, every time a frame is sent.
+ *
+ * render() draws with rgblight_layer_set(), and only has to touch the LEDs it
+ * lights. It returns true while the layer is animating, so that more frames
+ * are sent even when nothing else changes.
+ */
+struct rgblight_layer_t {
+  bool (*render)(rgblight_layer_t *layer);
+  // Optional, called for every key press and release
+  void (*key_event)(rgblight_layer_t *layer, uint8_t led, bool pressed);
+  // A PROGMEM bitmap of the LEDs the layer may draw on, LED 0 is bit 0 of the
+  // first byte. NULL for all of them
+  const uint8_t *mask;
+  uint8_t blend;
+  bool enabled;
+};
+
+void rgblight_layers_add(rgblight_layer_t *layer);
+void rgblight_layers_remove(rgblight_layer_t *layer);
+// Draws a new frame, call it after changing a layer from outside render()
+void rgblight_layers_refresh(void);
+
+// Only valid inside render()
+void rgblight_layer_set(uint8_t index, uint8_t r, uint8_t g, uint8_t b);
+void rgblight_layer_sethsv(uint8_t index, uint16_t hue, uint8_t sat, uint8_t val);
+
+// The LED under a key, or RGBLIGHT_NO_LED. By default the strip is taken to
+// run along the columns, keyboards with another layout can override it.
+uint8_t rgblight_led_for_key(keypos_t key);
+
+// Called by process_record_quantum() for every key event
+void rgblight_layers_key_event(keypos_t key, bool pressed);
+
+// Used by rgblight.c, returns the frame to send for the colors in base
+LED_TYPE *rgblight_layers_compose(LED_TYPE *base);
+bool rgblight_layers_animating(void);
+
+/*
+ * A layer lighting up the keys that are pressed. With a spread of 0 a key's
+ * LED stays lit while the key is held and then fades out, otherwise a ripple
+ * travels spread LEDs each way from the key while it fades. Drawing costs
+ * O(keys animating), not O(LEDs).
+ */
+typedef struct {
+  uint8_t  state; // 0 for a free slot
+  uint8_t  led;
+  uint16_t timer;
+} rgblight_hit_t;
+
+typedef struct {
+  rgblight_layer_t layer;
+  uint16_t hue;
+  uint8_t  sat;
+  uint8_t  val;
+  uint16_t duration; // of the fade, in ms
+  uint8_t  spread;
+  rgblight_hit_t hits[RGBLIGHT_REACTIVE_HITS];
+} rgblight_reactive_t;
+
+bool rgblight_reactive_render(rgblight_layer_t *layer);
+void rgblight_reactive_key_event(rgblight_layer_t *layer, uint8_t led, bool pressed);
+
+// rgblight_reactive_t ripple = RGBLIGHT_REACTIVE(0, 255, 255, 500, 4);
+// rgblight_layers_add(&ripple.layer);
+#define RGBLIGHT_REACTIVE(hue, sat, val, duration, spread) \
+  { { rgblight_reactive_render, rgblight_reactive_key_event, NULL, RGBLIGHT_BLEND_MAX, true }, \
+    hue, sat, val, duration, spread, { { 0 } } }
+
+#endif
@@ -0,0 +1,314 @@
+/*
+ * WARNING: be careful changing this code, it is very timing dependent
+ */
+
+#ifndef F_CPU
+#define F_CPU 16000000
+#endif
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/delay.h>
+#include <stdbool.h>
+#include "serial.h"
+
+#ifndef USE_I2C
+
+// Serial pulse period in microseconds. Its probably a bad idea to lower this
+// value.
+#define SERIAL_DELAY 24
+
+uint8_t volatile serial_slave_buffer[SERIAL_SLAVE_BUFFER_LENGTH] = {0};
+uint8_t volatile serial_master_buffer[SERIAL_MASTER_BUFFER_LENGTH] = {0};
+
+#define SLAVE_DATA_CORRUPT (1<<0)
+volatile uint8_t status = 0;
+
+inline static
+void serial_delay(void) {
+  _delay_us(SERIAL_DELAY);
+}
+
+inline static
+void serial_output(void) {
+  SERIAL_PIN_DDR |= SERIAL_PIN_MASK;
+}
+
+// make the serial pin an input with pull-up resistor
+inline static
+void serial_input(void) {
+  SERIAL_PIN_DDR  &= ~SERIAL_PIN_MASK;
+  SERIAL_PIN_PORT |= SERIAL_PIN_MASK;
+}
+
+inline static
+uint8_t serial_read_pin(void) {
+  return !!(SERIAL_PIN_INPUT & SERIAL_PIN_MASK);
+}
+
+inline static
+void serial_low(void) {
+  SERIAL_PIN_PORT &= ~SERIAL_PIN_MASK;
+}
+
+inline static
+void serial_high(void) {
+  SERIAL_PIN_PORT |= SERIAL_PIN_MASK;
+}
+
+void serial_master_init(void) {
+  serial_output();
+  serial_high();
+}
+
+void serial_slave_init(void) {
+  serial_input();
+
+  // Enable INT0
+  EIMSK |= _BV(INT0);
+  // Trigger on falling edge of INT0
+  EICRA &= ~(_BV(ISC00) | _BV(ISC01));
+}
+
+// Used by the master to synchronize timing with the slave.
+static
+void sync_recv(void) {
+  serial_input();
+  // This shouldn't hang if the slave disconnects because the
+  // serial line will float to high if the slave does disconnect.
+  while (!serial_read_pin());
+  serial_delay();
+}
+
+// Used by the slave to send a synchronization signal to the master.
+static
+void sync_send(void) {
+  serial_output();
+
+  serial_low();
+  serial_delay();
+
+  serial_high();
+}
+
+// Reads a byte from the serial line
+static
+uint8_t serial_read_byte(void) {
+  uint8_t byte = 0;
+  serial_input();
+  for ( uint8_t i = 0; i < 8; ++i) {
+    byte = (byte << 1) | serial_read_pin();
+    serial_delay();
+    _delay_us(1);
+  }
+
+  return byte;
+}
+
+// Sends a byte with MSB ordering
+static
+void serial_write_byte(uint8_t data) {
+  uint8_t b = 8;
+  serial_output();
+  while( b-- ) {
+    if(data & (1 << b)) {
+      serial_high();
+    } else {
+      serial_low();
+    }
+    serial_delay();
+  }
+}
+
+// The first byte each side sends, followed by its complement as a check.
+// While nothing changes the two headers are all that crosses the link.
+#define HEADER_ROWS            (1<<0) // slave: the slave buffer follows
+#define HEADER_MASTER_RECEIVED (1<<1) // slave: the last master buffer sent arrived intact
+#define HEADER_RESEND_ROWS     (1<<0) // master: the rows didn't arrive, send them again
+#define HEADER_MASTER          (1<<1) // master: the master buffer follows
+
+// Slave side, the sequence of the rows last sent and whether the master
+// still has to confirm them
+static uint8_t sequence_sent;
+static bool rows_resend = true;
+static bool master_received = false;
+
+// interrupt handle to be used by the slave device
+ISR(SERIAL_PIN_INTERRUPT) {
+  // The sequence comes first in the slave buffer
+  bool send_rows = rows_resend || serial_slave_buffer[0] != sequence_sent;
+  uint8_t header = (send_rows ? HEADER_ROWS : 0) | (master_received ? HEADER_MASTER_RECEIVED : 0);
+
+  sync_send();
+
+  serial_write_byte(header);
+  sync_send();
+  serial_write_byte(~header);
+  sync_send();
+
+  if (send_rows) {
+    sequence_sent = serial_slave_buffer[0];
+    uint8_t checksum = 0;
+    for (int i = 0; i < SERIAL_SLAVE_BUFFER_LENGTH; ++i) {
+      serial_write_byte(serial_slave_buffer[i]);
+      sync_send();
+      checksum += serial_slave_buffer[i];
+    }
+    serial_write_byte(checksum);
+    sync_send();
+  }
+
+  // wait for the sync to finish sending
+  serial_delay();
+
+  // read the middle of pulses
+  _delay_us(SERIAL_DELAY/2);
+
+  uint8_t request = serial_read_byte();
+  sync_send();
+  uint8_t request_check = serial_read_byte();
+  sync_send();
+
+  if (request_check != (uint8_t)~request) {
+    // Out of step with the master, start over with everything
+    rows_resend = true;
+    master_received = false;
+    status |= SLAVE_DATA_CORRUPT;
+    serial_input(); // end transaction
+    return;
+  }
+  rows_resend = request & HEADER_RESEND_ROWS;
+
+  if (request & HEADER_MASTER) {
+    uint8_t data[SERIAL_MASTER_BUFFER_LENGTH];
+    uint8_t checksum_computed = 0;
+    for (int i = 0; i < SERIAL_MASTER_BUFFER_LENGTH; ++i) {
+      data[i] = serial_read_byte();
+      sync_send();
+      checksum_computed += data[i];
+    }
+    uint8_t checksum_received = serial_read_byte();
+    sync_send();
+
+    master_received = checksum_computed == checksum_received;
+    if (master_received) {
+      for (int i = 0; i < SERIAL_MASTER_BUFFER_LENGTH; ++i) {
+        serial_master_buffer[i] = data[i];
+      }
+    }
+  }
+
+  serial_input(); // end transaction
+
+  if (master_received) {
+    status &= ~SLAVE_DATA_CORRUPT;
+  } else {
+    status |= SLAVE_DATA_CORRUPT;
+  }
+}
+
+inline
+bool serial_slave_DATA_CORRUPT(void) {
+  return status & SLAVE_DATA_CORRUPT;
+}
+
+// Master side, whether serial_slave_buffer holds the rows the slave last
+// sent, and whether the slave has yet to confirm the last master buffer
+static bool rows_valid = false;
+static bool master_unconfirmed = false;
+
+// Fetches the serial_slave_buffer from the master when it has changed and
+// sends the serial_master_buffer to the slave when write_master is set, or
+// again when the last one didn't arrive.
+//
+// Returns:
+// 0 => no error
+// 1 => slave did not respond
+int serial_update_buffers(bool write_master) {
+  // this code is very time dependent, so we need to disable interrupts
+  cli();
+
+  // signal to the slave that we want to start a transaction
+  serial_output();
+  serial_low();
+  _delay_us(1);
+
+  // wait for the slaves response
+  serial_input();
+  serial_high();
+  _delay_us(SERIAL_DELAY);
+
+  // check if the slave is present
+  if (serial_read_pin()) {
+    // slave failed to pull the line low, assume not present
+    sei();
+    return 1;
+  }
+
+  // if the slave is present syncronize with it
+  sync_recv();
+
+  uint8_t header = serial_read_byte();
+  sync_recv();
+  uint8_t header_check = serial_read_byte();
+  sync_recv();
+
+  if (header_check != (uint8_t)~header) {
+    rows_valid = false;
+    sei();
+    return 1;
+  }
+
+  if (header & HEADER_ROWS) {
+    uint8_t data[SERIAL_SLAVE_BUFFER_LENGTH];
+    uint8_t checksum_computed = 0;
+    for (int i = 0; i < SERIAL_SLAVE_BUFFER_LENGTH; ++i) {
+      data[i] = serial_read_byte();
+      sync_recv();
+      checksum_computed += data[i];
+    }
+    uint8_t checksum_received = serial_read_byte();
+    sync_recv();
+
+    if (checksum_computed != checksum_received) {
+      rows_valid = false;
+      sei();
+      return 1;
+    }
+    for (int i = 0; i < SERIAL_SLAVE_BUFFER_LENGTH; ++i) {
+      serial_slave_buffer[i] = data[i];
+    }
+    rows_valid = true;
+  }
+
+  if (master_unconfirmed && !(header & HEADER_MASTER_RECEIVED)) {
+    write_master = true;
+  }
+  uint8_t request = (rows_valid ? 0 : HEADER_RESEND_ROWS) | (write_master ? HEADER_MASTER : 0);
+
+  serial_write_byte(request);
+  sync_recv();
+  serial_write_byte(~request);
+  sync_recv();
+
+  if (write_master) {
+    uint8_t checksum = 0;
+    for (int i = 0; i < SERIAL_MASTER_BUFFER_LENGTH; ++i) {
+      serial_write_byte(serial_master_buffer[i]);
+      sync_recv();
+      checksum += serial_master_buffer[i];
+    }
+    serial_write_byte(checksum);
+    sync_recv();
+  }
+  master_unconfirmed = write_master;
+
+  // always, release the line when not in use
+  serial_output();
+  serial_high();
+
+  sei();
+  return 0;
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "config.h"
 #include <stdbool.h>
+#include "transport.h"
 
 /* TODO:  some defines for interrupt setup */
 #define SERIAL_PIN_DDR DDRD
@@ -11,8 +12,8 @@
 #define SERIAL_PIN_MASK _BV(PD0)
 #define SERIAL_PIN_INTERRUPT INT0_vect
 
-#define SERIAL_SLAVE_BUFFER_LENGTH MATRIX_ROWS/2
-#define SERIAL_MASTER_BUFFER_LENGTH 1
+#define SERIAL_SLAVE_BUFFER_LENGTH sizeof(split_slave_data_t)
+#define SERIAL_MASTER_BUFFER_LENGTH sizeof(split_master_data_t)
 
 // Buffers for master - slave communication
 extern volatile uint8_t serial_slave_buffer[SERIAL_SLAVE_BUFFER_LENGTH];
@@ -20,7 +21,7 @@ extern volatile uint8_t serial_master_buffer[SERIAL_MASTER_BUFFER_LENGTH];
 
 void serial_master_init(void);
 void serial_slave_init(void);
-int serial_update_buffers(void);
+int serial_update_buffers(bool write_master);
 bool serial_slave_data_corrupt(void);
 
 #endif
@@ -9,11 +9,11 @@
 #include "keyboard.h"
 #include "config.h"
 #include "timer.h"
+#include "transport.h"
+#include "eeconfig.h"
 
-#ifdef USE_I2C
-#  include "i2c.h"
-#else
-#  include "serial.h"
+#if defined(RGBLIGHT_ENABLE) && defined(SPLIT_SYNC_RGBLIGHT)
+#  include "rgblight.h"
 #endif
 
 volatile bool isLeftHand = true;
@@ -32,23 +32,15 @@ static void setup_handedness(void) {
 }
 
 static void keyboard_master_setup(void) {
-#ifdef USE_I2C
-    i2c_master_init();
-#ifdef SSD1306OLED
+    transport_master_init();
+#if defined(USE_I2C) && defined(SSD1306OLED)
     matrix_master_OLED_init ();
 #endif
-#else
-    serial_master_init();
-#endif
 }
 
 static void keyboard_slave_setup(void) {
-  timer_init();
-#ifdef USE_I2C
-    i2c_slave_init(SLAVE_I2C_ADDRESS);
-#else
-    serial_slave_init();
-#endif
+    timer_init();
+    transport_slave_init();
 }
 
 bool has_usb(void) {
@@ -70,9 +62,17 @@ void split_keyboard_setup(void) {
 
 void keyboard_slave_loop(void) {
    matrix_init();
+#if defined(RGBLIGHT_ENABLE) && defined(SPLIT_SYNC_RGBLIGHT)
+   rgblight_init();
+#endif
 
    while (1) {
       matrix_slave_scan();
+#if defined(RGBLIGHT_ENABLE) && defined(SPLIT_SYNC_RGBLIGHT) && defined(RGBLIGHT_ANIMATIONS)
+      rgblight_task();
+#endif
+      // Writes back whatever the master's RGB sync left pending
+      eeconfig_task();
    }
 }
 
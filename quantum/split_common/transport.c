@@ -0,0 +1,221 @@
+#include <string.h>
+#include <stddef.h>
+#include <avr/interrupt.h>
+#include "transport.h"
+
+#ifdef USE_I2C
+#  include "i2c.h"
+#  include "split_util.h"
+#else // USE_SERIAL
+#  include "serial.h"
+#endif
+
+#ifdef SPLIT_SYNC_LAYER_STATE
+#  include "action_layer.h"
+#endif
+
+#if defined(RGBLIGHT_ENABLE) && defined(SPLIT_SYNC_RGBLIGHT)
+#  include "rgblight.h"
+#endif
+
+#define I2C_SLAVE_DATA_START  offsetof(split_buffer_t, slave)
+#define I2C_MASTER_DATA_START offsetof(split_buffer_t, master)
+
+// Sequence of the last rows that the master copied from the slave
+static uint8_t last_slave_sequence;
+// Set when last_slave_sequence can't be trusted, after errors and on startup
+static bool slave_sequence_invalid = true;
+
+static split_master_data_t master_data;
+// Set when master_data has changed and hasn't reached the slave yet
+static bool master_data_pending = true;
+
+static uint8_t slave_sequence;
+static uint8_t last_master_sequence;
+
+static void update_master_data(void) {
+    split_master_data_t data = master_data;
+#ifdef SPLIT_SYNC_LAYER_STATE
+    data.layer_state = layer_state;
+#endif
+#if defined(RGBLIGHT_ENABLE) && defined(SPLIT_SYNC_RGBLIGHT)
+    data.rgblight_config = rgblight_read_dword();
+#endif
+    if (master_data_pending || memcmp(&data, &master_data, sizeof(data)) != 0) {
+        master_data = data;
+        master_data.sequence++;
+        master_data_pending = true;
+    }
+}
+
+static void apply_master_data(const split_master_data_t *data) {
+    if (data->sequence == last_master_sequence) {
+        return;
+    }
+    last_master_sequence = data->sequence;
+#ifdef SPLIT_SYNC_LAYER_STATE
+    layer_state = data->layer_state;
+#endif
+#if defined(RGBLIGHT_ENABLE) && defined(SPLIT_SYNC_RGBLIGHT)
+    if (data->rgblight_config != rgblight_read_dword()) {
+        rgblight_update_dword(data->rgblight_config);
+    }
+#endif
+}
+
+#ifdef USE_I2C
+
+void transport_master_init(void) {
+    i2c_master_init();
+}
+
+void transport_slave_init(void) {
+    i2c_slave_init(SLAVE_I2C_ADDRESS);
+}
+
+static bool i2c_read_block(uint8_t reg, uint8_t *data, uint8_t size) {
+    if (i2c_master_start(SLAVE_I2C_ADDRESS + I2C_WRITE)) goto i2c_error;
+    if (i2c_master_write(reg)) goto i2c_error;
+    if (i2c_master_start(SLAVE_I2C_ADDRESS + I2C_READ)) goto i2c_error;
+
+    uint8_t i;
+    for (i = 0; i < size - 1; ++i) {
+        data[i] = i2c_master_read(I2C_ACK);
+    }
+    data[i] = i2c_master_read(I2C_NACK);
+    i2c_master_stop();
+    return true;
+
+i2c_error: // the cable is disconnceted, or something else went wrong
+    i2c_reset_state();
+    return false;
+}
+
+static bool i2c_write_block(uint8_t reg, const uint8_t *data, uint8_t size) {
+    if (i2c_master_start(SLAVE_I2C_ADDRESS + I2C_WRITE)) goto i2c_error;
+    if (i2c_master_write(reg)) goto i2c_error;
+    for (uint8_t i = 0; i < size; ++i) {
+        if (i2c_master_write(data[i])) goto i2c_error;
+    }
+    i2c_master_stop();
+    return true;
+
+i2c_error:
+    i2c_reset_state();
+    return false;
+}
+
+bool transport_master(matrix_row_t slave_matrix[]) {
+    // While the other half is idle only the sequence byte crosses the bus
+    if (!slave_sequence_invalid) {
+        uint8_t sequence;
+        if (!i2c_read_block(I2C_SLAVE_DATA_START, &sequence, 1)) {
+            slave_sequence_invalid = true;
+            return false;
+        }
+        if (sequence != last_slave_sequence) {
+            slave_sequence_invalid = true;
+        }
+    }
+
+    if (slave_sequence_invalid) {
+        split_slave_data_t data;
+        if (!i2c_read_block(I2C_SLAVE_DATA_START, (uint8_t*)&data, sizeof(data))) {
+            return false;
+        }
+        memcpy(slave_matrix, data.rows, sizeof(data.rows));
+        last_slave_sequence = data.sequence;
+        slave_sequence_invalid = false;
+    }
+
+    update_master_data();
+    if (master_data_pending) {
+        if (!i2c_write_block(I2C_MASTER_DATA_START, (const uint8_t*)&master_data, sizeof(master_data))) {
+            return false;
+        }
+        master_data_pending = false;
+    }
+    return true;
+}
+
+void transport_slave(const matrix_row_t matrix[]) {
+    volatile split_buffer_t *buffer = (volatile split_buffer_t*)i2c_slave_buffer;
+
+    bool changed = false;
+    for (uint8_t i = 0; i < ROWS_PER_HAND; ++i) {
+        if (buffer->slave.rows[i] != matrix[i]) {
+            buffer->slave.rows[i] = matrix[i];
+            changed = true;
+        }
+    }
+    // The rows have to be in place before the master can see the new sequence
+    if (changed) {
+        buffer->slave.sequence = ++slave_sequence;
+    }
+
+    split_master_data_t data;
+    cli();
+    memcpy(&data, (const void*)&buffer->master, sizeof(data));
+    sei();
+    apply_master_data(&data);
+}
+
+#else // USE_SERIAL
+
+void transport_master_init(void) {
+    serial_master_init();
+}
+
+void transport_slave_init(void) {
+    serial_slave_init();
+}
+
+bool transport_master(matrix_row_t slave_matrix[]) {
+    update_master_data();
+    if (master_data_pending) {
+        memcpy((void*)serial_master_buffer, &master_data, sizeof(master_data));
+    }
+
+    // Only the headers cross the link unless one of the halves has changed,
+    // serial.c sends the master data again if it didn't get through
+    if (serial_update_buffers(master_data_pending)) {
+        slave_sequence_invalid = true;
+        return false;
+    }
+    master_data_pending = false;
+
+    volatile split_slave_data_t *data = (volatile split_slave_data_t*)serial_slave_buffer;
+    if (slave_sequence_invalid || data->sequence != last_slave_sequence) {
+        for (uint8_t i = 0; i < ROWS_PER_HAND; ++i) {
+            slave_matrix[i] = data->rows[i];
+        }
+        last_slave_sequence = data->sequence;
+        slave_sequence_invalid = false;
+    }
+    return true;
+}
+
+void transport_slave(const matrix_row_t matrix[]) {
+    volatile split_slave_data_t *buffer = (volatile split_slave_data_t*)serial_slave_buffer;
+
+    bool changed = false;
+    cli();
+    for (uint8_t i = 0; i < ROWS_PER_HAND; ++i) {
+        if (buffer->rows[i] != matrix[i]) {
+            buffer->rows[i] = matrix[i];
+            changed = true;
+        }
+    }
+    if (changed) {
+        buffer->sequence = ++slave_sequence;
+    }
+    sei();
+
+    split_master_data_t data;
+    cli();
+    memcpy(&data, (const void*)serial_master_buffer, sizeof(data));
+    sei();
+    apply_master_data(&data);
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef SPLIT_TRANSPORT_H
+#define SPLIT_TRANSPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+#include "matrix.h"
+
+#define ROWS_PER_HAND (MATRIX_ROWS/2)
+
+/*
+ * Data exchanged between the two halves. Both the I2C and the serial
+ * transports move these structures as plain byte buffers.
+ *
+ * The slave bumps `sequence` after it has updated `rows`, so the master only
+ * has to fetch a single byte while nothing is happening on the other half.
+ */
+typedef struct {
+    uint8_t      sequence;
+    matrix_row_t rows[ROWS_PER_HAND];
+} __attribute__((packed)) split_slave_data_t;
+
+/*
+ * State mirrored from the master to the slave. `sequence` comes last so that
+ * with the I2C auto increment it's the last byte written, and the slave never
+ * sees a new sequence with half updated fields.
+ */
+typedef struct {
+#ifdef SPLIT_SYNC_LAYER_STATE
+    uint32_t layer_state;
+#endif
+#if defined(RGBLIGHT_ENABLE) && defined(SPLIT_SYNC_RGBLIGHT)
+    uint32_t rgblight_config;
+#endif
+    uint8_t  sequence;
+} __attribute__((packed)) split_master_data_t;
+
+/* The register map exposed by the I2C slave */
+typedef struct {
+    split_slave_data_t  slave;
+    split_master_data_t master;
+} __attribute__((packed)) split_buffer_t;
+
+void transport_master_init(void);
+void transport_slave_init(void);
+
+// Exchanges data with the slave, the rows of the other half are only
+// written to slave_matrix when they have changed.
+// Returns false if the slave didn't respond
+bool transport_master(matrix_row_t slave_matrix[]);
+// Publishes the rows of this half and applies any state synced from the master
+void transport_slave(const matrix_row_t matrix[]);
+
+#endif
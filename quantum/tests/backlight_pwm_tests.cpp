@@ -0,0 +1,205 @@
+/*
+ * Tests for the backlight fading and breathing
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cstdlib>
+
+extern "C" {
+#include "backlight_pwm.h"
+#include "led_tables.h"
+    void set_time(uint32_t t);
+    void advance_time(uint32_t ms);
+}
+
+// The biggest change from one ms to the next that doesn't look like a jump,
+// the curve is steepest at the top where a fade takes it about 1.4%
+static const int SMOOTH = 0x400;
+
+class BacklightPwm : public testing::Test {
+protected:
+    void SetUp() override {
+        set_time(0);
+        backlight_pwm_breathe_stop();
+        backlight_pwm_breathe_speed(4);
+        backlight_pwm_breathe_peak(255);
+        backlight_pwm_fade_to(0);
+        advance_time(BACKLIGHT_FADE_TIME + 1);
+        duty = backlight_pwm_duty();
+    }
+
+    // The main loop, once a ms
+    void run(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; i++) {
+            advance_time(1);
+            uint16_t next = backlight_pwm_duty();
+            max_change = std::max(max_change, std::abs((int)next - (int)duty));
+            duty = next;
+        }
+    }
+
+    uint16_t duty;
+    int max_change = 0;
+};
+
+TEST_F(BacklightPwm, GammaFollowsTheCurve) {
+    for (uint16_t i = 0; i < 256; i++) {
+        EXPECT_EQ(pgm_read_byte(&CIE1931_CURVE[i]) * 257, backlight_pwm_gamma(i << 8));
+    }
+    EXPECT_EQ(0xFFFF, backlight_pwm_gamma(0xFFFF));
+
+    uint16_t last = 0;
+    for (uint32_t light = 0; light <= 0xFFFF; light++) {
+        uint16_t value = backlight_pwm_gamma(light);
+        ASSERT_GE(value, last) << light;
+        last = value;
+    }
+}
+
+TEST_F(BacklightPwm, IdleNeedsNoUpdates) {
+    EXPECT_FALSE(backlight_pwm_animating());
+    EXPECT_EQ(0, duty);
+}
+
+TEST_F(BacklightPwm, LevelsFadeIn) {
+    backlight_pwm_fade_to(255);
+    EXPECT_TRUE(backlight_pwm_animating());
+    uint16_t last = duty;
+    for (uint32_t i = 0; i < BACKLIGHT_FADE_TIME - 1; i++) {
+        run(1);
+        EXPECT_GE(duty, last);
+        last = duty;
+    }
+    EXPECT_LT(duty, 0xFFFF);
+    run(2);
+    EXPECT_EQ(0xFFFF, duty);
+    EXPECT_FALSE(backlight_pwm_animating());
+    EXPECT_LE(max_change, SMOOTH);
+}
+
+TEST_F(BacklightPwm, ChangingTheLevelWhileFadingTurnsAround) {
+    backlight_pwm_fade_to(255);
+    run(BACKLIGHT_FADE_TIME / 2);
+    uint16_t middle = duty;
+    backlight_pwm_fade_to(0);
+    run(1);
+    EXPECT_LE(duty, middle);
+    run(BACKLIGHT_FADE_TIME);
+    EXPECT_EQ(0, duty);
+    EXPECT_LE(max_change, SMOOTH);
+}
+
+TEST_F(BacklightPwm, FadeStartsFromTheChange) {
+    // A long time without updates doesn't skip the fade
+    advance_time(60000);
+    backlight_pwm_fade_to(128);
+    run(1);
+    EXPECT_LT(duty, backlight_pwm_gamma(128 << 8));
+}
+
+TEST_F(BacklightPwm, JumpingSkipsTheFade) {
+    backlight_pwm_fade_to(255);
+    run(BACKLIGHT_FADE_TIME / 2);
+    backlight_pwm_jump(0);
+    EXPECT_FALSE(backlight_pwm_animating());
+    EXPECT_EQ(0, backlight_pwm_duty());
+}
+
+TEST_F(BacklightPwm, JumpingStopsTheBreath) {
+    backlight_pwm_breathe(BACKLIGHT_PHASE_PEAK, BACKLIGHT_HALT_NONE);
+    run(100);
+    backlight_pwm_jump(0);
+    EXPECT_FALSE(backlight_pwm_breathing());
+    EXPECT_FALSE(backlight_pwm_animating());
+    run(1000);
+    EXPECT_EQ(0, duty);
+}
+
+TEST_F(BacklightPwm, BreathingGoesRound) {
+    backlight_pwm_breathe(0, BACKLIGHT_HALT_NONE);
+    run(1);
+    EXPECT_LT(duty, 0x10);
+    // 256 << 4 ms a breath, the brightest half way
+    run(2047);
+    EXPECT_EQ(0xFFFF, duty);
+    run(2048);
+    EXPECT_EQ(0, duty);
+    run(2048);
+    EXPECT_EQ(0xFFFF, duty);
+    EXPECT_TRUE(backlight_pwm_animating());
+    EXPECT_LE(max_change, SMOOTH);
+}
+
+TEST_F(BacklightPwm, BreathingPeaksAtTheIntensity) {
+    backlight_pwm_breathe_peak(127);
+    backlight_pwm_breathe(0, BACKLIGHT_HALT_NONE);
+    run(2048);
+    EXPECT_EQ(backlight_pwm_gamma(255 * 128), duty);
+}
+
+TEST_F(BacklightPwm, ChangingTheSpeedKeepsThePhase) {
+    backlight_pwm_breathe(0, BACKLIGHT_HALT_NONE);
+    run(1000);
+    backlight_pwm_breathe_speed(2);
+    run(1);
+    backlight_pwm_breathe_speed(6);
+    run(1);
+    EXPECT_LE(max_change, SMOOTH);
+    // 1024 ms a breath at speed 2
+    backlight_pwm_breathe_speed(2);
+    run(1024);
+    uint16_t before = duty;
+    run(1024);
+    EXPECT_NEAR(before, duty, 0x10);
+}
+
+TEST_F(BacklightPwm, PulseStopsAtThePeak) {
+    backlight_pwm_fade_to(255);
+    run(BACKLIGHT_FADE_TIME + 1);
+    backlight_pwm_breathe(BACKLIGHT_PHASE_PEAK + 0x100, BACKLIGHT_HALT_PEAK);
+    run(2048);
+    EXPECT_LT(duty, 0x100);
+    run(2048);
+    EXPECT_FALSE(backlight_pwm_breathing());
+    run(BACKLIGHT_FADE_TIME);
+    EXPECT_EQ(0xFFFF, duty);
+    EXPECT_FALSE(backlight_pwm_animating());
+    EXPECT_LE(max_change, SMOOTH);
+}
+
+TEST_F(BacklightPwm, SelfDisableStopsWhenDark) {
+    backlight_pwm_breathe(0, BACKLIGHT_HALT_NONE);
+    run(1000);
+    backlight_pwm_breathe_halt(BACKLIGHT_HALT_DARK);
+    run(2000);
+    EXPECT_TRUE(backlight_pwm_breathing());
+    run(1100);
+    EXPECT_FALSE(backlight_pwm_breathing());
+    EXPECT_EQ(0, duty);
+    run(1);
+    EXPECT_FALSE(backlight_pwm_animating());
+}
+
+TEST_F(BacklightPwm, StoppingFadesBackToTheLevel) {
+    backlight_pwm_fade_to(100);
+    backlight_pwm_breathe(0, BACKLIGHT_HALT_NONE);
+    run(2000);
+    backlight_pwm_breathe_stop();
+    run(BACKLIGHT_FADE_TIME);
+    EXPECT_EQ(backlight_pwm_gamma(100 * 257), duty);
+    EXPECT_FALSE(backlight_pwm_animating());
+    EXPECT_LE(max_change, SMOOTH);
+}
@@ -0,0 +1,165 @@
+/*
+ * Tests for the vertical counter debouncing
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <random>
+
+extern "C" {
+#include "debounce.h"
+}
+
+// The per key byte counters that the vertical counters replace
+class ReferenceDebounce {
+public:
+    ReferenceDebounce() {
+        for (auto& row : counters) {
+            for (auto& c : row) {
+                c = 0;
+            }
+        }
+    }
+
+    matrix_row_t update(uint8_t row, matrix_row_t debounced, matrix_row_t raw) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            matrix_row_t bit = (matrix_row_t)1 << col;
+            uint8_t& counter = counters[row][col];
+            if (counter) {
+                counter--;
+            } else if ((raw ^ debounced) & bit) {
+                debounced ^= bit;
+                counter = DEBOUNCE;
+            }
+        }
+        return debounced;
+    }
+
+private:
+    uint8_t counters[MATRIX_ROWS][MATRIX_COLS];
+};
+
+// Generates switches that are pressed and released at random, and that
+// chatter for a few scans around every transition
+class BounceTrace {
+public:
+    BounceTrace(uint32_t seed) : rng(seed) {
+        for (auto& row : keys) {
+            for (auto& key : row) {
+                key.state = false;
+                key.bounce = 0;
+            }
+        }
+    }
+
+    matrix_row_t read(uint8_t row) {
+        matrix_row_t value = 0;
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            key_t& key = keys[row][col];
+            if (key.bounce) {
+                key.bounce--;
+                if (rng() & 1) {
+                    value |= (matrix_row_t)1 << col;
+                }
+                continue;
+            }
+            if (rng() % 64 == 0) {
+                key.state = !key.state;
+                key.bounce = rng() % (DEBOUNCE + 3);
+            }
+            if (key.state) {
+                value |= (matrix_row_t)1 << col;
+            }
+        }
+        return value;
+    }
+
+private:
+    struct key_t {
+        bool state;
+        uint8_t bounce;
+    };
+    std::mt19937 rng;
+    key_t keys[MATRIX_ROWS][MATRIX_COLS];
+};
+
+class Debounce : public testing::Test {
+public:
+    Debounce() {
+        debounce_init();
+        for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+            matrix[i] = 0;
+            reference_matrix[i] = 0;
+        }
+    }
+
+    matrix_row_t matrix[MATRIX_ROWS];
+    matrix_row_t reference_matrix[MATRIX_ROWS];
+    ReferenceDebounce reference;
+};
+
+TEST_F(Debounce, APressIsReportedImmediately) {
+    EXPECT_EQ(debounce_row(0, 0, 1), 1);
+    EXPECT_TRUE(debounce_row_active(0));
+    EXPECT_FALSE(debounce_row_active(1));
+}
+
+TEST_F(Debounce, ChangesAreIgnoredForDebounceScans) {
+    matrix[0] = debounce_row(0, 0, 1);
+    for (int i = 0; i < DEBOUNCE; i++) {
+        matrix[0] = debounce_row(0, matrix[0], i & 1);
+        EXPECT_EQ(matrix[0], 1);
+    }
+    EXPECT_FALSE(debounce_row_active(0));
+    EXPECT_EQ(debounce_row(0, matrix[0], 0), 0);
+}
+
+TEST_F(Debounce, KeysHaveTheirOwnCounters) {
+    matrix_row_t last_col = (matrix_row_t)1 << (MATRIX_COLS - 1);
+    matrix[0] = debounce_row(0, 0, 1);
+    matrix[0] = debounce_row(0, matrix[0], 1 | last_col);
+    EXPECT_EQ(matrix[0], 1 | last_col);
+    for (int i = 0; i < DEBOUNCE; i++) {
+        matrix[0] = debounce_row(0, matrix[0], 0);
+    }
+    // The first key is free again, the last one still has a scan to go
+    EXPECT_EQ(matrix[0], last_col);
+    matrix[0] = debounce_row(0, matrix[0], 0);
+    EXPECT_EQ(matrix[0], 0);
+}
+
+TEST_F(Debounce, MatchesThePerKeyCountersOnRandomBounces) {
+    BounceTrace trace(12345);
+    for (int scan = 0; scan < 100000; scan++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            matrix_row_t raw = trace.read(row);
+            matrix[row] = debounce_row(row, matrix[row], raw);
+            reference_matrix[row] = reference.update(row, reference_matrix[row], raw);
+            ASSERT_EQ(matrix[row], reference_matrix[row]) << "scan " << scan << " row " << (int)row;
+        }
+    }
+}
+
+TEST_F(Debounce, MatchesThePerKeyCountersOnRandomNoise) {
+    std::mt19937 rng(54321);
+    for (int scan = 0; scan < 100000; scan++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            matrix_row_t raw = (matrix_row_t)rng();
+            matrix[row] = debounce_row(row, matrix[row], raw);
+            reference_matrix[row] = reference.update(row, reference_matrix[row], raw);
+            ASSERT_EQ(matrix[row], reference_matrix[row]) << "scan " << scan << " row " << (int)row;
+        }
+    }
+}
@@ -0,0 +1,135 @@
+/*
+ * Tests for the eeconfig write-back cache
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cstring>
+
+extern "C" {
+#include "eeconfig.h"
+#include "eeprom.h"
+    void set_time(uint32_t t);
+    void advance_time(uint32_t ms);
+    uint32_t eeprom_bytes_written(void);
+}
+
+class Eeconfig : public testing::Test {
+protected:
+    void SetUp() override {
+        set_time(0);
+        eeconfig_init();
+        written = eeprom_bytes_written();
+    }
+
+    // The main loop, for ms milliseconds
+    void run(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; i++) {
+            advance_time(1);
+            eeconfig_task();
+        }
+    }
+
+    uint32_t writes() {
+        return eeprom_bytes_written() - written;
+    }
+
+    uint32_t written;
+};
+
+TEST_F(Eeconfig, InitIsWrittenRightAway) {
+    eeconfig_update_backlight(3);
+    eeconfig_init();
+    EXPECT_EQ(0, eeconfig_pending_writes());
+    EXPECT_TRUE(eeconfig_is_enabled());
+    EXPECT_EQ(0, eeprom_read_byte(EECONFIG_BACKLIGHT));
+    EXPECT_EQ(0xFF, eeprom_read_byte(EECONFIG_AUDIO));
+
+    eeconfig_disable();
+    EXPECT_EQ(0, eeconfig_pending_writes());
+    EXPECT_FALSE(eeconfig_is_enabled());
+    EXPECT_EQ(0xFFFF, eeprom_read_word(EECONFIG_MAGIC));
+}
+
+TEST_F(Eeconfig, StepsAreWrittenOnceTheyStop) {
+    // Holding a key that steps the backlight, with the key repeating
+    for (uint8_t level = 1; level <= 20; level++) {
+        eeconfig_update_backlight(level);
+        run(100);
+        EXPECT_EQ(level, eeconfig_read_backlight());
+    }
+    EXPECT_EQ(0u, writes());
+    EXPECT_EQ(1, eeconfig_pending_writes());
+
+    run(EECONFIG_WRITE_DELAY);
+    EXPECT_EQ(1u, writes());
+    EXPECT_EQ(0, eeconfig_pending_writes());
+    EXPECT_EQ(20, eeprom_read_byte(EECONFIG_BACKLIGHT));
+}
+
+TEST_F(Eeconfig, ChangingBackIsNotWritten) {
+    eeconfig_update_audio(0);
+    run(100);
+    eeconfig_update_audio(0xFF);
+    EXPECT_EQ(0, eeconfig_pending_writes());
+    run(EECONFIG_WRITE_DELAY);
+    EXPECT_EQ(0u, writes());
+}
+
+TEST_F(Eeconfig, UnchangedSettingsAreNotWritten) {
+    eeconfig_update_keymap(0);
+    eeconfig_update_debug(0);
+    EXPECT_EQ(0, eeconfig_pending_writes());
+}
+
+TEST_F(Eeconfig, BlocksOnlyWriteTheChangedBytes) {
+    uint32_t config = 0x00123400;
+    eeconfig_update_block(&config, EECONFIG_RGBLIGHT, sizeof(config));
+    EXPECT_EQ(2, eeconfig_pending_writes());
+
+    uint32_t read = 0;
+    eeconfig_read_block(&read, EECONFIG_RGBLIGHT, sizeof(read));
+    EXPECT_EQ(config, read);
+    EXPECT_EQ(0u, eeprom_read_dword(EECONFIG_RGBLIGHT));
+
+    run(EECONFIG_WRITE_DELAY);
+    EXPECT_EQ(2u, writes());
+    EXPECT_EQ(config, eeprom_read_dword(EECONFIG_RGBLIGHT));
+}
+
+TEST_F(Eeconfig, FlushWritesRightAway) {
+    eeconfig_update_default_layer(2);
+    eeconfig_update_backlight(4);
+    EXPECT_EQ(2, eeconfig_pending_writes());
+    eeconfig_flush();
+    EXPECT_EQ(0, eeconfig_pending_writes());
+    EXPECT_EQ(2u, writes());
+    EXPECT_EQ(2, eeprom_read_byte(EECONFIG_DEFAULT_LAYER));
+    EXPECT_EQ(4, eeprom_read_byte(EECONFIG_BACKLIGHT));
+}
+
+TEST_F(Eeconfig, BytesPastEeconfigAreWrittenRightAway) {
+    uint8_t block[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t* addr = (uint8_t*)(EECONFIG_SIZE - 3);
+    eeconfig_update_block(block, addr, sizeof(block));
+    EXPECT_EQ(3, eeconfig_pending_writes());
+    EXPECT_EQ(5u, writes());
+    EXPECT_EQ(4, eeprom_read_byte(addr + 3));
+    EXPECT_EQ(8, eeprom_read_byte(addr + 7));
+
+    uint8_t read[8] = {};
+    eeconfig_read_block(read, addr, sizeof(read));
+    EXPECT_EQ(0, memcmp(block, read, sizeof(block)));
+}
@@ -0,0 +1,252 @@
+/*
+ * Tests for the EEPROM emulation in flash
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cstring>
+
+extern "C" {
+#include "flash_store.h"
+    void set_time(uint32_t t);
+    void advance_time(uint32_t ms);
+}
+
+// Two pages of flash, with counters and a power switch
+namespace {
+    uint16_t pages[2][FLASH_STORE_PAGE_SIZE / 2];
+    uint32_t erases;
+    uint32_t programs;
+    uint32_t reads;
+    // Operations before the power goes out, the next one is cut short
+    int32_t power_left;
+    bool powered;
+
+    // Only part of the bits made it
+    const uint16_t TORN_BITS = 0x5555;
+
+    bool power_cut() {
+        if (!powered) {
+            return true;
+        }
+        if (power_left >= 0 && power_left-- == 0) {
+            powered = false;
+            return true;
+        }
+        return false;
+    }
+}
+
+extern "C" {
+    uint16_t flash_store_read_halfword(uint8_t page, uint16_t offset) {
+        reads++;
+        return pages[page][offset / 2];
+    }
+
+    void flash_store_program_halfword(uint8_t page, uint16_t offset, uint16_t value) {
+        if (!powered) {
+            return;
+        }
+        uint16_t &cell = pages[page][offset / 2];
+        if (cell != 0xFFFF && value != 0) {
+            ADD_FAILURE() << "Programmed page " << (int)page << " offset " << offset << " twice";
+        }
+        programs++;
+        cell = power_cut() ? value | TORN_BITS : value;
+    }
+
+    void flash_store_erase_page(uint8_t page) {
+        if (!powered) {
+            return;
+        }
+        erases++;
+        size_t halfwords = FLASH_STORE_PAGE_SIZE / 2;
+        if (power_cut()) {
+            halfwords /= 2;
+        }
+        for (size_t i = 0; i < halfwords; i++) {
+            pages[page][i] = 0xFFFF;
+        }
+    }
+}
+
+class FlashStore : public testing::Test {
+protected:
+    void SetUp() override {
+        set_time(0);
+        memset(pages, 0xFF, sizeof(pages));
+        reboot();
+    }
+
+    void reboot() {
+        powered = true;
+        power_left = -1;
+        flash_store_init();
+        erases = 0;
+        programs = 0;
+        reads = 0;
+    }
+
+    void idle() {
+        advance_time(FLASH_STORE_IDLE_TIME);
+        flash_store_task();
+        flash_store_task();
+    }
+};
+
+TEST_F(FlashStore, NewStoreReadsErased) {
+    for (uint16_t addr = 0; addr < FLASH_STORE_SIZE; addr++) {
+        EXPECT_EQ(0xFF, flash_store_read_byte(addr));
+    }
+}
+
+TEST_F(FlashStore, GarbageIsFormatted) {
+    memset(pages, 0x12, sizeof(pages));
+    reboot();
+    EXPECT_EQ(0xFF, flash_store_read_byte(0));
+    flash_store_write_byte(0, 3);
+    reboot();
+    EXPECT_EQ(3, flash_store_read_byte(0));
+}
+
+TEST_F(FlashStore, WritesSurviveAReboot) {
+    for (uint16_t addr = 0; addr < FLASH_STORE_SIZE; addr++) {
+        flash_store_write_byte(addr, addr * 3);
+    }
+    reboot();
+    for (uint16_t addr = 0; addr < FLASH_STORE_SIZE; addr++) {
+        EXPECT_EQ((uint8_t)(addr * 3), flash_store_read_byte(addr));
+    }
+}
+
+TEST_F(FlashStore, WritesAreAppendedWithoutErasing) {
+    flash_store_write_byte(1, 10);
+    flash_store_write_byte(1, 11);
+    flash_store_write_byte(2, 0);
+    EXPECT_EQ(0u, erases);
+    EXPECT_EQ(6u, programs);
+}
+
+TEST_F(FlashStore, UnchangedValuesAreNotWritten) {
+    flash_store_write_byte(1, 10);
+    flash_store_write_byte(1, 10);
+    flash_store_write_byte(2, 0xFF);
+    EXPECT_EQ(2u, programs);
+}
+
+TEST_F(FlashStore, ReadsDontTouchTheFlash) {
+    flash_store_write_byte(4, 1);
+    reads = 0;
+    for (uint16_t addr = 0; addr < FLASH_STORE_SIZE; addr++) {
+        flash_store_read_byte(addr);
+    }
+    EXPECT_EQ(0u, reads);
+}
+
+TEST_F(FlashStore, ErasesAreSpreadOverManyWrites) {
+    const uint32_t writes = 10000;
+    for (uint32_t i = 0; i < writes; i++) {
+        flash_store_write_byte(i % 4, i);
+        if (i % 20 == 0) {
+            idle();
+        }
+    }
+    reboot();
+    for (uint16_t addr = 0; addr < 4; addr++) {
+        EXPECT_EQ((uint8_t)(writes - 4 + addr), flash_store_read_byte(addr));
+    }
+    // Each copy moves at most every value, the rest of the page is for writes
+    const uint32_t records = (FLASH_STORE_PAGE_SIZE - 4) / 4;
+    EXPECT_LE(erases, writes / (records - FLASH_STORE_SIZE) + 1);
+}
+
+TEST_F(FlashStore, SparePageIsErasedWhileIdle) {
+    uint32_t inline_erases = 0;
+    for (uint32_t i = 0; i < 1000; i++) {
+        uint32_t before = erases;
+        flash_store_write_byte(i % FLASH_STORE_SIZE, i);
+        inline_erases += erases - before;
+        if (i % 30 == 0) {
+            idle();
+        }
+    }
+    EXPECT_EQ(0u, inline_erases);
+    EXPECT_GT(erases, 0u);
+}
+
+TEST_F(FlashStore, NothingHappensWhileTyping) {
+    for (uint32_t i = 0; i < 1000; i++) {
+        flash_store_write_byte(i % FLASH_STORE_SIZE, i);
+        advance_time(100);
+        flash_store_task();
+    }
+    uint32_t before = programs + erases;
+    advance_time(FLASH_STORE_IDLE_TIME - 200);
+    flash_store_task();
+    EXPECT_EQ(before, programs + erases);
+}
+
+// Replays the same writes with the power going out at every step
+TEST_F(FlashStore, PowerLossKeepsTheOldOrTheNewValue) {
+    const uint32_t writes = 150;
+    uint32_t cut = 0;
+    bool cut_happened = true;
+    while (cut_happened) {
+        memset(pages, 0xFF, sizeof(pages));
+        reboot();
+        power_left = cut;
+
+        uint8_t expected[FLASH_STORE_SIZE];
+        memset(expected, 0xFF, sizeof(expected));
+        int interrupted = -1;
+        uint8_t interrupted_value = 0;
+        for (uint32_t i = 0; i < writes && powered; i++) {
+            uint8_t addr = (i * 7) % FLASH_STORE_SIZE;
+            uint8_t value = i;
+            flash_store_write_byte(addr, value);
+            if (!powered) {
+                interrupted = addr;
+                interrupted_value = value;
+                break;
+            }
+            expected[addr] = value;
+            if (i % 25 == 24) {
+                idle();
+            }
+        }
+        cut_happened = !powered;
+
+        reboot();
+        for (uint16_t addr = 0; addr < FLASH_STORE_SIZE; addr++) {
+            uint8_t value = flash_store_read_byte(addr);
+            if (addr == interrupted && value == interrupted_value) {
+                continue;
+            }
+            EXPECT_EQ(expected[addr], value) << "address " << addr << " cut at " << cut;
+        }
+
+        // And the store is still usable
+        for (uint16_t addr = 0; addr < FLASH_STORE_SIZE; addr++) {
+            flash_store_write_byte(addr, addr);
+        }
+        idle();
+        reboot();
+        for (uint16_t addr = 0; addr < FLASH_STORE_SIZE; addr++) {
+            EXPECT_EQ(addr, flash_store_read_byte(addr)) << "cut at " << cut;
+        }
+        cut++;
+    }
+    EXPECT_GT(cut, 300u);
+}
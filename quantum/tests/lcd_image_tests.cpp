@@ -0,0 +1,131 @@
+/*
+ * Tests for the run length encoded LCD images
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "lcd_image.h"
+extern const uint8_t resource_lcd_logo[];
+}
+
+// lcd_logo.png as it was drawn before it was compressed, 1 bit a pixel,
+// left to right and top to bottom
+static const uint8_t original_logo[512] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0xf8, 0xfe, 0x3e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x38, 0x38, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x38, 0x38, 0x38, 0x06, 0x29, 0x41, 0x24, 0x52, 0x24, 0x46, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x38, 0x38, 0x38, 0x09, 0x55, 0x42, 0xaa, 0xaa, 0xaa, 0xa8, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x38, 0x38, 0x38, 0x09, 0x55, 0x82, 0x28, 0xaa, 0xae, 0x8c, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x38, 0x38, 0x38, 0x09, 0x55, 0x43, 0x28, 0xaa, 0xaa, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x38, 0x38, 0x38, 0x0a, 0x55, 0x42, 0x28, 0xaa, 0xaa, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x38, 0x38, 0x38, 0x05, 0x45, 0x42, 0x28, 0x89, 0x4a, 0x86, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x18, 0x38, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x1c, 0x38, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x0e, 0x38, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x03, 0xff, 0x80, 0x04, 0x45, 0x14, 0xa4, 0x92, 0x83, 0x52, 0x22, 0x22, 0x36, 0x00, 0x00,
+    0x00, 0x00, 0x38, 0x00, 0x0a, 0xaa, 0xaa, 0xaa, 0xba, 0x84, 0x55, 0x55, 0x57, 0x45, 0x00, 0x00,
+    0x00, 0x00, 0x38, 0x00, 0x08, 0xaa, 0xaa, 0xaa, 0x92, 0xb2, 0x55, 0x55, 0x42, 0x65, 0x00, 0x00,
+    0x00, 0x00, 0x38, 0x00, 0x08, 0xaa, 0xaa, 0xaa, 0x92, 0x81, 0x56, 0x65, 0x42, 0x45, 0x00, 0x00,
+    0x00, 0x00, 0x38, 0x00, 0x0a, 0xaa, 0xaa, 0xaa, 0x92, 0x81, 0x54, 0x45, 0x42, 0x45, 0x00, 0x00,
+    0x00, 0x00, 0x38, 0x00, 0x04, 0x48, 0xa2, 0x4a, 0x89, 0x06, 0x24, 0x42, 0x41, 0x36, 0x00, 0x00,
+    0x00, 0x00, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static bool page_pixel(const std::vector<uint8_t>& pages, int stride, int x, int y) {
+    return pages[y / 8 * stride + x] & (1 << (y % 8));
+}
+
+TEST(LcdImage, TheLogoDecodesToTheOriginal) {
+    ASSERT_EQ(128, resource_lcd_logo[0]);
+    ASSERT_EQ(32, resource_lcd_logo[1]);
+    std::vector<uint8_t> pages(128 * 4, 0x5A);
+    lcd_image_decode(resource_lcd_logo, pages.data(), 128);
+    for (int y = 0; y < 32; y++) {
+        for (int x = 0; x < 128; x++) {
+            bool expected = original_logo[(y * 128 + x) / 8] & (0x80 >> (x % 8));
+            ASSERT_EQ(expected, page_pixel(pages, 128, x, y)) << "x " << x << " y " << y;
+        }
+    }
+}
+
+TEST(LcdImage, LiteralsAndRunsOfAllLengths) {
+    // 128 literal bytes, a run of 130, one literal and a run of 3
+    std::vector<uint8_t> image = {131, 16, 0x7F};
+    for (int i = 0; i < 128; i++) {
+        image.push_back(i);
+    }
+    image.push_back(0xFF);
+    image.push_back(0xAA);
+    image.push_back(0x00);
+    image.push_back(0x42);
+    image.push_back(0x80);
+    image.push_back(0x11);
+    // Past the end of the image, never read
+    image.push_back(0xFF);
+    image.push_back(0xFF);
+
+    std::vector<uint8_t> pages(2 * 131, 0x33);
+    lcd_image_decode(image.data(), pages.data(), 131);
+    for (int i = 0; i < 128; i++) {
+        ASSERT_EQ(i, pages[i]);
+    }
+    for (int i = 128; i < 258; i++) {
+        ASSERT_EQ(0xAA, pages[i]) << i;
+    }
+    EXPECT_EQ(0x42, pages[258]);
+    EXPECT_EQ(0x11, pages[259]);
+    EXPECT_EQ(0x11, pages[260]);
+    EXPECT_EQ(0x11, pages[261]);
+}
+
+TEST(LcdImage, RowsBelowTheImageAreKept) {
+    // 2x5, all set
+    const uint8_t image[] = {2, 5, 0x01, 0xFF, 0xFF};
+    std::vector<uint8_t> pages = {0xA0, 0x40, 0x77};
+    lcd_image_decode(image, pages.data(), 3);
+    EXPECT_EQ(0xBF, pages[0]);
+    EXPECT_EQ(0x5F, pages[1]);
+    EXPECT_EQ(0x77, pages[2]);
+}
+
+TEST(LcdImage, PagesAreStrideApart) {
+    // 3x16 in a 10 byte wide buffer
+    const uint8_t image[] = {3, 16, 0x80, 0x0F, 0x80, 0xF0};
+    std::vector<uint8_t> pages(20, 0x00);
+    lcd_image_decode(image, pages.data(), 10);
+    std::vector<uint8_t> expected = {
+        0x0F, 0x0F, 0x0F, 0, 0, 0, 0, 0, 0, 0,
+        0xF0, 0xF0, 0xF0, 0, 0, 0, 0, 0, 0, 0,
+    };
+    EXPECT_EQ(expected, pages);
+}
@@ -0,0 +1,89 @@
+/*
+ * Tests for the integer LED backlight kernels
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cmath>
+
+extern "C" {
+#include "led_backlight_kernels.h"
+}
+
+// What the gradients used to compute in floating point
+static uint8_t float_gradient_color(float t, float index, float num) {
+    const float two_pi = M_PI * 2.0f;
+    float normalized_index = (1.0f - index / (num - 1.0f)) * two_pi;
+    float x = t * two_pi + normalized_index;
+    float v = 0.5 * (cosf(x) + 1.0f);
+    return (uint8_t)(255.0f * v);
+}
+
+TEST(LedBacklightKernels, GradientMatchesTheFloatVersion) {
+    const int frame_length = 1000;
+    const int nums[] = {5, 7, 9, 16};
+    for (int num : nums) {
+        for (int pos = 0; pos <= frame_length; pos++) {
+            uint16_t phase = led_gradient_phase(pos, frame_length);
+            float t = (float)pos / frame_length;
+            for (int i = 0; i < num; i++) {
+                int expected = float_gradient_color(t, i, num);
+                int actual = led_gradient_color(phase + led_gradient_offset(i, num));
+                ASSERT_NEAR(expected, actual, 1) << "num " << num << " pos " << pos << " index " << i;
+            }
+        }
+    }
+}
+
+TEST(LedBacklightKernels, GradientEnds) {
+    EXPECT_EQ(255, led_gradient_color(0));
+    EXPECT_EQ(0, led_gradient_color(0x8000));
+    EXPECT_EQ(0u, led_gradient_offset(6, 7));
+    EXPECT_EQ(0u, led_gradient_offset(0, 1));
+    // A whole turn is the same as none
+    EXPECT_EQ(0u, led_gradient_offset(0, 7));
+    EXPECT_EQ(0u, led_gradient_phase(1000, 1000));
+}
+
+// What the crossfade used to compute with a division for each LED
+static uint8_t divided_crossfade_color(int from, int to, int current_pos, int frame_length) {
+    return from + ((to - from) * current_pos) / frame_length;
+}
+
+TEST(LedBacklightKernels, CrossfadeMatchesTheDividedVersion) {
+    const int frame_lengths[] = {100, 500, 1000, 5000};
+    for (int frame_length : frame_lengths) {
+        for (int pos = 0; pos <= frame_length; pos += 3) {
+            uint16_t weight = led_crossfade_weight(pos, frame_length);
+            for (int from = 0; from < 256; from += 5) {
+                for (int to = 0; to < 256; to += 7) {
+                    int expected = divided_crossfade_color(from, to, pos, frame_length);
+                    int actual = led_crossfade_color(from, to, weight);
+                    ASSERT_NEAR(expected, actual, 1) << "from " << from << " to " << to << " pos " << pos;
+                }
+            }
+        }
+    }
+}
+
+TEST(LedBacklightKernels, CrossfadeEnds) {
+    EXPECT_EQ(10, led_crossfade_color(10, 200, led_crossfade_weight(0, 500)));
+    EXPECT_EQ(200, led_crossfade_color(10, 200, led_crossfade_weight(500, 500)));
+    EXPECT_EQ(0, led_crossfade_color(255, 0, led_crossfade_weight(500, 500)));
+    // Past the end of the frame stays at the end
+    EXPECT_EQ(256u, led_crossfade_weight(510, 500));
+    EXPECT_EQ(105, led_crossfade_color(10, 200, led_crossfade_weight(250, 500)));
+    EXPECT_EQ(105, led_crossfade_color(200, 10, led_crossfade_weight(250, 500)));
+}
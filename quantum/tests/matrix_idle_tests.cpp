@@ -0,0 +1,177 @@
+/*
+ * Tests for stopping the matrix scans while idle
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "matrix_idle.h"
+    void set_time(uint32_t t);
+    void advance_time(uint32_t ms);
+}
+
+// A simulated matrix with the col interrupt
+static bool key_down;
+static bool armed;
+static int arm_count;
+static int scan_count;
+
+extern "C" {
+    bool matrix_idle_arm(void) {
+        arm_count++;
+        if (key_down) {
+            return false;
+        }
+        armed = true;
+        return true;
+    }
+
+    void matrix_idle_disarm(void) {
+        armed = false;
+    }
+}
+
+class MatrixIdle : public testing::Test {
+public:
+    MatrixIdle() {
+        key_down = false;
+        armed = false;
+        arm_count = 0;
+        scan_count = 0;
+        set_time(0);
+        matrix_idle_init(true);
+    }
+
+    // One pass of the keyboard task, a ms apart
+    void task() {
+        if (matrix_idle_should_scan()) {
+            scan_count++;
+            matrix_idle_scanned(key_down);
+        }
+        advance_time(1);
+    }
+
+    void run(int ms) {
+        for (int i = 0; i < ms; i++) {
+            task();
+        }
+    }
+
+    // Simulates a key press, which raises the interrupt when armed
+    void press() {
+        key_down = true;
+        if (armed) {
+            armed = false;
+            matrix_idle_wake();
+        }
+    }
+
+    void release() {
+        key_down = false;
+    }
+};
+
+TEST_F(MatrixIdle, KeepsScanningBeforeTheTimeout) {
+    run(MATRIX_IDLE_TIMEOUT);
+    EXPECT_EQ(scan_count, MATRIX_IDLE_TIMEOUT);
+    EXPECT_FALSE(matrix_idle_is_asleep());
+    EXPECT_EQ(arm_count, 0);
+}
+
+TEST_F(MatrixIdle, SleepsAfterTheTimeout) {
+    run(MATRIX_IDLE_TIMEOUT + 1);
+    EXPECT_TRUE(matrix_idle_is_asleep());
+    EXPECT_TRUE(armed);
+    EXPECT_EQ(arm_count, 1);
+    int scans = scan_count;
+    run(10000);
+    EXPECT_EQ(scan_count, scans);
+    EXPECT_EQ(arm_count, 1);
+}
+
+TEST_F(MatrixIdle, ScansImmediatelyOnWake) {
+    run(MATRIX_IDLE_TIMEOUT + 100);
+    ASSERT_TRUE(matrix_idle_is_asleep());
+    int scans = scan_count;
+    press();
+    task();
+    EXPECT_EQ(scan_count, scans + 1);
+    EXPECT_FALSE(matrix_idle_is_asleep());
+    EXPECT_FALSE(armed);
+}
+
+TEST_F(MatrixIdle, StaysAwakeWhileAKeyIsHeld) {
+    press();
+    run(MATRIX_IDLE_TIMEOUT * 10);
+    EXPECT_FALSE(matrix_idle_is_asleep());
+    EXPECT_EQ(scan_count, MATRIX_IDLE_TIMEOUT * 10);
+    EXPECT_EQ(arm_count, 0);
+}
+
+TEST_F(MatrixIdle, TimeoutStartsFromTheRelease) {
+    press();
+    run(1000);
+    release();
+    run(MATRIX_IDLE_TIMEOUT - 1);
+    EXPECT_FALSE(matrix_idle_is_asleep());
+    run(2);
+    EXPECT_TRUE(matrix_idle_is_asleep());
+}
+
+TEST_F(MatrixIdle, GoesBackToSleepAfterWaking) {
+    run(MATRIX_IDLE_TIMEOUT + 1);
+    press();
+    run(50);
+    release();
+    run(MATRIX_IDLE_TIMEOUT + 1);
+    EXPECT_TRUE(matrix_idle_is_asleep());
+    EXPECT_EQ(arm_count, 2);
+}
+
+TEST_F(MatrixIdle, KeyDownWhileArmingKeepsScanning) {
+    run(MATRIX_IDLE_TIMEOUT);
+    // The key goes down between the last scan and arming, without an edge
+    key_down = true;
+    matrix_idle_scanned(false);
+    EXPECT_FALSE(matrix_idle_is_asleep());
+    EXPECT_EQ(arm_count, 1);
+    task();
+    EXPECT_FALSE(matrix_idle_is_asleep());
+}
+
+TEST_F(MatrixIdle, WakeBeforeSleepIsIgnored) {
+    matrix_idle_wake();
+    run(MATRIX_IDLE_TIMEOUT + 1);
+    EXPECT_TRUE(matrix_idle_is_asleep());
+    int scans = scan_count;
+    run(100);
+    EXPECT_EQ(scan_count, scans);
+}
+
+TEST_F(MatrixIdle, NeverSleepsWhenNotAllowed) {
+    matrix_idle_init(false);
+    run(MATRIX_IDLE_TIMEOUT * 10);
+    EXPECT_FALSE(matrix_idle_is_asleep());
+    EXPECT_EQ(arm_count, 0);
+}
+
+TEST_F(MatrixIdle, SleepsAcrossTimerWraparound) {
+    set_time(0xFFFF - 100);
+    matrix_idle_init(true);
+    // TIMER_DIFF_16 comes up a ms short across the wraparound
+    run(MATRIX_IDLE_TIMEOUT + 2);
+    EXPECT_TRUE(matrix_idle_is_asleep());
+}
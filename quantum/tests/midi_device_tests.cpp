@@ -0,0 +1,289 @@
+/*
+ * Tests for the MIDI device queues
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <vector>
+
+extern "C" {
+#include "midi.h"
+}
+
+// What the transport got, one vector of events for each batch
+static std::vector<std::vector<midi_output_event_t>> batches;
+// How many batches the transport takes before it's busy
+static int ready;
+static int max_batch;
+
+static uint8_t batch_send(MidiDevice* device, const midi_output_event_t* events, uint8_t count) {
+    if (ready == 0) {
+        return 0;
+    }
+    ready--;
+    if (count > max_batch) {
+        count = max_batch;
+    }
+    batches.emplace_back(events, events + count);
+    return count;
+}
+
+static std::vector<std::vector<uint8_t>> sent;
+
+static void send(MidiDevice* device, uint16_t count, uint8_t byte0, uint8_t byte1, uint8_t byte2) {
+    std::vector<uint8_t> bytes = {byte0, byte1, byte2};
+    bytes.resize(count);
+    sent.push_back(bytes);
+}
+
+static std::vector<std::vector<uint8_t>> received;
+
+static void cc_callback(MidiDevice* device, uint8_t chan, uint8_t num, uint8_t val) {
+    received.push_back({chan, num, val});
+}
+
+class MidiQueue : public testing::Test {
+protected:
+    void SetUp() override {
+        batches.clear();
+        sent.clear();
+        received.clear();
+        ready = 1000;
+        max_batch = MIDI_OUTPUT_QUEUE_LENGTH;
+        midi_device_init(&device);
+        midi_device_set_batch_send_func(&device, batch_send);
+    }
+
+    // One pass of the main loop, where the transport takes one batch
+    void frame() {
+        ready = 1;
+        midi_device_process(&device);
+    }
+
+    size_t batched_events() {
+        size_t events = 0;
+        for (auto& batch : batches) {
+            events += batch.size();
+        }
+        return events;
+    }
+
+    MidiDevice device;
+};
+
+TEST_F(MidiQueue, WithoutBatchingEachEventIsSentRightAway) {
+    midi_device_init(&device);
+    midi_device_set_send_func(&device, send);
+    midi_send_noteon(&device, 1, 60, 100);
+    ASSERT_EQ(1u, sent.size());
+    EXPECT_EQ(std::vector<uint8_t>({MIDI_NOTEON | 1, 60, 100}), sent[0]);
+}
+
+TEST_F(MidiQueue, EventsWaitForTheFrame) {
+    midi_send_noteon(&device, 0, 60, 100);
+    midi_send_noteon(&device, 0, 64, 100);
+    midi_send_clock(&device);
+    EXPECT_TRUE(batches.empty());
+    frame();
+    ASSERT_EQ(1u, batches.size());
+    ASSERT_EQ(3u, batches[0].size());
+    EXPECT_EQ(MIDI_NOTEON, batches[0][0].data[0]);
+    EXPECT_EQ(64, batches[0][1].data[1]);
+    EXPECT_EQ(1, batches[0][2].count);
+    EXPECT_EQ(MIDI_CLOCK, batches[0][2].data[0]);
+    frame();
+    EXPECT_EQ(1u, batches.size());
+}
+
+TEST_F(MidiQueue, AFullQueueGoesOutAsItFills) {
+    ready = 1;
+    // An arpeggio of 20 notes in one frame, 16 fit in a batch
+    for (int i = 0; i < 20; i++) {
+        midi_send_noteon(&device, 0, 40 + i, 100);
+    }
+    ASSERT_EQ(1u, batches.size());
+    EXPECT_EQ(16u, batches[0].size());
+    frame();
+    ASSERT_EQ(2u, batches.size());
+    ASSERT_EQ(4u, batches[1].size());
+    EXPECT_EQ(40 + 19, batches[1][3].data[1]);
+    EXPECT_EQ(0, midi_device_output_drops(&device));
+}
+
+TEST_F(MidiQueue, WhatTheTransportDoesntTakeWaits) {
+    max_batch = 3;
+    for (int i = 0; i < 5; i++) {
+        midi_send_noteon(&device, 0, 40 + i, 100);
+    }
+    frame();
+    EXPECT_EQ(3u, batched_events());
+    frame();
+    ASSERT_EQ(5u, batched_events());
+    EXPECT_EQ(44, batches[1][1].data[1]);
+}
+
+TEST_F(MidiQueue, EventsAreDroppedAndCountedWhenTheTransportIsBusy) {
+    ready = 0;
+    for (int i = 0; i < 20; i++) {
+        midi_send_noteon(&device, 0, 40 + i, 100);
+    }
+    EXPECT_EQ(4, midi_device_output_drops(&device));
+    frame();
+    ASSERT_EQ(16u, batched_events());
+    // The oldest are kept
+    EXPECT_EQ(40 + 15, batches[0][15].data[1]);
+}
+
+TEST_F(MidiQueue, AControllerSweepSendsTheLatestValue) {
+    for (int i = 0; i < 100; i++) {
+        midi_send_cc(&device, 2, 7, i);
+        midi_send_cc(&device, 2, 10, 127 - i);
+    }
+    midi_send_cc(&device, 3, 7, 5);
+    frame();
+    ASSERT_EQ(3u, batched_events());
+    EXPECT_EQ(99, batches[0][0].data[2]);
+    EXPECT_EQ(127 - 99, batches[0][1].data[2]);
+    EXPECT_EQ(MIDI_CC | 3, batches[0][2].data[0]);
+    EXPECT_EQ(0, midi_device_output_drops(&device));
+}
+
+TEST_F(MidiQueue, ControllersAreNotMovedPastOtherEvents) {
+    midi_send_cc(&device, 0, 64, 127);
+    midi_send_noteon(&device, 0, 60, 100);
+    midi_send_cc(&device, 0, 64, 0);
+    midi_send_cc(&device, 0, 64, 1);
+    frame();
+    ASSERT_EQ(3u, batched_events());
+    EXPECT_EQ(127, batches[0][0].data[2]);
+    EXPECT_EQ(1, batches[0][2].data[2]);
+}
+
+TEST_F(MidiQueue, RpnWritesAreAllSent) {
+    // Pitch bend range, then fine tuning
+    midi_send_cc(&device, 0, 101, 0);
+    midi_send_cc(&device, 0, 100, 0);
+    midi_send_cc(&device, 0, 6, 12);
+    midi_send_cc(&device, 0, 101, 0);
+    midi_send_cc(&device, 0, 100, 1);
+    midi_send_cc(&device, 0, 6, 64);
+    midi_send_cc(&device, 0, 96, 0);
+    midi_send_cc(&device, 0, 96, 0);
+    frame();
+    ASSERT_EQ(8u, batched_events());
+    EXPECT_EQ(12, batches[0][2].data[2]);
+    EXPECT_EQ(1, batches[0][4].data[2]);
+    EXPECT_EQ(64, batches[0][5].data[2]);
+    EXPECT_EQ(96, batches[0][7].data[1]);
+}
+
+TEST_F(MidiQueue, ControllersAreNotMovedPastAnRpnSelect) {
+    midi_send_cc(&device, 0, 7, 10);
+    midi_send_cc(&device, 0, 101, 0);
+    midi_send_cc(&device, 0, 7, 20);
+    frame();
+    ASSERT_EQ(3u, batched_events());
+    EXPECT_EQ(10, batches[0][0].data[2]);
+    EXPECT_EQ(20, batches[0][2].data[2]);
+}
+
+TEST_F(MidiQueue, ASentControllerIsNotUpdated) {
+    midi_send_cc(&device, 0, 1, 10);
+    frame();
+    midi_send_cc(&device, 0, 1, 20);
+    frame();
+    ASSERT_EQ(2u, batches.size());
+    EXPECT_EQ(10, batches[0][0].data[2]);
+    EXPECT_EQ(20, batches[1][0].data[2]);
+}
+
+TEST_F(MidiQueue, SysexIsQueuedInOrder) {
+    uint8_t sysex[] = {SYSEX_BEGIN, 1, 2, 3, 4, SYSEX_END};
+    midi_send_array(&device, sizeof(sysex), sysex);
+    frame();
+    ASSERT_EQ(2u, batched_events());
+    EXPECT_EQ(SYSEX_BEGIN, batches[0][0].data[0]);
+    EXPECT_EQ(3, batches[0][1].count);
+    EXPECT_EQ(SYSEX_END, batches[0][1].data[2]);
+}
+
+TEST_F(MidiQueue, InputIsProcessedInOrder) {
+    midi_register_cc_callback(&device, cc_callback);
+    uint8_t input[] = {MIDI_CC | 1, 7, 100, MIDI_CLOCK, MIDI_CC | 2, 8, 50};
+    midi_device_input(&device, sizeof(input), input);
+    EXPECT_TRUE(received.empty());
+    midi_device_process(&device);
+    ASSERT_EQ(2u, received.size());
+    EXPECT_EQ(std::vector<uint8_t>({1, 7, 100}), received[0]);
+    EXPECT_EQ(std::vector<uint8_t>({2, 8, 50}), received[1]);
+}
+
+TEST_F(MidiQueue, InputThatDoesntFitIsDropped) {
+    midi_register_cc_callback(&device, cc_callback);
+    std::vector<uint8_t> input;
+    for (int i = 0; i < 50; i++) {
+        input.insert(input.end(), {MIDI_CC, (uint8_t)i, 1});
+    }
+    midi_device_input(&device, input.size(), input.data());
+    midi_device_process(&device);
+    // 127 bytes, 42 whole messages
+    ASSERT_EQ(42u, received.size());
+    EXPECT_EQ(41, received.back()[1]);
+}
+
+static std::vector<uint8_t> serialize(const std::vector<midi_output_event_t>& events) {
+    uint8_t running_status = 0;
+    std::vector<uint8_t> bytes;
+    for (auto& event : events) {
+        uint8_t out[3];
+        uint8_t n = midi_running_status_encode(&running_status, &event, out);
+        bytes.insert(bytes.end(), out, out + n);
+    }
+    return bytes;
+}
+
+TEST(MidiRunningStatus, RepeatedStatusBytesAreLeftOut) {
+    std::vector<midi_output_event_t> events = {
+        {3, {MIDI_NOTEON, 60, 100}},
+        {3, {MIDI_NOTEON, 64, 100}},
+        {1, {MIDI_CLOCK}},
+        {3, {MIDI_NOTEON, 67, 100}},
+        {3, {MIDI_NOTEON | 1, 60, 100}},
+        {2, {MIDI_PROGCHANGE | 1, 5}},
+        {2, {MIDI_PROGCHANGE | 1, 6}},
+    };
+    std::vector<uint8_t> expected = {
+        MIDI_NOTEON, 60, 100, 64, 100, MIDI_CLOCK, 67, 100,
+        MIDI_NOTEON | 1, 60, 100, MIDI_PROGCHANGE | 1, 5, 6,
+    };
+    EXPECT_EQ(expected, serialize(events));
+}
+
+TEST(MidiRunningStatus, SystemMessagesClearIt) {
+    std::vector<midi_output_event_t> events = {
+        {3, {MIDI_CC, 1, 2}},
+        {3, {SYSEX_BEGIN, 1, 2}},
+        {1, {SYSEX_END}},
+        {3, {MIDI_CC, 1, 3}},
+        {2, {MIDI_SONGSELECT, 1}},
+        {3, {MIDI_CC, 1, 4}},
+        {3, {MIDI_CC, 1, 5}},
+    };
+    std::vector<uint8_t> expected = {
+        MIDI_CC, 1, 2, SYSEX_BEGIN, 1, 2, SYSEX_END, MIDI_CC, 1, 3,
+        MIDI_SONGSELECT, 1, MIDI_CC, 1, 4, 1, 5,
+    };
+    EXPECT_EQ(expected, serialize(events));
+}
@@ -0,0 +1,149 @@
+/*
+ * Tests for the rgblight effects
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cmath>
+#include <cstring>
+
+extern "C" {
+#include "rgblight.h"
+#include "led_tables.h"
+    void set_time(uint32_t t);
+    void advance_time(uint32_t ms);
+    void eeconfig_init(void);
+    extern const uint16_t RGBLED_GRADIENT_RANGES[];
+
+    void ws2812_setleds(LED_TYPE *leds, uint16_t count) {
+    }
+}
+
+// The effects as they were computed with divisions and floats, the integer
+// versions have to show the same pixels
+static LED_TYPE reference_hsv(uint16_t hue, uint8_t sat, uint8_t val) {
+    uint8_t r = 0, g = 0, b = 0, base, color;
+
+    if (sat == 0) {
+        r = val;
+        g = val;
+        b = val;
+    } else {
+        base = ((255 - sat) * val) >> 8;
+        color = (val - base) * (hue % 60) / 60;
+
+        switch (hue / 60) {
+            case 0: r = val;         g = base + color; b = base;         break;
+            case 1: r = val - color; g = val;          b = base;         break;
+            case 2: r = base;        g = val;          b = base + color; break;
+            case 3: r = base;        g = val - color;  b = val;          break;
+            case 4: r = base + color; g = base;        b = val;          break;
+            case 5: r = val;         g = base;         b = val - color;  break;
+        }
+    }
+    LED_TYPE led = {};
+    led.r = CIE1931_CURVE[r];
+    led.g = CIE1931_CURVE[g];
+    led.b = CIE1931_CURVE[b];
+    return led;
+}
+
+static uint8_t reference_breathing(uint8_t pos) {
+    float val = (exp(sin((pos/255.0)*M_PI)) - RGBLIGHT_EFFECT_BREATHE_CENTER/M_E)*(RGBLIGHT_EFFECT_BREATHE_MAX/(M_E-1/M_E));
+    return val;
+}
+
+static bool same_led(const LED_TYPE &a, const LED_TYPE &b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+class RgblightEffects : public testing::Test {
+protected:
+    void SetUp() override {
+        set_time(0);
+        eeconfig_init();
+        rgblight_init();
+        rgblight_timer_disable();
+        rgblight_mode(1);
+        rgblight_sethsv(hue, sat, val);
+    }
+
+    const uint16_t hue = 200;
+    const uint8_t sat = 230;
+    const uint8_t val = 255;
+};
+
+TEST_F(RgblightEffects, SethsvMatchesReference) {
+    LED_TYPE led;
+    for (uint16_t hue = 0; hue < 360; hue++) {
+        for (uint16_t sat = 0; sat < 256; sat++) {
+            for (uint16_t val = 0; val < 256; val++) {
+                sethsv(hue, sat, val, &led);
+                LED_TYPE expected = reference_hsv(hue, sat, val);
+                ASSERT_TRUE(same_led(expected, led)) << "hsv " << hue << "," << sat << "," << val;
+            }
+        }
+    }
+}
+
+TEST_F(RgblightEffects, BreathingIsWithinOneStepOfReference) {
+    int exact = 0;
+    // Twice round the cycle, the effect keeps its position between calls
+    for (int i = 0; i < 512; i++) {
+        advance_time(pgm_read_byte(&RGBLED_BREATHING_INTERVALS[0]));
+        rgblight_effect_breathing(0);
+
+        uint8_t expected = reference_breathing(i % 256);
+        bool within_one = false;
+        for (int v = expected - 1; v <= expected + 1; v++) {
+            if (v >= 0 && v <= 255 && same_led(reference_hsv(hue, sat, v), led[0])) {
+                within_one = true;
+                exact += v == expected;
+            }
+        }
+        EXPECT_TRUE(within_one) << "position " << i % 256;
+        EXPECT_TRUE(same_led(led[0], led[RGBLED_NUM - 1]));
+    }
+    // Off by one only where the float lands right next to a whole number
+    EXPECT_GE(exact, 500);
+}
+
+TEST_F(RgblightEffects, SwirlMatchesReference) {
+    for (uint16_t current_hue = 0; current_hue < 400; current_hue++) {
+        advance_time(pgm_read_byte(&RGBLED_RAINBOW_SWIRL_INTERVALS[0]));
+        rgblight_effect_rainbow_swirl(1);
+        for (uint8_t i = 0; i < RGBLED_NUM; i++) {
+            uint16_t expected_hue = (360 / RGBLED_NUM * i + current_hue % 360) % 360;
+            ASSERT_TRUE(same_led(reference_hsv(expected_hue, sat, val), led[i]))
+                << "frame " << current_hue << " LED " << (int)i;
+        }
+    }
+}
+
+TEST_F(RgblightEffects, GradientMatchesReference) {
+    for (uint8_t mode = 25; mode <= 34; mode++) {
+        rgblight_mode(mode);
+        int8_t direction = ((mode - 25) % 2) ? -1 : 1;
+        uint16_t range = pgm_read_word(&RGBLED_GRADIENT_RANGES[(mode - 25) / 2]);
+        for (uint16_t hue = 0; hue < 360; hue += 7) {
+            rgblight_sethsv(hue, sat, val);
+            for (uint8_t i = 0; i < RGBLED_NUM; i++) {
+                uint16_t expected_hue = (range / RGBLED_NUM * i * direction + hue + 360) % 360;
+                ASSERT_TRUE(same_led(reference_hsv(expected_hue, sat, val), led[i]))
+                    << "mode " << (int)mode << " hue " << hue << " LED " << (int)i;
+            }
+        }
+    }
+}
@@ -0,0 +1,276 @@
+/*
+ * Tests for the layers drawn over the rgblight colors
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "rgblight.h"
+#include "rgblight_layers.h"
+    void set_time(uint32_t t);
+    void advance_time(uint32_t ms);
+    void eeconfig_init(void);
+
+    static LED_TYPE strip[RGBLED_NUM];
+    static uint32_t frames_sent;
+
+    void ws2812_setleds(LED_TYPE *leds, uint16_t count) {
+        memcpy(strip, leds, count * sizeof(LED_TYPE));
+        frames_sent++;
+    }
+}
+
+// Fills every LED it may draw on with one color
+struct SolidLayer {
+    rgblight_layer_t layer;
+    uint8_t r, g, b;
+    uint32_t renders;
+};
+
+static bool solid_render(rgblight_layer_t *layer) {
+    SolidLayer *solid = (SolidLayer *)layer;
+    solid->renders++;
+    for (uint8_t i = 0; i < RGBLED_NUM; i++) {
+        rgblight_layer_set(i, solid->r, solid->g, solid->b);
+    }
+    return false;
+}
+
+// LEDs 0-7 and 16
+static const uint8_t test_mask[(RGBLED_NUM + 7) / 8] = { 0xFF, 0x00, 0x01 };
+
+static keypos_t key_at(uint8_t col) {
+    keypos_t key = { col, 0 };
+    return key;
+}
+
+class RgblightLayers : public testing::Test {
+protected:
+    void SetUp() override {
+        set_time(0);
+        eeconfig_init();
+        rgblight_init();
+        rgblight_mode(1);
+        set_base(0, 0, 0);
+        frames_sent = 0;
+    }
+
+    void TearDown() override {
+        for (rgblight_layer_t *layer : added) {
+            rgblight_layers_remove(layer);
+        }
+        added.clear();
+    }
+
+    void add(rgblight_layer_t *layer) {
+        rgblight_layers_add(layer);
+        added.push_back(layer);
+    }
+
+    void set_base(uint8_t r, uint8_t g, uint8_t b) {
+        rgblight_setrgb(r, g, b);
+        run(100);
+    }
+
+    void run(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; i++) {
+            advance_time(1);
+            rgblight_task();
+        }
+    }
+
+    void expect_strip(uint8_t index, uint8_t r, uint8_t g, uint8_t b) {
+        EXPECT_EQ(r, strip[index].r) << "LED " << (int)index;
+        EXPECT_EQ(g, strip[index].g) << "LED " << (int)index;
+        EXPECT_EQ(b, strip[index].b) << "LED " << (int)index;
+    }
+
+    bool strip_is_lit(uint8_t index) {
+        return strip[index].r || strip[index].g || strip[index].b;
+    }
+
+    std::vector<rgblight_layer_t *> added;
+};
+
+TEST_F(RgblightLayers, WithoutLayersTheStripShowsLed) {
+    set_base(1, 2, 3);
+    for (uint8_t i = 0; i < RGBLED_NUM; i++) {
+        expect_strip(i, 1, 2, 3);
+    }
+}
+
+TEST_F(RgblightLayers, MaskLimitsTheLayer) {
+    SolidLayer solid = { { solid_render, NULL, test_mask, RGBLIGHT_BLEND_REPLACE, true }, 200, 0, 0 };
+    set_base(1, 2, 3);
+    add(&solid.layer);
+    run(100);
+
+    for (uint8_t i = 0; i < RGBLED_NUM; i++) {
+        if (i < 8 || i == 16) {
+            expect_strip(i, 200, 0, 0);
+        } else {
+            expect_strip(i, 1, 2, 3);
+        }
+        // The layers never touch led[]
+        EXPECT_EQ(1, led[i].r);
+    }
+}
+
+TEST_F(RgblightLayers, BlendModes) {
+    SolidLayer solid = { { solid_render, NULL, NULL, RGBLIGHT_BLEND_ADD, true }, 200, 50, 128 };
+    set_base(100, 100, 100);
+    add(&solid.layer);
+    run(100);
+    expect_strip(0, 255, 150, 228);
+
+    solid.layer.blend = RGBLIGHT_BLEND_MAX;
+    rgblight_layers_refresh();
+    run(100);
+    expect_strip(0, 200, 100, 128);
+
+    solid.layer.blend = RGBLIGHT_BLEND_MULTIPLY;
+    rgblight_layers_refresh();
+    run(100);
+    expect_strip(0, 78, 19, 50);
+}
+
+TEST_F(RgblightLayers, LayersStackInTheOrderTheyWereAdded) {
+    SolidLayer red = { { solid_render, NULL, NULL, RGBLIGHT_BLEND_REPLACE, true }, 200, 0, 0 };
+    SolidLayer half = { { solid_render, NULL, test_mask, RGBLIGHT_BLEND_MULTIPLY, true }, 127, 127, 127 };
+    add(&red.layer);
+    add(&half.layer);
+    run(100);
+    expect_strip(0, 100, 0, 0);
+    expect_strip(8, 200, 0, 0);
+
+    half.layer.enabled = false;
+    rgblight_layers_refresh();
+    run(100);
+    expect_strip(0, 200, 0, 0);
+}
+
+TEST_F(RgblightLayers, BaseChangesShowThroughTheLayers) {
+    SolidLayer solid = { { solid_render, NULL, test_mask, RGBLIGHT_BLEND_REPLACE, true }, 200, 0, 0 };
+    add(&solid.layer);
+    run(100);
+    set_base(5, 5, 5);
+    expect_strip(0, 200, 0, 0);
+    expect_strip(8, 5, 5, 5);
+}
+
+TEST_F(RgblightLayers, StaticLayersAreOnlyDrawnForNewFrames) {
+    SolidLayer solid = { { solid_render, NULL, NULL, RGBLIGHT_BLEND_REPLACE, true }, 200, 0, 0 };
+    add(&solid.layer);
+    run(100);
+    uint32_t renders = solid.renders;
+    frames_sent = 0;
+    run(1000);
+    EXPECT_EQ(renders, solid.renders);
+    EXPECT_EQ(0u, frames_sent);
+}
+
+TEST_F(RgblightLayers, KeyStaysLitWhileHeldThenFades) {
+    rgblight_reactive_t reactive = RGBLIGHT_REACTIVE(0, 255, 255, 300, 0);
+    add(&reactive.layer);
+    run(100);
+
+    rgblight_layers_key_event(key_at(5), true);
+    run(20);
+    // 15 columns over 60 LEDs
+    expect_strip(20, 255, 0, 0);
+    EXPECT_FALSE(strip_is_lit(19));
+    EXPECT_FALSE(strip_is_lit(21));
+    run(1000);
+    expect_strip(20, 255, 0, 0);
+
+    rgblight_layers_key_event(key_at(5), false);
+    run(150);
+    EXPECT_GT(strip[20].r, 0);
+    EXPECT_LT(strip[20].r, 255);
+    run(200);
+    EXPECT_FALSE(strip_is_lit(20));
+
+    // Nothing to send once the fade is over
+    frames_sent = 0;
+    run(1000);
+    EXPECT_EQ(0u, frames_sent);
+}
+
+TEST_F(RgblightLayers, RippleSpreadsFromTheKey) {
+    rgblight_reactive_t reactive = RGBLIGHT_REACTIVE(120, 255, 255, 500, 4);
+    add(&reactive.layer);
+    run(100);
+
+    rgblight_layers_key_event(key_at(5), true);
+    rgblight_layers_key_event(key_at(5), false);
+    run(20);
+    EXPECT_TRUE(strip_is_lit(20));
+
+    run(250);
+    // 270 ms in, 270 * 5 / 500 == 2 LEDs out
+    EXPECT_FALSE(strip_is_lit(20));
+    EXPECT_TRUE(strip_is_lit(18));
+    EXPECT_TRUE(strip_is_lit(22));
+    EXPECT_GT(strip[18].g, 0);
+
+    run(300);
+    for (uint8_t i = 0; i < RGBLED_NUM; i++) {
+        EXPECT_FALSE(strip_is_lit(i)) << "LED " << (int)i;
+    }
+}
+
+TEST_F(RgblightLayers, RippleStopsAtTheEndsOfTheStrip) {
+    rgblight_reactive_t reactive = RGBLIGHT_REACTIVE(120, 255, 255, 500, 4);
+    add(&reactive.layer);
+    run(100);
+
+    rgblight_layers_key_event(key_at(14), true);
+    run(450);
+    // LED 56, 4 LEDs out would be 60 which isn't on the strip
+    EXPECT_TRUE(strip_is_lit(52));
+    for (uint8_t i = 53; i < RGBLED_NUM; i++) {
+        EXPECT_FALSE(strip_is_lit(i)) << "LED " << (int)i;
+    }
+}
+
+TEST_F(RgblightLayers, ManyKeysReuseTheOldestHit) {
+    rgblight_reactive_t reactive = RGBLIGHT_REACTIVE(0, 255, 255, 1000, 1);
+    add(&reactive.layer);
+    run(100);
+
+    for (uint8_t col = 0; col < RGBLIGHT_REACTIVE_HITS + 1; col++) {
+        rgblight_layers_key_event(key_at(col), true);
+        run(10);
+    }
+    // The first key made way for the last one
+    EXPECT_FALSE(strip_is_lit(0));
+    EXPECT_TRUE(strip_is_lit(RGBLIGHT_REACTIVE_HITS * 4));
+}
+
+TEST_F(RgblightLayers, NothingIsShownWhileDisabled) {
+    rgblight_reactive_t reactive = RGBLIGHT_REACTIVE(0, 255, 255, 300, 0);
+    add(&reactive.layer);
+    rgblight_toggle();
+    run(100);
+
+    rgblight_layers_key_event(key_at(5), true);
+    run(100);
+    EXPECT_FALSE(strip_is_lit(20));
+    rgblight_layers_key_event(key_at(5), false);
+    rgblight_toggle();
+}
@@ -0,0 +1,198 @@
+/*
+ * Tests for the rgblight frame sending
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <cstring>
+
+extern "C" {
+#include "rgblight.h"
+#include "eeprom.h"
+    void set_time(uint32_t t);
+    void advance_time(uint32_t ms);
+    void eeconfig_init(void);
+    uint32_t eeprom_bytes_written(void);
+
+    // What a WS2812 strip would show, the LEDs past the data sent keep
+    // their color
+    static LED_TYPE strip[RGBLED_NUM];
+    static uint32_t frames_sent;
+    static uint32_t bytes_sent;
+
+    void ws2812_setleds(LED_TYPE *leds, uint16_t count) {
+        memcpy(strip, leds, count * sizeof(LED_TYPE));
+        frames_sent++;
+        bytes_sent += count * sizeof(LED_TYPE);
+    }
+}
+
+class Rgblight : public testing::Test {
+protected:
+    void SetUp() override {
+        set_time(0);
+        eeconfig_init();
+        rgblight_init();
+        // Let the first frame out
+        run(100);
+        frames_sent = 0;
+        bytes_sent = 0;
+    }
+
+    // The main loop, for ms milliseconds
+    void run(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; i++) {
+            advance_time(1);
+            rgblight_task();
+        }
+    }
+
+    // Stops the effect and lets the last frame out
+    void settle() {
+        rgblight_timer_disable();
+        run(100);
+    }
+
+    void expect_strip_shows_leds() {
+        for (uint8_t i = 0; i < RGBLED_NUM; i++) {
+            EXPECT_EQ(0, memcmp(&strip[i], &led[i], sizeof(LED_TYPE))) << "LED " << (int)i;
+        }
+    }
+};
+
+TEST_F(Rgblight, IdenticalFramesAreSkipped) {
+    rgblight_setrgb(10, 20, 30);
+    run(100);
+    EXPECT_EQ(1u, frames_sent);
+    EXPECT_EQ(3u * RGBLED_NUM, bytes_sent);
+
+    rgblight_setrgb(10, 20, 30);
+    run(100);
+    EXPECT_EQ(1u, frames_sent);
+    expect_strip_shows_leds();
+}
+
+TEST_F(Rgblight, OnlyTheChangedPrefixIsSent) {
+    rgblight_setrgb(10, 20, 30);
+    run(100);
+    led[4].r = 0;
+    rgblight_set();
+    run(100);
+    EXPECT_EQ(2u, frames_sent);
+    EXPECT_EQ(3u * RGBLED_NUM + 3u * 5, bytes_sent);
+    expect_strip_shows_leds();
+}
+
+TEST_F(Rgblight, FramesAreRateLimited) {
+    for (int i = 0; i < 100; i++) {
+        rgblight_setrgb(i, 0, 0);
+    }
+    EXPECT_EQ(1u, frames_sent);
+    // The last color shows once it's time for the next frame
+    run(1000 / RGBLIGHT_MAX_FPS);
+    EXPECT_EQ(2u, frames_sent);
+    EXPECT_EQ(99, strip[0].r);
+    expect_strip_shows_leds();
+}
+
+TEST_F(Rgblight, DisablingClearsTheStrip) {
+    rgblight_setrgb(10, 20, 30);
+    run(100);
+    rgblight_toggle();
+    run(100);
+    for (uint8_t i = 0; i < RGBLED_NUM; i++) {
+        EXPECT_EQ(0, strip[i].r);
+        EXPECT_EQ(0, strip[i].g);
+        EXPECT_EQ(0, strip[i].b);
+    }
+    rgblight_toggle();
+}
+
+struct Effect {
+    const char *name;
+    uint8_t mode;
+};
+
+static const Effect effects[] = {
+    {"breathing", 5},
+    {"rainbow mood", 8},
+    {"rainbow swirl", 14},
+    {"snake", 20},
+    {"knight", 23},
+    {"christmas", 24},
+};
+
+TEST_F(Rgblight, EffectsShowEveryFrame) {
+    for (const Effect &effect : effects) {
+        rgblight_mode(effect.mode);
+        for (int i = 0; i < 20; i++) {
+            rgblight_timer_enable();
+            run(97);
+            // Only the LEDs that changed were sent, but the strip shows the
+            // whole last frame
+            settle();
+            expect_strip_shows_leds();
+        }
+    }
+}
+
+TEST_F(Rgblight, RefreshBytesPerEffect) {
+    for (const Effect &effect : effects) {
+        rgblight_mode(effect.mode);
+        run(100);
+        frames_sent = 0;
+        bytes_sent = 0;
+        run(10000);
+        printf("%-14s %5.1f frames/s %7.1f bytes/frame (full frame %u bytes)\n", effect.name,
+               frames_sent / 10.0, frames_sent ? (double)bytes_sent / frames_sent : 0.0,
+               (unsigned)(3 * RGBLED_NUM));
+        EXPECT_LE(frames_sent, 10000u / (1000 / RGBLIGHT_MAX_FPS) + 1) << effect.name;
+    }
+
+    // Snake and knight only move a few LEDs
+    for (uint8_t mode : {20, 23}) {
+        rgblight_mode(mode);
+        run(100);
+        frames_sent = 0;
+        bytes_sent = 0;
+        run(10000);
+        EXPECT_GT(frames_sent, 0u);
+        EXPECT_LT(bytes_sent, frames_sent * 3u * RGBLED_NUM * 3 / 4) << (int)mode;
+    }
+}
+
+TEST_F(Rgblight, HoldingAHueKeyWritesTheEepromOnce) {
+    uint32_t written = eeprom_bytes_written();
+    // RGB_HUI held down, with the key repeating every 50ms
+    for (int i = 0; i < 40; i++) {
+        rgblight_increase_hue();
+        for (int ms = 0; ms < 50; ms++) {
+            advance_time(1);
+            rgblight_task();
+            eeconfig_task();
+        }
+    }
+    EXPECT_EQ(written, eeprom_bytes_written());
+    EXPECT_GT(eeconfig_pending_writes(), 0);
+
+    for (int i = 0; i < EECONFIG_WRITE_DELAY; i++) {
+        advance_time(1);
+        eeconfig_task();
+    }
+    EXPECT_EQ(0, eeconfig_pending_writes());
+    EXPECT_LE(eeprom_bytes_written() - written, 4u);
+    EXPECT_EQ(rgblight_read_dword(), eeprom_read_dword(EECONFIG_RGBLIGHT));
+}
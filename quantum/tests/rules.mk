@@ -0,0 +1,140 @@
+quantum_matrix_idle_SRC :=\
+	$(QUANTUM_PATH)/tests/matrix_idle_tests.cpp \
+	$(QUANTUM_PATH)/matrix_idle.c \
+	$(TMK_PATH)/common/test/timer.c
+
+quantum_debounce_SRC :=\
+	$(QUANTUM_PATH)/tests/debounce_tests.cpp \
+	$(QUANTUM_PATH)/debounce.c
+quantum_debounce_DEFS := -DMATRIX_ROWS=4 -DMATRIX_COLS=32 -DDEBOUNCE=5
+
+quantum_debounce_long_SRC := $(quantum_debounce_SRC)
+quantum_debounce_long_DEFS := -DMATRIX_ROWS=4 -DMATRIX_COLS=8 -DDEBOUNCE=31
+
+quantum_eeconfig_SRC :=\
+	$(QUANTUM_PATH)/tests/eeconfig_tests.cpp \
+	$(TMK_PATH)/common/eeconfig.c \
+	$(TMK_PATH)/common/test/eeprom.c \
+	$(TMK_PATH)/common/test/timer.c
+quantum_eeconfig_DEFS := -DBACKLIGHT_ENABLE -DAUDIO_ENABLE -DRGBLIGHT_ENABLE
+
+quantum_backlight_pwm_SRC :=\
+	$(QUANTUM_PATH)/tests/backlight_pwm_tests.cpp \
+	$(QUANTUM_PATH)/backlight_pwm.c \
+	$(QUANTUM_PATH)/led_tables.c \
+	$(TMK_PATH)/common/test/timer.c
+quantum_backlight_pwm_DEFS := -DUSE_CIE1931_CURVE -DUSE_LED_BREATHING_TABLE
+
+quantum_ws2812_encode_SRC :=\
+	$(QUANTUM_PATH)/tests/ws2812_encode_tests.cpp \
+	$(DRIVER_PATH)/arm/ws2812_encode.c
+quantum_ws2812_encode_INC := $(DRIVER_PATH)/arm
+quantum_ws2812_encode_DEFS := -DRGBLED_NUM=60
+
+quantum_flash_store_SRC :=\
+	$(QUANTUM_PATH)/tests/flash_store_tests.cpp \
+	$(TMK_PATH)/common/flash_store.c \
+	$(TMK_PATH)/common/test/timer.c
+quantum_flash_store_DEFS := -DFLASH_STORE_SIZE=16 -DFLASH_STORE_PAGE_SIZE=256
+
+quantum_rgblight_SRC :=\
+	$(QUANTUM_PATH)/tests/rgblight_tests.cpp \
+	$(QUANTUM_PATH)/rgblight.c \
+	$(QUANTUM_PATH)/led_tables.c \
+	$(TMK_PATH)/common/eeconfig.c \
+	$(TMK_PATH)/common/debug.c \
+	$(TMK_PATH)/common/test/eeprom.c \
+	$(TMK_PATH)/common/test/timer.c
+quantum_rgblight_INC := $(DRIVER_PATH)/avr
+quantum_rgblight_DEFS := -DRGBLED_NUM=60 -DRGBLIGHT_ANIMATIONS -DRGBLIGHT_ENABLE -DUSE_CIE1931_CURVE -DNO_PRINT -DNO_DEBUG
+
+quantum_rgblight_effects_SRC :=\
+	$(QUANTUM_PATH)/tests/rgblight_effects_tests.cpp \
+	$(filter-out %/rgblight_tests.cpp,$(quantum_rgblight_SRC))
+quantum_rgblight_effects_INC := $(quantum_rgblight_INC)
+quantum_rgblight_effects_DEFS := $(quantum_rgblight_DEFS)
+
+# The breathing curve of the Clueboard 66
+quantum_rgblight_breathe_SRC := $(quantum_rgblight_effects_SRC)
+quantum_rgblight_breathe_INC := $(quantum_rgblight_INC)
+quantum_rgblight_breathe_DEFS := -DRGBLED_NUM=14 -DRGBLIGHT_ANIMATIONS -DRGBLIGHT_ENABLE -DUSE_CIE1931_CURVE -DNO_PRINT -DNO_DEBUG -DRGBLIGHT_EFFECT_BREATHE_CENTER=1 -DRGBLIGHT_EFFECT_BREATHE_MAX=200
+
+quantum_rgblight_layers_SRC :=\
+	$(QUANTUM_PATH)/tests/rgblight_layers_tests.cpp \
+	$(QUANTUM_PATH)/rgblight_layers.c \
+	$(filter-out %/rgblight_tests.cpp,$(quantum_rgblight_SRC))
+quantum_rgblight_layers_INC := $(quantum_rgblight_INC)
+quantum_rgblight_layers_DEFS := $(quantum_rgblight_DEFS) -DRGBLIGHT_LAYERS -DMATRIX_ROWS=5 -DMATRIX_COLS=15
+
+quantum_ugfx_st7565_SRC :=\
+	$(QUANTUM_PATH)/tests/ugfx_st7565_tests.cpp \
+	$(DRIVER_PATH)/ugfx/gdisp/st7565/gdisp_lld_ST7565.c \
+	$(QUANTUM_PATH)/visualizer/lcd_image.c
+quantum_ugfx_st7565_INC := $(QUANTUM_PATH)/tests/ugfx $(DRIVER_PATH)/ugfx/gdisp/st7565 $(QUANTUM_PATH)/visualizer
+quantum_ugfx_st7565_DEFS := -DLCD_WIDTH=128 -DLCD_HEIGHT=32
+
+quantum_ugfx_is31fl3731c_SRC :=\
+	$(QUANTUM_PATH)/tests/ugfx_is31fl3731c_tests.cpp \
+	$(DRIVER_PATH)/ugfx/gdisp/is31fl3731c/gdisp_is31fl3731c.c \
+	$(QUANTUM_PATH)/led_tables.c
+quantum_ugfx_is31fl3731c_INC := $(QUANTUM_PATH)/tests/ugfx $(DRIVER_PATH)/ugfx/gdisp/is31fl3731c
+quantum_ugfx_is31fl3731c_DEFS := -DLED_WIDTH=7 -DLED_HEIGHT=7 -DUSE_CIE1931_CURVE
+
+quantum_ssd1306_SRC :=\
+	$(QUANTUM_PATH)/tests/ssd1306_tests.cpp \
+	$(DRIVER_PATH)/avr/ssd1306.c \
+	$(TMK_PATH)/common/test/timer.c
+quantum_ssd1306_INC := $(QUANTUM_PATH)/tests/ssd1306 $(DRIVER_PATH)/avr
+quantum_ssd1306_DEFS := -DSSD1306OLED -DNO_PRINT -DNO_DEBUG
+
+quantum_ssd1306_incremental_SRC := $(quantum_ssd1306_SRC)
+quantum_ssd1306_incremental_INC := $(quantum_ssd1306_INC)
+quantum_ssd1306_incremental_DEFS := $(quantum_ssd1306_DEFS) -DSSD1306_INCREMENTAL_RENDER
+
+quantum_visualizer_animations_SRC :=\
+	$(QUANTUM_PATH)/tests/visualizer_animations_tests.cpp \
+	$(QUANTUM_PATH)/visualizer/visualizer_animations.c \
+	$(TMK_PATH)/common/test/timer.c
+quantum_visualizer_animations_INC := $(QUANTUM_PATH)/visualizer
+
+quantum_led_backlight_kernels_SRC :=\
+	$(QUANTUM_PATH)/tests/led_backlight_kernels_tests.cpp \
+	$(QUANTUM_PATH)/visualizer/led_backlight_kernels.c
+quantum_led_backlight_kernels_INC := $(QUANTUM_PATH)/visualizer
+
+quantum_lcd_image_SRC :=\
+	$(QUANTUM_PATH)/tests/lcd_image_tests.cpp \
+	$(QUANTUM_PATH)/visualizer/lcd_image.c \
+	$(QUANTUM_PATH)/visualizer/resources/lcd_logo.c
+quantum_lcd_image_INC := $(QUANTUM_PATH)/visualizer
+
+quantum_visualizer_emulator_SRC :=\
+	$(QUANTUM_PATH)/tests/visualizer_emulator_tests.cpp \
+	$(QUANTUM_PATH)/tests/ugfx/emulator.c \
+	$(QUANTUM_PATH)/visualizer/visualizer.c \
+	$(QUANTUM_PATH)/visualizer/visualizer_animations.c \
+	$(QUANTUM_PATH)/visualizer/visualizer_keyframes.c \
+	$(QUANTUM_PATH)/serial_link/protocol/triple_buffered_object.c \
+	$(QUANTUM_PATH)/visualizer/led_backlight_keyframes.c \
+	$(QUANTUM_PATH)/visualizer/led_backlight_kernels.c \
+	$(QUANTUM_PATH)/visualizer/default_animations.c \
+	$(DRIVER_PATH)/ugfx/gdisp/is31fl3731c/gdisp_is31fl3731c.c \
+	$(QUANTUM_PATH)/led_tables.c
+quantum_visualizer_emulator_INC := $(QUANTUM_PATH)/tests/ugfx $(QUANTUM_PATH)/visualizer $(DRIVER_PATH)/ugfx/gdisp/is31fl3731c
+quantum_visualizer_emulator_DEFS := -DEMULATOR -DVISUALIZER_ENABLE -DBACKLIGHT_ENABLE -DNO_ACTION_ONESHOT \
+	-DLED_WIDTH=7 -DLED_HEIGHT=7 -DLED_DISPLAY_NUMBER=0 -DUSE_CIE1931_CURVE
+
+quantum_spsc_ring_SRC :=\
+	$(QUANTUM_PATH)/tests/spsc_ring_tests.cpp
+quantum_spsc_ring_INC := $(TMK_PATH)
+
+quantum_midi_device_SRC :=\
+	$(QUANTUM_PATH)/tests/midi_device_tests.cpp \
+	$(TMK_PATH)/protocol/midi/midi_device.c \
+	$(TMK_PATH)/protocol/midi/midi.c
+quantum_midi_device_INC := $(TMK_PATH)/protocol/midi
+
+quantum_sysex_tools_SRC :=\
+	$(QUANTUM_PATH)/tests/sysex_tools_tests.cpp \
+	$(TMK_PATH)/protocol/midi/sysex_tools.c
+quantum_sysex_tools_INC := $(TMK_PATH)/protocol/midi
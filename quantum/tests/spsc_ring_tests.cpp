@@ -0,0 +1,202 @@
+/*
+ * Tests for the single producer, single consumer ring
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "spsc_ring.h"
+}
+#include "protocol/lufa/ringbuffer.hpp"
+
+TEST(SpscRing, HoldsOneLessThanItsSize) {
+    uint8_t data[8];
+    spsc_ring_t ring = SPSC_RING_INITIALIZER(data);
+    EXPECT_EQ(7, spsc_ring_space(&ring));
+    for (int i = 0; i < 7; i++) {
+        EXPECT_TRUE(spsc_ring_push(&ring, i));
+    }
+    EXPECT_FALSE(spsc_ring_push(&ring, 7));
+    EXPECT_EQ(7, spsc_ring_count(&ring));
+    EXPECT_EQ(0, spsc_ring_space(&ring));
+    for (int i = 0; i < 7; i++) {
+        uint8_t byte;
+        ASSERT_TRUE(spsc_ring_pop(&ring, &byte));
+        EXPECT_EQ(i, byte);
+    }
+    uint8_t byte;
+    EXPECT_FALSE(spsc_ring_pop(&ring, &byte));
+}
+
+TEST(SpscRing, BulkPushAndPopWrapAround) {
+    uint8_t data[16];
+    spsc_ring_t ring;
+    spsc_ring_init(&ring, data, sizeof(data));
+    uint8_t in[20];
+    for (int i = 0; i < 20; i++) {
+        in[i] = 100 + i;
+    }
+    uint8_t out[20];
+    EXPECT_EQ(10, spsc_ring_push_bulk(&ring, in, 10));
+    EXPECT_EQ(10, spsc_ring_pop_bulk(&ring, out, 20));
+    // Across the end of the buffer, only 15 fit
+    EXPECT_EQ(15, spsc_ring_push_bulk(&ring, in, 20));
+    EXPECT_EQ(0, spsc_ring_push_bulk(&ring, in, 1));
+    EXPECT_EQ(4, spsc_ring_pop_bulk(&ring, out, 4));
+    EXPECT_EQ(11, spsc_ring_pop_bulk(&ring, out + 4, 20));
+    for (int i = 0; i < 15; i++) {
+        EXPECT_EQ(in[i], out[i]);
+    }
+}
+
+TEST(SpscRing, PeekSkipAndClear) {
+    uint8_t data[4];
+    spsc_ring_t ring = SPSC_RING_INITIALIZER(data);
+    spsc_ring_push(&ring, 1);
+    spsc_ring_push(&ring, 2);
+    spsc_ring_push(&ring, 3);
+    uint8_t byte = 0;
+    EXPECT_TRUE(spsc_ring_peek(&ring, 2, &byte));
+    EXPECT_EQ(3, byte);
+    EXPECT_FALSE(spsc_ring_peek(&ring, 3, &byte));
+    spsc_ring_skip(&ring, 2);
+    EXPECT_TRUE(spsc_ring_peek(&ring, 0, &byte));
+    EXPECT_EQ(3, byte);
+    spsc_ring_skip(&ring, 5);
+    EXPECT_EQ(0, spsc_ring_count(&ring));
+    spsc_ring_push(&ring, 4);
+    spsc_ring_clear(&ring);
+    EXPECT_FALSE(spsc_ring_pop(&ring, &byte));
+}
+
+TEST(SpscRing, TheFullByteRange) {
+    uint8_t data[256];
+    spsc_ring_t ring;
+    spsc_ring_init(&ring, data, sizeof(data));
+    for (int i = 0; i < 255; i++) {
+        ASSERT_TRUE(spsc_ring_push(&ring, i));
+    }
+    EXPECT_FALSE(spsc_ring_push(&ring, 0));
+    EXPECT_EQ(255, spsc_ring_count(&ring));
+    uint8_t byte;
+    spsc_ring_pop(&ring, &byte);
+    EXPECT_EQ(0, byte);
+    EXPECT_TRUE(spsc_ring_push(&ring, 255));
+}
+
+static const uint32_t STRESS_BYTES = 20000000;
+
+// One thread pushes a counting sequence in bursts of all lengths, the other
+// pops it in bursts of other lengths, any byte lost, repeated or out of
+// order breaks the sequence. Either side yields when it can't go on, for
+// when the two share a core
+TEST(SpscRing, TwoThreads) {
+    static uint8_t data[64];
+    spsc_ring_t ring = SPSC_RING_INITIALIZER(data);
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer([&ring]() {
+        uint8_t burst[37];
+        uint32_t sent = 0;
+        uint8_t length = 1;
+        while (sent < STRESS_BYTES) {
+            uint8_t n = length;
+            if (n > STRESS_BYTES - sent) {
+                n = STRESS_BYTES - sent;
+            }
+            uint8_t pushed;
+            if (n == 1) {
+                pushed = spsc_ring_push(&ring, sent);
+            } else {
+                for (uint8_t i = 0; i < n; i++) {
+                    burst[i] = sent + i;
+                }
+                pushed = spsc_ring_push_bulk(&ring, burst, n);
+            }
+            if (!pushed) {
+                std::this_thread::yield();
+            }
+            sent += pushed;
+            length = length % sizeof(burst) + 1;
+        }
+    });
+
+    uint32_t received = 0;
+    uint32_t errors = 0;
+    uint8_t burst[23];
+    uint8_t length = 1;
+    while (received < STRESS_BYTES) {
+        uint8_t n = spsc_ring_pop_bulk(&ring, burst, length);
+        for (uint8_t i = 0; i < n; i++) {
+            if (burst[i] != (uint8_t)(received + i)) {
+                errors++;
+            }
+        }
+        if (!n) {
+            std::this_thread::yield();
+        }
+        received += n;
+        length = length % sizeof(burst) + 1;
+    }
+    producer.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(0u, errors);
+    EXPECT_EQ(0, spsc_ring_count(&ring));
+    printf("spsc_ring      %6.1f MB/s\n", STRESS_BYTES / seconds / 1e6);
+}
+
+struct Item {
+    uint32_t sequence;
+    uint32_t check;
+};
+
+TEST(SpscRing, RingBufferTwoThreads) {
+    static RingBuffer<Item, 32> ring;
+    const uint32_t items = STRESS_BYTES / 8;
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer([items]() {
+        for (uint32_t i = 0; i < items;) {
+            if (ring.enqueue(Item{i, ~i})) {
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < items;) {
+        Item item;
+        if (ring.peek(item)) {
+            Item popped;
+            ring.get(popped);
+            if (item.sequence != i || item.check != ~i || popped.sequence != i) {
+                errors++;
+            }
+            i++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(0u, errors);
+    EXPECT_TRUE(ring.empty());
+    printf("RingBuffer     %6.1f M items/s\n", items / seconds / 1e6);
+}
@@ -0,0 +1,274 @@
+/*
+ * Tests for the SSD1306 OLED driver
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "ssd1306.h"
+#include "glcdfont.c"
+}
+
+static const uint8_t ADDRESS = SSD1306_ADDRESS << 1;
+
+// The display on the other end of the bus, in horizontal addressing mode
+static struct {
+    uint8_t ram[DisplayHeight / 8][DisplayWidth];
+    bool started;
+    bool first;
+    bool data;
+    std::vector<uint8_t> cmd;
+    uint8_t col_start, col_end, page_start, page_end;
+    uint8_t col, page;
+    size_t bytes;
+    size_t data_bytes;
+} oled;
+
+static void command(uint8_t c) {
+    oled.cmd.push_back(c);
+    uint8_t op = oled.cmd[0];
+    size_t operands = 0;
+    switch (op) {
+    case ColumnAddr:
+    case PageAddr:
+        operands = 2;
+        break;
+    case SetContrast:
+    case SetDisplayClockDiv:
+    case SetMultiPlex:
+    case SetDisplayOffset:
+    case SetChargePump:
+    case SetMemoryMode:
+    case SetComPins:
+    case SetPreCharge:
+    case SetVComDetect:
+        operands = 1;
+        break;
+    }
+    if (oled.cmd.size() <= operands) {
+        return;
+    }
+    if (op == ColumnAddr) {
+        oled.col = oled.col_start = oled.cmd[1];
+        oled.col_end = oled.cmd[2];
+    } else if (op == PageAddr) {
+        oled.page = oled.page_start = oled.cmd[1];
+        oled.page_end = oled.cmd[2];
+    }
+    oled.cmd.clear();
+}
+
+extern "C" uint8_t i2c_master_start(uint8_t address) {
+    EXPECT_EQ(ADDRESS, address);
+    EXPECT_FALSE(oled.started);
+    oled.started = true;
+    oled.first = true;
+    oled.bytes++;
+    return 0;
+}
+
+extern "C" void i2c_master_stop(void) {
+    oled.started = false;
+    EXPECT_TRUE(oled.cmd.empty()) << "a command was cut short";
+    oled.cmd.clear();
+}
+
+extern "C" uint8_t i2c_master_write(uint8_t data) {
+    EXPECT_TRUE(oled.started);
+    oled.bytes++;
+    if (oled.first) {
+        // The control byte, for all the bytes after it
+        oled.first = false;
+        oled.data = data == 0x40;
+        return 0;
+    }
+    if (!oled.data) {
+        command(data);
+        return 0;
+    }
+    oled.data_bytes++;
+    EXPECT_LT(oled.page, DisplayHeight / 8);
+    EXPECT_LT(oled.col, DisplayWidth);
+    oled.ram[oled.page % (DisplayHeight / 8)][oled.col % DisplayWidth] = data;
+    if (oled.col++ == oled.col_end) {
+        oled.col = oled.col_start;
+        oled.page = oled.page == oled.page_end ? oled.page_start : oled.page + 1;
+    }
+    return 0;
+}
+
+class Ssd1306 : public testing::Test {
+protected:
+    void SetUp() override {
+        oled.cmd.clear();
+        oled.started = false;
+        // Whatever it had at power on
+        memset(oled.ram, 0x5A, sizeof(oled.ram));
+        EXPECT_TRUE(iota_gfx_init());
+        expect_shown();
+    }
+
+    // The bytes on the bus
+    size_t render() {
+        oled.bytes = 0;
+        oled.data_bytes = 0;
+        iota_gfx_flush();
+        return oled.bytes;
+    }
+
+    void expect_shown() {
+        for (int row = 0; row < MatrixRows; row++) {
+            for (int col = 0; col < DisplayWidth; col++) {
+                uint8_t expected = 0;
+                int c = col / FontWidth;
+                if (c < MatrixCols && col % FontWidth < FontWidth - 1) {
+                    expected = font[display.display[row][c] * (FontWidth - 1) + col % FontWidth];
+                }
+                ASSERT_EQ(expected, oled.ram[row][col]) << "row " << row << " col " << col;
+            }
+        }
+    }
+
+    // What a keymap does, build the text elsewhere and copy it over
+    void update(const struct CharacterMatrix &source) {
+        if (memcmp(display.display, source.display, sizeof(display.display))) {
+            memcpy(display.display, source.display, sizeof(display.display));
+            display.dirty = true;
+        }
+    }
+};
+
+TEST_F(Ssd1306, InitClearsTheDisplay) {
+    for (int row = 0; row < MatrixRows; row++) {
+        for (int col = 0; col < MatrixCols; col++) {
+            EXPECT_EQ(' ', display.display[row][col]);
+        }
+    }
+}
+
+TEST_F(Ssd1306, NothingIsSentWithoutChanges) {
+    EXPECT_EQ(0u, render());
+    iota_gfx_write("hello");
+    render();
+    iota_gfx_clear_screen();
+    iota_gfx_write("hello");
+    EXPECT_EQ(0u, render());
+    EXPECT_FALSE(display.dirty);
+}
+
+TEST_F(Ssd1306, OnlyTheChangedCharactersAreSent) {
+    iota_gfx_write("hello");
+    render();
+    EXPECT_EQ(5u * FontWidth, oled.data_bytes);
+    expect_shown();
+
+    iota_gfx_clear_screen();
+    iota_gfx_write("jello");
+    // Two commands of three bytes and the data, each with the address and
+    // the control byte
+    EXPECT_EQ(2 * 5 + 2 + FontWidth, render());
+    EXPECT_EQ(1u * FontWidth, oled.data_bytes);
+    expect_shown();
+}
+
+TEST_F(Ssd1306, TheCharactersBetweenTheChangesAreSent) {
+    iota_gfx_write("hello");
+    render();
+    iota_gfx_clear_screen();
+    iota_gfx_write("jellY");
+    render();
+    EXPECT_EQ(5u * FontWidth, oled.data_bytes);
+    expect_shown();
+}
+
+TEST_F(Ssd1306, EachRowIsSentOnItsOwn) {
+    iota_gfx_write("a\nb\nc\nd");
+    render();
+    EXPECT_EQ(4u * FontWidth, oled.data_bytes);
+    expect_shown();
+}
+
+TEST_F(Ssd1306, ScrollingSendsTheRowsThatChange) {
+    iota_gfx_write("1\n2\n3\n4\n5");
+    render();
+    expect_shown();
+    iota_gfx_write("\n");
+    render();
+    expect_shown();
+}
+
+TEST_F(Ssd1306, CopiedTextIsCompared) {
+    struct CharacterMatrix matrix;
+    matrix_clear(&matrix);
+    matrix_write(&matrix, "Layer: Default\nCAPS");
+    update(matrix);
+    render();
+    expect_shown();
+
+    matrix_clear(&matrix);
+    matrix_write(&matrix, "Layer: Raise\nCAPS");
+    update(matrix);
+    render();
+    // "Raise  " over "Default"
+    EXPECT_EQ(7u * FontWidth, oled.data_bytes);
+    expect_shown();
+}
+
+TEST_F(Ssd1306, TheWholeDisplayIsMuchLess) {
+    // One more would scroll
+    for (int i = 0; i < MatrixRows * MatrixCols - 1; i++) {
+        iota_gfx_write_char('A' + i % 26);
+    }
+    size_t full = render();
+    EXPECT_EQ((MatrixRows * MatrixCols - 1u) * FontWidth, oled.data_bytes);
+    expect_shown();
+    display.display[2][7] = '!';
+    display.dirty = true;
+    EXPECT_LT(render() * 20, full);
+    expect_shown();
+}
+
+#ifdef SSD1306_INCREMENTAL_RENDER
+TEST_F(Ssd1306, TheTaskSendsOneRowAtATime) {
+    iota_gfx_write("a\nb\n\nd");
+    for (int row : {0, 1, 3}) {
+        oled.data_bytes = 0;
+        iota_gfx_task();
+        EXPECT_EQ(1u * FontWidth, oled.data_bytes) << "row " << row;
+        EXPECT_TRUE(display.dirty);
+    }
+    oled.bytes = 0;
+    iota_gfx_task();
+    EXPECT_EQ(0u, oled.bytes);
+    EXPECT_FALSE(display.dirty);
+    expect_shown();
+}
+
+TEST_F(Ssd1306, ChangesDuringTheUpdateAreCaughtUp) {
+    iota_gfx_write("a\nb\nc\nd");
+    iota_gfx_task();
+    iota_gfx_task();
+    display.display[0][3] = 'x';
+    for (int i = 0; i < MatrixRows + 1; i++) {
+        iota_gfx_task();
+    }
+    EXPECT_FALSE(display.dirty);
+    expect_shown();
+}
+#endif
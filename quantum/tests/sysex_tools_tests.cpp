@@ -0,0 +1,163 @@
+/*
+ * Tests for the SysEx 7-bit codec
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+extern "C" {
+#include "sysex_tools.h"
+}
+
+static void collect(void* context, uint8_t byte) {
+    static_cast<std::vector<uint8_t>*>(context)->push_back(byte);
+}
+
+static std::vector<uint8_t> random_bytes(size_t length) {
+    std::vector<uint8_t> bytes(length);
+    for (auto& b : bytes) {
+        b = rand();
+    }
+    return bytes;
+}
+
+static std::vector<uint8_t> encode(const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> encoded(sysex_encoded_length(data.size()));
+    encoded.resize(sysex_encode(encoded.data(), data.data(), data.size()));
+    return encoded;
+}
+
+// Through the streaming encoder, in pieces of up to max_piece bytes
+static std::vector<uint8_t> stream_encode(const std::vector<uint8_t>& data, int max_piece) {
+    std::vector<uint8_t> encoded;
+    sysex_encoder_t encoder;
+    sysex_encoder_init(&encoder, collect, &encoded);
+    for (size_t i = 0; i < data.size();) {
+        size_t piece = std::min<size_t>(rand() % max_piece + 1, data.size() - i);
+        sysex_encoder_write(&encoder, data.data() + i, piece);
+        i += piece;
+    }
+    sysex_encoder_finish(&encoder);
+    return encoded;
+}
+
+static std::vector<uint8_t> stream_decode(const std::vector<uint8_t>& encoded, int max_piece) {
+    std::vector<uint8_t> decoded;
+    sysex_decoder_t decoder;
+    sysex_decoder_init(&decoder, collect, &decoded);
+    for (size_t i = 0; i < encoded.size();) {
+        size_t piece = std::min<size_t>(rand() % max_piece + 1, encoded.size() - i);
+        sysex_decoder_write(&decoder, encoded.data() + i, piece);
+        i += piece;
+    }
+    return decoded;
+}
+
+TEST(SysexTools, SevenBytesBecomeEight) {
+    std::vector<uint8_t> data = {0x80, 0x01, 0xFF, 0x7F, 0x00, 0x81, 0x40, 0xC0};
+    std::vector<uint8_t> expected = {0x52, 0x00, 0x01, 0x7F, 0x7F, 0x00, 0x01, 0x40, 0x40, 0x40};
+    EXPECT_EQ(expected, encode(data));
+    EXPECT_EQ(expected, stream_encode(data, 1));
+    EXPECT_EQ(10u, sysex_encoded_length(8));
+    EXPECT_EQ(8u, sysex_decoded_length(10));
+}
+
+TEST(SysexTools, StreamingEncodesLikeTheWholeMessage) {
+    srand(1);
+    for (size_t length = 0; length < 100; length++) {
+        std::vector<uint8_t> data = random_bytes(length);
+        std::vector<uint8_t> encoded = encode(data);
+        ASSERT_EQ(encoded, stream_encode(data, 10)) << "length " << length;
+        for (uint8_t b : encoded) {
+            ASSERT_EQ(0, b & 0x80);
+        }
+    }
+}
+
+TEST(SysexTools, StreamingDecodesLikeTheWholeMessage) {
+    srand(2);
+    for (size_t length = 0; length < 100; length++) {
+        std::vector<uint8_t> data = random_bytes(length);
+        std::vector<uint8_t> encoded = encode(data);
+        std::vector<uint8_t> decoded(length);
+        if (length > 0) {
+            decoded.resize(sysex_decode(decoded.data(), encoded.data(), encoded.size()));
+        }
+        ASSERT_EQ(data, decoded) << "length " << length;
+        ASSERT_EQ(data, stream_decode(encoded, 10)) << "length " << length;
+    }
+}
+
+TEST(SysexTools, TheEncoderIsReadyForTheNextMessage) {
+    std::vector<uint8_t> encoded;
+    sysex_encoder_t encoder;
+    sysex_encoder_init(&encoder, collect, &encoded);
+    const uint8_t first[] = {0xFF, 0xFF};
+    sysex_encoder_write(&encoder, first, 2);
+    sysex_encoder_finish(&encoder);
+    sysex_encoder_finish(&encoder);
+    const uint8_t second[] = {0x01};
+    sysex_encoder_write(&encoder, second, 1);
+    sysex_encoder_finish(&encoder);
+    EXPECT_EQ(std::vector<uint8_t>({0x60, 0x7F, 0x7F, 0x00, 0x01}), encoded);
+}
+
+static void count(void* context, uint8_t byte) {
+    *static_cast<uint32_t*>(context) += byte;
+}
+
+TEST(SysexTools, Throughput) {
+    srand(3);
+    // As much as the lengths of the whole message functions go
+    const size_t size = 7 * 8000;
+    const int rounds = 20;
+    std::vector<uint8_t> data = random_bytes(size);
+    std::vector<uint8_t> encoded(sysex_encoded_length(size));
+    std::vector<uint8_t> decoded(size);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        sysex_encode(encoded.data(), data.data(), size);
+        sysex_decode(decoded.data(), encoded.data(), encoded.size());
+    }
+    double block = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_EQ(data, decoded);
+
+    // Through the sinks, in chunks like the API transfers
+    uint32_t sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        sysex_encoder_t encoder;
+        sysex_encoder_init(&encoder, count, &sum);
+        for (size_t i = 0; i < size; i += 24) {
+            sysex_encoder_write(&encoder, data.data() + i, std::min<size_t>(24, size - i));
+        }
+        sysex_encoder_finish(&encoder);
+        sysex_decoder_t decoder;
+        sysex_decoder_init(&decoder, count, &sum);
+        for (size_t i = 0; i < encoded.size(); i += 24) {
+            sysex_decoder_write(&decoder, encoded.data() + i, std::min<size_t>(24, encoded.size() - i));
+        }
+    }
+    double streaming = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_NE(0u, sum);
+
+    printf("sysex block    %6.1f MB/s encoded and decoded\n", size * rounds / block / 1e6);
+    printf("sysex stream   %6.1f MB/s encoded and decoded\n", size * rounds / streaming / 1e6);
+}
@@ -0,0 +1,23 @@
+TEST_LIST +=\
+	quantum_matrix_idle\
+	quantum_debounce\
+	quantum_debounce_long\
+	quantum_eeconfig\
+	quantum_flash_store\
+	quantum_backlight_pwm\
+	quantum_ws2812_encode\
+	quantum_spsc_ring\
+	quantum_midi_device\
+	quantum_sysex_tools\
+	quantum_ugfx_st7565\
+	quantum_ugfx_is31fl3731c\
+	quantum_ssd1306\
+	quantum_ssd1306_incremental\
+	quantum_visualizer_animations\
+	quantum_led_backlight_kernels\
+	quantum_lcd_image\
+	quantum_visualizer_emulator\
+	quantum_rgblight\
+	quantum_rgblight_effects\
+	quantum_rgblight_breathe\
+	quantum_rgblight_layers
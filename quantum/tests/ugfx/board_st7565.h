@@ -0,0 +1,65 @@
+/*
+ * ST7565 board file for the display driver tests
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _GDISP_LLD_BOARD_H
+#define _GDISP_LLD_BOARD_H
+
+#include "fake_bus.h"
+
+#define ST7565_LCD_BIAS         ST7565_LCD_BIAS_9
+#define ST7565_ADC              ST7565_ADC_NORMAL
+#define ST7565_COM_SCAN         ST7565_COM_SCAN_DEC
+#define ST7565_PAGE_ORDER       0,1,2,3
+
+static GFXINLINE void acquire_bus(GDisplay *g) {
+    (void) g;
+}
+
+static GFXINLINE void release_bus(GDisplay *g) {
+    (void) g;
+}
+
+static GFXINLINE void init_board(GDisplay *g) {
+    (void) g;
+}
+
+static GFXINLINE void post_init_board(GDisplay *g) {
+    (void) g;
+}
+
+static GFXINLINE void setpin_reset(GDisplay *g, bool_t state) {
+    (void) g;
+    (void) state;
+}
+
+static GFXINLINE void enter_data_mode(GDisplay *g) {
+    (void) g;
+    fake_bus_data_mode(true);
+}
+
+static GFXINLINE void enter_cmd_mode(GDisplay *g) {
+    (void) g;
+    fake_bus_data_mode(false);
+}
+
+static GFXINLINE void write_data(GDisplay *g, uint8_t* data, uint16_t length) {
+    (void) g;
+    fake_bus_write(data, length);
+}
+
+#endif /* _GDISP_LLD_BOARD_H */
@@ -0,0 +1,371 @@
+/*
+ * Visualizer emulator for the tests
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gfx.h"
+#include "src/gdisp/gdisp_driver.h"
+#include "fake_bus.h"
+#include "emulator.h"
+#include "visualizer.h"
+
+#define COMMANDREGISTER 0xFD
+#define FUNCTIONREG     0x0B
+#define PICTDISP        0x01
+#define SHUTDOWN        0x0A
+#define PWM_REG         0x24
+
+// How many pixels of the PPM images a LED takes
+#define PPM_SCALE       16
+
+// The registers of the IS31FL3731C, eight frames and the function page
+static uint8_t regs[FUNCTIONREG + 1][0xB4];
+static uint8_t page;
+
+static GDisplay led_display;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static bool thread_waiting = false;
+static bool thread_may_run = false;
+static bool event_pending = false;
+static systemticks_t now = 0;
+static systemticks_t wake_time = TIME_INFINITE;
+
+static GListener* attached_listener;
+static GSourceHandle attached_source;
+static GSourceListener source_listener;
+
+static threadreturn_t (*thread_function)(void*);
+static void* thread_param;
+
+// What the current step of the visualizer thread has done so far
+static uint64_t step_cpu_start;
+static uint32_t step_bus_bytes;
+
+static emulator_frame_t* frames;
+static uint16_t num_frames;
+static uint16_t frames_size;
+static unsigned frames_written;
+
+void fake_bus_data_mode(bool data) {
+    (void) data;
+}
+
+void fake_bus_write(const uint8_t* data, uint16_t length) {
+    step_bus_bytes += length;
+    if (data[0] == COMMANDREGISTER) {
+        page = data[1];
+        return;
+    }
+    if (page > FUNCTIONREG) {
+        return;
+    }
+    for (uint16_t i = 1; i < length && data[0] + i - 1 < (int)sizeof(regs[0]); i++) {
+        regs[page][data[0] + i - 1] = data[i];
+    }
+}
+
+uint8_t emulator_led(coord_t x, coord_t y) {
+    if (regs[FUNCTIONREG][SHUTDOWN] == 0) {
+        return 0;
+    }
+    uint8_t frame = regs[FUNCTIONREG][PICTDISP] & 0x7;
+    return regs[frame][PWM_REG + x + y * 16];
+}
+
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void begin_step(void) {
+    step_bus_bytes = 0;
+    step_cpu_start = thread_cpu_ns();
+}
+
+// Lets the visualizer thread run until it waits again
+static void step_thread(void) {
+    pthread_mutex_lock(&lock);
+    thread_waiting = false;
+    thread_may_run = true;
+    pthread_cond_broadcast(&cond);
+    while (!thread_waiting) {
+        pthread_cond_wait(&cond, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+static void* thread_main(void* arg) {
+    (void) arg;
+    pthread_mutex_lock(&lock);
+    while (!thread_may_run) {
+        pthread_cond_wait(&cond, &lock);
+    }
+    thread_may_run = false;
+    pthread_mutex_unlock(&lock);
+    begin_step();
+    return thread_function(thread_param);
+}
+
+void gfxInit(void) {
+    memset(&led_display, 0, sizeof(led_display));
+    gdisp_lld_init(&led_display);
+    // Like the uGFX core does with GDISP_STARTUP_COLOR
+    gdispGClear(&led_display, Black);
+    gdispGFlush(&led_display);
+}
+
+systemticks_t gfxSystemTicks(void) {
+    return now;
+}
+
+gfxThreadHandle gfxThreadCreate(void* stackarea, size_t stacksz, threadpriority_t prio,
+                                DECLARE_THREAD_FUNCTION((*fn), p), void* param) {
+    (void) stackarea;
+    (void) stacksz;
+    (void) prio;
+    static pthread_t thread;
+    thread_function = fn;
+    thread_param = param;
+    pthread_create(&thread, NULL, thread_main, NULL);
+    pthread_detach(thread);
+    // The first step runs right away, like on the keyboard
+    step_thread();
+    return &thread;
+}
+
+void geventListenerInit(GListener* pl) {
+    pl->source = NULL;
+}
+
+bool_t geventAttachSource(GListener* pl, GSourceHandle gsh, unsigned flags) {
+    (void) flags;
+    pl->source = gsh;
+    attached_listener = pl;
+    attached_source = gsh;
+    return TRUE;
+}
+
+GEvent* geventEventWait(GListener* pl, systemticks_t timeout) {
+    (void) pl;
+    pthread_mutex_lock(&lock);
+    wake_time = timeout == TIME_INFINITE ? TIME_INFINITE : now + timeout;
+    thread_waiting = true;
+    pthread_cond_broadcast(&cond);
+    while (!thread_may_run) {
+        pthread_cond_wait(&cond, &lock);
+    }
+    thread_may_run = false;
+    pthread_mutex_unlock(&lock);
+    begin_step();
+    return NULL;
+}
+
+GSourceListener* geventGetSourceListener(GSourceHandle gsh, GSourceListener* lastlr) {
+    if (lastlr || !attached_listener || gsh != attached_source) {
+        return NULL;
+    }
+    source_listener.listener = attached_listener;
+    return &source_listener;
+}
+
+void geventSendEvent(GSourceListener* psl) {
+    (void) psl;
+    pthread_mutex_lock(&lock);
+    event_pending = true;
+    pthread_mutex_unlock(&lock);
+}
+
+void emulator_run(systemticks_t ms) {
+    systemticks_t end = now + ms;
+    while (true) {
+        pthread_mutex_lock(&lock);
+        systemticks_t next = event_pending ? now : wake_time;
+        if (next == TIME_INFINITE || next > end) {
+            now = end;
+            pthread_mutex_unlock(&lock);
+            return;
+        }
+        now = next;
+        event_pending = false;
+        pthread_mutex_unlock(&lock);
+        step_thread();
+    }
+}
+
+GDisplay* gdispGetDisplay(unsigned display) {
+    return display == 0 ? &led_display : NULL;
+}
+
+void gdispGDrawPixel(GDisplay* g, coord_t x, coord_t y, color_t color) {
+    if (x < 0 || y < 0 || x >= g->g.Width || y >= g->g.Height) {
+        return;
+    }
+    g->p.x = x;
+    g->p.y = y;
+    g->p.color = color;
+    gdisp_lld_draw_pixel(g);
+}
+
+void gdispGDrawLine(GDisplay* g, coord_t x0, coord_t y0, coord_t x1, coord_t y1, color_t color) {
+    int dx = abs(x1 - x0);
+    int dy = -abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    while (true) {
+        gdispGDrawPixel(g, x0, y0, color);
+        if (x0 == x1 && y0 == y1) {
+            return;
+        }
+        int e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void gdispGClear(GDisplay* g, color_t color) {
+    for (coord_t y = 0; y < g->g.Height; y++) {
+        for (coord_t x = 0; x < g->g.Width; x++) {
+            gdispGDrawPixel(g, x, y, color);
+        }
+    }
+}
+
+color_t gdispGGetPixelColor(GDisplay* g, coord_t x, coord_t y) {
+    g->p.x = x;
+    g->p.y = y;
+    return gdisp_lld_get_pixel_color(g);
+}
+
+void gdispGFlush(GDisplay* g) {
+    gdisp_lld_flush(g);
+}
+
+static void control(GDisplay* g, unsigned what, unsigned value) {
+    g->p.x = what;
+    g->p.ptr = (void*)(uintptr_t)value;
+    gdisp_lld_control(g);
+}
+
+void gdispGSetPowerMode(GDisplay* g, powermode_t mode) {
+    control(g, GDISP_CONTROL_POWER, mode);
+}
+
+void gdispGSetOrientation(GDisplay* g, orientation_t orientation) {
+    control(g, GDISP_CONTROL_ORIENTATION, orientation);
+}
+
+void gdispGSetBacklight(GDisplay* g, unsigned percent) {
+    control(g, GDISP_CONTROL_BACKLIGHT, percent);
+}
+
+static uint32_t led_checksum(void) {
+    uint32_t hash = 2166136261u;
+    for (coord_t y = 0; y < LED_HEIGHT; y++) {
+        for (coord_t x = 0; x < LED_WIDTH; x++) {
+            hash = (hash ^ emulator_led(x, y)) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+static void write_frame(const char* dir, const emulator_frame_t* frame) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frame_%05u.ppm", dir, frames_written);
+    FILE* file = fopen(path, "wb");
+    if (file) {
+        fprintf(file, "P6\n%d %d\n255\n", LED_WIDTH * PPM_SCALE, LED_HEIGHT * PPM_SCALE);
+        for (int y = 0; y < LED_HEIGHT * PPM_SCALE; y++) {
+            for (int x = 0; x < LED_WIDTH * PPM_SCALE; x++) {
+                uint8_t pwm = emulator_led(x / PPM_SCALE, y / PPM_SCALE);
+                uint8_t rgb[3] = {pwm, pwm, pwm};
+                fwrite(rgb, 1, sizeof(rgb), file);
+            }
+        }
+        fclose(file);
+    }
+    snprintf(path, sizeof(path), "%s/frames.txt", dir);
+    file = fopen(path, frames_written == 0 ? "w" : "a");
+    if (file) {
+        fprintf(file, "%05u %8u ms %08x %8u ns %5u bytes\n", frames_written,
+                frame->time, frame->checksum, frame->cpu_ns, frame->bus_bytes);
+        fclose(file);
+    }
+}
+
+// Called by the visualizer after each flush
+void draw_emulator(void) {
+    if (num_frames == frames_size) {
+        frames_size = frames_size ? frames_size * 2 : 256;
+        frames = realloc(frames, frames_size * sizeof(emulator_frame_t));
+    }
+    emulator_frame_t* frame = &frames[num_frames++];
+    frame->time = now;
+    frame->checksum = led_checksum();
+    frame->cpu_ns = thread_cpu_ns() - step_cpu_start;
+    frame->bus_bytes = step_bus_bytes;
+
+    const char* dir = getenv("QMK_EMULATOR_FRAMES");
+    if (dir) {
+        write_frame(dir, frame);
+    }
+    frames_written++;
+}
+
+uint16_t emulator_num_frames(void) {
+    return num_frames;
+}
+
+const emulator_frame_t* emulator_frame(uint16_t index) {
+    return index < num_frames ? &frames[index] : NULL;
+}
+
+void emulator_clear_frames(void) {
+    num_frames = 0;
+}
+
+void emulator_print_report(FILE* file) {
+    uint64_t cpu_ns = 0;
+    uint32_t max_cpu_ns = 0;
+    uint64_t bus_bytes = 0;
+    uint32_t max_bus_bytes = 0;
+    for (uint16_t i = 0; i < num_frames; i++) {
+        cpu_ns += frames[i].cpu_ns;
+        bus_bytes += frames[i].bus_bytes;
+        if (frames[i].cpu_ns > max_cpu_ns) {
+            max_cpu_ns = frames[i].cpu_ns;
+        }
+        if (frames[i].bus_bytes > max_bus_bytes) {
+            max_bus_bytes = frames[i].bus_bytes;
+        }
+    }
+    unsigned n = num_frames ? num_frames : 1;
+    fprintf(file, "%u frames, CPU %u ns a frame, %u ns at most, bus %u bytes a frame, %u bytes at most\n",
+            num_frames, (unsigned)(cpu_ns / n), max_cpu_ns, (unsigned)(bus_bytes / n), max_bus_bytes);
+}
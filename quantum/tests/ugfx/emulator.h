@@ -0,0 +1,58 @@
+/*
+ * Visualizer emulator for the tests
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EMULATOR_H
+#define EMULATOR_H
+
+#include <stdio.h>
+#include "gfx.h"
+
+/*
+ * Runs the visualizer on the host, with the real LED driver writing to an
+ * emulated IS31FL3731C. The visualizer thread only runs when the emulator
+ * steps it, so the emulated time and the frames are the same on every run.
+ *
+ * If QMK_EMULATOR_FRAMES names a directory, each frame is also written to
+ * it as a PPM image.
+ */
+
+typedef struct {
+    // When the frame was drawn, in emulated milliseconds
+    systemticks_t time;
+    // FNV-1a of the PWM of the LEDs
+    uint32_t checksum;
+    // The CPU time the visualizer thread spent on the frame
+    uint32_t cpu_ns;
+    // The bytes written to the LED controller for the frame
+    uint32_t bus_bytes;
+} emulator_frame_t;
+
+// Runs the visualizer for ms of emulated time, waking it up when it asked
+// to be or when the status has changed
+void emulator_run(systemticks_t ms);
+
+uint16_t emulator_num_frames(void);
+const emulator_frame_t* emulator_frame(uint16_t index);
+void emulator_clear_frames(void);
+
+// The PWM the controller shows for the LED at x, y
+uint8_t emulator_led(coord_t x, coord_t y);
+
+void emulator_print_report(FILE* file);
+
+#endif /* EMULATOR_H */
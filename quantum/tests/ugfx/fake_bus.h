@@ -0,0 +1,29 @@
+/*
+ * Recorded bus traffic for the display driver tests
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FAKE_BUS_H
+#define FAKE_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Implemented by the tests, which simulate the display on the other end
+void fake_bus_data_mode(bool data);
+void fake_bus_write(const uint8_t* data, uint16_t length);
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * uGFX stand-in for the display driver tests
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// Just enough of uGFX for the display drivers to build in the tests
+
+#ifndef _GFX_H
+#define _GFX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifndef __cplusplus
+// The drivers take integers out of g->p.ptr, which is wider on the host
+#pragma GCC diagnostic ignored "-Wpointer-to-int-cast"
+#endif
+
+#define GFX_USE_GDISP       1
+#define GDISP_NEED_CONTROL  1
+
+#define TRUE                1
+#define FALSE               0
+#define GFXINLINE           inline
+
+typedef bool bool_t;
+typedef int16_t coord_t;
+typedef uint8_t color_t;
+
+#define Black               0
+#define White               0xFF
+
+#define gfxAlloc(size)              malloc(size)
+#define gfxSleepMilliseconds(ms)    ((void)(ms))
+#define gfxSleepMicroseconds(us)    ((void)(us))
+
+#ifdef EMULATOR
+// The rest of uGFX the visualizer uses, implemented by emulator.c. The
+// displays are the real drivers, and the ticks are milliseconds of the
+// emulated time.
+
+typedef struct GDisplay GDisplay;
+typedef uint32_t systemticks_t;
+typedef int threadpriority_t;
+typedef void* threadreturn_t;
+typedef void* gfxThreadHandle;
+typedef void* GSourceHandle;
+typedef enum { powerOff, powerSleep, powerDeepSleep, powerOn } powermode_t;
+typedef enum {
+    GDISP_ROTATE_0 = 0,
+    GDISP_ROTATE_90 = 90,
+    GDISP_ROTATE_180 = 180,
+    GDISP_ROTATE_270 = 270
+} orientation_t;
+
+typedef struct GListener {
+    GSourceHandle source;
+} GListener;
+
+typedef struct GSourceListener {
+    GListener* listener;
+} GSourceListener;
+
+typedef void GEvent;
+
+#define TIME_INFINITE                   ((systemticks_t)-1)
+#define NORMAL_PRIORITY                 0
+#define DECLARE_THREAD_STACK(name, sz)  uint8_t name[sz]
+#define DECLARE_THREAD_FUNCTION(fn, p)  threadreturn_t fn(void* p)
+#define gfxMillisecondsToTicks(ms)      (ms)
+
+void gfxInit(void);
+systemticks_t gfxSystemTicks(void);
+gfxThreadHandle gfxThreadCreate(void* stackarea, size_t stacksz, threadpriority_t prio,
+                                DECLARE_THREAD_FUNCTION((*fn), p), void* param);
+
+void geventListenerInit(GListener* pl);
+bool_t geventAttachSource(GListener* pl, GSourceHandle gsh, unsigned flags);
+GEvent* geventEventWait(GListener* pl, systemticks_t timeout);
+GSourceListener* geventGetSourceListener(GSourceHandle gsh, GSourceListener* lastlr);
+void geventSendEvent(GSourceListener* psl);
+
+GDisplay* gdispGetDisplay(unsigned display);
+void gdispGDrawPixel(GDisplay* g, coord_t x, coord_t y, color_t color);
+void gdispGDrawLine(GDisplay* g, coord_t x0, coord_t y0, coord_t x1, coord_t y1, color_t color);
+void gdispGClear(GDisplay* g, color_t color);
+color_t gdispGGetPixelColor(GDisplay* g, coord_t x, coord_t y);
+void gdispGFlush(GDisplay* g);
+void gdispGSetPowerMode(GDisplay* g, powermode_t mode);
+void gdispGSetOrientation(GDisplay* g, orientation_t orientation);
+void gdispGSetBacklight(GDisplay* g, unsigned percent);
+
+#define LUMA2COLOR(l)                   ((color_t)(l))
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+/*
+ * uGFX driver interface stand-in for the display driver tests
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// The part of the uGFX driver interface the display drivers use
+
+#ifndef _GDISP_LLD_H
+#define _GDISP_LLD_H
+
+#ifndef EMULATOR
+typedef enum { powerOff, powerSleep, powerDeepSleep, powerOn } powermode_t;
+typedef enum {
+    GDISP_ROTATE_0 = 0,
+    GDISP_ROTATE_90 = 90,
+    GDISP_ROTATE_180 = 180,
+    GDISP_ROTATE_270 = 270
+} orientation_t;
+#endif
+
+#define GDISP_CONTROL_POWER         0
+#define GDISP_CONTROL_ORIENTATION   1
+#define GDISP_CONTROL_BACKLIGHT     2
+#define GDISP_CONTROL_CONTRAST      3
+#define GDISP_CONTROL_LLD           1000
+
+#define GDISP_FLG_DRIVER            0x0100
+
+#define LLDSPEC
+#define gdispColor2Native(c)        (c)
+#define gdispNative2Color(c)        (c)
+
+typedef struct GDisplay {
+    struct {
+        coord_t Width;
+        coord_t Height;
+        orientation_t Orientation;
+        powermode_t Powermode;
+        uint8_t Backlight;
+        uint8_t Contrast;
+    } g;
+    void* priv;
+    uint16_t flags;
+    struct {
+        coord_t x, y;
+        coord_t cx, cy;
+        coord_t x1, y1;
+        coord_t x2, y2;
+        color_t color;
+        void* ptr;
+    } p;
+} GDisplay;
+
+bool_t gdisp_lld_init(GDisplay *g);
+void gdisp_lld_flush(GDisplay *g);
+void gdisp_lld_draw_pixel(GDisplay *g);
+color_t gdisp_lld_get_pixel_color(GDisplay *g);
+void gdisp_lld_blit_area(GDisplay *g);
+void gdisp_lld_control(GDisplay *g);
+
+#endif
@@ -0,0 +1,189 @@
+/*
+ * Tests for the IS31FL3731C display driver
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include "gfx.h"
+#include "src/gdisp/gdisp_driver.h"
+#include "fake_bus.h"
+#include "led_tables.h"
+}
+
+static const uint8_t COMMANDREGISTER = 0xFD;
+static const uint8_t FUNCTIONREG = 0x0B;
+static const uint8_t PICTDISP = 0x01;
+static const uint8_t PWM_REG = 0x24;
+
+// The registers of the controller, eight frames and the function page
+static struct {
+    uint8_t regs[FUNCTIONREG + 1][0xB4];
+    uint8_t page;
+    size_t pwm_bytes;
+} leds;
+
+extern "C" void fake_bus_data_mode(bool data) {
+    (void) data;
+}
+
+extern "C" void fake_bus_write(const uint8_t* data, uint16_t length) {
+    if (data[0] == COMMANDREGISTER) {
+        ASSERT_EQ(2, length);
+        leds.page = data[1];
+        return;
+    }
+    ASSERT_LE(leds.page, FUNCTIONREG);
+    ASSERT_LE(data[0] + length - 1, 0xB4);
+    for (uint16_t i = 1; i < length; i++) {
+        leds.regs[leds.page][data[0] + i - 1] = data[i];
+    }
+    if (leds.page != FUNCTIONREG && data[0] >= PWM_REG) {
+        leds.pwm_bytes += length - 1;
+    }
+}
+
+class UgfxIs31fl3731c : public testing::Test {
+protected:
+    void SetUp() override {
+        memset(&leds, 0, sizeof(leds));
+        memset(&g, 0, sizeof(g));
+        gdisp_lld_init(&g);
+        backlight(100);
+    }
+
+    void TearDown() override {
+        free(g.priv);
+    }
+
+    void draw(coord_t x, coord_t y, color_t color) {
+        g.p.x = x;
+        g.p.y = y;
+        g.p.color = color;
+        gdisp_lld_draw_pixel(&g);
+    }
+
+    void backlight(unsigned level) {
+        g.p.x = GDISP_CONTROL_BACKLIGHT;
+        g.p.ptr = (void*)(uintptr_t)level;
+        gdisp_lld_control(&g);
+    }
+
+    color_t pixel(coord_t x, coord_t y) {
+        g.p.x = x;
+        g.p.y = y;
+        return gdisp_lld_get_pixel_color(&g);
+    }
+
+    uint8_t shown(coord_t x, coord_t y) {
+        uint8_t frame = leds.regs[FUNCTIONREG][PICTDISP];
+        return leds.regs[frame][PWM_REG + x + y * 16];
+    }
+
+    // The PWM registers sent
+    size_t flush() {
+        leds.pwm_bytes = 0;
+        gdisp_lld_flush(&g);
+        return leds.pwm_bytes;
+    }
+
+    void expect_shown() {
+        for (coord_t y = 0; y < LED_HEIGHT; y++) {
+            for (coord_t x = 0; x < LED_WIDTH; x++) {
+                ASSERT_EQ(CIE1931_CURVE[pixel(x, y) * g.g.Backlight / 100], shown(x, y))
+                    << "x " << x << " y " << y;
+            }
+        }
+    }
+
+    GDisplay g;
+};
+
+TEST_F(UgfxIs31fl3731c, NothingIsSentForADarkScreen) {
+    draw(3, 3, 0);
+    EXPECT_EQ(0u, flush());
+    expect_shown();
+}
+
+TEST_F(UgfxIs31fl3731c, OnePixelSendsOneRegister) {
+    draw(3, 2, 255);
+    EXPECT_EQ(1u, flush());
+    expect_shown();
+    EXPECT_EQ(CIE1931_CURVE[255], shown(3, 2));
+    // The other frame still misses the first pixel
+    draw(4, 2, 128);
+    EXPECT_EQ(2u, flush());
+    expect_shown();
+    draw(4, 2, 100);
+    EXPECT_EQ(1u, flush());
+    expect_shown();
+}
+
+TEST_F(UgfxIs31fl3731c, TheRegistersBetweenTheChangesAreSent) {
+    draw(1, 1, 200);
+    draw(2, 3, 200);
+    EXPECT_EQ(34u, flush());
+    expect_shown();
+}
+
+TEST_F(UgfxIs31fl3731c, NothingIsSentWhenNothingChanges) {
+    draw(1, 1, 200);
+    flush();
+    flush();
+    draw(1, 1, 200);
+    // Too dim to show at all
+    draw(5, 5, 1);
+    EXPECT_EQ(0u, flush());
+}
+
+TEST_F(UgfxIs31fl3731c, TheBacklightScalesEveryPixel) {
+    for (coord_t y = 0; y < LED_HEIGHT; y++) {
+        for (coord_t x = 0; x < LED_WIDTH; x++) {
+            draw(x, y, x * 40 + y);
+        }
+    }
+    flush();
+    backlight(50);
+    flush();
+    expect_shown();
+    backlight(100);
+    flush();
+    expect_shown();
+    // Nothing to do when it stays
+    backlight(100);
+    EXPECT_EQ(0u, flush());
+}
+
+TEST_F(UgfxIs31fl3731c, TheLedsFollowRandomDrawing) {
+    srand(1);
+    size_t sent = 0;
+    for (int frame = 0; frame < 200; frame++) {
+        int pixels = rand() % 4;
+        for (int i = 0; i < pixels; i++) {
+            draw(rand() % LED_WIDTH, rand() % LED_HEIGHT, rand() % 256);
+        }
+        if (rand() % 20 == 0) {
+            backlight(rand() % 101);
+        }
+        sent += flush();
+        expect_shown();
+    }
+    // Every frame used to send all 144 registers
+    EXPECT_LT(sent, 200 * 144u / 2);
+}
@@ -0,0 +1,227 @@
+/*
+ * Tests for the ST7565 display driver
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "gfx.h"
+#include "src/gdisp/gdisp_driver.h"
+#include "fake_bus.h"
+#include "st7565.h"
+#include "lcd_image.h"
+}
+
+static const int PAGES = LCD_HEIGHT / 8;
+static const size_t FULL_FLUSH = PAGES * LCD_WIDTH;
+
+// The controller on the other end of the bus, with the room for two frames
+// that the driver alternates between
+static struct {
+    uint8_t ram[PAGES * 2][LCD_WIDTH];
+    bool data_mode;
+    unsigned page;
+    unsigned column;
+    unsigned start_line;
+    size_t bytes;
+    size_t data_bytes;
+} lcd;
+
+extern "C" void fake_bus_data_mode(bool data) {
+    lcd.data_mode = data;
+}
+
+extern "C" void fake_bus_write(const uint8_t* data, uint16_t length) {
+    lcd.bytes += length;
+    for (uint16_t i = 0; i < length; i++) {
+        uint8_t b = data[i];
+        if (lcd.data_mode) {
+            lcd.data_bytes++;
+            ASSERT_LT(lcd.page, PAGES * 2u);
+            ASSERT_LT(lcd.column, (unsigned)LCD_WIDTH);
+            lcd.ram[lcd.page][lcd.column++] = b;
+        } else if ((b & 0xF0) == ST7565_PAGE) {
+            lcd.page = b & 0xF;
+        } else if ((b & 0xF0) == ST7565_COLUMN_MSB) {
+            lcd.column = (lcd.column & 0xF) | (b & 0xF) << 4;
+        } else if ((b & 0xF0) == ST7565_COLUMN_LSB) {
+            lcd.column = (lcd.column & 0xF0) | (b & 0xF);
+        } else if ((b & 0xC0) == ST7565_START_LINE) {
+            lcd.start_line = b & 0x3F;
+        }
+    }
+}
+
+class UgfxSt7565 : public testing::Test {
+protected:
+    void SetUp() override {
+        memset(&lcd, 0, sizeof(lcd));
+        // Whatever the controller had before
+        memset(lcd.ram, 0xA5, sizeof(lcd.ram));
+        memset(&g, 0, sizeof(g));
+        gdisp_lld_init(&g);
+    }
+
+    void TearDown() override {
+        free(g.priv);
+    }
+
+    void draw(coord_t x, coord_t y, color_t color) {
+        g.p.x = x;
+        g.p.y = y;
+        g.p.color = color;
+        gdisp_lld_draw_pixel(&g);
+    }
+
+    color_t pixel(coord_t x, coord_t y) {
+        g.p.x = x;
+        g.p.y = y;
+        return gdisp_lld_get_pixel_color(&g);
+    }
+
+    bool shown(coord_t x, coord_t y) {
+        unsigned page = lcd.start_line / 8 + y / 8;
+        return lcd.ram[page][x] & (1 << (y % 8));
+    }
+
+    // The data bytes sent
+    size_t flush() {
+        lcd.bytes = 0;
+        lcd.data_bytes = 0;
+        gdisp_lld_flush(&g);
+        return lcd.data_bytes;
+    }
+
+    void expect_shown() {
+        for (coord_t y = 0; y < LCD_HEIGHT; y++) {
+            for (coord_t x = 0; x < LCD_WIDTH; x++) {
+                ASSERT_EQ(pixel(x, y) != Black, shown(x, y)) << "x " << x << " y " << y;
+            }
+        }
+    }
+
+    // Both frames on the controller written once, the one shown next still
+    // misses the last change, in the first column of the top page
+    void settle() {
+        draw(0, 0, White);
+        EXPECT_EQ(FULL_FLUSH, flush());
+        draw(0, 0, Black);
+        EXPECT_EQ(FULL_FLUSH, flush());
+    }
+
+    GDisplay g;
+};
+
+TEST_F(UgfxSt7565, TheFirstTwoFlushesSendEverything) {
+    for (coord_t x = 0; x < LCD_WIDTH; x++) {
+        draw(x, 0, Black);
+    }
+    draw(5, 5, White);
+    EXPECT_EQ(FULL_FLUSH, flush());
+    expect_shown();
+    draw(6, 6, White);
+    EXPECT_EQ(FULL_FLUSH, flush());
+    expect_shown();
+}
+
+TEST_F(UgfxSt7565, OnePixelSendsOneColumn) {
+    settle();
+    draw(10, 13, White);
+    EXPECT_EQ(2u, flush());
+    expect_shown();
+    // The other frame still misses the first pixel
+    draw(100, 20, White);
+    EXPECT_EQ(2u, flush());
+    expect_shown();
+    draw(100, 21, White);
+    EXPECT_EQ(1u, flush());
+    expect_shown();
+}
+
+TEST_F(UgfxSt7565, TheColumnsBetweenTheChangesAreSent) {
+    settle();
+    draw(20, 9, White);
+    draw(30, 12, White);
+    EXPECT_EQ(11u + 1, flush());
+    expect_shown();
+}
+
+TEST_F(UgfxSt7565, NothingIsSentWhenNothingChanges) {
+    settle();
+    draw(20, 9, White);
+    flush();
+    flush();
+    draw(20, 9, White);
+    draw(21, 9, Black);
+    lcd.bytes = 0;
+    flush();
+    EXPECT_EQ(0u, lcd.bytes);
+}
+
+TEST_F(UgfxSt7565, BlitSendsOnlyTheChanges) {
+    settle();
+    // A 16x16 image, all black except for one pixel
+    uint8_t image[16 * 16 / 8] = {};
+    image[5 * 2 + 1] = 0x08;
+    g.p.x = 40;
+    g.p.y = 8;
+    g.p.cx = 16;
+    g.p.cy = 16;
+    g.p.x1 = 0;
+    g.p.y1 = 0;
+    g.p.x2 = 16;
+    g.p.ptr = image;
+    gdisp_lld_blit_area(&g);
+    EXPECT_EQ(1u + 1, flush());
+    EXPECT_TRUE(shown(40 + 12, 8 + 5));
+    expect_shown();
+}
+
+TEST_F(UgfxSt7565, ImagesAreDecodedIntoTheRam) {
+    settle();
+    // 4x12, a run of set columns and then a literal
+    const uint8_t image[] = {4, 12, 0x81, 0xFF, 0x03, 0x01, 0x02, 0x04, 0x08};
+    g.p.x = GDISP_CONTROL_LCD_IMAGE;
+    g.p.ptr = (void*)image;
+    gdisp_lld_control(&g);
+    EXPECT_EQ(2u * 4, flush());
+    for (coord_t y = 0; y < 8; y++) {
+        EXPECT_TRUE(shown(2, y));
+    }
+    EXPECT_TRUE(shown(0, 8));
+    EXPECT_FALSE(shown(0, 9));
+    EXPECT_TRUE(shown(3, 11));
+    expect_shown();
+}
+
+TEST_F(UgfxSt7565, TheScreenFollowsRandomDrawing) {
+    srand(1);
+    settle();
+    size_t sent = 0;
+    for (int frame = 0; frame < 200; frame++) {
+        int pixels = rand() % 8;
+        for (int i = 0; i < pixels; i++) {
+            draw(rand() % LCD_WIDTH, rand() % LCD_HEIGHT, rand() % 2 ? White : Black);
+        }
+        sent += flush();
+        expect_shown();
+    }
+    EXPECT_LT(sent, 200 * FULL_FLUSH / 4);
+}
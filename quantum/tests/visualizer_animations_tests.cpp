@@ -0,0 +1,219 @@
+/*
+ * Tests for the visualizer animations
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <vector>
+
+extern "C" {
+#include "visualizer_animations.h"
+#include "timer.h"
+    void set_time(uint32_t t);
+    void advance_time(uint32_t ms);
+}
+
+struct call {
+    int frame;
+    uint32_t time;
+    bool first;
+    bool last;
+};
+
+static std::vector<call> calls;
+// What the frame functions ask for
+static bool continuous;
+static int next_update;
+
+static bool record(keyframe_animation_t* animation, struct visualizer_state_t* state) {
+    (void)state;
+    calls.push_back({animation->current_frame, timer_read32(),
+        animation->first_update_of_frame, animation->last_update_of_frame});
+    if (next_update) {
+        animation->time_to_next_update = next_update;
+    }
+    return continuous;
+}
+
+class VisualizerAnimations : public testing::Test {
+protected:
+    void SetUp() override {
+        stop_all_keyframe_animations();
+        calls.clear();
+        continuous = false;
+        next_update = 0;
+        set_time(0);
+        last = 0;
+    }
+
+    // What the visualizer thread does when it wakes up
+    uint32_t update() {
+        uint32_t now = timer_read32();
+        drawn = false;
+        uint32_t next = update_keyframe_animations(nullptr, now - last, &drawn);
+        last = now;
+        return next;
+    }
+
+    // Sleeps until the next update every time, returns the number of wakeups
+    int run_until(uint32_t end) {
+        int wakeups = 0;
+        uint32_t next = update();
+        while (next != VISUALIZER_NO_UPDATE && timer_read32() + next <= end) {
+            advance_time(next);
+            next = update();
+            wakeups++;
+        }
+        return wakeups;
+    }
+
+    keyframe_animation_t animation = {
+        .num_frames = 3,
+        .loop = false,
+        .frame_lengths = {100, 50, 200},
+        .frame_functions = {record, record, record},
+    };
+    uint32_t last;
+    bool drawn;
+};
+
+TEST_F(VisualizerAnimations, StaticFramesSleepUntilTheNextFrame) {
+    start_keyframe_animation(&animation);
+    EXPECT_EQ(1, get_num_running_animations());
+    EXPECT_EQ(100u, update());
+    EXPECT_TRUE(drawn);
+    advance_time(60);
+    EXPECT_EQ(40u, update());
+    EXPECT_FALSE(drawn);
+    advance_time(40);
+    EXPECT_EQ(50u, update());
+    advance_time(50);
+    EXPECT_EQ(200u, update());
+    advance_time(200);
+    EXPECT_EQ(VISUALIZER_NO_UPDATE, update());
+    EXPECT_EQ(0, get_num_running_animations());
+
+    ASSERT_EQ(3u, calls.size());
+    EXPECT_EQ(0u, calls[0].time);
+    EXPECT_EQ(100u, calls[1].time);
+    EXPECT_EQ(150u, calls[2].time);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(i, calls[i].frame);
+        EXPECT_TRUE(calls[i].first);
+        EXPECT_FALSE(calls[i].last);
+    }
+}
+
+TEST_F(VisualizerAnimations, AStaticAnimationWakesOncePerFrame) {
+    start_keyframe_animation(&animation);
+    EXPECT_EQ(3, run_until(1000));
+    EXPECT_EQ(3u, calls.size());
+}
+
+TEST_F(VisualizerAnimations, ContinuousFramesUpdateEveryInterval) {
+    continuous = true;
+    start_keyframe_animation(&animation);
+    EXPECT_EQ(100 / VISUALIZER_UPDATE_INTERVAL, run_until(100));
+    // Every interval, once more at the end of the frame, and the start of
+    // the next frame
+    ASSERT_EQ(100u / VISUALIZER_UPDATE_INTERVAL + 2, calls.size());
+    call end = calls[calls.size() - 2];
+    EXPECT_EQ(0, end.frame);
+    EXPECT_TRUE(end.last);
+    EXPECT_EQ(100u, end.time);
+    EXPECT_EQ(1, calls.back().frame);
+}
+
+TEST_F(VisualizerAnimations, FramesDeclareTheirNextUpdate) {
+    continuous = true;
+    next_update = 40;
+    start_keyframe_animation(&animation);
+    EXPECT_EQ(40u, update());
+    advance_time(40);
+    EXPECT_EQ(40u, update());
+    advance_time(40);
+    // Not after the end of the frame
+    EXPECT_EQ(20u, update());
+    advance_time(20);
+    update();
+    ASSERT_EQ(5u, calls.size());
+    EXPECT_TRUE(calls[3].last);
+    EXPECT_EQ(100u, calls[3].time);
+    EXPECT_EQ(1, calls[4].frame);
+    EXPECT_TRUE(calls[4].first);
+}
+
+TEST_F(VisualizerAnimations, LateWakeupsCatchUp) {
+    continuous = true;
+    start_keyframe_animation(&animation);
+    update();
+    advance_time(170);
+    // The end of the first two frames, and the start of the third
+    EXPECT_EQ(10u, update());
+    ASSERT_EQ(4u, calls.size());
+    EXPECT_EQ(0, calls[1].frame);
+    EXPECT_TRUE(calls[1].last);
+    EXPECT_EQ(1, calls[2].frame);
+    EXPECT_TRUE(calls[2].last);
+    EXPECT_EQ(2, calls[3].frame);
+    EXPECT_TRUE(calls[3].first);
+}
+
+TEST_F(VisualizerAnimations, LoopingAnimationsStartOver) {
+    animation.loop = true;
+    start_keyframe_animation(&animation);
+    run_until(1050);
+    // Three frames every 350 ms
+    ASSERT_EQ(10u, calls.size());
+    EXPECT_EQ(0, calls[9].frame);
+    EXPECT_EQ(1050u, calls[9].time);
+    EXPECT_EQ(1, get_num_running_animations());
+}
+
+TEST_F(VisualizerAnimations, TheEarliestAnimationDecides) {
+    keyframe_animation_t other = {
+        .num_frames = 1,
+        .loop = false,
+        .frame_lengths = {30},
+        .frame_functions = {record},
+    };
+    start_keyframe_animation(&animation);
+    start_keyframe_animation(&other);
+    EXPECT_EQ(30u, update());
+    advance_time(30);
+    EXPECT_EQ(70u, update());
+    EXPECT_EQ(1, get_num_running_animations());
+}
+
+TEST_F(VisualizerAnimations, StoppedAnimationsDontRun) {
+    start_keyframe_animation(&animation);
+    update();
+    stop_keyframe_animation(&animation);
+    advance_time(100);
+    EXPECT_EQ(VISUALIZER_NO_UPDATE, update());
+    EXPECT_FALSE(drawn);
+    EXPECT_EQ(1u, calls.size());
+}
+
+TEST_F(VisualizerAnimations, FadesUpdateWhenTheNextStepIsDue) {
+    animation.current_frame = 2;
+    keyframe_update_per_step(&animation, 255);
+    // Less than the interval, so it stays at that
+    EXPECT_EQ(0, animation.time_to_next_update);
+    keyframe_update_per_step(&animation, -8);
+    EXPECT_EQ(25, animation.time_to_next_update);
+    keyframe_update_per_step(&animation, 0);
+    EXPECT_EQ(200, animation.time_to_next_update);
+}
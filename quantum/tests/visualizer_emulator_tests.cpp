@@ -0,0 +1,195 @@
+/*
+ * Tests for the visualizer on the emulator
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cstdio>
+
+extern "C" {
+#include "visualizer.h"
+#include "default_animations.h"
+#include "emulator.h"
+}
+
+// The user visualizer the emulator runs: the default animations when
+// starting and suspending, and the LED test animation on layer 1
+extern "C" {
+
+uint8_t get_mods(void) {
+    return 0;
+}
+
+void initialize_user_visualizer(visualizer_state_t* state) {
+    (void) state;
+    start_keyframe_animation(&default_startup_animation);
+}
+
+static unsigned user_updates;
+
+void update_user_visualizer_state(visualizer_state_t* state, visualizer_keyboard_status_t* prev_status) {
+    user_updates++;
+    if (state->status.layer == prev_status->layer) {
+        return;
+    }
+    if (state->status.layer & 2) {
+        start_keyframe_animation(&led_test_animation);
+    } else {
+        stop_keyframe_animation(&led_test_animation);
+    }
+}
+
+void user_visualizer_suspend(visualizer_state_t* state) {
+    (void) state;
+    start_keyframe_animation(&default_suspend_animation);
+}
+
+void user_visualizer_resume(visualizer_state_t* state) {
+    (void) state;
+    start_keyframe_animation(&default_startup_animation);
+}
+
+}
+
+static uint8_t all_leds(void) {
+    uint8_t pwm = emulator_led(0, 0);
+    for (int y = 0; y < LED_HEIGHT; y++) {
+        for (int x = 0; x < LED_WIDTH; x++) {
+            if (emulator_led(x, y) != pwm) {
+                return 0xAA;
+            }
+        }
+    }
+    return pwm;
+}
+
+// There's only one visualizer thread, so the tests continue where the
+// previous one left off
+class VisualizerEmulator : public testing::Test {
+protected:
+    static void SetUpTestCase() {
+        visualizer_init();
+        backlight_set(BACKLIGHT_LEVELS);
+    }
+
+    void SetUp() override {
+        emulator_clear_frames();
+    }
+
+    void TearDown() override {
+        if (emulator_num_frames()) {
+            emulator_print_report(stdout);
+        }
+    }
+};
+
+TEST_F(VisualizerEmulator, StartupFadesTheLedsIn) {
+    emulator_run(5000);
+    ASSERT_GT(emulator_num_frames(), 100);
+    const emulator_frame_t* last = emulator_frame(emulator_num_frames() - 1);
+    EXPECT_EQ(5000u, last->time);
+    EXPECT_EQ(255, all_leds());
+    for (uint16_t i = 1; i < emulator_num_frames(); i++) {
+        EXPECT_GE(emulator_frame(i)->time, emulator_frame(i - 1)->time);
+    }
+}
+
+TEST_F(VisualizerEmulator, NothingIsDrawnWhenNothingAnimates) {
+    // The frame for enabling the visualizer when the startup has finished
+    emulator_run(100);
+    emulator_clear_frames();
+    emulator_run(10000);
+    EXPECT_EQ(0, emulator_num_frames());
+}
+
+TEST_F(VisualizerEmulator, TheLayerStartsTheLedTestAnimation) {
+    systemticks_t start = gfxSystemTicks();
+    visualizer_update(1, 3, 0, 0);
+    // Fade in, on and fade out
+    emulator_run(3000);
+    ASSERT_GT(emulator_num_frames(), 100);
+    // Right away, without waiting for the next animation update
+    EXPECT_EQ(start, emulator_frame(0)->time);
+    EXPECT_EQ(0, all_leds());
+    // At most the PWM registers once, and the page select and the frame
+    // to display
+    for (uint16_t i = 0; i < emulator_num_frames(); i++) {
+        EXPECT_LE(emulator_frame(i)->bus_bytes, 1u + 0x90 + 3 * 2) << "frame " << i;
+    }
+    // The rest of the loop, crossfades and gradients
+    emulator_run(14000);
+    EXPECT_GT(emulator_num_frames(), 1000);
+}
+
+TEST_F(VisualizerEmulator, TheSameInputDrawsTheSameFrames) {
+    visualizer_update(1, 1, 0, 0);
+    emulator_run(100);
+    emulator_clear_frames();
+    visualizer_update(1, 3, 0, 0);
+    emulator_run(4000);
+    std::vector<uint32_t> first;
+    for (uint16_t i = 0; i < emulator_num_frames(); i++) {
+        first.push_back(emulator_frame(i)->checksum);
+    }
+
+    visualizer_update(1, 1, 0, 0);
+    emulator_run(100);
+    emulator_clear_frames();
+    visualizer_update(1, 3, 0, 0);
+    emulator_run(4000);
+    ASSERT_EQ(first.size(), emulator_num_frames());
+    for (uint16_t i = 0; i < emulator_num_frames(); i++) {
+        EXPECT_EQ(first[i], emulator_frame(i)->checksum) << "frame " << i;
+    }
+}
+
+TEST_F(VisualizerEmulator, SuspendFadesTheLedsOut) {
+    visualizer_update(1, 1, 0, 0);
+    emulator_run(100);
+    visualizer_suspend();
+    emulator_run(1100);
+    EXPECT_EQ(0, all_leds());
+    emulator_clear_frames();
+    emulator_run(10000);
+    EXPECT_EQ(0, emulator_num_frames());
+
+    visualizer_resume();
+    emulator_run(5100);
+    EXPECT_EQ(255, all_leds());
+}
+
+TEST_F(VisualizerEmulator, TheThreadOnlySeesTheLatestStatus) {
+    visualizer_update(1, 1, 0, 0);
+    emulator_run(100);
+    user_updates = 0;
+    visualizer_update(1, 4, 0, 0);
+    visualizer_update(1, 8, 0, 0);
+    visualizer_update(1, 16, 0x2, 0);
+    emulator_run(1);
+    EXPECT_EQ(1u, user_updates);
+}
+
+TEST_F(VisualizerEmulator, AnUnchangedStatusDoesNotWakeTheThread) {
+    visualizer_update(1, 1, 0, 0);
+    emulator_run(100);
+    user_updates = 0;
+    emulator_clear_frames();
+    for (int i = 0; i < 100; i++) {
+        visualizer_update(1, 1, 0, 0);
+        emulator_run(10);
+    }
+    EXPECT_EQ(0u, user_updates);
+    EXPECT_EQ(0, emulator_num_frames());
+}
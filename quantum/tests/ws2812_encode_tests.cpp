@@ -0,0 +1,110 @@
+/*
+ * Tests for the WS2812 SPI bit stream
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "ws2812_encode.h"
+}
+
+// The MOSI line, one bool per SPI bit
+static std::vector<bool> line(const std::vector<uint8_t> &buffer, size_t size) {
+    std::vector<bool> bits;
+    for (size_t i = 0; i < size; i++) {
+        for (int bit = 7; bit >= 0; bit--) {
+            bits.push_back(buffer[i] & (1 << bit));
+        }
+    }
+    return bits;
+}
+
+static const double NS_PER_BIT = 1e9 / WS2812_SPI_BIT_RATE;
+
+TEST(Ws2812Encode, BytesAreThreeBitsPerBit) {
+    EXPECT_EQ(0x924924u, ws2812_encode_byte(0x00));
+    EXPECT_EQ(0xDB6DB6u, ws2812_encode_byte(0xFF));
+    EXPECT_EQ(0xD24924u, ws2812_encode_byte(0x80));
+    EXPECT_EQ(0x924926u, ws2812_encode_byte(0x01));
+    EXPECT_EQ(0xD24926u, ws2812_encode_byte(0x81));
+}
+
+TEST(Ws2812Encode, BufferSize) {
+    EXPECT_EQ(9u, WS2812_BYTES_PER_LED);
+    // 300 µs at 2.25 MHz
+    EXPECT_EQ(85u, WS2812_RESET_BYTES);
+    std::vector<uint8_t> buffer(WS2812_ENCODED_SIZE(10) + 1, 0x55);
+    LED_TYPE leds[10] = {};
+    EXPECT_EQ(WS2812_ENCODED_SIZE(10), ws2812_encode(leds, 10, buffer.data()));
+    // Nothing past the end is touched
+    EXPECT_EQ(0x55, buffer.back());
+}
+
+TEST(Ws2812Encode, TheLineDecodesBackToTheLeds) {
+    LED_TYPE leds[RGBLED_NUM];
+    for (int i = 0; i < RGBLED_NUM; i++) {
+        leds[i].r = i * 37;
+        leds[i].g = 255 - i * 11;
+        leds[i].b = i * i;
+    }
+    std::vector<uint8_t> buffer(WS2812_ENCODED_SIZE(RGBLED_NUM));
+    size_t size = ws2812_encode(leds, RGBLED_NUM, buffer.data());
+    std::vector<bool> bits = line(buffer, size - WS2812_RESET_BYTES);
+
+    std::vector<uint8_t> decoded;
+    uint8_t byte = 0;
+    for (size_t i = 0; i < bits.size(); i += 3) {
+        ASSERT_TRUE(bits[i]) << "bit " << i;
+        ASSERT_FALSE(bits[i + 2]) << "bit " << i;
+        byte = byte << 1 | bits[i + 1];
+        if ((i / 3) % 8 == 7) {
+            decoded.push_back(byte);
+        }
+    }
+    ASSERT_EQ(RGBLED_NUM * 3u, decoded.size());
+    for (int i = 0; i < RGBLED_NUM; i++) {
+        // Green first
+        EXPECT_EQ(leds[i].g, decoded[i * 3]);
+        EXPECT_EQ(leds[i].r, decoded[i * 3 + 1]);
+        EXPECT_EQ(leds[i].b, decoded[i * 3 + 2]);
+    }
+}
+
+TEST(Ws2812Encode, TimingsAreWithinTheDatasheet) {
+    // T0H 400 ns, T1H 800 ns, 1250 ns a bit, all +-150 ns
+    EXPECT_NEAR(400, NS_PER_BIT, 150);
+    EXPECT_NEAR(800, NS_PER_BIT * 2, 150);
+    EXPECT_NEAR(1250, NS_PER_BIT * WS2812_SPI_BITS_PER_BIT, 150);
+}
+
+TEST(Ws2812Encode, FrameEndsWithTheLineLow) {
+    LED_TYPE leds[4];
+    memset(leds, 0xFF, sizeof(leds));
+    std::vector<uint8_t> buffer(WS2812_ENCODED_SIZE(4), 0xAA);
+    size_t size = ws2812_encode(leds, 4, buffer.data());
+    std::vector<bool> bits = line(buffer, size);
+
+    // Low from the last data bit to the end
+    size_t low = 0;
+    while (low < bits.size() && !bits[bits.size() - 1 - low]) {
+        low++;
+    }
+    // The last bit ends low too, then the newer WS2812B need 280 µs to latch
+    EXPECT_EQ(WS2812_RESET_BYTES * 8 + 1, low);
+    EXPECT_GE(low * NS_PER_BIT, 280000);
+}
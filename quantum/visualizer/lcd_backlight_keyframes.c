@@ -32,6 +32,14 @@ bool lcd_backlight_keyframe_animate_color(keyframe_animation_t* animation, visua
     int d_h = abs(d_h2) < d_h1 ? d_h2 : d_h1;
     int d_s = t_s - p_s;
     int d_i = t_i - p_i;
+    int steps = abs(d_h);
+    if (abs(d_s) > steps) {
+        steps = abs(d_s);
+    }
+    if (abs(d_i) > steps) {
+        steps = abs(d_i);
+    }
+    keyframe_update_per_step(animation, steps);
 
     int hue = (d_h * current_pos) / frame_length;
     int sat = (d_s * current_pos) / frame_length;
@@ -0,0 +1,58 @@
+/*
+ * Run length encoded LCD images
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lcd_image.h"
+#include <stdbool.h>
+#include "progmem.h"
+
+void lcd_image_decode(const uint8_t* image, uint8_t* pages, uint16_t stride) {
+    uint8_t width = pgm_read_byte(image++);
+    uint8_t height = pgm_read_byte(image++);
+    if (width == 0) {
+        return;
+    }
+    uint8_t x = 0;
+    uint8_t rows_left = height;
+    uint8_t mask = rows_left >= 8 ? 0xFF : (1 << rows_left) - 1;
+    uint8_t* out = pages;
+    uint8_t count = 0;
+    bool repeat = false;
+    uint8_t value = 0;
+    while (rows_left) {
+        if (count == 0) {
+            uint8_t control = pgm_read_byte(image++);
+            repeat = control >= LCD_IMAGE_RLE_REPEAT;
+            if (repeat) {
+                count = control - LCD_IMAGE_RLE_REPEAT + LCD_IMAGE_RLE_MIN_RUN;
+                value = pgm_read_byte(image++);
+            } else {
+                count = control + 1;
+            }
+        }
+        if (!repeat) {
+            value = pgm_read_byte(image++);
+        }
+        count--;
+        out[x] = (out[x] & ~mask) | (value & mask);
+        if (++x == width) {
+            x = 0;
+            out += stride;
+            rows_left = rows_left > 8 ? rows_left - 8 : 0;
+            mask = rows_left >= 8 ? 0xFF : (1 << rows_left) - 1;
+        }
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ * Run length encoded LCD images
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUANTUM_VISUALIZER_LCD_IMAGE_H_
+#define QUANTUM_VISUALIZER_LCD_IMAGE_H_
+
+#include <stdint.h>
+
+/*
+ * The LCD images in the resources are made by resources/lcd_image.py. The
+ * first two bytes are the width and the height, then come the pixels in
+ * pages like the RAM of the ST7565 and the SSD1306 has them, run length
+ * encoded. A control byte below LCD_IMAGE_RLE_REPEAT is followed by that
+ * many plus one bytes to copy. From LCD_IMAGE_RLE_REPEAT up, it's followed
+ * by one byte to repeat that many minus LCD_IMAGE_RLE_REPEAT plus
+ * LCD_IMAGE_RLE_MIN_RUN times.
+ */
+
+#define LCD_IMAGE_RLE_REPEAT 0x80
+#define LCD_IMAGE_RLE_MIN_RUN 3
+
+// Draws an image at the top left corner, with
+// gdispGControl(display, GDISP_CONTROL_LCD_IMAGE, (void*)image)
+#define GDISP_CONTROL_LCD_IMAGE (GDISP_CONTROL_LLD + 0)
+
+/* Decodes the image, which can be in PROGMEM, into pages of stride bytes.
+ * In the last page, the rows below the image are left as they were.
+ */
+void lcd_image_decode(const uint8_t* image, uint8_t* pages, uint16_t stride);
+
+#endif /* QUANTUM_VISUALIZER_LCD_IMAGE_H_ */
@@ -18,6 +18,7 @@
 #include <string.h>
 #include "action_util.h"
 #include "led.h"
+#include "lcd_image.h"
 #include "resources/resources.h"
 
 bool lcd_keyframe_display_layer_text(keyframe_animation_t* animation, visualizer_state_t* state) {
@@ -165,9 +166,9 @@ bool lcd_keyframe_draw_logo(keyframe_animation_t* animation, visualizer_state_t*
     // You can use static variables for things that can't be found in the animation
     // or state structs, here we use the image
 
-    //gdispGBlitArea is a tricky function to use since it supports blitting part of the image
-    // if you have full screen image, then just use LCD_WIDTH and LCD_HEIGHT for both source and target dimensions
-    gdispGBlitArea(GDISP, 0, 0, LCD_WIDTH, LCD_HEIGHT, 0, 0, LCD_WIDTH, (pixel_t*)resource_lcd_logo);
+    // The images in the resources are compressed, and the driver decodes
+    // them straight into the display memory
+    gdispGControl(GDISP, GDISP_CONTROL_LCD_IMAGE, (void*)resource_lcd_logo);
 
     return false;
 }
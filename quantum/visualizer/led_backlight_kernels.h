@@ -0,0 +1,46 @@
+/*
+Integer gradients and crossfades for the LED backlight
+
+The MIT License (MIT)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef LED_BACKLIGHT_KERNELS_H
+#define LED_BACKLIGHT_KERNELS_H
+
+#include <stdint.h>
+
+// Integer math for the LED backlight animations. Phases are in 1/0x10000
+// of a turn, so they wrap around by themselves.
+
+// How far position is into length, as a phase
+uint16_t led_gradient_phase(int position, int length);
+// The phase of LED index out of num along a gradient, one turn for the
+// first LED down to none for the last
+uint16_t led_gradient_offset(int index, int num);
+// The brightness of a gradient at phase, 255 * (cos(phase) + 1) / 2
+uint8_t led_gradient_color(uint16_t phase);
+
+// How far position is into length, out of 256, for led_crossfade_color
+uint16_t led_crossfade_weight(int position, int length);
+// The color weight/256 of the way from from to to, rounded
+uint8_t led_crossfade_color(uint8_t from, uint8_t to, uint16_t weight);
+
+#endif /* LED_BACKLIGHT_KERNELS_H */
@@ -22,8 +22,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include "gfx.h"
-#include "math.h"
 #include "led_backlight_keyframes.h"
+#include "led_backlight_kernels.h"
 
 static uint8_t fade_led_color(keyframe_animation_t* animation, int from, int to) {
     int frame_length = animation->frame_lengths[animation->current_frame];
@@ -38,6 +38,7 @@ static void keyframe_fade_all_leds_from_to(keyframe_animation_t* animation, uint
     uint8_t luma = fade_led_color(animation, from, to);
     color_t color = LUMA2COLOR(luma);
     gdispGClear(LED_DISPLAY, color);
+    keyframe_update_per_step(animation, to - from);
 }
 
 // TODO: Should be customizable per keyboard
@@ -47,12 +48,10 @@ static void keyframe_fade_all_leds_from_to(keyframe_animation_t* animation, uint
 static uint8_t crossfade_start_frame[NUM_ROWS][NUM_COLS];
 static uint8_t crossfade_end_frame[NUM_ROWS][NUM_COLS];
 
-static uint8_t compute_gradient_color(float t, float index, float num) {
-    const float two_pi = M_PI * 2.0f;
-    float normalized_index = (1.0f - index / (num - 1.0f)) * two_pi;
-    float x = t * two_pi + normalized_index;
-    float v = 0.5 * (cosf(x) + 1.0f);
-    return (uint8_t)(255.0f * v);
+static uint16_t gradient_phase(keyframe_animation_t* animation) {
+    int frame_length = animation->frame_lengths[animation->current_frame];
+    int current_pos = frame_length - animation->time_left_in_frame;
+    return led_gradient_phase(current_pos, frame_length);
 }
 
 bool led_backlight_keyframe_fade_in_all(keyframe_animation_t* animation, visualizer_state_t* state) {
@@ -69,11 +68,9 @@ bool led_backlight_keyframe_fade_out_all(keyframe_animation_t* animation, visual
 
 bool led_backlight_keyframe_left_to_right_gradient(keyframe_animation_t* animation, visualizer_state_t* state) {
     (void)state;
-    float frame_length = animation->frame_lengths[animation->current_frame];
-    float current_pos = frame_length - animation->time_left_in_frame;
-    float t = current_pos / frame_length;
+    uint16_t phase = gradient_phase(animation);
     for (int i=0; i< NUM_COLS; i++) {
-        uint8_t color = compute_gradient_color(t, i, NUM_COLS);
+        uint8_t color = led_gradient_color(phase + led_gradient_offset(i, NUM_COLS));
         gdispGDrawLine(LED_DISPLAY, i, 0, i, NUM_ROWS - 1, LUMA2COLOR(color));
     }
     return true;
@@ -81,11 +78,9 @@ bool led_backlight_keyframe_left_to_right_gradient(keyframe_animation_t* animati
 
 bool led_backlight_keyframe_top_to_bottom_gradient(keyframe_animation_t* animation, visualizer_state_t* state) {
     (void)state;
-    float frame_length = animation->frame_lengths[animation->current_frame];
-    float current_pos = frame_length - animation->time_left_in_frame;
-    float t = current_pos / frame_length;
+    uint16_t phase = gradient_phase(animation);
     for (int i=0; i< NUM_ROWS; i++) {
-        uint8_t color = compute_gradient_color(t, i, NUM_ROWS);
+        uint8_t color = led_gradient_color(phase + led_gradient_offset(i, NUM_ROWS));
         gdispGDrawLine(LED_DISPLAY, 0, i, NUM_COLS - 1, i, LUMA2COLOR(color));
     }
     return true;
@@ -105,10 +100,13 @@ bool led_backlight_keyframe_crossfade(keyframe_animation_t* animation, visualize
         run_next_keyframe(animation, state);
         copy_current_led_state(&crossfade_end_frame[0][0]);
     }
+    int frame_length = animation->frame_lengths[animation->current_frame];
+    int current_pos = frame_length - animation->time_left_in_frame;
+    uint16_t weight = led_crossfade_weight(current_pos, frame_length);
     for (int i=0;i<NUM_ROWS;i++) {
         for (int j=0;j<NUM_COLS;j++) {
-            color_t color  = LUMA2COLOR(fade_led_color(animation, crossfade_start_frame[i][j], crossfade_end_frame[i][j]));
-            gdispGDrawPixel(LED_DISPLAY, j, i, color);
+            uint8_t luma = led_crossfade_color(crossfade_start_frame[i][j], crossfade_end_frame[i][j], weight);
+            gdispGDrawPixel(LED_DISPLAY, j, i, LUMA2COLOR(luma));
         }
     }
     return true;
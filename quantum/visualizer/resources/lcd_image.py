@@ -0,0 +1,225 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+"""Converts PNG images to RLE compressed LCD images for the visualizer
+
+The images are packed in pages, like the RAM of the ST7565 and the
+SSD1306: each byte is eight pixels of a column, the top one in the lowest
+bit, and the pages go from the top down. The pages are then run length
+encoded, and lcd_image_decode() in lcd_image.c decodes them straight into
+the page buffer of the display.
+
+Light opaque pixels are set, dark or transparent ones are clear, like in
+lcd_logo.png.
+
+Usage:
+    python lcd_image.py INPUT.png NAME [OUTPUT.c]
+"""
+from __future__ import division
+from __future__ import print_function
+from __future__ import absolute_import
+from __future__ import unicode_literals
+
+import os
+import struct
+import sys
+import zlib
+
+# A control byte below RLE_REPEAT is followed by that many plus one bytes
+# to copy, from RLE_REPEAT up it's followed by one byte to repeat that many
+# minus RLE_REPEAT plus RLE_MIN_RUN times
+RLE_REPEAT = 0x80
+RLE_MAX_LITERAL = 0x80
+RLE_MIN_RUN = 3
+RLE_MAX_RUN = 0xFF - RLE_REPEAT + RLE_MIN_RUN
+
+PNG_SIGNATURE = b'\x89PNG\r\n\x1a\n'
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa = abs(p - a)
+    pb = abs(p - b)
+    pc = abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    if pb <= pc:
+        return b
+    return c
+
+
+def read_png(path):
+    """Returns the width, the height and the rows of (luma, alpha) pixels"""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != PNG_SIGNATURE:
+        raise ValueError('%s is not a PNG image' % path)
+
+    pos = 8
+    idat = b''
+    palette = []
+    transparency = b''
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b'IHDR':
+            width, height, depth, color_type, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+        elif kind == b'PLTE':
+            palette = [bytearray(chunk[i:i + 3]) for i in range(0, length, 3)]
+        elif kind == b'tRNS':
+            transparency = bytearray(chunk)
+        elif kind == b'IDAT':
+            idat += chunk
+        elif kind == b'IEND':
+            break
+
+    if interlace:
+        raise ValueError('%s is interlaced, which is not supported' % path)
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color_type]
+    if depth == 16:
+        raise ValueError('%s has 16 bits a channel, which is not supported' % path)
+
+    raw = bytearray(zlib.decompress(idat))
+    bits_per_pixel = channels * depth
+    stride = (width * bits_per_pixel + 7) // 8
+    step = max(1, bits_per_pixel // 8)
+    rows = []
+    previous = bytearray(stride)
+    for y in range(height):
+        start = y * (stride + 1)
+        filter_type = raw[start]
+        line = raw[start + 1:start + 1 + stride]
+        for i in range(stride):
+            a = line[i - step] if i >= step else 0
+            b = previous[i]
+            c = previous[i - step] if i >= step else 0
+            if filter_type == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif filter_type == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif filter_type == 3:
+                line[i] = (line[i] + (a + b) // 2) & 0xFF
+            elif filter_type == 4:
+                line[i] = (line[i] + paeth(a, b, c)) & 0xFF
+        previous = line
+
+        row = []
+        for x in range(width):
+            if depth < 8:
+                bit = x * depth
+                sample = (line[bit // 8] >> (8 - depth - bit % 8)) & ((1 << depth) - 1)
+                samples = [sample]
+            else:
+                samples = list(line[x * channels:(x + 1) * channels])
+            if color_type == 3:
+                r, g, b = palette[samples[0]]
+                alpha = transparency[samples[0]] if samples[0] < len(transparency) else 255
+            elif color_type in (0, 4):
+                r = g = b = samples[0] * 255 // ((1 << depth) - 1)
+                alpha = samples[1] if color_type == 4 else 255
+            else:
+                r, g, b = samples[:3]
+                alpha = samples[3] if color_type == 6 else 255
+            row.append(((r * 299 + g * 587 + b * 114) // 1000, alpha))
+        rows.append(row)
+    return width, height, rows
+
+
+def pack_pages(width, height, rows):
+    """The pixels as the display RAM has them, a page of columns at a time"""
+    pages = bytearray()
+    for page in range((height + 7) // 8):
+        for x in range(width):
+            byte = 0
+            for bit in range(8):
+                y = page * 8 + bit
+                if y < height:
+                    luma, alpha = rows[y][x]
+                    if alpha >= 128 and luma >= 128:
+                        byte |= 1 << bit
+            pages.append(byte)
+    return pages
+
+
+def encode(data):
+    out = bytearray()
+    literal = bytearray()
+
+    def flush_literal():
+        while literal:
+            chunk = literal[:RLE_MAX_LITERAL]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+            del literal[:RLE_MAX_LITERAL]
+
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < RLE_MAX_RUN:
+            run += 1
+        if run >= RLE_MIN_RUN:
+            flush_literal()
+            out.append(RLE_REPEAT + run - RLE_MIN_RUN)
+            out.append(data[i])
+        else:
+            literal.extend(data[i:i + run])
+        i += run
+    flush_literal()
+    return out
+
+
+def decode(data, size):
+    out = bytearray()
+    i = 0
+    while len(out) < size:
+        control = data[i]
+        if control < RLE_REPEAT:
+            out.extend(data[i + 1:i + 2 + control])
+            i += 2 + control
+        else:
+            out.extend(bytearray([data[i + 1]]) * (control - RLE_REPEAT + RLE_MIN_RUN))
+            i += 2
+    return out
+
+
+def to_c(name, source, width, height, encoded):
+    lines = [
+        '/* Generated from %s by lcd_image.py, don\'t edit */' % source,
+        '',
+        '#include "resources.h"',
+        '#include "progmem.h"',
+        '',
+        '// %dx%d, %d bytes compressed from %d' % (width, height, len(encoded), width * ((height + 7) // 8)),
+        'const uint8_t %s[] PROGMEM = {' % name,
+        '    %d, %d,' % (width, height),
+    ]
+    for i in range(0, len(encoded), 16):
+        lines.append('    ' + ' '.join('0x%02x,' % b for b in encoded[i:i + 16]))
+    lines.append('};')
+    return '\n'.join(lines) + '\n'
+
+
+def main(argv):
+    if len(argv) not in (3, 4):
+        print(__doc__, file=sys.stderr)
+        return 1
+    width, height, rows = read_png(argv[1])
+    if width > 255 or height > 255:
+        print('%s is bigger than 255x255' % argv[1], file=sys.stderr)
+        return 1
+    pages = pack_pages(width, height, rows)
+    encoded = encode(pages)
+    if decode(encoded, len(pages)) != pages:
+        print('The image didn\'t decode back to itself', file=sys.stderr)
+        return 1
+    source = to_c(argv[2], os.path.basename(argv[1]), width, height, encoded)
+    if len(argv) == 4:
+        with open(argv[3], 'w') as f:
+            f.write(source)
+    else:
+        sys.stdout.write(source)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
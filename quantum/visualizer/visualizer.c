@@ -49,6 +49,7 @@ SOFTWARE.
 #endif
 
 #include "action_util.h"
+#include "serial_link/protocol/triple_buffered_object.h"
 
 // Define this in config.h
 #ifndef VISUALIZER_THREAD_PRIORITY
@@ -56,7 +57,10 @@ SOFTWARE.
 #define VISUALIZER_THREAD_PRIORITY (NORMAL_PRIORITY - 2)
 #endif
 
+// The status as the main thread sees it, the visualizer thread gets copies
+// of it through status_buffer
 static visualizer_keyboard_status_t current_status = {
+    .generation = 0,
     .layer = 0xFFFFFFFF,
     .default_layer = 0xFFFFFFFF,
     .leds = 0xFFFFFFFF,
@@ -70,20 +74,10 @@ static visualizer_keyboard_status_t current_status = {
 #endif
 };
 
-static bool same_status(visualizer_keyboard_status_t* status1, visualizer_keyboard_status_t* status2) {
-    return status1->layer == status2->layer &&
-        status1->default_layer == status2->default_layer &&
-        status1->mods == status2->mods &&
-        status1->leds == status2->leds &&
-        status1->suspended == status2->suspended
-#ifdef BACKLIGHT_ENABLE
-        && status1->backlight_level == status2->backlight_level
-#endif
-#ifdef VISUALIZER_USER_DATA_SIZE
-        && memcmp(status1->user_data, status2->user_data, VISUALIZER_USER_DATA_SIZE) == 0
-#endif
-    ;
-}
+static struct {
+    uint8_t state;
+    visualizer_keyboard_status_t buffer[3];
+} status_buffer;
 
 static bool visualizer_enabled = false;
 
@@ -91,10 +85,16 @@ static bool visualizer_enabled = false;
 static uint8_t user_data[VISUALIZER_USER_DATA_SIZE];
 #endif
 
-#define MAX_SIMULTANEOUS_ANIMATIONS 4
-static keyframe_animation_t* animations[MAX_SIMULTANEOUS_ANIMATIONS] = {};
+// Set when the status changes, and cleared by the thread before it reads it,
+// so that a burst of changes wakes the thread only once
+static volatile bool status_changed = false;
 
 #ifdef SERIAL_LINK_ENABLE
+// The generation of the last status from the master, a slave gives the
+// statuses its own generations
+static bool has_remote_status = false;
+static uint32_t remote_generation;
+
 MASTER_TO_ALL_SLAVES_OBJECT(current_status, visualizer_keyboard_status_t);
 
 static remote_object_t* remote_objects[] = {
@@ -120,112 +120,6 @@ GDisplay* get_led_display(void) {
 }
 #endif
 
-void start_keyframe_animation(keyframe_animation_t* animation) {
-    animation->current_frame = -1;
-    animation->time_left_in_frame = 0;
-    animation->need_update = true;
-    int free_index = -1;
-    for (int i=0;i<MAX_SIMULTANEOUS_ANIMATIONS;i++) {
-        if (animations[i] == animation) {
-            return;
-        }
-        if (free_index == -1 && animations[i] == NULL) {
-           free_index=i;
-        }
-    }
-    if (free_index!=-1) {
-        animations[free_index] = animation;
-    }
-}
-
-void stop_keyframe_animation(keyframe_animation_t* animation) {
-    animation->current_frame = animation->num_frames;
-    animation->time_left_in_frame = 0;
-    animation->need_update = true;
-    animation->first_update_of_frame = false;
-    animation->last_update_of_frame = false;
-    for (int i=0;i<MAX_SIMULTANEOUS_ANIMATIONS;i++) {
-        if (animations[i] == animation) {
-            animations[i] = NULL;
-            return;
-        }
-    }
-}
-
-void stop_all_keyframe_animations(void) {
-    for (int i=0;i<MAX_SIMULTANEOUS_ANIMATIONS;i++) {
-        if (animations[i]) {
-            animations[i]->current_frame = animations[i]->num_frames;
-            animations[i]->time_left_in_frame = 0;
-            animations[i]->need_update = true;
-            animations[i]->first_update_of_frame = false;
-            animations[i]->last_update_of_frame = false;
-            animations[i] = NULL;
-        }
-    }
-}
-
-static uint8_t get_num_running_animations(void) {
-    uint8_t count = 0;
-    for (int i=0;i<MAX_SIMULTANEOUS_ANIMATIONS;i++) {
-        count += animations[i] ? 1 : 0;
-    }
-    return count;
-}
-
-static bool update_keyframe_animation(keyframe_animation_t* animation, visualizer_state_t* state, systemticks_t delta, systemticks_t* sleep_time) {
-    // TODO: Clean up this messy code
-    dprintf("Animation frame%d, left %d, delta %d\n", animation->current_frame,
-            animation->time_left_in_frame, delta);
-    if (animation->current_frame == animation->num_frames) {
-        animation->need_update = false;
-        return false;
-    }
-    if (animation->current_frame == -1) {
-       animation->current_frame = 0;
-       animation->time_left_in_frame = animation->frame_lengths[0];
-       animation->need_update = true;
-       animation->first_update_of_frame = true;
-    } else {
-        animation->time_left_in_frame -= delta;
-        while (animation->time_left_in_frame <= 0) {
-            int left = animation->time_left_in_frame;
-            if (animation->need_update) {
-                animation->time_left_in_frame = 0;
-                animation->last_update_of_frame = true;
-                (*animation->frame_functions[animation->current_frame])(animation, state);
-                animation->last_update_of_frame = false;
-            }
-            animation->current_frame++;
-            animation->need_update = true;
-            animation->first_update_of_frame = true;
-            if (animation->current_frame == animation->num_frames) {
-                if (animation->loop) {
-                    animation->current_frame = 0;
-                }
-                else {
-                    stop_keyframe_animation(animation);
-                    return false;
-                }
-            }
-            delta = -left;
-            animation->time_left_in_frame = animation->frame_lengths[animation->current_frame];
-            animation->time_left_in_frame -= delta;
-        }
-    }
-    if (animation->need_update) {
-        animation->need_update = (*animation->frame_functions[animation->current_frame])(animation, state);
-        animation->first_update_of_frame = false;
-    }
-
-    systemticks_t wanted_sleep = animation->need_update ? gfxMillisecondsToTicks(10) : (unsigned)animation->time_left_in_frame;
-    if (wanted_sleep < *sleep_time) {
-        *sleep_time = wanted_sleep;
-    }
-
-    return true;
-}
-
 void run_next_keyframe(keyframe_animation_t* animation, visualizer_state_t* state) {
     int next_frame = animation->current_frame + 1;
     if (next_frame == animation->num_frames) {
@@ -251,6 +145,7 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
     geventAttachSource(&event_listener, (GSourceHandle)&current_status, 0);
 
     visualizer_keyboard_status_t initial_status = {
+        .generation = 0,
         .default_layer = 0xFFFFFFFF,
         .layer = 0xFFFFFFFF,
         .mods = 0xFF,
@@ -285,43 +180,52 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
     systemticks_t sleep_time = TIME_INFINITE;
     systemticks_t current_time = gfxSystemTicks();
     bool force_update = true;
+    // The latest status from the main thread
+    visualizer_keyboard_status_t latest_status = initial_status;
 
     while(true) {
         systemticks_t new_time = gfxSystemTicks();
         systemticks_t delta = new_time - current_time;
         current_time = new_time;
         bool enabled = visualizer_enabled;
-        if (force_update || !same_status(&state.status, &current_status)) {
+        bool drawn = false;
+        status_changed = false;
+        visualizer_keyboard_status_t* new_status = triple_buffer_read(&status_buffer);
+        if (new_status) {
+            latest_status = *new_status;
+        }
+        if (force_update || latest_status.generation != state.status.generation) {
             force_update = false;
+            drawn = true;
     #if BACKLIGHT_ENABLE
-            if(current_status.backlight_level != state.status.backlight_level) {
-                if (current_status.backlight_level != 0) {
+            if(latest_status.backlight_level != state.status.backlight_level) {
+                if (latest_status.backlight_level != 0) {
                     gdispGSetPowerMode(LED_DISPLAY, powerOn);
-                    uint16_t percent = (uint16_t)current_status.backlight_level * 100 / BACKLIGHT_LEVELS;
+                    uint16_t percent = (uint16_t)latest_status.backlight_level * 100 / BACKLIGHT_LEVELS;
                     gdispGSetBacklight(LED_DISPLAY, percent);
                 }
                 else {
                     gdispGSetPowerMode(LED_DISPLAY, powerOff);
                 }
-                state.status.backlight_level = current_status.backlight_level;
+                state.status.backlight_level = latest_status.backlight_level;
             }
     #endif
             if (visualizer_enabled) {
-                if (current_status.suspended) {
+                if (latest_status.suspended) {
                     stop_all_keyframe_animations();
                     visualizer_enabled = false;
-                    state.status = current_status;
+                    state.status = latest_status;
                     user_visualizer_suspend(&state);
                 }
                 else {
                     visualizer_keyboard_status_t prev_status = state.status;
-                    state.status = current_status;
+                    state.status = latest_status;
                     update_user_visualizer_state(&state, &prev_status);
                 }
                 state.prev_lcd_color = state.current_lcd_color;
             }
         }
-        if (!enabled && state.status.suspended && current_status.suspended == false) {
+        if (!enabled && state.status.suspended && latest_status.suspended == false) {
             // Setting the status to the initial status will force an update
             // when the visualizer is enabled again
             state.status = initial_status;
@@ -329,24 +233,27 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
             stop_all_keyframe_animations();
             user_visualizer_resume(&state);
             state.prev_lcd_color = state.current_lcd_color;
+            drawn = true;
         }
-        sleep_time = TIME_INFINITE;
-        for (int i=0;i<MAX_SIMULTANEOUS_ANIMATIONS;i++) {
-            if (animations[i]) {
-                update_keyframe_animation(animations[i], &state, delta, &sleep_time);
-            }
-        }
+        // The animations take the ticks as milliseconds, as they always have
+        uint32_t next_update = update_keyframe_animations(&state, delta, &drawn);
+        sleep_time = next_update == VISUALIZER_NO_UPDATE ? TIME_INFINITE : gfxMillisecondsToTicks(next_update);
+
+        // The drivers only send what changed, there's nothing to flush
+        // when nothing was drawn
+        if (drawn) {
 #ifdef BACKLIGHT_ENABLE
-        gdispGFlush(LED_DISPLAY);
+            gdispGFlush(LED_DISPLAY);
 #endif
 
 #ifdef LCD_ENABLE
-        gdispGFlush(LCD_DISPLAY);
+            gdispGFlush(LCD_DISPLAY);
 #endif
 
 #ifdef EMULATOR
-        draw_emulator();
+            draw_emulator();
 #endif
+        }
         // Enable the visualizer when the startup or the suspend animation has finished
         if (!visualizer_enabled && state.status.suspended == false && get_num_running_animations() == 0) {
             visualizer_enabled = true;
@@ -364,7 +271,6 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
                 sleep_time = 0;
             }
         }
-        dprintf("Update took %d, last delta %d, sleep_time %d\n", update_delta, delta, sleep_time);
 #ifdef PROTOCOL_CHIBIOS
         // The gEventWait function really takes milliseconds, even if the documentation says ticks.
         // Unfortunately there's no generic ugfx conversion from system time to milliseconds,
@@ -386,6 +292,7 @@ static DECLARE_THREAD_FUNCTION(visualizerThread, arg) {
 }
 
 void visualizer_init(void) {
+    triple_buffer_init((triple_buffer_object_t*)&status_buffer);
     gfxInit();
 
   #ifdef LCD_BACKLIGHT_ENABLE
@@ -412,6 +319,12 @@ void visualizer_init(void) {
 
 void update_status(bool changed) {
     if (changed) {
+        current_status.generation++;
+        *triple_buffer_begin_write(&status_buffer) = current_status;
+        triple_buffer_end_write(&status_buffer);
+    }
+    if (changed && !status_changed) {
+        status_changed = true;
         GSourceListener* listener = geventGetSourceListener((GSourceHandle)&current_status, NULL);
         if (listener) {
             geventSendEvent(listener);
@@ -448,42 +361,43 @@ void visualizer_set_user_data(void* u) {
 #endif
 
 void visualizer_update(uint32_t default_state, uint32_t state, uint8_t mods, uint32_t leds) {
-    // Note that there's a small race condition here, the thread could read
-    // a state where one of these are set but not the other. But this should
-    // not really matter as it will be fixed during the next loop step.
-    // Alternatively a mutex could be used instead of the volatile variables
+    // The visualizer thread only sees the status when update_status()
+    // hands it over, so there's no race with the thread reading it
 
     bool changed = false;
 #ifdef SERIAL_LINK_ENABLE
     if (is_serial_link_connected ()) {
         visualizer_keyboard_status_t* new_status = read_current_status();
-        if (new_status) {
-            if (!same_status(&current_status, new_status)) {
-                changed = true;
-                current_status = *new_status;
-            }
+        if (new_status && (!has_remote_status || new_status->generation != remote_generation)) {
+            has_remote_status = true;
+            remote_generation = new_status->generation;
+            uint32_t generation = current_status.generation;
+            current_status = *new_status;
+            current_status.generation = generation;
+            changed = true;
         }
     }
     else {
+        has_remote_status = false;
 #else
    {
 #endif
-        visualizer_keyboard_status_t new_status = {
-            .layer = state,
-            .default_layer = default_state,
-            .mods = mods,
-            .leds = leds,
-#ifdef BACKLIGHT_ENABLE
-            .backlight_level = current_status.backlight_level,
-#endif
-            .suspended = current_status.suspended,
-        };
+        if (current_status.layer != state ||
+            current_status.default_layer != default_state ||
+            current_status.mods != mods ||
+            current_status.leds != leds
 #ifdef VISUALIZER_USER_DATA_SIZE
-       memcpy(new_status.user_data, user_data, VISUALIZER_USER_DATA_SIZE);
+            || memcmp(current_status.user_data, user_data, VISUALIZER_USER_DATA_SIZE) != 0
 #endif
-        if (!same_status(&current_status, &new_status)) {
+        ) {
             changed = true;
-            current_status = new_status;
+            current_status.layer = state;
+            current_status.default_layer = default_state;
+            current_status.mods = mods;
+            current_status.leds = leds;
+#ifdef VISUALIZER_USER_DATA_SIZE
+            memcpy(current_status.user_data, user_data, VISUALIZER_USER_DATA_SIZE);
+#endif
         }
     }
     update_status(changed);
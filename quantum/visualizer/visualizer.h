@@ -30,6 +30,7 @@ SOFTWARE.
 
 #include "config.h"
 #include "gfx.h"
+#include "visualizer_animations.h"
 
 #ifdef LCD_BACKLIGHT_ENABLE
 #include "lcd_backlight.h"
@@ -62,12 +63,10 @@ GDisplay* get_led_display(void);
 void draw_emulator(void);
 #endif
 
-// If you need support for more than 16 keyframes per animation, you can change this
-#define MAX_VISUALIZER_KEY_FRAMES 16
-
-struct keyframe_animation_t;
-
 typedef struct {
+    // Changes with every change of the status, so that it's cheap to tell
+    // whether anything has changed
+    uint32_t generation;
     uint32_t layer;
     uint32_t default_layer;
     uint32_t leds; // See led.h for available statuses
@@ -101,35 +100,9 @@ typedef struct visualizer_state_t {
 #endif
 } visualizer_state_t;
 
-// Any custom keyframe function should have this signature
-// return true to get continuous updates, otherwise you will only get one
-// update per frame
-typedef bool (*frame_func)(struct keyframe_animation_t*, visualizer_state_t*);
-
-// Represents a keyframe animation, so fields are internal to the system
-// while others are meant to be initialized by the user code
-typedef struct keyframe_animation_t {
-    // These should be initialized
-    int num_frames;
-    bool loop;
-    int frame_lengths[MAX_VISUALIZER_KEY_FRAMES];
-    frame_func frame_functions[MAX_VISUALIZER_KEY_FRAMES];
-
-    // Used internally by the system, and can also be read by
-    // keyframe update functions
-    int current_frame;
-    int time_left_in_frame;
-    bool first_update_of_frame;
-    bool last_update_of_frame;
-    bool need_update;
-
-} keyframe_animation_t;
-
 extern GDisplay* LCD_DISPLAY;
 extern GDisplay* LED_DISPLAY;
 
-void start_keyframe_animation(keyframe_animation_t* animation);
-void stop_keyframe_animation(keyframe_animation_t* animation);
 // This runs the next keyframe, but does not update the animation state
 // Useful for crossfades for example
 void run_next_keyframe(keyframe_animation_t* animation, visualizer_state_t* state);
@@ -45,7 +45,13 @@ endef
 GDISP_DRIVER_LIST:=
 
 SRC += $(VISUALIZER_DIR)/visualizer.c \
+	$(VISUALIZER_DIR)/visualizer_animations.c \
 	$(VISUALIZER_DIR)/visualizer_keyframes.c
+# The status goes to the visualizer thread through a triple buffer, which
+# the serial link builds already when it's enabled
+ifneq ($(strip $(SERIAL_LINK_ENABLE)), yes)
+SRC += $(SERIAL_DIR)/protocol/triple_buffered_object.c
+endif
 EXTRAINCDIRS += $(GFXINC) $(VISUALIZER_DIR)
 GFXLIB = $(LIB_PATH)/ugfx
 VPATH += $(VISUALIZER_PATH)
@@ -60,6 +66,7 @@ endif
 ifeq ($(strip $(LCD_ENABLE)), yes)
 SRC += $(VISUALIZER_DIR)/lcd_backlight.c
 SRC += $(VISUALIZER_DIR)/lcd_keyframes.c
+SRC += $(VISUALIZER_DIR)/lcd_image.c
 SRC += $(VISUALIZER_DIR)/lcd_backlight_keyframes.c
 # Note, that the linker will strip out any resources that are not actually in use
 SRC += $(VISUALIZER_DIR)/resources/lcd_logo.c
@@ -69,6 +76,7 @@ endif
 
 ifeq ($(strip $(BACKLIGHT_ENABLE)), yes)
 SRC += $(VISUALIZER_DIR)/led_backlight_keyframes.c
+SRC += $(VISUALIZER_DIR)/led_backlight_kernels.c
 $(eval $(call ADD_DRIVER,LED))
 endif
 
@@ -0,0 +1,166 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 Fred Sundvik
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "visualizer_animations.h"
+#include <stddef.h>
+
+static keyframe_animation_t* animations[MAX_SIMULTANEOUS_ANIMATIONS] = {};
+
+void start_keyframe_animation(keyframe_animation_t* animation) {
+    animation->current_frame = -1;
+    animation->time_left_in_frame = 0;
+    animation->need_update = true;
+    int free_index = -1;
+    for (int i=0;i<MAX_SIMULTANEOUS_ANIMATIONS;i++) {
+        if (animations[i] == animation) {
+            return;
+        }
+        if (free_index == -1 && animations[i] == NULL) {
+           free_index=i;
+        }
+    }
+    if (free_index!=-1) {
+        animations[free_index] = animation;
+    }
+}
+
+static void reset_animation(keyframe_animation_t* animation) {
+    animation->current_frame = animation->num_frames;
+    animation->time_left_in_frame = 0;
+    animation->need_update = true;
+    animation->first_update_of_frame = false;
+    animation->last_update_of_frame = false;
+}
+
+void stop_keyframe_animation(keyframe_animation_t* animation) {
+    reset_animation(animation);
+    for (int i=0;i<MAX_SIMULTANEOUS_ANIMATIONS;i++) {
+        if (animations[i] == animation) {
+            animations[i] = NULL;
+            return;
+        }
+    }
+}
+
+void stop_all_keyframe_animations(void) {
+    for (int i=0;i<MAX_SIMULTANEOUS_ANIMATIONS;i++) {
+        if (animations[i]) {
+            reset_animation(animations[i]);
+            animations[i] = NULL;
+        }
+    }
+}
+
+uint8_t get_num_running_animations(void) {
+    uint8_t count = 0;
+    for (int i=0;i<MAX_SIMULTANEOUS_ANIMATIONS;i++) {
+        count += animations[i] ? 1 : 0;
+    }
+    return count;
+}
+
+void keyframe_update_per_step(keyframe_animation_t* animation, int steps) {
+    int frame_length = animation->frame_lengths[animation->current_frame];
+    if (steps < 0) {
+        steps = -steps;
+    }
+    int interval = steps ? frame_length / steps : frame_length;
+    if (interval > VISUALIZER_UPDATE_INTERVAL) {
+        animation->time_to_next_update = interval;
+    }
+}
+
+static bool call_frame_function(keyframe_animation_t* animation, struct visualizer_state_t* state) {
+    animation->time_to_next_update = VISUALIZER_UPDATE_INTERVAL;
+    return (*animation->frame_functions[animation->current_frame])(animation, state);
+}
+
+// Returns false when the animation has finished, otherwise lowers *next_update
+// to when it's due again
+static bool update_keyframe_animation(keyframe_animation_t* animation, struct visualizer_state_t* state,
+        uint32_t delta, uint32_t* next_update, bool* drawn) {
+    if (animation->current_frame == animation->num_frames) {
+        animation->need_update = false;
+        return false;
+    }
+    if (animation->current_frame == -1) {
+       animation->current_frame = 0;
+       animation->time_left_in_frame = animation->frame_lengths[0];
+       animation->need_update = true;
+       animation->first_update_of_frame = true;
+    } else {
+        animation->time_left_in_frame -= delta;
+        while (animation->time_left_in_frame <= 0) {
+            int left = animation->time_left_in_frame;
+            if (animation->need_update) {
+                // One last update at the end of the frame
+                animation->time_left_in_frame = 0;
+                animation->last_update_of_frame = true;
+                call_frame_function(animation, state);
+                *drawn = true;
+                animation->last_update_of_frame = false;
+            }
+            animation->current_frame++;
+            animation->need_update = true;
+            animation->first_update_of_frame = true;
+            if (animation->current_frame == animation->num_frames) {
+                if (animation->loop) {
+                    animation->current_frame = 0;
+                }
+                else {
+                    stop_keyframe_animation(animation);
+                    return false;
+                }
+            }
+            delta = -left;
+            animation->time_left_in_frame = animation->frame_lengths[animation->current_frame];
+            animation->time_left_in_frame -= delta;
+        }
+    }
+    if (animation->need_update) {
+        animation->need_update = call_frame_function(animation, state);
+        animation->first_update_of_frame = false;
+        *drawn = true;
+    }
+
+    // The end of the frame is due in any case
+    uint32_t wanted = animation->time_left_in_frame;
+    if (animation->need_update && animation->time_to_next_update < animation->time_left_in_frame) {
+        wanted = animation->time_to_next_update > 0 ? animation->time_to_next_update : 0;
+    }
+    if (wanted < *next_update) {
+        *next_update = wanted;
+    }
+    return true;
+}
+
+uint32_t update_keyframe_animations(struct visualizer_state_t* state, uint32_t delta, bool* drawn) {
+    uint32_t next_update = VISUALIZER_NO_UPDATE;
+    for (int i=0;i<MAX_SIMULTANEOUS_ANIMATIONS;i++) {
+        if (animations[i]) {
+            update_keyframe_animation(animations[i], state, delta, &next_update, drawn);
+        }
+    }
+    return next_update;
+}
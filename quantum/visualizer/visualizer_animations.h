@@ -0,0 +1,92 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2016 Fred Sundvik
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef VISUALIZER_ANIMATIONS_H
+#define VISUALIZER_ANIMATIONS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// The timing of the keyframe animations, this doesn't depend on uGFX so it
+// can be run anywhere
+
+// If you need support for more than 16 keyframes per animation, you can change this
+#define MAX_VISUALIZER_KEY_FRAMES 16
+
+#define MAX_SIMULTANEOUS_ANIMATIONS 4
+
+// How often a frame function that returns true is called again, unless it
+// sets time_to_next_update, in ms
+#ifndef VISUALIZER_UPDATE_INTERVAL
+#define VISUALIZER_UPDATE_INTERVAL 10
+#endif
+
+// Returned by update_keyframe_animations when nothing needs to run again
+#define VISUALIZER_NO_UPDATE 0xFFFFFFFF
+
+struct keyframe_animation_t;
+struct visualizer_state_t;
+
+// Any custom keyframe function should have this signature
+// return true to get continuous updates, otherwise you will only get one
+// update per frame
+typedef bool (*frame_func)(struct keyframe_animation_t*, struct visualizer_state_t*);
+
+// Represents a keyframe animation, so fields are internal to the system
+// while others are meant to be initialized by the user code
+typedef struct keyframe_animation_t {
+    // These should be initialized
+    int num_frames;
+    bool loop;
+    int frame_lengths[MAX_VISUALIZER_KEY_FRAMES];
+    frame_func frame_functions[MAX_VISUALIZER_KEY_FRAMES];
+
+    // Used internally by the system, and can also be read by
+    // keyframe update functions
+    int current_frame;
+    int time_left_in_frame;
+    bool first_update_of_frame;
+    bool last_update_of_frame;
+    bool need_update;
+
+    // A frame function that returns true can set this to when it needs to
+    // be called next, in ms. It's VISUALIZER_UPDATE_INTERVAL before each call.
+    int time_to_next_update;
+} keyframe_animation_t;
+
+void start_keyframe_animation(keyframe_animation_t* animation);
+void stop_keyframe_animation(keyframe_animation_t* animation);
+void stop_all_keyframe_animations(void);
+uint8_t get_num_running_animations(void);
+
+// For a frame function that fades through steps values over the frame, asks
+// to be called again when the next value is due
+void keyframe_update_per_step(keyframe_animation_t* animation, int steps);
+
+// Advances the running animations by delta ms, calling the frame functions
+// that are due. Sets *drawn if any of them was called. Returns how long
+// until the next one is due, in ms, or VISUALIZER_NO_UPDATE.
+uint32_t update_keyframe_animations(struct visualizer_state_t* state, uint32_t delta, bool* drawn);
+
+#endif /* VISUALIZER_ANIMATIONS_H */
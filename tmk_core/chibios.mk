@@ -124,6 +124,9 @@ EXTRAINCDIRS += $(CHIBIOS)/os/license \
          $(HALINC) $(PLATFORMINC) $(BOARDINC) $(TESTINC) \
          $(STREAMSINC) $(CHIBIOS)/os/various 
 
+# The drivers written for ChibiOS, like the WS2812 one
+COMMON_VPATH += $(DRIVER_PATH)/arm
+
 #
 # Project, sources and paths
 ##############################################################################
@@ -30,6 +30,7 @@ endif
 ifeq ($(PLATFORM),CHIBIOS)
 	TMK_COMMON_SRC += $(PLATFORM_COMMON_DIR)/printf.c
 	TMK_COMMON_SRC += $(PLATFORM_COMMON_DIR)/eeprom.c
+	TMK_COMMON_SRC += $(COMMON_DIR)/flash_store.c
 endif
 
 ifeq ($(PLATFORM),TEST)
@@ -15,6 +15,10 @@
  * 64               periods/second[frequency]
  * 256*64           interrupts/second
  * F_CPU/(256*64)   clocks/interrupt
+ *
+ * This stays apart from backlight_pwm: it blinks the lock LEDs through
+ * led_set(), which can be on any pin, and it has to run while the main loop
+ * is stopped in the suspend loop, where nothing would call backlight_task().
  */
 #define SLEEP_LED_TIMER_TOP F_CPU/(256*64)
 
@@ -82,14 +86,18 @@ ISR(TIMER1_COMPA_vect)
         } pwm;
     } timer = { .row = 0 };
 
+    // Only looked up at the start of each PWM period
+    static uint8_t on_time = 0;
+
     timer.row++;
     
     // LED on
     if (timer.pwm.count == 0) {
+        on_time = pgm_read_byte(&breathing_table[timer.pwm.index]);
         led_set(1<<USB_LED_CAPS_LOCK);
     }
     // LED off
-    if (timer.pwm.count == pgm_read_byte(&breathing_table[timer.pwm.index])) {
+    if (timer.pwm.count == on_time) {
         led_set(0);
     }
 }
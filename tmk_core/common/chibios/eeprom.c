@@ -305,6 +305,10 @@ void do_flash_cmd(volatile uint8_t *fstat)
    e:	4770      	bx	lr
 */
 
+// Nothing to do in the background
+void eeprom_task(void) {
+}
+
 #elif defined(KL2x) /* chip selection */
 /* Teensy LC (emulated) */
 
@@ -501,6 +505,130 @@ void eeprom_write_block(const void *buf, void *addr, uint32_t len)
 	}
 }
 
+// Nothing to do in the background
+void eeprom_task(void) {
+}
+
+#elif defined(STM32F0xx_MCUCONF) || defined(STM32F3xx_MCUCONF) /* chip selection */
+/* STM32F0 and STM32F3, emulated in two pages of flash the linker script
+ * sets aside as the EEPROM work area */
+
+#ifndef FLASH_STORE_PAGE_SIZE
+#  if defined(STM32F030x6) || defined(STM32F030x8) || defined(STM32F031x6) || defined(STM32F038xx) || \
+      defined(STM32F042x6) || defined(STM32F048xx) || defined(STM32F051x8) || defined(STM32F058xx) || \
+      defined(STM32F070x6)
+#    define FLASH_STORE_PAGE_SIZE 1024
+#  elif defined(STM32F030xC) || defined(STM32F070xB) || defined(STM32F071xB) || defined(STM32F072xB) || \
+        defined(STM32F078xx) || defined(STM32F091xC) || defined(STM32F098xx) || defined(STM32F3xx_MCUCONF)
+#    define FLASH_STORE_PAGE_SIZE 2048
+#  else
+#    error "Unknown flash page size for this MCU, set FLASH_STORE_PAGE_SIZE"
+#  endif
+#endif
+
+#include "flash_store.h"
+
+#define SYMVAL(sym) (uint32_t)(((uint8_t *)&(sym)) - ((uint8_t *)0))
+
+extern uint32_t __eeprom_workarea_start__;
+extern uint32_t __eeprom_workarea_end__;
+
+#define FLASH_KEY_1 0x45670123
+#define FLASH_KEY_2 0xCDEF89AB
+
+static volatile uint16_t *page_address(uint8_t page) {
+	return (volatile uint16_t *)(SYMVAL(__eeprom_workarea_start__) + page * FLASH_STORE_PAGE_SIZE);
+}
+
+static void flash_unlock(void) {
+	if (FLASH->CR & FLASH_CR_LOCK) {
+		FLASH->KEYR = FLASH_KEY_1;
+		FLASH->KEYR = FLASH_KEY_2;
+	}
+}
+
+static void flash_wait(void) {
+	while (FLASH->SR & FLASH_SR_BSY);
+	// Clear the end of operation and error flags
+	FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPERR;
+}
+
+uint16_t flash_store_read_halfword(uint8_t page, uint16_t offset) {
+	return page_address(page)[offset / 2];
+}
+
+void flash_store_program_halfword(uint8_t page, uint16_t offset, uint16_t value) {
+	flash_unlock();
+	FLASH->CR |= FLASH_CR_PG;
+	page_address(page)[offset / 2] = value;
+	flash_wait();
+	FLASH->CR &= ~FLASH_CR_PG;
+	FLASH->CR |= FLASH_CR_LOCK;
+}
+
+void flash_store_erase_page(uint8_t page) {
+	flash_unlock();
+	FLASH->CR |= FLASH_CR_PER;
+	FLASH->AR = (uint32_t)page_address(page);
+	FLASH->CR |= FLASH_CR_STRT;
+	flash_wait();
+	FLASH->CR &= ~FLASH_CR_PER;
+	FLASH->CR |= FLASH_CR_LOCK;
+}
+
+void eeprom_task(void) {
+	flash_store_task();
+}
+
+uint8_t eeprom_read_byte(const uint8_t *addr) {
+	return flash_store_read_byte((uint32_t)addr);
+}
+
+void eeprom_write_byte(uint8_t *addr, uint8_t value) {
+	flash_store_write_byte((uint32_t)addr, value);
+}
+
+uint16_t eeprom_read_word(const uint16_t *addr) {
+	const uint8_t *p = (const uint8_t *)addr;
+	return eeprom_read_byte(p) | (eeprom_read_byte(p+1) << 8);
+}
+
+uint32_t eeprom_read_dword(const uint32_t *addr) {
+	const uint8_t *p = (const uint8_t *)addr;
+	return eeprom_read_byte(p) | (eeprom_read_byte(p+1) << 8)
+		| (eeprom_read_byte(p+2) << 16) | (eeprom_read_byte(p+3) << 24);
+}
+
+void eeprom_read_block(void *buf, const void *addr, uint32_t len) {
+	const uint8_t *p = (const uint8_t *)addr;
+	uint8_t *dest = (uint8_t *)buf;
+	while (len--) {
+		*dest++ = eeprom_read_byte(p++);
+	}
+}
+
+void eeprom_write_word(uint16_t *addr, uint16_t value) {
+	uint8_t *p = (uint8_t *)addr;
+	eeprom_write_byte(p++, value);
+	eeprom_write_byte(p, value >> 8);
+}
+
+void eeprom_write_dword(uint32_t *addr, uint32_t value) {
+	uint8_t *p = (uint8_t *)addr;
+	eeprom_write_byte(p++, value);
+	eeprom_write_byte(p++, value >> 8);
+	eeprom_write_byte(p++, value >> 16);
+	eeprom_write_byte(p, value >> 24);
+}
+
+void eeprom_write_block(const void *buf, void *addr, uint32_t len) {
+	uint8_t *p = (uint8_t *)addr;
+	const uint8_t *src = (const uint8_t *)buf;
+	while (len--) {
+		eeprom_write_byte(p++, *src++);
+	}
+}
+
 #else
 // No EEPROM supported, so emulate it
 
@@ -558,6 +686,10 @@ void eeprom_write_block(const void *buf, void *addr, uint32_t len) {
 	}
 }
 
+// Nothing to do in the background
+void eeprom_task(void) {
+}
+
 #endif /* chip selection */
 // The update functions just calls write for now, but could probably be optimized
 
@@ -11,6 +11,7 @@
 #include "backlight.h"
 #include "suspend.h"
 #include "wait.h"
+#include "eeconfig.h"
 
 void suspend_idle(uint8_t time) {
 	// TODO: this is not used anywhere - what units is 'time' in?
@@ -18,6 +19,9 @@ void suspend_idle(uint8_t time) {
 }
 
 void suspend_power_down(void) {
+	// The power may go while the host is asleep
+	eeconfig_flush();
+
 	// TODO: figure out what to power down and how
 	// shouldn't power down TPM/FTM if we want a breathing LED
 	// also shouldn't power down USB
@@ -2,58 +2,166 @@
 #include <stdbool.h>
 #include "eeprom.h"
 #include "eeconfig.h"
+#include "timer.h"
 
+/* Write-back cache
+ *
+ * Stepping through the hue or the backlight levels updates a setting on
+ * every key press, and every EEPROM write takes 3.3ms on AVR and wears the
+ * cell a bit. The updates are kept here instead, and written out once the
+ * setting has settled.
+ */
+_Static_assert(EECONFIG_SIZE <= 16, "pending_mask has a bit for each byte of eeconfig");
+
+static uint8_t pending[EECONFIG_SIZE];
+static uint16_t pending_mask = 0;
+static uint16_t last_update;
+
+// Anything past eeconfig goes straight to the EEPROM
+static uint8_t read_byte(const void *addr)
+{
+    uintptr_t offset = (uintptr_t)addr;
+    if (offset >= EECONFIG_SIZE) {
+        return eeprom_read_byte(addr);
+    }
+    if (pending_mask & (1 << offset)) {
+        return pending[offset];
+    }
+    return eeprom_read_byte(addr);
+}
+
+static void update_byte(void *addr, uint8_t val)
+{
+    uintptr_t offset = (uintptr_t)addr;
+    if (offset >= EECONFIG_SIZE) {
+        eeprom_update_byte(addr, val);
+        return;
+    }
+    if (read_byte(addr) == val) {
+        return;
+    }
+    // Changed back before it was written
+    if (eeprom_read_byte(addr) == val) {
+        pending_mask &= ~(1 << offset);
+        return;
+    }
+    pending[offset] = val;
+    pending_mask |= (1 << offset);
+    last_update = timer_read();
+}
+
+void eeconfig_read_block(void *buf, const void *addr, uint8_t len)
+{
+    uint8_t *dest = (uint8_t *)buf;
+    const uint8_t *p = (const uint8_t *)addr;
+    while (len--) {
+        *dest++ = read_byte(p++);
+    }
+}
+
+void eeconfig_update_block(const void *buf, void *addr, uint8_t len)
+{
+    const uint8_t *src = (const uint8_t *)buf;
+    uint8_t *p = (uint8_t *)addr;
+    while (len--) {
+        update_byte(p++, *src++);
+    }
+}
+
+void eeconfig_flush(void)
+{
+    for (uint8_t i = 0; pending_mask; i++) {
+        if (pending_mask & (1 << i)) {
+            eeprom_update_byte((uint8_t *)(uintptr_t)i, pending[i]);
+            pending_mask &= ~(1 << i);
+        }
+    }
+}
+
+void eeconfig_task(void)
+{
+    if (pending_mask && timer_elapsed(last_update) >= EECONFIG_WRITE_DELAY) {
+        eeconfig_flush();
+    }
+}
+
+uint8_t eeconfig_pending_writes(void)
+{
+    uint8_t count = 0;
+    for (uint16_t mask = pending_mask; mask; mask >>= 1) {
+        count += mask & 1;
+    }
+    return count;
+}
+
+static uint16_t read_word(const void *addr)
+{
+    uint16_t val;
+    eeconfig_read_block(&val, addr, sizeof(val));
+    return val;
+}
+
+static void update_word(void *addr, uint16_t val)
+{
+    eeconfig_update_block(&val, addr, sizeof(val));
+}
+
+// These take effect right away, they're rare and may come just before a reset
 void eeconfig_init(void)
 {
-    eeprom_update_word(EECONFIG_MAGIC,          EECONFIG_MAGIC_NUMBER);
-    eeprom_update_byte(EECONFIG_DEBUG,          0);
-    eeprom_update_byte(EECONFIG_DEFAULT_LAYER,  0);
-    eeprom_update_byte(EECONFIG_KEYMAP,         0);
-    eeprom_update_byte(EECONFIG_MOUSEKEY_ACCEL, 0);
+    update_word(EECONFIG_MAGIC,          EECONFIG_MAGIC_NUMBER);
+    update_byte(EECONFIG_DEBUG,          0);
+    update_byte(EECONFIG_DEFAULT_LAYER,  0);
+    update_byte(EECONFIG_KEYMAP,         0);
+    update_byte(EECONFIG_MOUSEKEY_ACCEL, 0);
 #ifdef BACKLIGHT_ENABLE
-    eeprom_update_byte(EECONFIG_BACKLIGHT,      0);
+    update_byte(EECONFIG_BACKLIGHT,      0);
 #endif
 #ifdef AUDIO_ENABLE
-    eeprom_update_byte(EECONFIG_AUDIO,             0xFF); // On by default
+    update_byte(EECONFIG_AUDIO,             0xFF); // On by default
 #endif
 #ifdef RGBLIGHT_ENABLE
-    eeprom_update_dword(EECONFIG_RGBLIGHT,      0);
+    uint32_t rgblight = 0;
+    eeconfig_update_block(&rgblight, EECONFIG_RGBLIGHT, sizeof(rgblight));
 #endif
 #ifdef STENO_ENABLE
-    eeprom_update_byte(EECONFIG_STENOMODE,      0);
+    update_byte(EECONFIG_STENOMODE,      0);
 #endif
+    eeconfig_flush();
 }
 
 void eeconfig_enable(void)
 {
-    eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
+    update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
+    eeconfig_flush();
 }
 
 void eeconfig_disable(void)
 {
-    eeprom_update_word(EECONFIG_MAGIC, 0xFFFF);
+    update_word(EECONFIG_MAGIC, 0xFFFF);
+    eeconfig_flush();
 }
 
 bool eeconfig_is_enabled(void)
 {
-    return (eeprom_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER);
+    return (read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER);
 }
 
-uint8_t eeconfig_read_debug(void)      { return eeprom_read_byte(EECONFIG_DEBUG); }
-void eeconfig_update_debug(uint8_t val) { eeprom_update_byte(EECONFIG_DEBUG, val); }
+uint8_t eeconfig_read_debug(void)      { return read_byte(EECONFIG_DEBUG); }
+void eeconfig_update_debug(uint8_t val) { update_byte(EECONFIG_DEBUG, val); }
 
-uint8_t eeconfig_read_default_layer(void)      { return eeprom_read_byte(EECONFIG_DEFAULT_LAYER); }
-void eeconfig_update_default_layer(uint8_t val) { eeprom_update_byte(EECONFIG_DEFAULT_LAYER, val); }
+uint8_t eeconfig_read_default_layer(void)      { return read_byte(EECONFIG_DEFAULT_LAYER); }
+void eeconfig_update_default_layer(uint8_t val) { update_byte(EECONFIG_DEFAULT_LAYER, val); }
 
-uint8_t eeconfig_read_keymap(void)      { return eeprom_read_byte(EECONFIG_KEYMAP); }
-void eeconfig_update_keymap(uint8_t val) { eeprom_update_byte(EECONFIG_KEYMAP, val); }
+uint8_t eeconfig_read_keymap(void)      { return read_byte(EECONFIG_KEYMAP); }
+void eeconfig_update_keymap(uint8_t val) { update_byte(EECONFIG_KEYMAP, val); }
 
 #ifdef BACKLIGHT_ENABLE
-uint8_t eeconfig_read_backlight(void)      { return eeprom_read_byte(EECONFIG_BACKLIGHT); }
-void eeconfig_update_backlight(uint8_t val) { eeprom_update_byte(EECONFIG_BACKLIGHT, val); }
+uint8_t eeconfig_read_backlight(void)      { return read_byte(EECONFIG_BACKLIGHT); }
+void eeconfig_update_backlight(uint8_t val) { update_byte(EECONFIG_BACKLIGHT, val); }
 #endif
 
 #ifdef AUDIO_ENABLE
-uint8_t eeconfig_read_audio(void)      { return eeprom_read_byte(EECONFIG_AUDIO); }
-void eeconfig_update_audio(uint8_t val) { eeprom_update_byte(EECONFIG_AUDIO, val); }
+uint8_t eeconfig_read_audio(void)      { return read_byte(EECONFIG_AUDIO); }
+void eeconfig_update_audio(uint8_t val) { update_byte(EECONFIG_AUDIO, val); }
 #endif
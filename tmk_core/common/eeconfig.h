@@ -38,6 +38,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // EEHANDS for two handed boards
 #define EECONFIG_HANDEDNESS         				(uint8_t *)14
 
+// The bytes above, the ones that go through the write-back cache
+#define EECONFIG_SIZE                               15
+
+// Settings are held in RAM when they're updated, and only written to the
+// EEPROM once they haven't changed for this long (in ms)
+#ifndef EECONFIG_WRITE_DELAY
+#define EECONFIG_WRITE_DELAY                        2000
+#endif
+
 
 /* debug bit */
 #define EECONFIG_DEBUG_ENABLE                       (1<<0)
@@ -64,6 +73,19 @@ void eeconfig_enable(void);
 
 void eeconfig_disable(void);
 
+/* Writes the settings that have been held back once they've been quiet for
+ * EECONFIG_WRITE_DELAY, call it from the main loop */
+void eeconfig_task(void);
+/* Writes all the settings that have been held back right now, before the
+ * power might go away */
+void eeconfig_flush(void);
+/* The number of bytes waiting to be written */
+uint8_t eeconfig_pending_writes(void);
+
+/* For settings wider than a byte, the reads see the updates still pending */
+void eeconfig_read_block(void *buf, const void *addr, uint8_t len);
+void eeconfig_update_block(const void *buf, void *addr, uint8_t len);
+
 uint8_t eeconfig_read_debug(void);
 void eeconfig_update_debug(uint8_t val);
 
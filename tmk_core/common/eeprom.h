@@ -18,6 +18,8 @@ void 	eeprom_update_byte (uint8_t *__p, uint8_t __value);
 void 	eeprom_update_word (uint16_t *__p, uint16_t __value);
 void 	eeprom_update_dword (uint32_t *__p, uint32_t __value);
 void 	eeprom_update_block (const void *__src, void *__dst, uint32_t __n);
+// Background upkeep of emulated EEPROM, from the main loop
+void 	eeprom_task (void);
 #endif
 
 
@@ -0,0 +1,184 @@
+/*
+EEPROM emulation on two pages of flash
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string.h>
+#include "timer.h"
+#include "flash_store.h"
+
+/*
+ * Page layout, in half-words:
+ *   0: 0xEEEE while the page is being filled, 0x0000 once it's obsolete
+ *   1: 0xAAAA once the page is complete and active
+ *   2 onwards: records, (addr << 8 | value) followed by its complement
+ *
+ * Each step only clears bits, so a page that has been written to is never
+ * written again until it's erased.
+ */
+#define ERASED    0xFFFF
+#define RECEIVING 0xEEEE
+#define ACTIVE    0xAAAA
+#define OBSOLETE  0x0000
+
+#define HEADER_SIZE 4
+#define RECORD_SIZE 4
+#define PAGE_RECORDS ((FLASH_STORE_PAGE_SIZE - HEADER_SIZE) / RECORD_SIZE)
+
+static uint8_t values[FLASH_STORE_SIZE];
+static bool initialized = false;
+static uint8_t active;
+static uint16_t next_record;
+// Whether the other page is known to be erased
+static bool spare_erased;
+static uint16_t last_write;
+
+static uint16_t record_offset(uint16_t record) {
+  return HEADER_SIZE + record * RECORD_SIZE;
+}
+
+static bool page_is_active(uint8_t page) {
+  return flash_store_read_halfword(page, 0) == RECEIVING &&
+         flash_store_read_halfword(page, 2) == ACTIVE;
+}
+
+static bool page_is_erased(uint8_t page) {
+  for (uint16_t offset = 0; offset < FLASH_STORE_PAGE_SIZE; offset += 2) {
+    if (flash_store_read_halfword(page, offset) != ERASED) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Applies the records of a page to values[], returns how many there are
+static uint16_t load_page(uint8_t page, bool apply) {
+  uint16_t record;
+  for (record = 0; record < PAGE_RECORDS; record++) {
+    uint16_t value = flash_store_read_halfword(page, record_offset(record));
+    uint16_t check = flash_store_read_halfword(page, record_offset(record) + 2);
+    if (value == ERASED && check == ERASED) {
+      break;
+    }
+    // Anything else was cut short and takes up the slot
+    if (apply && check == (uint16_t)~value && (value >> 8) < FLASH_STORE_SIZE) {
+      values[value >> 8] = value & 0xFF;
+    }
+  }
+  return record;
+}
+
+static void program_record(uint8_t page, uint16_t record, uint8_t addr, uint8_t value) {
+  uint16_t data = (uint16_t)addr << 8 | value;
+  flash_store_program_halfword(page, record_offset(record), data);
+  flash_store_program_halfword(page, record_offset(record) + 2, ~data);
+}
+
+static void format(void) {
+  flash_store_erase_page(0);
+  flash_store_erase_page(1);
+  flash_store_program_halfword(0, 0, RECEIVING);
+  flash_store_program_halfword(0, 2, ACTIVE);
+  active = 0;
+  next_record = 0;
+  spare_erased = true;
+}
+
+// Moves the current values to the other page
+static void compact(void) {
+  uint8_t spare = active ^ 1;
+  if (!spare_erased) {
+    flash_store_erase_page(spare);
+  }
+  flash_store_program_halfword(spare, 0, RECEIVING);
+  uint16_t record = 0;
+  for (uint16_t addr = 0; addr < FLASH_STORE_SIZE; addr++) {
+    // Erased bytes read back as 0xFF anyway
+    if (values[addr] != 0xFF) {
+      program_record(spare, record++, addr, values[addr]);
+    }
+  }
+  flash_store_program_halfword(spare, 2, ACTIVE);
+  // The old page is still active until here, so both are after a power loss
+  flash_store_program_halfword(active, 0, OBSOLETE);
+  active = spare;
+  next_record = record;
+  spare_erased = false;
+}
+
+void flash_store_init(void) {
+  memset(values, 0xFF, sizeof(values));
+  initialized = true;
+  last_write = timer_read();
+
+  bool active0 = page_is_active(0);
+  bool active1 = page_is_active(1);
+  if (!active0 && !active1) {
+    format();
+    return;
+  }
+  if (active0 && active1) {
+    // The copy finished but the old page wasn't marked, the copy has fewer records
+    uint16_t records0 = load_page(0, false);
+    uint16_t records1 = load_page(1, false);
+    active = records0 < records1 ? 0 : 1;
+    flash_store_program_halfword(active ^ 1, 0, OBSOLETE);
+  } else {
+    active = active0 ? 0 : 1;
+  }
+  next_record = load_page(active, true);
+  spare_erased = page_is_erased(active ^ 1);
+}
+
+uint8_t flash_store_read_byte(uint16_t addr) {
+  if (!initialized) {
+    flash_store_init();
+  }
+  if (addr >= FLASH_STORE_SIZE) {
+    return 0xFF;
+  }
+  return values[addr];
+}
+
+void flash_store_write_byte(uint16_t addr, uint8_t value) {
+  if (!initialized) {
+    flash_store_init();
+  }
+  if (addr >= FLASH_STORE_SIZE || values[addr] == value) {
+    return;
+  }
+  values[addr] = value;
+  if (next_record >= PAGE_RECORDS) {
+    // The new value is copied over with the rest
+    compact();
+  } else {
+    program_record(active, next_record++, addr, value);
+  }
+  last_write = timer_read();
+}
+
+void flash_store_task(void) {
+  if (!initialized || timer_elapsed(last_write) < FLASH_STORE_IDLE_TIME) {
+    return;
+  }
+  if (!spare_erased) {
+    flash_store_erase_page(active ^ 1);
+    spare_erased = true;
+  } else if (next_record >= PAGE_RECORDS * 3 / 4) {
+    // Nearly full, better to copy it now than in the middle of typing
+    compact();
+    last_write = timer_read();
+  }
+}
@@ -0,0 +1,77 @@
+/*
+EEPROM emulation on two pages of flash
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FLASH_STORE_H
+#define FLASH_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * EEPROM emulation on two pages of flash.
+ *
+ * Every write appends a record with the address and the new value to the
+ * active page, so a write only programs two half-words and never erases.
+ * When the active page is full the current values are copied to the other
+ * page, which is erased beforehand by flash_store_task() while the keyboard
+ * is idle. The values are kept in RAM, so reads don't touch the flash.
+ *
+ * A record that was cut short by a power loss fails its check and is
+ * skipped, and a copy that didn't finish leaves the old page active.
+ */
+
+// Bytes of EEPROM emulated, addresses 0xFF and up can't be stored
+#ifndef FLASH_STORE_SIZE
+  #define FLASH_STORE_SIZE 64
+#endif
+
+// Size of one of the two pages, in bytes
+#ifndef FLASH_STORE_PAGE_SIZE
+  #define FLASH_STORE_PAGE_SIZE 2048
+#endif
+
+// How long there have to be no writes before the flash is erased or
+// compacted in the background, in ms
+#ifndef FLASH_STORE_IDLE_TIME
+  #define FLASH_STORE_IDLE_TIME 5000
+#endif
+
+#if FLASH_STORE_SIZE > 255
+  #error "FLASH_STORE_SIZE can't be more than 255"
+#endif
+// Room for every value twice over, so a copy always frees up half the page
+#if FLASH_STORE_SIZE * 8 + 4 > FLASH_STORE_PAGE_SIZE
+  #error "FLASH_STORE_PAGE_SIZE is too small for FLASH_STORE_SIZE"
+#endif
+
+// Scans the flash and loads the values, done on the first access otherwise
+void flash_store_init(void);
+uint8_t flash_store_read_byte(uint16_t addr);
+void flash_store_write_byte(uint16_t addr, uint8_t value);
+// Erases and compacts pages ahead of time, call it from the main loop
+void flash_store_task(void);
+
+/*
+ * The flash, provided by the platform. Offsets are in bytes from the start
+ * of the page and always even. Like on the STM32, a half-word can only be
+ * programmed when it's erased, or to 0.
+ */
+uint16_t flash_store_read_halfword(uint8_t page, uint16_t offset);
+void flash_store_program_halfword(uint8_t page, uint16_t offset, uint16_t value);
+void flash_store_erase_page(uint8_t page);
+
+#endif
@@ -66,6 +66,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef POINTING_DEVICE_ENABLE
 #   include "pointing_device.h"
 #endif
+#ifdef MATRIX_IDLE_WAKE_ENABLE
+#   include "matrix_idle.h"
+#endif
 
 #ifdef MATRIX_HAS_GHOST
 extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
@@ -179,7 +182,12 @@ void keyboard_task(void)
     matrix_row_t matrix_change = 0;
 
     matrix_scan();
+#ifdef MATRIX_IDLE_WAKE_ENABLE
+    // The matrix wasn't scanned, so there's nothing to compare
+    if (is_keyboard_master() && !matrix_idle_is_asleep()) {
+#else
     if (is_keyboard_master()) {
+#endif
         for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
             matrix_row = matrix_get_row(r);
             matrix_change = matrix_row ^ matrix_prev[r];
@@ -249,6 +257,8 @@ MATRIX_LOOP_END:
     pointing_device_task();
 #endif
 
+    eeconfig_task();
+
     // update LED
     if (led_status != host_keyboard_leds()) {
         led_status = host_keyboard_leds();
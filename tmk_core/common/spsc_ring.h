@@ -0,0 +1,146 @@
+/*
+Lock-free single producer, single consumer byte ring
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * A byte queue between one producer and one consumer, for instance an
+ * interrupt and the main loop, or two threads. Nothing is locked and the
+ * interrupts stay on: the producer only ever writes head and the consumer
+ * only ever writes tail, and both are single bytes.
+ *
+ * The size is a power of two up to 256, and one byte is always left free
+ * to tell a full ring from an empty one.
+ *
+ * Each side reads the other's index with acquire and publishes its own with
+ * release, so the data is in place before the index that hands it over.
+ * That's a compiler barrier on AVR and a DMB on Cortex-M.
+ *
+ * The functions are split by side: push for the producer, pop, peek, skip
+ * and clear for the consumer, count and space for either.
+ */
+
+typedef struct {
+    uint8_t head;
+    uint8_t tail;
+    uint8_t mask;
+    uint8_t* data;
+} spsc_ring_t;
+
+#define SPSC_RING_IS_SIZE(size) ((size) >= 2 && (size) <= 256 && ((size) & ((size) - 1)) == 0)
+
+// For a static ring on a static buffer
+#define SPSC_RING_INITIALIZER(buffer) { 0, 0, sizeof(buffer) - 1, buffer }
+
+#define spsc_ring_load(index) __atomic_load_n(index, __ATOMIC_ACQUIRE)
+#define spsc_ring_store(index, value) __atomic_store_n(index, value, __ATOMIC_RELEASE)
+
+static inline void spsc_ring_init(spsc_ring_t* ring, uint8_t* data, uint16_t size) {
+    ring->head = 0;
+    ring->tail = 0;
+    ring->mask = size - 1;
+    ring->data = data;
+}
+
+static inline uint8_t spsc_ring_count(spsc_ring_t* ring) {
+    return (spsc_ring_load(&ring->head) - spsc_ring_load(&ring->tail)) & ring->mask;
+}
+
+static inline uint8_t spsc_ring_space(spsc_ring_t* ring) {
+    return ring->mask - spsc_ring_count(ring);
+}
+
+static inline bool spsc_ring_push(spsc_ring_t* ring, uint8_t byte) {
+    uint8_t head = ring->head;
+    uint8_t next = (head + 1) & ring->mask;
+    if (next == spsc_ring_load(&ring->tail)) {
+        return false;
+    }
+    ring->data[head] = byte;
+    spsc_ring_store(&ring->head, next);
+    return true;
+}
+
+// Pushes as much as fits, returns how much that was
+static inline uint8_t spsc_ring_push_bulk(spsc_ring_t* ring, const uint8_t* data, uint8_t length) {
+    uint8_t head = ring->head;
+    uint8_t space = (spsc_ring_load(&ring->tail) - head - 1) & ring->mask;
+    if (length > space) {
+        length = space;
+    }
+    for (uint8_t i = 0; i < length; i++) {
+        ring->data[head] = data[i];
+        head = (head + 1) & ring->mask;
+    }
+    spsc_ring_store(&ring->head, head);
+    return length;
+}
+
+static inline bool spsc_ring_pop(spsc_ring_t* ring, uint8_t* byte) {
+    uint8_t tail = ring->tail;
+    if (tail == spsc_ring_load(&ring->head)) {
+        return false;
+    }
+    *byte = ring->data[tail];
+    spsc_ring_store(&ring->tail, (tail + 1) & ring->mask);
+    return true;
+}
+
+// Pops up to length bytes, returns how many there were
+static inline uint8_t spsc_ring_pop_bulk(spsc_ring_t* ring, uint8_t* data, uint8_t length) {
+    uint8_t tail = ring->tail;
+    uint8_t count = (spsc_ring_load(&ring->head) - tail) & ring->mask;
+    if (length > count) {
+        length = count;
+    }
+    for (uint8_t i = 0; i < length; i++) {
+        data[i] = ring->data[tail];
+        tail = (tail + 1) & ring->mask;
+    }
+    spsc_ring_store(&ring->tail, tail);
+    return length;
+}
+
+// The byte index places from the front, without popping it
+static inline bool spsc_ring_peek(spsc_ring_t* ring, uint8_t index, uint8_t* byte) {
+    uint8_t tail = ring->tail;
+    if (index >= ((spsc_ring_load(&ring->head) - tail) & ring->mask)) {
+        return false;
+    }
+    *byte = ring->data[(tail + index) & ring->mask];
+    return true;
+}
+
+// Drops count bytes from the front, no more than there are
+static inline void spsc_ring_skip(spsc_ring_t* ring, uint8_t count) {
+    uint8_t tail = ring->tail;
+    uint8_t available = (spsc_ring_load(&ring->head) - tail) & ring->mask;
+    if (count > available) {
+        count = available;
+    }
+    spsc_ring_store(&ring->tail, (tail + count) & ring->mask);
+}
+
+static inline void spsc_ring_clear(spsc_ring_t* ring) {
+    spsc_ring_store(&ring->tail, spsc_ring_load(&ring->head));
+}
+
+#endif
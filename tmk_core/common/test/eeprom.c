@@ -19,6 +19,12 @@
 #define EEPROM_SIZE 32
 
 static uint8_t buffer[EEPROM_SIZE];
+// Bytes written so far, so the tests can check for EEPROM wear
+static uint32_t bytes_written = 0;
+
+uint32_t eeprom_bytes_written(void) {
+	return bytes_written;
+}
 
 uint8_t eeprom_read_byte(const uint8_t *addr) {
 	uintptr_t offset = (uintptr_t)addr;
@@ -28,6 +34,7 @@ uint8_t eeprom_read_byte(const uint8_t *addr) {
 void eeprom_write_byte(uint8_t *addr, uint8_t value) {
 	uintptr_t offset = (uintptr_t)addr;
 	buffer[offset] = value;
+	bytes_written++;
 }
 
 uint16_t eeprom_read_word(const uint16_t *addr) {
@@ -71,28 +78,31 @@ void eeprom_write_block(const void *buf, void *addr, uint32_t len) {
 	}
 }
 
+// Like on AVR, the update functions only write the bytes that change
 void eeprom_update_byte(uint8_t *addr, uint8_t value) {
-	eeprom_write_byte(addr, value);
+	if (eeprom_read_byte(addr) != value) {
+		eeprom_write_byte(addr, value);
+	}
 }
 
 void eeprom_update_word(uint16_t *addr, uint16_t value) {
 	uint8_t *p = (uint8_t *)addr;
-	eeprom_write_byte(p++, value);
-	eeprom_write_byte(p, value >> 8);
+	eeprom_update_byte(p++, value);
+	eeprom_update_byte(p, value >> 8);
 }
 
 void eeprom_update_dword(uint32_t *addr, uint32_t value) {
 	uint8_t *p = (uint8_t *)addr;
-	eeprom_write_byte(p++, value);
-	eeprom_write_byte(p++, value >> 8);
-	eeprom_write_byte(p++, value >> 16);
-	eeprom_write_byte(p, value >> 24);
+	eeprom_update_byte(p++, value);
+	eeprom_update_byte(p++, value >> 8);
+	eeprom_update_byte(p++, value >> 16);
+	eeprom_update_byte(p, value >> 24);
 }
 
 void eeprom_update_block(const void *buf, void *addr, uint32_t len) {
 	uint8_t *p = (uint8_t *)addr;
 	const uint8_t *src = (const uint8_t *)buf;
 	while (len--) {
-		eeprom_write_byte(p++, *src++);
+		eeprom_update_byte(p++, *src++);
 	}
 }
@@ -42,6 +42,10 @@
 #include "visualizer/visualizer.h"
 #endif
 #include "suspend.h"
+#include "eeprom.h"
+#ifdef RGBLIGHT_ENABLE
+#include "rgblight.h"
+#endif
 #include "wait.h"
 
 /* -------------------------
@@ -182,5 +186,9 @@ int main(void) {
     }
 
     keyboard_task();
+    eeprom_task();
+#if defined(RGBLIGHT_ANIMATIONS) & defined(RGBLIGHT_ENABLE)
+    rgblight_task();
+#endif
   }
 }
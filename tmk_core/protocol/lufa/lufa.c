@@ -98,7 +98,7 @@ static uint8_t keyboard_led_stats = 0;
 static report_keyboard_t keyboard_report_sent;
 
 #ifdef MIDI_ENABLE
-static void usb_send_func(MidiDevice * device, uint16_t cnt, uint8_t byte0, uint8_t byte1, uint8_t byte2);
+static uint8_t usb_send_midi(MidiDevice * device, const midi_output_event_t * events, uint8_t count);
 static void usb_get_midi(MidiDevice * device);
 static void midi_usb_init(MidiDevice * device);
 #endif
@@ -116,7 +116,7 @@ host_driver_t lufa_driver = {
     send_system,
     send_consumer,
 #ifdef MIDI_ENABLE
-    usb_send_func,
+    midi_device_queue_output,
     usb_get_midi,
     midi_usb_init
 #endif
@@ -853,64 +853,85 @@ int8_t sendchar(uint8_t c)
  ******************************************************************************/
 
 #ifdef MIDI_ENABLE
-static void usb_send_func(MidiDevice * device, uint16_t cnt, uint8_t byte0, uint8_t byte1, uint8_t byte2) {
-  MIDI_EventPacket_t event;
-  event.Data1 = byte0;
-  event.Data2 = byte1;
-  event.Data3 = byte2;
+// The USB-MIDI packet for an event, false if it has none
+static bool usb_midi_event(const midi_output_event_t * output, MIDI_EventPacket_t * event) {
+  uint8_t cnt = output->count;
+  uint8_t byte0 = output->data[0];
+  uint8_t byte1 = output->data[1];
+  uint8_t byte2 = output->data[2];
+  event->Data1 = byte0;
+  event->Data2 = byte1;
+  event->Data3 = byte2;
 
   uint8_t cable = 0;
 
-// Endpoint_SelectEndpoint(MIDI_STREAM_IN_EPNUM);
-
   //if the length is undefined we assume it is a SYSEX message
   if (midi_packet_length(byte0) == UNDEFINED) {
     switch(cnt) {
       case 3:
         if (byte2 == SYSEX_END)
-          event.Event = MIDI_EVENT(cable, SYSEX_ENDS_IN_3);
+          event->Event = MIDI_EVENT(cable, SYSEX_ENDS_IN_3);
         else
-          event.Event = MIDI_EVENT(cable, SYSEX_START_OR_CONT);
+          event->Event = MIDI_EVENT(cable, SYSEX_START_OR_CONT);
         break;
       case 2:
         if (byte1 == SYSEX_END)
-          event.Event = MIDI_EVENT(cable, SYSEX_ENDS_IN_2);
+          event->Event = MIDI_EVENT(cable, SYSEX_ENDS_IN_2);
         else
-          event.Event = MIDI_EVENT(cable, SYSEX_START_OR_CONT);
+          event->Event = MIDI_EVENT(cable, SYSEX_START_OR_CONT);
         break;
       case 1:
         if (byte0 == SYSEX_END)
-          event.Event = MIDI_EVENT(cable, SYSEX_ENDS_IN_1);
+          event->Event = MIDI_EVENT(cable, SYSEX_ENDS_IN_1);
         else
-          event.Event = MIDI_EVENT(cable, SYSEX_START_OR_CONT);
+          event->Event = MIDI_EVENT(cable, SYSEX_START_OR_CONT);
         break;
       default:
-        return; //invalid cnt
+        return false; //invalid cnt
     }
   } else {
     //deal with 'system common' messages
     //TODO are there any more?
     switch(byte0 & 0xF0){
       case MIDI_SONGPOSITION:
-        event.Event = MIDI_EVENT(cable, SYS_COMMON_3);
+        event->Event = MIDI_EVENT(cable, SYS_COMMON_3);
         break;
       case MIDI_SONGSELECT:
       case MIDI_TC_QUARTERFRAME:
-        event.Event = MIDI_EVENT(cable, SYS_COMMON_2);
+        event->Event = MIDI_EVENT(cable, SYS_COMMON_2);
         break;
       default:
-        event.Event = MIDI_EVENT(cable, byte0);
+        event->Event = MIDI_EVENT(cable, byte0);
         break;
     }
   }
+  return true;
+}
 
-// Endpoint_Write_Stream_LE(&event, sizeof(event), NULL);
-// Endpoint_ClearIN();
+// Up to a full endpoint of events in one packet, once a pass of the main
+// loop, instead of a packet for each event
+static uint8_t usb_send_midi(MidiDevice * device, const midi_output_event_t * events, uint8_t count) {
+  //nobody is listening, the events are thrown away like they always were
+  if (USB_DeviceState != DEVICE_STATE_Configured)
+    return count;
+
+  //the events wait for the next pass, unless the queue is full, then this
+  //waits for the host like every event used to
+  Endpoint_SelectEndpoint(MIDI_STREAM_IN_EPADDR);
+  if (!Endpoint_IsINReady()) {
+    if (count < MIDI_OUTPUT_QUEUE_LENGTH || Endpoint_WaitUntilReady() != ENDPOINT_READYWAIT_NoError)
+      return 0;
+  }
 
-  MIDI_Device_SendEventPacket(&USB_MIDI_Interface, &event);
-  MIDI_Device_Flush(&USB_MIDI_Interface);
-  MIDI_Device_USBTask(&USB_MIDI_Interface);
-  USB_USBTask();
+  uint8_t sent = 0;
+  while (sent < count && sent < MIDI_STREAM_EPSIZE / sizeof(MIDI_EventPacket_t)) {
+    MIDI_EventPacket_t event;
+    if (usb_midi_event(&events[sent], &event))
+      Endpoint_Write_Stream_LE(&event, sizeof(event), NULL);
+    sent++;
+  }
+  Endpoint_ClearIN();
+  return sent;
 }
 
 static void usb_get_midi(MidiDevice * device) {
@@ -945,80 +966,13 @@ static void usb_get_midi(MidiDevice * device) {
 
 static void midi_usb_init(MidiDevice * device){
   midi_device_init(device);
-  midi_device_set_send_func(device, usb_send_func);
+  midi_device_set_batch_send_func(device, usb_send_midi);
   midi_device_set_pre_input_process_func(device, usb_get_midi);
 
   // SetupHardware();
   sei();
 }
 
-void MIDI_Task(void)
-{
-
-    /* Device must be connected and configured for the task to run */
-    dprint("in MIDI_TASK\n");
-    if (USB_DeviceState != DEVICE_STATE_Configured)
-      return;
-    dprint("continuing in MIDI_TASK\n");
-
-    Endpoint_SelectEndpoint(MIDI_STREAM_IN_EPADDR);
-
-    if (Endpoint_IsINReady())
-    {
-
-        dprint("Endpoint is ready\n");
-
-        uint8_t MIDICommand = 0;
-        uint8_t MIDIPitch;
-
-        /* Get board button status - if pressed use channel 10 (percussion), otherwise use channel 1 */
-        uint8_t Channel = MIDI_CHANNEL(1);
-
-        MIDICommand = MIDI_COMMAND_NOTE_ON;
-        MIDIPitch   = 0x3E;
-
-        /* Check if a MIDI command is to be sent */
-        if (MIDICommand)
-        {
-            dprint("Command exists\n");
-            MIDI_EventPacket_t MIDIEvent = (MIDI_EventPacket_t)
-                {
-                    .Event       = MIDI_EVENT(0, MIDICommand),
-
-                    .Data1       = MIDICommand | Channel,
-                    .Data2       = MIDIPitch,
-                    .Data3       = MIDI_STANDARD_VELOCITY,
-                };
-
-            /* Write the MIDI event packet to the endpoint */
-            Endpoint_Write_Stream_LE(&MIDIEvent, sizeof(MIDIEvent), NULL);
-
-            /* Send the data in the endpoint to the host */
-            Endpoint_ClearIN();
-        }
-    }
-
-
-    /* Select the MIDI OUT stream */
-    Endpoint_SelectEndpoint(MIDI_STREAM_OUT_EPADDR);
-
-    /* Check if a MIDI command has been received */
-    if (Endpoint_IsOUTReceived())
-    {
-        MIDI_EventPacket_t MIDIEvent;
-
-        /* Read the MIDI event packet from the endpoint */
-        Endpoint_Read_Stream_LE(&MIDIEvent, sizeof(MIDIEvent), NULL);
-
-        /* If the endpoint is now empty, clear the bank */
-        if (!(Endpoint_BytesInEndpoint()))
-        {
-            /* Clear the endpoint ready for new packet */
-            Endpoint_ClearOUT();
-        }
-    }
-}
-
 #endif
 
 /*******************************************************************************
@@ -1120,7 +1074,7 @@ void setup_midi(void)
 	midi_init();
 #endif
 	midi_device_init(&midi_device);
-    midi_device_set_send_func(&midi_device, usb_send_func);
+    midi_device_set_batch_send_func(&midi_device, usb_send_midi);
     midi_device_set_pre_input_process_func(&midi_device, usb_get_midi);
 }
 #endif
@@ -1251,41 +1205,9 @@ void cc_callback(MidiDevice * device,
   // midi_send_cc(device, (chan + 1) % 16, num, val);
 }
 
-#ifdef API_SYSEX_ENABLE
-uint8_t midi_buffer[MIDI_SYSEX_BUFFER] = {0};
-#endif
-
 void sysex_callback(MidiDevice * device, uint16_t start, uint8_t length, uint8_t * data) {
     #ifdef API_SYSEX_ENABLE
-        // SEND_STRING("\n");
-        // send_word(start);
-        // SEND_STRING(": ");
-        // Don't store the header
-        int16_t pos = start - 4;
-        for (uint8_t place = 0; place < length; place++) {
-            // send_byte(*data);
-            if (pos >= 0) {
-                if (*data == 0xF7) {
-                    // SEND_STRING("\nRD: ");
-                    // for (uint8_t i = 0; i < start + place + 1; i++){
-                    //     send_byte(midi_buffer[i]);
-                    // SEND_STRING(" ");
-                    // }
-                    const unsigned decoded_length = sysex_decoded_length(pos);
-                    uint8_t decoded[API_SYSEX_MAX_SIZE];
-                    sysex_decode(decoded, midi_buffer, pos);
-                    process_api(decoded_length, decoded);
-                    return;
-                }
-                else if (pos >= MIDI_SYSEX_BUFFER) {
-                    return;
-                }
-                midi_buffer[pos] = *data;
-            }
-            // SEND_STRING(" ");
-            data++;
-            pos++;
-        }
+        recv_bytes_sysex(start, length, data);
     #endif
 }
 
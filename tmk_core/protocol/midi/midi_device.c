@@ -18,6 +18,7 @@
 
 #include "midi_device.h"
 #include "midi.h"
+#include <string.h>
 
 #ifndef NULL
 #define NULL 0
@@ -30,7 +31,10 @@ void midi_process_byte(MidiDevice * device, uint8_t input);
 void midi_device_init(MidiDevice * device){
   device->input_state = IDLE;
   device->input_count = 0;
-  bytequeue_init(&device->input_queue, device->input_queue_data, MIDI_INPUT_QUEUE_LENGTH);
+  spsc_ring_init(&device->input_queue, device->input_queue_data, MIDI_INPUT_QUEUE_LENGTH);
+  device->batch_send_func = NULL;
+  device->output_count = 0;
+  device->output_drops = 0;
 
   //three byte funcs
   device->input_cc_callback = NULL;
@@ -59,9 +63,8 @@ void midi_device_init(MidiDevice * device){
 }
 
 void midi_device_input(MidiDevice * device, uint8_t cnt, uint8_t * input) {
-  uint8_t i;
-  for (i = 0; i < cnt; i++)
-    bytequeue_enqueue(&device->input_queue, input[i]);
+  //whatever doesn't fit is dropped
+  spsc_ring_push_bulk(&device->input_queue, input, cnt);
 }
 
 void midi_device_set_send_func(MidiDevice * device, midi_var_byte_func_t send_func){
@@ -72,20 +75,101 @@ void midi_device_set_pre_input_process_func(MidiDevice * device, midi_no_byte_fu
   device->pre_input_process_callback = pre_process_func;
 }
 
+void midi_device_set_batch_send_func(MidiDevice * device, midi_batch_send_func_t batch_send_func){
+  device->send_func = midi_device_queue_output;
+  device->batch_send_func = batch_send_func;
+}
+
+//a controller where only the latest value matters, not the data entry,
+//increment/decrement and (N)RPN select controllers or the channel modes
+static bool midi_cc_coalesces(const midi_output_event_t * event) {
+  if (event->count != 3 || (event->data[0] & 0xF0) != MIDI_CC)
+    return false;
+  uint8_t num = event->data[1];
+  return num != 6 && num != 38 && (num < 96 || num > 101) && num < 120;
+}
+
+void midi_device_queue_output(MidiDevice * device, uint16_t cnt, uint8_t byte0, uint8_t byte1, uint8_t byte2) {
+  midi_output_event_t event = {cnt, {byte0, byte1, byte2}};
+
+  //a newer value for a controller waiting behind nothing but other controllers
+  if (midi_cc_coalesces(&event)) {
+    uint8_t i = device->output_count;
+    while (i > 0 && midi_cc_coalesces(&device->output_queue[i - 1])) {
+      i--;
+      midi_output_event_t * queued = &device->output_queue[i];
+      if (queued->data[0] == byte0 && queued->data[1] == byte1) {
+        queued->data[2] = byte2;
+        return;
+      }
+    }
+  }
+
+  if (device->output_count == MIDI_OUTPUT_QUEUE_LENGTH)
+    midi_device_flush_output(device);
+  if (device->output_count == MIDI_OUTPUT_QUEUE_LENGTH) {
+    device->output_drops++;
+    return;
+  }
+  device->output_queue[device->output_count++] = event;
+}
+
+void midi_device_flush_output(MidiDevice * device) {
+  uint8_t sent = 0;
+  while (sent < device->output_count) {
+    uint8_t n = device->batch_send_func(device, device->output_queue + sent, device->output_count - sent);
+    if (n == 0)
+      break;
+    sent += n;
+  }
+  if (sent > 0) {
+    device->output_count -= sent;
+    memmove(device->output_queue, device->output_queue + sent, device->output_count * sizeof(midi_output_event_t));
+  }
+}
+
+uint16_t midi_device_output_drops(MidiDevice * device) {
+  return device->output_drops;
+}
+
+uint8_t midi_running_status_encode(uint8_t * running_status, const midi_output_event_t * event, uint8_t * output) {
+  uint8_t status = event->data[0];
+  uint8_t skip = 0;
+  if (midi_is_realtime(status)) {
+    //can go anywhere, even between the bytes of another message
+  } else if (status >= SYSEX_BEGIN) {
+    *running_status = 0;
+  } else if (midi_is_statusbyte(status)) {
+    if (status == *running_status)
+      skip = 1;
+    *running_status = status;
+  }
+  //else sysex data, after a SYSEX_BEGIN that already cleared it
+
+  uint8_t i;
+  for (i = skip; i < event->count; i++)
+    output[i - skip] = event->data[i];
+  return event->count - skip;
+}
+
 void midi_device_process(MidiDevice * device) {
   //call the pre_input_process_callback if there is one
   if(device->pre_input_process_callback)
     device->pre_input_process_callback(device);
 
   //pull stuff off the queue and process
-  byteQueueIndex_t len = bytequeue_length(&device->input_queue);
+  uint8_t len = spsc_ring_count(&device->input_queue);
   uint16_t i;
   //TODO limit number of bytes processed?
   for(i = 0; i < len; i++) {
-    uint8_t val = bytequeue_get(&device->input_queue, 0);
+    uint8_t val = 0;
+    spsc_ring_pop(&device->input_queue, &val);
     midi_process_byte(device, val);
-    bytequeue_remove(&device->input_queue, 1);
   }
+
+  //send what was queued since the last time
+  if (device->batch_send_func)
+    midi_device_flush_output(device);
 }
 
 void midi_process_byte(MidiDevice * device, uint8_t input) {
@@ -48,8 +48,21 @@ extern "C" {
  */
 
 #include "midi_function_types.h"
-#include "bytequeue/bytequeue.h"
-#define MIDI_INPUT_QUEUE_LENGTH 192
+#include "spsc_ring.h"
+// A power of two, up to 256
+#define MIDI_INPUT_QUEUE_LENGTH 128
+// As many as one USB-MIDI endpoint write takes
+#define MIDI_OUTPUT_QUEUE_LENGTH 16
+
+//one event waiting to be sent, as it was given to the send function
+typedef struct {
+   uint8_t count;
+   uint8_t data[3];
+} midi_output_event_t;
+
+//sends events from the front of the queue, returns how many it took, 0 if
+//the transport can't take any right now
+typedef uint8_t (* midi_batch_send_func_t)(MidiDevice * device, const midi_output_event_t * events, uint8_t count);
 
 typedef enum {
    IDLE, 
@@ -73,6 +86,8 @@ typedef void (* midi_no_byte_func_t)(MidiDevice * device);
 struct _midi_device {
    //output send function
    midi_var_byte_func_t send_func;
+   //output batch send function, when the output is queued
+   midi_batch_send_func_t batch_send_func;
 
    //********input callbacks
    //three byte funcs
@@ -109,7 +124,12 @@ struct _midi_device {
 
    //for queueing data between the input and the processing functions
    uint8_t input_queue_data[MIDI_INPUT_QUEUE_LENGTH];
-   byteQueue_t input_queue;
+   spsc_ring_t input_queue;
+
+   //for queueing output between the send functions and the batch send function
+   midi_output_event_t output_queue[MIDI_OUTPUT_QUEUE_LENGTH];
+   uint8_t output_count;
+   uint16_t output_drops;
 };
 
 /**
@@ -147,6 +167,58 @@ void midi_device_set_send_func(MidiDevice * device, midi_var_byte_func_t send_fu
  */
 void midi_device_set_pre_input_process_func(MidiDevice * device, midi_no_byte_func_t pre_process_func);
 
+/**
+ * @brief Queue the output and send it in batches instead of an event at a
+ * time.  The send functions queue their events, and midi_device_process
+ * hands the queue to batch_send_func at the end, so that everything sent in
+ * one pass of the main loop can go out in one transfer.
+ *
+ * Control changes to a controller that's already waiting in the queue, with
+ * only other control changes after it, update that event instead of being
+ * queued, so a fast sweep sends only its latest value.
+ *
+ * When the queue is full and the transport can't take anything, the new
+ * event is dropped, see midi_device_output_drops.
+ *
+ * \param device the midi device to associate this callback with
+ * \param batch_send_func the callback function that will do the sending
+ */
+void midi_device_set_batch_send_func(MidiDevice * device, midi_batch_send_func_t batch_send_func);
+
+/**
+ * @brief The send function used with midi_device_set_batch_send_func, which
+ * queues an event.
+ */
+void midi_device_queue_output(MidiDevice * device, uint16_t cnt, uint8_t byte0, uint8_t byte1, uint8_t byte2);
+
+/**
+ * @brief Send what's in the output queue, as far as the transport takes it.
+ * midi_device_process already does this.
+ *
+ * \param device the midi device to flush
+ */
+void midi_device_flush_output(MidiDevice * device);
+
+/**
+ * @brief The number of output events dropped because the queue was full.
+ *
+ * \param device the midi device
+ */
+uint16_t midi_device_output_drops(MidiDevice * device);
+
+/**
+ * @brief Serialize an event for a serial MIDI transport with running
+ * status, leaving the status byte out when it's the same as the last one.
+ * Real time messages go through without changing the running status, and
+ * system common and sysex messages clear it.
+ *
+ * \param running_status the last status sent, 0 to start with
+ * \param event the event to serialize
+ * \param output room for 3 bytes
+ * \return the number of bytes written to output
+ */
+uint8_t midi_running_status_encode(uint8_t * running_status, const midi_output_event_t * event, uint8_t * output);
+
 /**@}*/
 
 #ifdef __cplusplus
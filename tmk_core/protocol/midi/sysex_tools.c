@@ -97,3 +97,50 @@ uint16_t sysex_decode(uint8_t *decoded, const uint8_t *source, const uint16_t le
    }
 }
 
+void sysex_encoder_init(sysex_encoder_t *encoder, sysex_sink_func_t sink, void *context){
+   encoder->sink = sink;
+   encoder->context = context;
+   encoder->count = 0;
+}
+
+void sysex_encoder_write(sysex_encoder_t *encoder, const uint8_t *source, uint16_t length){
+   uint16_t i;
+   for(i = 0; i < length; i++){
+      encoder->group[encoder->count++] = source[i];
+      if (encoder->count == 7)
+         sysex_encoder_finish(encoder);
+   }
+}
+
+void sysex_encoder_finish(sysex_encoder_t *encoder){
+   uint8_t j;
+   uint8_t msbs = 0;
+   if (encoder->count == 0)
+      return;
+   for(j = 0; j < encoder->count; j++)
+      msbs |= (0x80 & encoder->group[j]) >> (1 + j);
+   encoder->sink(encoder->context, msbs);
+   for(j = 0; j < encoder->count; j++)
+      encoder->sink(encoder->context, 0x7F & encoder->group[j]);
+   encoder->count = 0;
+}
+
+void sysex_decoder_init(sysex_decoder_t *decoder, sysex_sink_func_t sink, void *context){
+   decoder->sink = sink;
+   decoder->context = context;
+   decoder->position = 0;
+   decoder->msbs = 0;
+}
+
+void sysex_decoder_write(sysex_decoder_t *decoder, const uint8_t *source, uint16_t length){
+   uint16_t i;
+   for(i = 0; i < length; i++){
+      //each group starts with the top bits of the bytes that follow
+      if (decoder->position == 0) {
+         decoder->msbs = source[i];
+      } else {
+         decoder->sink(decoder->context, (0x7F & source[i]) | (0x80 & (decoder->msbs << decoder->position)));
+      }
+      decoder->position = decoder->position == 7 ? 0 : decoder->position + 1;
+   }
+}
@@ -86,6 +86,78 @@ uint16_t sysex_encode(uint8_t *encoded, const uint8_t *source, uint16_t length);
  */
 uint16_t sysex_decode(uint8_t *decoded, const uint8_t *source, uint16_t length);
 
+/**
+ * @brief Where the streaming encoder and decoder put their output, a byte at
+ * a time.
+ */
+typedef void (* sysex_sink_func_t)(void *context, uint8_t byte);
+
+/**
+ * @brief State of a streaming encoder, which produces the same bytes as
+ * sysex_encode without the whole message in memory.  It only holds on to
+ * the 7 bytes of the group in progress, as their top bits go out first.
+ */
+typedef struct {
+   sysex_sink_func_t sink;
+   void *context;
+   uint8_t count;
+   uint8_t group[7];
+} sysex_encoder_t;
+
+/**
+ * @brief State of a streaming decoder, which produces the same bytes as
+ * sysex_decode, each one as soon as it's complete.
+ */
+typedef struct {
+   sysex_sink_func_t sink;
+   void *context;
+   uint8_t position;
+   uint8_t msbs;
+} sysex_decoder_t;
+
+/**
+ * @brief Start encoding a message.
+ *
+ * @param encoder The encoder state.
+ * @param sink Called with each encoded byte.
+ * @param context Passed to the sink.
+ */
+void sysex_encoder_init(sysex_encoder_t *encoder, sysex_sink_func_t sink, void *context);
+
+/**
+ * @brief Encode the next part of a message, in pieces of any length.
+ *
+ * @param encoder The encoder state.
+ * @param source The input buffer of data to be encoded.
+ * @param length The number of bytes from the input buffer to encode.
+ */
+void sysex_encoder_write(sysex_encoder_t *encoder, const uint8_t *source, uint16_t length);
+
+/**
+ * @brief Send out the last, incomplete group of the message.
+ *
+ * @param encoder The encoder state, which is ready for the next message afterwards.
+ */
+void sysex_encoder_finish(sysex_encoder_t *encoder);
+
+/**
+ * @brief Start decoding a message.
+ *
+ * @param decoder The decoder state.
+ * @param sink Called with each decoded byte.
+ * @param context Passed to the sink.
+ */
+void sysex_decoder_init(sysex_decoder_t *decoder, sysex_sink_func_t sink, void *context);
+
+/**
+ * @brief Decode the next part of a message, in pieces of any length.
+ *
+ * @param decoder The decoder state.
+ * @param source The input buffer of data to be decoded.
+ * @param length The number of bytes from the input buffer to decode.
+ */
+void sysex_decoder_write(sysex_decoder_t *decoder, const uint8_t *source, uint16_t length);
+
 /**@}*/
 
 #ifdef __cplusplus
@@ -39,6 +39,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include "serial.h"
+#include "spsc_ring.h"
 
 
 #if defined(SERIAL_UART_RTS_LO) && defined(SERIAL_UART_RTS_HI)
@@ -46,7 +47,7 @@ POSSIBILITY OF SUCH DAMAGE.
     //   Empty:           RBUF_SPACE == RBUF_SIZE(head==tail)
     //   Last 1 space:    RBUF_SPACE == 2
     //   Full:            RBUF_SPACE == 1(last cell of rbuf be never used.)
-    #define RBUF_SPACE()   (rbuf_head < rbuf_tail ?  (rbuf_tail - rbuf_head) : (RBUF_SIZE - rbuf_head + rbuf_tail))
+    #define RBUF_SPACE()   (spsc_ring_space(&rbuf) + 1)
     // allow to send
     #define rbuf_check_rts_lo() do { if (RBUF_SPACE() > 2) SERIAL_UART_RTS_LO(); } while (0)
     // prohibit to send
@@ -62,21 +63,18 @@ void serial_init(void)
     SERIAL_UART_INIT();
 }
 
-// RX ring buffer
+// RX ring buffer, filled from the interrupt
 #define RBUF_SIZE   256
-static uint8_t rbuf[RBUF_SIZE];
-static uint8_t rbuf_head = 0;
-static uint8_t rbuf_tail = 0;
+static uint8_t rbuf_data[RBUF_SIZE];
+static spsc_ring_t rbuf = SPSC_RING_INITIALIZER(rbuf_data);
 
 uint8_t serial_recv(void)
 {
     uint8_t data = 0;
-    if (rbuf_head == rbuf_tail) {
+    if (!spsc_ring_pop(&rbuf, &data)) {
         return 0;
     }
 
-    data = rbuf[rbuf_tail];
-    rbuf_tail = (rbuf_tail + 1) % RBUF_SIZE;
     rbuf_check_rts_lo();
     return data;
 }
@@ -84,12 +82,10 @@ uint8_t serial_recv(void)
 int16_t serial_recv2(void)
 {
     uint8_t data = 0;
-    if (rbuf_head == rbuf_tail) {
+    if (!spsc_ring_pop(&rbuf, &data)) {
         return -1;
     }
 
-    data = rbuf[rbuf_tail];
-    rbuf_tail = (rbuf_tail + 1) % RBUF_SIZE;
     rbuf_check_rts_lo();
     return data;
 }
@@ -103,10 +99,8 @@ void serial_send(uint8_t data)
 // USART RX complete interrupt
 ISR(SERIAL_UART_RXD_VECT)
 {
-    uint8_t next = (rbuf_head + 1) % RBUF_SIZE;
-    if (next != rbuf_tail) {
-        rbuf[rbuf_head] = SERIAL_UART_DATA;
-        rbuf_head = next;
-    }
+    // Read even when it's full, to clear the interrupt
+    uint8_t data = SERIAL_UART_DATA;
+    spsc_ring_push(&rbuf, data);
     rbuf_check_rts_hi();
 }